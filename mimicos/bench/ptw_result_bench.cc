@@ -0,0 +1,187 @@
+/*
+ * Page-walk result microbenchmark
+ *
+ * Replays the host-side bookkeeping that one TLB miss costs in Sniper's MMU, for the
+ * access patterns of the radix, elastic cuckoo (ECH) and hashed (HDC) page tables:
+ * the page table builds its access list, performPTW deduplicates it, the PWC filter
+ * rebuilds it and calculatePTWCycles iterates over it.
+ *
+ *   before: std::vector access list, PTWResult passed by value (the old MMU plumbing)
+ *   after:  InlineVector access list, PTWResult passed by reference / deduplicated in place
+ *
+ * The walk contents are identical in both pipelines, so a checksum is printed per run.
+ *
+ * Usage: ./build/ptw_result_bench [misses]
+ */
+#include "misc/inline_vector.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using BenchClock = std::chrono::steady_clock;
+
+// Same layout as ParametricDramDirectoryMSI::PTWAccess
+struct PTWAccess
+{
+    int table_level;
+    int depth;
+    uintptr_t physical_addr;
+    bool is_pte;
+
+    PTWAccess() : table_level(0), depth(0), physical_addr(0), is_pte(false) {}
+    PTWAccess(int table_level, int depth, uintptr_t physical_addr, bool is_pte)
+        : table_level(table_level), depth(depth), physical_addr(physical_addr), is_pte(is_pte) {}
+
+    bool operator<(const PTWAccess& other) const
+    {
+        if (table_level != other.table_level) return table_level < other.table_level;
+        if (depth != other.depth) return depth < other.depth;
+        if (physical_addr != other.physical_addr) return physical_addr < other.physical_addr;
+        return is_pte < other.is_pte;
+    }
+    bool operator==(const PTWAccess& other) const
+    {
+        return table_level == other.table_level && depth == other.depth &&
+               physical_addr == other.physical_addr && is_pte == other.is_pte;
+    }
+};
+
+template <class List>
+struct PTWResult
+{
+    int page_size = 0;
+    List accesses;
+    uintptr_t ppn = 0;
+    bool fault_happened = false;
+
+    PTWResult() {}
+    PTWResult(int page_size, const List& accesses, uintptr_t ppn, bool fault_happened)
+        : page_size(page_size), accesses(accesses), ppn(ppn), fault_happened(fault_happened) {}
+};
+
+enum class WalkShape { RADIX, ECH, HDC };
+
+// Access pattern of one walk; the PTE addresses only depend on the VA
+template <class List>
+static PTWResult<List> walk(WalkShape shape, uintptr_t va)
+{
+    List accesses;
+    switch (shape)
+    {
+    case WalkShape::RADIX:
+        // 4 levels, the last one holds the translation
+        for (int level = 0; level < 4; level++)
+            accesses.push_back(PTWAccess(0, level, ((va >> (39 - 9 * level)) & 0x1FF) * 8 + level * 4096, level == 3));
+        break;
+    case WalkShape::ECH:
+        // 2 page sizes x 4 ways, probed in parallel
+        for (int size = 0; size < 2; size++)
+            for (int way = 0; way < 4; way++)
+                accesses.push_back(PTWAccess(size, 0, ((va >> (12 + 9 * size)) * (way + 7)) % (1 << 20) * 64, size == 0 && way == 1));
+        break;
+    case WalkShape::HDC:
+        // 2 page sizes, short linear probe in the 4KB table
+        for (int depth = 0; depth < 2; depth++)
+            accesses.push_back(PTWAccess(0, depth, ((va >> 15) + depth) % (1 << 20) * 64, depth == 1));
+        accesses.push_back(PTWAccess(1, 0, (va >> 24) % (1 << 20) * 64, false));
+        break;
+    }
+    return PTWResult<List>(12, accesses, va >> 12, false);
+}
+
+// PWC filter: drop the upper levels, as a warm PWC would
+template <class List, class Param>
+static PTWResult<List> filter(Param ptw_result)
+{
+    List original = ptw_result.accesses;
+    List filtered;
+    for (const auto& access : original)
+        if (access.depth >= 2 || access.table_level > 0 || access.is_pte)
+            filtered.push_back(access);
+    return PTWResult<List>(ptw_result.page_size, filtered, ptw_result.ppn, ptw_result.fault_happened);
+}
+
+template <class List, class Param>
+static uint64_t cycles(Param ptw_result)
+{
+    uint64_t latency = 0;
+    for (const auto& access : ptw_result.accesses)
+        latency += (access.physical_addr >> 6) % 97 + access.depth;
+    return latency;
+}
+
+// The old plumbing: copies at every hand-off
+static uint64_t missBefore(WalkShape shape, uintptr_t va)
+{
+    typedef std::vector<PTWAccess> List;
+    typedef PTWResult<List> Result;
+
+    Result ptw_result = walk<List>(shape, va);
+    List visited_pts = ptw_result.accesses;
+    std::sort(visited_pts.begin(), visited_pts.end());
+    visited_pts.erase(std::unique(visited_pts.begin(), visited_pts.end()), visited_pts.end());
+    ptw_result.accesses = visited_pts;
+
+    ptw_result = filter<List, Result>(ptw_result);
+    return cycles<List, Result>(ptw_result);
+}
+
+// The current plumbing: inline storage, in-place dedup, const references
+static uint64_t missAfter(WalkShape shape, uintptr_t va)
+{
+    typedef InlineVector<PTWAccess, 32> List;
+    typedef PTWResult<List> Result;
+
+    Result ptw_result = walk<List>(shape, va);
+    List& visited_pts = ptw_result.accesses;
+    std::sort(visited_pts.begin(), visited_pts.end());
+    visited_pts.erase(std::unique(visited_pts.begin(), visited_pts.end()), visited_pts.end());
+
+    ptw_result = filter<List, const Result&>(ptw_result);
+    return cycles<List, const Result&>(ptw_result);
+}
+
+static double runBench(uint64_t (*miss)(WalkShape, uintptr_t), WalkShape shape, uint64_t misses, uint64_t& checksum)
+{
+    auto start = BenchClock::now();
+    for (uint64_t i = 0; i < misses; i++)
+        checksum = checksum * 31 + miss(shape, (i * 2654435761ULL) << 12);
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(BenchClock::now() - start).count();
+    return misses ? (double)ns / misses : 0.0;
+}
+
+int main(int argc, char *argv[])
+{
+    uint64_t misses = (argc > 1) ? strtoull(argv[1], NULL, 10) : 2000000;
+
+    std::cout << std::endl << "[PTWResultBench] misses = " << misses << std::endl;
+    std::cout << std::left << std::setw(12) << "table"
+              << std::setw(20) << "before (ns/miss)" << std::setw(20) << "after (ns/miss)" << std::endl;
+
+    const struct { const char *name; WalkShape shape; } shapes[] = {
+        { "radix", WalkShape::RADIX }, { "ech", WalkShape::ECH }, { "hdc", WalkShape::HDC } };
+
+    bool agree = true;
+    for (const auto& s : shapes)
+    {
+        uint64_t before_sum = 0, after_sum = 0;
+        double before = runBench(missBefore, s.shape, misses, before_sum);
+        double after = runBench(missAfter, s.shape, misses, after_sum);
+        std::cout << std::left << std::setw(12) << s.name
+                  << std::setw(20) << before << std::setw(20) << after << std::endl;
+        agree &= (before_sum == after_sum);
+    }
+
+    if (!agree)
+    {
+        std::cerr << "[PTWResultBench] ERROR: pipelines produced different results" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "[PTWResultBench] pipelines agree" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+/*
+ * VMA lookup microbenchmark
+ *
+ * Replays the VA -> VMA lookups of page-fault handling (SpOT offsets, eager paging,
+ * range MMU) against address spaces of growing VMA counts, as JVM or database traces
+ * produce them. Faults come from several cores; each core touches one VMA for a run
+ * of faults, then moves on to another one.
+ *
+ *   scan:        linear scan of the VMA vector (the old ApplicationContext::findVMA)
+ *   copy+scan:   copy of the VMA vector, then scan (the old eager-paging / range MMU path)
+ *   shared hint: VMAIndex with a single last-hit slot shared by all cores
+ *   core hint:   VMAIndex with the per-core last-hit cache
+ *
+ * All variants must find the same VMAs, so a checksum is printed per VMA count.
+ *
+ * Usage: ./build/vma_index_bench [faults] [max_vmas]
+ */
+#include "memory_management/misc/vma_index.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using BenchClock = std::chrono::steady_clock;
+
+static const int CORES = 8;
+static const int RUN_LENGTH = 32; // Faults of a core in one VMA before it moves on
+
+struct Fault
+{
+    IntPtr address;
+    int core_id;
+};
+
+static double faultsPerUs(BenchClock::time_point start, UInt64 faults)
+{
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(BenchClock::now() - start).count();
+    return ns ? (double)faults * 1000.0 / ns : 0.0;
+}
+
+// Sorted, disjoint VMAs of 4KB..64MB with gaps, like a real memory map
+static std::vector<VMA> buildVMAs(int count, std::mt19937_64 &rng)
+{
+    std::vector<VMA> vmas;
+    IntPtr base = 0x400000;
+    for (int i = 0; i < count; i++)
+    {
+        IntPtr size = (1 + rng() % 16384) * 4096;
+        IntPtr gap = (1 + rng() % 16) * 4096;
+        vmas.emplace_back(base, base + size);
+        base += size + gap;
+    }
+    return vmas;
+}
+
+static std::vector<Fault> buildFaults(const std::vector<VMA> &vmas, UInt64 count, std::mt19937_64 &rng)
+{
+    std::vector<Fault> faults;
+    faults.reserve(count);
+    int current[CORES];
+    for (int c = 0; c < CORES; c++)
+        current[c] = rng() % vmas.size();
+
+    for (UInt64 i = 0; i < count; i++)
+    {
+        int core_id = i % CORES;
+        if ((i / CORES) % RUN_LENGTH == 0)
+            current[core_id] = rng() % vmas.size();
+        const VMA &vma = vmas[current[core_id]];
+        IntPtr pages = (vma.getEnd() - vma.getBase()) / 4096;
+        faults.push_back(Fault{vma.getBase() + (rng() % pages) * 4096, core_id});
+    }
+    return faults;
+}
+
+static const VMA *scan(const std::vector<VMA> &vmas, IntPtr address)
+{
+    for (const auto &vma : vmas)
+    {
+        if (vma.contains(address))
+            return &vma;
+    }
+    return nullptr;
+}
+
+int main(int argc, char *argv[])
+{
+    UInt64 num_faults = (argc > 1) ? strtoull(argv[1], NULL, 10) : 400000;
+    int max_vmas = (argc > 2) ? atoi(argv[2]) : 16384;
+
+    std::cout << std::endl << "[VMAIndexBench] faults = " << num_faults << ", cores = " << CORES
+              << ", run length = " << RUN_LENGTH << std::endl;
+    std::cout << std::left << std::setw(10) << "vmas"
+              << std::right << std::setw(14) << "scan" << std::setw(14) << "copy+scan"
+              << std::setw(14) << "shared hint" << std::setw(14) << "core hint"
+              << "   (faults/us)" << std::endl;
+
+    bool agree = true;
+    for (int count = 16; count <= max_vmas; count *= 4)
+    {
+        std::mt19937_64 rng(count);
+        std::vector<VMA> vmas = buildVMAs(count, rng);
+        std::vector<Fault> faults = buildFaults(vmas, num_faults, rng);
+
+        VMAIndex shared(1);
+        shared.assign(vmas);
+        VMAIndex index(CORES);
+        index.assign(vmas);
+
+        // The old paths are quadratic in practice: replay fewer faults for large counts
+        UInt64 scan_faults = std::min<UInt64>(num_faults, 400000000ULL / count);
+
+        UInt64 sum_scan = 0, sum_copy = 0, sum_index = 0, sum_hint = 0;
+
+        auto start = BenchClock::now();
+        for (UInt64 i = 0; i < scan_faults; i++)
+            sum_scan += scan(vmas, faults[i].address)->getBase();
+        double scan_rate = faultsPerUs(start, scan_faults);
+
+        UInt64 copy_faults = std::max<UInt64>(1, scan_faults / 16);
+        start = BenchClock::now();
+        for (UInt64 i = 0; i < copy_faults; i++)
+        {
+            std::vector<VMA> copy = vmas;
+            sum_copy += scan(copy, faults[i].address)->getBase();
+        }
+        double copy_rate = faultsPerUs(start, copy_faults);
+
+        // Faults of the cores interleave, so a single hint mostly misses
+        start = BenchClock::now();
+        for (UInt64 i = 0; i < num_faults; i++)
+            sum_index += shared.lookup(faults[i].address, faults[i].core_id)->getBase();
+        double index_rate = faultsPerUs(start, num_faults);
+
+        start = BenchClock::now();
+        for (UInt64 i = 0; i < num_faults; i++)
+            sum_hint += index.lookup(faults[i].address, faults[i].core_id)->getBase();
+        double hint_rate = faultsPerUs(start, num_faults);
+
+        // Compare over the faults every variant replayed
+        UInt64 check_index = 0, check_scan = 0;
+        for (UInt64 i = 0; i < copy_faults; i++)
+        {
+            check_index += index.lookup(faults[i].address)->getBase();
+            check_scan += scan(vmas, faults[i].address)->getBase();
+        }
+        agree = agree && check_index == check_scan && check_scan == sum_copy && sum_index == sum_hint;
+
+        std::cout << std::left << std::setw(10) << count << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(14) << scan_rate << std::setw(14) << copy_rate
+                  << std::setw(14) << index_rate << std::setw(14) << hint_rate
+                  << "   checksum " << sum_scan << std::endl;
+    }
+
+    if (!agree)
+    {
+        std::cout << "[VMAIndexBench] ERROR: lookups disagree" << std::endl;
+        return 1;
+    }
+    std::cout << "[VMAIndexBench] all variants agree" << std::endl;
+    return 0;
+}
@@ -7,6 +7,10 @@
 #include "INIReader.h"
 #include "memory_management/physical_memory_allocators/physical_memory_allocator.h"
 #include "globals.h"
+#include "misc/mimicos_protocol.h"
+#include "radix_page_table.h"
+#include <memory>
+#include <vector>
 
 // Forward declarations
 class INIReader;
@@ -14,20 +18,32 @@ class MetricsRegistry;
 class PhysicalMemoryAllocator;
 struct mm_package;
 
-struct Message{
-    int argc;
-    uint64_t *argv;
-};
 
   
 class MimicOS {
     private:    
+
+        // State of one core: its message buffers and what its page faults allocated
+        struct CoreState {
+            MimicOSProtocol::Message request;
+            MimicOSProtocol::Message reply;
+            UInt64 page_faults = 0;
+            UInt64 data_frames = 0;
+            UInt64 page_table_frames = 0; // Tables the radix tree needed
+            UInt64 padding_frames = 0;    // Frames Sniper's page table asked for beyond those
+            UInt64 leaked_frames = 0;     // Table frames dropped when a large page replaced their tables
+        };
     
         INIReader* reader;
         MetricsRegistry* m_stats;
         PhysicalMemoryAllocator* physical_memory_allocator;
         // Shared memory variables used to communicate with the simulator
         mm_package* mmpackage;
+        // Page table of the application, built as its pages fault in
+        std::unique_ptr<RadixPageTable> page_table;
+        std::vector<std::unique_ptr<CoreState>> cores;
+
+        CoreState& getCoreState(UInt64 core_id);
         
         //Declare Singleton
         static MimicOS* instance;
@@ -46,11 +62,14 @@ class MimicOS {
         void setupSharedMemory();
         void start_application();
         void poll_for_signal();
+        void handle_page_faults(const MimicOSProtocol::MessageView& request, MimicOSProtocol::Message& reply);
+        void serve_page_fault(const MimicOSProtocol::PageFaultRequest& fault, MimicOSProtocol::PageFaultResponse& response);
 
 
         
         mm_package* get_mm_package(){ return mmpackage; }
         PhysicalMemoryAllocator* get_physical_memory_allocator(){ return physical_memory_allocator; }
+        RadixPageTable* get_page_table(){ return page_table.get(); }
 
         // Function to get the instance of the MimicOS class with the configuration file, output file, and application file
         static MimicOS* getMimicOS(std::string configurationFile, std::string outputFile, std::string appFile){
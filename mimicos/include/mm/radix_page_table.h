@@ -1,30 +1,55 @@
-#include <iostream>
-#include <vector>
+#pragma once
 #include <memory>
 #include <cstdint>
 
+class PhysicalMemoryAllocator;
+
+// One 4KB table of the radix tree, backed by a frame from the MimicOS allocator
 class RadixPageTableFrame {
 public:
     static const int ENTRIES = 512; // Each table has 512 entries
-    std::unique_ptr<uint64_t[]> entries;
 
-    RadixPageTableFrame() : entries(new uint64_t[ENTRIES]) {
-        std::fill_n(entries.get(), ENTRIES, 0);
+    uint64_t ppn;                   // Frame holding this table
+    uint64_t entries[ENTRIES];      // Next-level table or data frame, plus flag bits
+    std::unique_ptr<std::unique_ptr<RadixPageTableFrame>[]> children; // Next-level tables (upper levels only)
+
+    RadixPageTableFrame(uint64_t ppn, bool has_children) : ppn(ppn), entries() {
+        if (has_children)
+            children.reset(new std::unique_ptr<RadixPageTableFrame>[ENTRIES]);
     }
 };
 
 class RadixPageTable{
 
+    public:
+        static const uint64_t PRESENT = 0x1;
+        static const uint64_t LARGE_PAGE = 0x80; // Leaf above the last level (x86 PS bit)
+        static const int MIN_LEVELS = 4;
+        static const int MAX_LEVELS = 5;
+
+        RadixPageTable(PhysicalMemoryAllocator* allocator, int levels = 4);
+        uint64_t* lookup(uint64_t virtualAddress);
+        int insert(uint64_t virtualAddress, uint64_t physicalPage, int pageSizeBits, uint64_t coreId,
+                   uint64_t* newFrames, int maxFrames);
+
+        int getLevels() const { return levels; }
+        uint64_t getRootFrame() const { return root->ppn; }
+        uint64_t getTableFrames() const { return tableFrames; }
+        uint64_t getLeakedFrames() const { return leakedFrames; }
+
     private:
-        std::vector<std::unique_ptr<RadixPageTableFrame>> pageTables;
+        PhysicalMemoryAllocator* allocator;
+        int levels;
+        std::unique_ptr<RadixPageTableFrame> root;
+        uint64_t tableFrames; // Frames of the tables in the tree, root included
+        uint64_t leakedFrames; // Frames of tables dropped from the tree, which the allocator cannot take back
 
-        int getIndex(uint64_t address, int level) {
+        // Level 0 is the last level (PT), level levels-1 the root (PML4 or PML5)
+        static int getIndex(uint64_t address, int level) {
             return (address >> (12 + 9 * level)) & 0x1FF;
         }
 
-    public:
-        RadixPageTable(); 
-        uint64_t* lookup(uint64_t virtualAddress);
-        void insert(uint64_t virtualAddress, uint64_t physicalAddress);
+        std::unique_ptr<RadixPageTableFrame> allocateTable(int level, uint64_t coreId);
+        uint64_t countTables(const RadixPageTableFrame* table) const;
 
-};
\ No newline at end of file
+};
@@ -22,7 +22,6 @@
 
 #define BASE_PAGE_SHIFT 12UL
 
-#define MAX_ARGS 10
 INIReader *reader;        // defined in globals.h
 MetricsRegistry *m_stats; // defined in globals.h
 
@@ -68,10 +67,42 @@ MimicOS::MimicOS(std::string configurationFile, std::string outputFile, std::str
     int threshold_for_promotion = reader->GetInteger("pmem_alloc", "threshold_for_promotion", -1);
     std::cout << "[MimicOS]: Threshold for promotion (Applicable to ReserveTHP, otherwise: default = -1): " << threshold_for_promotion << std::endl;
 
+    //Free-list engine of the Buddy allocator: "vector" or "indexed" (same pages, faster lookups)
+    String freeListType = reader->Get("pmem_alloc", "free_list_type", "vector").c_str();
+    Virtuoso::Buddy::NoMetricsPolicy::s_free_list_type = parseBuddyFreeListType(freeListType.c_str());
+    std::cout << "[MimicOS]: Buddy free list engine: " << freeListType << std::endl;
+
     //Create physical memory allocator - this will be used to serve page allocations
     // throughout the execution of the SIFT-based application
     physical_memory_allocator = AllocatorFactory::createAllocator(allocatorName, memory_size, maxOrder, kernelSize, fragType, threshold_for_promotion);
     std::cout << "[MimicOS]: Created allocator: " << allocatorName << std::endl;
+
+    //The page table of the application is a 4-level (x86-64) or 5-level (LA57) radix tree
+    // Its tables are allocated from the allocator above, as the application's pages fault in
+    int levels = reader->GetInteger("page_table", "levels", 4);
+    page_table = std::make_unique<RadixPageTable>(physical_memory_allocator, levels);
+    std::cout << "[MimicOS]: Page table levels: " << levels << std::endl;
+}
+
+/**
+ * @brief Returns the state of core_id, creating it on the core's first message.
+ */
+MimicOS::CoreState& MimicOS::getCoreState(UInt64 core_id)
+{
+    if (core_id >= cores.size()) {
+        cores.resize(core_id + 1);
+    }
+    if (!cores[core_id]) {
+        cores[core_id] = std::make_unique<CoreState>();
+        CoreState* core = cores[core_id].get();
+        std::string name = "core" + std::to_string(core_id);
+        m_stats->registerMetric(name, "page_faults", &core->page_faults);
+        m_stats->registerMetric(name, "data_frames", &core->data_frames);
+        m_stats->registerMetric(name, "page_table_frames", &core->page_table_frames);
+        m_stats->registerMetric(name, "padding_frames", &core->padding_frames);
+        m_stats->registerMetric(name, "leaked_frames", &core->leaked_frames);
+    }
+    return *cores[core_id];
 }
 
 void MimicOS::boot()
@@ -127,15 +158,15 @@ void MimicOS::start_application()
  * requests (typically triggered by page faults). The function continuously receives messages,
  * processes memory allocation requests, and sends responses back to the application.
  * 
- * Message Protocol:
- * - Incoming: [exception_type_code, virtual_address, num_requested_frames, ...]
- * - Outgoing: [exception_type_code, vpn, physical_address, page_size, frame1, frame2, ...]
+ * Message Protocol (misc/mimicos_protocol.h):
+ * - Incoming: [opcode, count, count x PageFaultRequest {va, num_frames, core_id}]
+ * - Outgoing: [opcode, count, count x PageFaultResponse {vpn, pa, page_size, num_frames, frames[]}]
  * 
  * @details The function:
  * 1. Performs initial context switch to synchronize with SIFT application
- * 2. Enters infinite loop to handle incoming memory requests
- * 3. Decodes exception type and extracts virtual page number (VPN)
- * 4. Allocates requested number of physical memory frames (data + page table frames)
+ * 2. Enters infinite loop to handle incoming memory requests, in the buffers of the core it runs on
+ * 3. Dispatches on the opcode; a page-fault request may carry a batch of faults
+ * 4. Maps each fault in the radix page table, allocating the data frame and missing tables for the faulting core
  * 5. Sends allocation results back to the requesting application
  * 6. Performs context switch to return control to the application
  * 
@@ -148,10 +179,6 @@ void MimicOS::start_application()
 
 void MimicOS::poll_for_signal()
 {
-    // Keep the message structure to receive messages and keep it alive and as simple as possible
-    Message* msg = new Message;
-    msg->argv = new uint64_t[10];
-
     //Initial context switch to halt and wait for the SIFT-based application to send a message
     // Sniper will only send a message when the SIFT-based application triggers a page fault
     SimContextSwitch();
@@ -160,120 +187,34 @@ void MimicOS::poll_for_signal()
 
     while (true) {
 
+        //The kernel runs on the core that trapped, and Sniper keeps that core's message for it
+        // Each core has its own request and reply buffers, reused for every round trip and sized for the largest message
+        CoreState& core = getCoreState(SimGetProcId());
+
         //Receive message from the SIFT-based application
-        // The message contains the exception type, virtual address, and number of requested frames
-        // We reuse the same message structure to keep things simple
-        // msg->argv[0] = exception_type_code
-        // msg->argv[1] = virtual_address
-        // msg->argv[2] = num_requested_frames (data frame + page table frames)
-        // msg->argv[3..] = unused
-
-        SimReceiveMessage(&msg->argc, msg->argv);
-        assert(msg->argc >= 2);
-        int exception_type_code = msg->argv[0];
-        std::string exception_type = std::to_string(exception_type_code);
-        IntPtr va = msg->argv[1];
-        IntPtr vpn = (va >> BASE_PAGE_SHIFT);
-        int num_requested_frames = msg->argv[2];
-        
-#if DEBUG_MimicOS >= DEBUG_BASIC
-        std::cout << "[MimicOS] Received response from context switch ..." << std::endl;
-        std::cout << "[MimicOS] Message is exception_type = " << exception_type <<
-                     " -- vpn = " << vpn <<
-                     "- - num_requested_frames = " << num_requested_frames << std::endl;
-#endif 
-
-        #ifdef PROTOCOL 
-            assert(argc >= 1);
-            std::string message_type;
-            if (protocol_codes_decode.find(argv[0]) == protocol_codes_decode.end()) {
-                std::cout << "[MimicOS]: Unknown protocol code: " << argv[0] << std::endl;
-                continue; // Skip unknown messages
-            }
-            else {
-                message_type = protocol_codes_decode[argv[0]];
-                std::cout << "[MimicOS]: protocol name / message type : " << message_type << std::endl;
-            }
-        #endif
-        
-        UInt64 bytes = (1 << 12);
-
-        //For simplicity, we assume core_id = 0 for now
-        // In a more complex scenario, we could extract core_id from the message or maintain per-core state
-        // This would be useful in a multi-core simulation where different cores may have different memory access patterns
-        // and we want to track allocations per core
-        // For now, we keep it simple and use core_id = 0
-        auto core_id = 0;
-
-        //Allocate the requested number of frames
-        // The first frame is the data frame, the rest are page table frames
-        // We use the physical memory allocator created during MimicOS initialization
-        // If allocation fails, we print an error and exit
-        // In a real OS, we would handle this more gracefully (e.g., by killing the process or freeing up memory)
-        // Here, we simply exit to keep the example straightforward
-
-        std::vector<UInt64> frames;
-        frames.reserve(num_requested_frames);
-
-        //Allocate the data frame first by asking for 'bytes' (4KB)
-        // The physical_memory_allocator->allocate() returns a pair of <physical_page, page_size>
-
-        auto [pa, page_size] = physical_memory_allocator->allocate(bytes, va, core_id);
-        if (pa == static_cast<UInt64>(-1)) {
-            std::cerr << "[FATAL] [MimicOS] No more memory available to sustain this memory allocation" << std::endl;
-            std::cerr << "[FATAL] [MimicOS] Exiting..." << std::endl;
-            exit(1);
-        }
+        // The message header holds the opcode and the number of entries that follow
+        SimReceiveMessage(&core.request.argc, core.request.argv);
+        const MimicOSProtocol::MessageView message = core.request.view();
 
-        //Store the allocated physical address of the data frame    
-        frames.push_back(pa);
-        // Allocate page table frames
-        for (int i = 0; i < num_requested_frames - 1; i++) {
-            auto frame = physical_memory_allocator->handle_page_table_allocations(bytes);
 #if DEBUG_MimicOS >= DEBUG_BASIC
-            std::cout << "[MimicOS] Allocated page table frame " << i << ": " << frame << std::endl;
+        std::cout << "[MimicOS] Received " << MimicOSProtocol::name(message.opcode()) <<
+                     " message with " << message.count() << " entries" << std::endl;
 #endif
-            frames.push_back(frame);
-        }
 
-#if DEBUG_MimicOS >= DEBUG_BASIC
-            std::cout << "[MimicOS] Physical memory allocation succeeded: " << std::endl;
-            std::cout << "[MimicOS] Number of frames requested = " << num_requested_frames << std::endl;
-            std::cout << "[MimicOS] Frames allocated: ";
-            for (int i = 0; i < num_requested_frames; i++) {
-                if (i == 0) {
-                    std::cout << "Data frame: ";
-                } else {
-                    std::cout << "Page table frame " << (i - 1) << ": ";
-                }
-                std::cout << frames[i] << std::endl;
-            }
-#endif
-        //Send the allocation results back to the SIFT-based application
-        // We reuse the same message structure to keep things simple
-        // msg->argv[0] = exception_type_code (same as received)
-        // msg->argv[1] = vpn (virtual page number)
-        // msg->argv[2] = pa (physical address of the data frame)
-        // msg->argv[3] = page_size (size of the data frame in bits, typically 12 for 4KB)
-        // msg->argv[4..] = frames[i] (physical addresses of allocated frames)
-        // msg->argc = 4 + num_requested_frames
-        // Reuse the message structure to send a response back to MimicOS
-        msg->argc = 4 + num_requested_frames; // 4 for exception_type_code, vpn, pa, page_size + num_requested_frames for frames
-
-        msg->argv[0] = exception_type_code;
-        msg->argv[1] = vpn;
-        msg->argv[2] = pa;
-        msg->argv[3] = page_size;
-        for (int i = 0; i < num_requested_frames; i++) {
-            msg->argv[4 + i] = frames[i];
+        switch (message.opcode()) {
+        case MimicOSProtocol::Opcode::PAGE_FAULT:
+            handle_page_faults(message, core.reply);
+            break;
+        default:
+            std::cerr << "[FATAL] [MimicOS] Unsupported message: " << MimicOSProtocol::name(message.opcode()) <<
+                         " (opcode " << (core.request.argc > 0 ? core.request.argv[0] : 0) << ")" << std::endl;
+            exit(1);
         }
 
-        
         //Send the response back to the SIFT-based application using a magic instruction
         // The application will receive the physical addresses and map them accordingly
+        SimMimicosResult(core.reply.argc, core.reply.argv);
 
-        SimMimicosResult(msg->argc, msg->argv);
-         
         //Perform context switch to return control to the SIFT-based application
         // The application will continue executing after receiving the allocation results
         SimContextSwitch();
@@ -281,6 +222,84 @@ void MimicOS::poll_for_signal()
 
 }
 
+/**
+ * @brief Serves a batch of page faults, appending one PageFaultResponse per request entry to reply.
+ *
+ * The faults of a batch may come from different cores; each is served with the allocation state of its own core.
+ */
+void MimicOS::handle_page_faults(const MimicOSProtocol::MessageView& request, MimicOSProtocol::Message& reply)
+{
+    if (!request.wellFormed<MimicOSProtocol::PageFaultRequest>()) {
+        std::cerr << "[FATAL] [MimicOS] Malformed page-fault request (" << request.count() << " entries)" << std::endl;
+        exit(1);
+    }
+
+    reply.begin(MimicOSProtocol::Opcode::PAGE_FAULT);
+    for (uint32_t i = 0; i < request.count(); i++) {
+        MimicOSProtocol::PageFaultResponse response;
+        serve_page_fault(request.entry<MimicOSProtocol::PageFaultRequest>(i), response);
+        reply.append(response);
+    }
+}
+
+/**
+ * @brief Maps the page of one faulting address.
+ *
+ * The data frame is allocated first (frames[0]) and inserted into the radix page table, followed by the
+ * tables the insertion had to allocate, root side first. Sniper's own page table may need more tables
+ * than ours (e.g. it is deeper, or not a radix): the missing ones are allocated on top, up to the number
+ * of frames its walk requested.
+ */
+void MimicOS::serve_page_fault(const MimicOSProtocol::PageFaultRequest& fault, MimicOSProtocol::PageFaultResponse& response)
+{
+    UInt64 bytes = (1 << 12);
+
+    IntPtr va = fault.va;
+    UInt64 core_id = fault.core_id;
+    int num_requested_frames = fault.num_frames;
+    if (num_requested_frames < 1 || num_requested_frames > (int)MimicOSProtocol::MAX_FRAMES_PER_FAULT) {
+        std::cerr << "[FATAL] [MimicOS] Page fault requests " << num_requested_frames << " frames (at most " <<
+                     MimicOSProtocol::MAX_FRAMES_PER_FAULT << " supported)" << std::endl;
+        exit(1);
+    }
+    CoreState& core = getCoreState(core_id);
+    core.page_faults++;
+
+    response.vpn = va >> BASE_PAGE_SHIFT;
+
+    //Allocate the data frame first by asking for 'bytes' (4KB)
+    // The physical_memory_allocator->allocate() returns a pair of <physical_page, page_size>
+    // If allocation fails, we print an error and exit
+    auto [pa, page_size] = physical_memory_allocator->allocate(bytes, va, core_id);
+    if (pa == static_cast<UInt64>(-1)) {
+        std::cerr << "[FATAL] [MimicOS] No more memory available to sustain this memory allocation" << std::endl;
+        std::cerr << "[FATAL] [MimicOS] Exiting..." << std::endl;
+        exit(1);
+    }
+    response.ppn = pa;
+    response.page_size = page_size;
+    response.frames[0] = pa;
+    core.data_frames++;
+
+    // Map the page, allocating the missing page tables on the way down
+    UInt64 leaked_frames = page_table->getLeakedFrames();
+    int num_frames = 1 + page_table->insert(va, pa, page_size, core_id, response.frames + 1, MimicOSProtocol::MAX_FRAMES_PER_FAULT - 1);
+    core.page_table_frames += num_frames - 1;
+    core.leaked_frames += page_table->getLeakedFrames() - leaked_frames;
+
+    // Allocate the page table frames Sniper's page table needs beyond ours
+    for (; num_frames < num_requested_frames; num_frames++) {
+        response.frames[num_frames] = physical_memory_allocator->handle_page_table_allocations(bytes, core_id);
+        core.padding_frames++;
+    }
+    response.num_frames = num_frames;
+
+#if DEBUG_MimicOS >= DEBUG_BASIC
+    std::cout << "[MimicOS] Core " << core_id << ": physical memory allocation succeeded for vpn = " << response.vpn <<
+                 ": data frame = " << pa << ", " << (num_frames - 1) << " page table frames" << std::endl;
+#endif
+}
+
 
 // Define the static member variable
 MimicOS* MimicOS::instance = nullptr;
\ No newline at end of file
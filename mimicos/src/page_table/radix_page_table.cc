@@ -1,20 +1,20 @@
-
-
 #include <iostream>
-#include <vector>
 #include <memory>
 #include <cstdint>
+#include <cstdlib>
 #include "radix_page_table.h"
+#include "memory_management/physical_memory_allocators/physical_memory_allocator.h"
 
 
-/*A simple Radix Page Table implementation for MimicOS. 
+/*A simple Radix Page Table implementation for MimicOS.
 This page table serves only a single purpose: emulate the memory accesses and the complexity of performing insert/update and lookup operations.
-Its contents are propagated to the SIFT-based application via the MimicOS physical memory allocator, which is invoked upon page faults but 
-its physical location is not shared with the SIFT-based application since we anyways emulate the physical memory allocation of the page table frames. 
+Its contents are propagated to the SIFT-based application via the MimicOS physical memory allocator, which is invoked upon page faults but
+its physical location is not shared with the SIFT-based application since we anyways emulate the physical memory allocation of the page table frames.
 
- We use a 4-level Radix tree, similar to x86-64 page tables.
+ We use a 4-level (or 5-level) Radix tree, similar to x86-64 page tables.
  Each level has 512 entries (9 bits), and the page size is 4KB (12 bits).
  The virtual address is split as follows:
+ - Bits 48-56: Level 5 index (PML5, 5-level tables only)
  - Bits 39-47: Level 4 index (PML4)
  - Bits 30-38: Level 3 index (PDPT)
  - Bits 21-29: Level 2 index (PD)
@@ -22,35 +22,95 @@ its physical location is not shared with the SIFT-based application since we any
  - Bits 0-11: Offset within the page
 
  Each entry in the page table contains the physical address of the next level table or the physical frame.
- For simplicity, we only store the physical address and a present bit (bit 0).
+ For simplicity, we only store the physical address, a present bit (bit 0) and, for 2MB/1GB pages, a large-page bit (bit 7).
+ Every table is a node of the tree with a frame of its own, allocated from the MimicOS allocator by the core that
+ faulted, so that the kernel work of a fault (walking the tree, allocating and zeroing the missing tables) is the real one.
 */
 
-RadixPageTable::RadixPageTable() {
-    // Initially allocate one page table for the PML4
-    pageTables.push_back(std::make_unique<RadixPageTableFrame>());
+RadixPageTable::RadixPageTable(PhysicalMemoryAllocator* allocator, int levels)
+    : allocator(allocator), levels(levels), tableFrames(0), leakedFrames(0)
+{
+    if (levels < MIN_LEVELS || levels > MAX_LEVELS) {
+        std::cerr << "[FATAL] [MimicOS] Radix page table with " << levels << " levels (" <<
+                     MIN_LEVELS << " or " << MAX_LEVELS << " supported)" << std::endl;
+        exit(1);
+    }
+    // The root table exists from the start, like the PML4 of a new process
+    root = allocateTable(levels - 1, (uint64_t)-1);
+}
+
+std::unique_ptr<RadixPageTableFrame> RadixPageTable::allocateTable(int level, uint64_t coreId) {
+    tableFrames++;
+    return std::make_unique<RadixPageTableFrame>(allocator->handle_page_table_allocations(4096, coreId), level > 0);
+}
+
+// Number of tables in the subtree of table, table included
+uint64_t RadixPageTable::countTables(const RadixPageTableFrame* table) const {
+    uint64_t tables = 1;
+    for (int i = 0; table->children && i < RadixPageTableFrame::ENTRIES; ++i) {
+        if (table->children[i]) {
+            tables += countTables(table->children[i].get());
+        }
+    }
+    return tables;
 }
 
+// Returns the leaf entry that maps virtualAddress, or nullptr if it is not mapped
 uint64_t* RadixPageTable::lookup(uint64_t virtualAddress) {
-    uint64_t* entry = nullptr;
-    for (int level = 0; level < 4; ++level) {
+    RadixPageTableFrame* table = root.get();
+    for (int level = levels - 1; level >= 0; --level) {
         int index = getIndex(virtualAddress, level);
-        if (level >= pageTables.size() || pageTables[level]->entries[index] == 0) {
+        uint64_t* entry = &table->entries[index];
+        if (!(*entry & PRESENT)) {
             return nullptr; // No entry
         }
-        entry = &pageTables[level]->entries[index];
+        if (level == 0 || (*entry & LARGE_PAGE)) {
+            return entry;
+        }
+        table = table->children[index].get();
     }
-    return entry;
+    return nullptr;
 }
 
-void RadixPageTable::insert(uint64_t virtualAddress, uint64_t physicalAddress) {
-    for (int level = 0; level < 4; ++level) {
+/*
+ Maps the page of virtualAddress (of 2^pageSizeBits bytes) to the frame physicalPage. Missing tables on the way down
+ are allocated for coreId, and their frames are appended to newFrames (at most maxFrames of them), root side first.
+ Returns the number of tables allocated.
+*/
+int RadixPageTable::insert(uint64_t virtualAddress, uint64_t physicalPage, int pageSizeBits, uint64_t coreId,
+                           uint64_t* newFrames, int maxFrames) {
+    int leafLevel = (pageSizeBits - 12) / 9;
+    if (pageSizeBits < 12 || (pageSizeBits - 12) % 9 != 0 || leafLevel >= levels - 1) {
+        std::cerr << "[FATAL] [MimicOS] Unsupported page size of 2^" << pageSizeBits << " bytes" << std::endl;
+        exit(1);
+    }
+
+    int allocated = 0;
+    RadixPageTableFrame* table = root.get();
+    for (int level = levels - 1; level > leafLevel; --level) {
         int index = getIndex(virtualAddress, level);
-        if (level >= pageTables.size()) {
-            pageTables.push_back(std::make_unique<RadixPageTableFrame>()); // Dynamically allocate a new page table
-        }
-        if (pageTables[level]->entries[index] == 0 || level == 3) {
-            pageTables[level]->entries[index] = physicalAddress | 0x1; // Set present bit
-            return;
+        std::unique_ptr<RadixPageTableFrame>& child = table->children[index];
+        if (!child) {
+            // A large page mapped here before is replaced by a table
+            child = allocateTable(level - 1, coreId);
+            table->entries[index] = (child->ppn << 12) | PRESENT;
+            if (allocated < maxFrames) {
+                newFrames[allocated] = child->ppn;
+            }
+            allocated++;
         }
+        table = child.get();
+    }
+
+    int index = getIndex(virtualAddress, leafLevel);
+    table->entries[index] = (physicalPage << 12) | PRESENT | (leafLevel > 0 ? LARGE_PAGE : 0);
+    if (leafLevel > 0 && table->children[index]) {
+        // The large page replaces a table of smaller pages. The allocator only takes page-table frames
+        // back in allocation order, so the frames of the subtree stay allocated and are counted as leaked
+        uint64_t dropped = countTables(table->children[index].get());
+        tableFrames -= dropped;
+        leakedFrames += dropped;
+        table->children[index].reset();
     }
+    return allocated;
 }
@@ -4,6 +4,7 @@
 #include "fixed_types.h"
 
 #include "memory_management/physical_memory_allocators/buddy_policy_traits.h"
+#include "memory_management/physical_memory_allocators/buddy_free_list.h"
 
 /* Policies that depend on Buddy Policy */
 #include "physical_allocator/policies/reserve_thp_policy.h"
@@ -13,6 +14,10 @@ namespace Virtuoso {
     namespace Buddy {
         struct NoMetricsPolicy
         {
+            /* Set by MimicOS from [pmem_alloc] free_list_type before it creates the allocator */
+            static inline BuddyFreeListType s_free_list_type = BuddyFreeListType::VECTOR;
+            static BuddyFreeListType free_list_type() { return s_free_list_type; }
+
             void on_init(int mem_size, int max_order, int kernel_size)
             {
                 std::cout << "[Buddy] Init: mem_size " << mem_size << "KB" <<
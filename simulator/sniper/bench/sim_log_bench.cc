@@ -0,0 +1,119 @@
+/*
+ * SimLog hot-path microbenchmark
+ *
+ * Replays the SimLog statements that one translation hitting in the L1 TLB executes, in
+ * MemoryManagementUnit::performAddressTranslation and TLB::lookup, with logging disabled as
+ * in a normal build (DEBUG_MMU and DEBUG_TLB at DEBUG_NONE), in two forms:
+ *
+ *   eager:  mmu_log->debug("..." + std::to_string(...)), as before the SIM_LOG_*_AT macros.
+ *           The call returns early, but its string arguments are built first.
+ *   gated:  SIM_LOG_DEBUG_AT(DEBUG_NONE, mmu_log, ...), as mmu.cc and tlb.cc do now.
+ *
+ * It reports the host time per translation and the translations per second that the logging
+ * alone allows, for both forms. The values logged change with every translation, so that
+ * neither form is folded away.
+ *
+ * Usage: lib/sim_log_bench [translations]
+ */
+#include "sim_log.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using BenchClock = std::chrono::steady_clock;
+
+struct Translation
+{
+   UInt64 address;
+   UInt64 ppn;
+   UInt64 time_ns;
+   int page_size;
+};
+
+static std::vector<Translation> buildTranslations(UInt64 count)
+{
+   std::vector<Translation> translations(count);
+   UInt64 seed = 1;
+   for (UInt64 i = 0; i < count; i++)
+   {
+      seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+      translations[i] = { (seed >> 16) & 0x7fffffffffffULL, (seed >> 28) & 0xfffffffULL, 1000 + 3 * i, (seed & 0x100) ? 21 : 12 };
+   }
+   return translations;
+}
+
+// Statements of an L1 TLB hit before the macros (mmu.cc, then the TLB::lookup ones of tlb.cc)
+static void logEager(SimLog *mmu_log, SimLog *tlb_log, const Translation &t, const String &tlb_name)
+{
+   UInt64 latency = 1;
+   mmu_log->section("Starting address translation for virtual address: " +
+                   mmu_log->hex(t.address) + " at time " + std::to_string(t.time_ns) + "ns");
+   mmu_log->debug("Searching TLB at level: " + std::to_string(0));
+   tlb_log->debug("Lookup for address: ", t.address, " at time: ", t.time_ns, " ns");
+   tlb_log->debug("Hit at time: ", t.time_ns, " ns", "");
+   mmu_log->log("TLB Hit at level " + std::to_string(0) + " at TLB " + std::string(tlb_name.c_str()));
+   mmu_log->log("TLB Hit at level " + std::to_string(0) + " at TLB " + std::string(tlb_name.c_str()));
+   mmu_log->debug("Charging TLB Hit Latency: " + std::to_string(latency) + "ns at level " + std::to_string(0));
+   mmu_log->debug("New time after charging TLB latency: " + std::to_string(t.time_ns + latency) + "ns");
+   mmu_log->debug("Total Walk Latency: " + std::to_string(0) + "ns");
+   mmu_log->debug("Total Fault Latency: " + std::to_string(0) + "ns");
+   mmu_log->debug("Physical Address: " + mmu_log->hex((t.ppn << 12) + (t.address & 0xfff)) +
+                  " PPN: " + mmu_log->hex(t.ppn << 12) +
+                  " Page Size: " + std::to_string(t.page_size) + " Offset: " + mmu_log->hex(t.address & 0xfff));
+   mmu_log->debug("Total translation latency: " + std::to_string(latency) + "ns");
+   mmu_log->debug("Total fault latency: " + std::to_string(0) + "ns");
+   mmu_log->section("Ending address translation for virtual address " + mmu_log->hex(t.address));
+}
+
+// The same statements, as they are written now
+static void logGated(SimLog *mmu_log, SimLog *tlb_log, const Translation &t, const String &tlb_name)
+{
+   UInt64 latency = 1;
+   SIM_LOG_SECTION_AT(DEBUG_NONE, mmu_log, "Starting address translation for virtual address: " +
+                      mmu_log->hex(t.address) + " at time " + std::to_string(t.time_ns) + "ns");
+   SIM_LOG_DEBUG_AT(DEBUG_NONE, mmu_log, "Searching TLB at level: " + std::to_string(0));
+   SIM_LOG_DEBUG_AT(DEBUG_NONE, tlb_log, "Lookup for address: ", t.address, " at time: ", t.time_ns, " ns");
+   SIM_LOG_DEBUG_AT(DEBUG_NONE, tlb_log, "Hit at time: ", t.time_ns, " ns", "");
+   SIM_LOG_INFO_AT(DEBUG_NONE, mmu_log, "TLB Hit at level " + std::to_string(0) + " at TLB " + std::string(tlb_name.c_str()));
+   SIM_LOG_INFO_AT(DEBUG_NONE, mmu_log, "TLB Hit at level " + std::to_string(0) + " at TLB " + std::string(tlb_name.c_str()));
+   SIM_LOG_DEBUG_AT(DEBUG_NONE, mmu_log, "Charging TLB Hit Latency: " + std::to_string(latency) + "ns at level " + std::to_string(0));
+   SIM_LOG_DEBUG_AT(DEBUG_NONE, mmu_log, "New time after charging TLB latency: " + std::to_string(t.time_ns + latency) + "ns");
+   SIM_LOG_DEBUG_AT(DEBUG_NONE, mmu_log, "Total Walk Latency: " + std::to_string(0) + "ns");
+   SIM_LOG_DEBUG_AT(DEBUG_NONE, mmu_log, "Total Fault Latency: " + std::to_string(0) + "ns");
+   SIM_LOG_DEBUG_AT(DEBUG_NONE, mmu_log, "Physical Address: " + mmu_log->hex((t.ppn << 12) + (t.address & 0xfff)) +
+                    " PPN: " + mmu_log->hex(t.ppn << 12) +
+                    " Page Size: " + std::to_string(t.page_size) + " Offset: " + mmu_log->hex(t.address & 0xfff));
+   SIM_LOG_DEBUG_AT(DEBUG_NONE, mmu_log, "Total translation latency: " + std::to_string(latency) + "ns");
+   SIM_LOG_DEBUG_AT(DEBUG_NONE, mmu_log, "Total fault latency: " + std::to_string(0) + "ns");
+   SIM_LOG_SECTION_AT(DEBUG_NONE, mmu_log, "Ending address translation for virtual address " + mmu_log->hex(t.address));
+}
+
+template <typename LogFunction>
+static double runBench(LogFunction log, SimLog *mmu_log, SimLog *tlb_log, const std::vector<Translation> &translations)
+{
+   String tlb_name = "dtlb";
+   BenchClock::time_point start = BenchClock::now();
+   for (const Translation &t : translations)
+      log(mmu_log, tlb_log, t, tlb_name);
+   return std::chrono::duration<double>(BenchClock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+   UInt64 count = (argc > 1) ? strtoull(argv[1], NULL, 10) : 1000000;
+   std::vector<Translation> translations = buildTranslations(count);
+
+   // Disabled loggers, as the MMU and TLB create them with DEBUG_MMU/DEBUG_TLB at DEBUG_NONE
+   SimLog mmu_log("MMU", 0, DEBUG_NONE);
+   SimLog tlb_log("TLB", 0, DEBUG_NONE);
+
+   double eager = runBench(logEager, &mmu_log, &tlb_log, translations);
+   double gated = runBench(logGated, &mmu_log, &tlb_log, translations);
+
+   printf("translations %lu, 14 log statements each, logging disabled\n", count);
+   printf("eager  %10.2f ns/translation  %12.0f translations/s\n", eager * 1e9 / count, count / eager);
+   printf("gated  %10.2f ns/translation  %12.0f translations/s\n", gated * 1e9 / count, gated > 0 ? count / gated : 0.0);
+   return 0;
+}
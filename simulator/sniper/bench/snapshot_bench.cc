@@ -0,0 +1,220 @@
+/*
+ * MimicOS snapshot microbenchmark and round-trip check
+ *
+ *   save:   maps a fixed set of pages for application 0 the way the sniper-space exception
+ *           handler does (data frame from the allocator, then the page-table update with the
+ *           frames the walk asked for), writes the translation of every page to <file>.ppns
+ *           and saves the snapshot to <file>
+ *   check:  runs on a simulator restored from <file> (general/mimicos_snapshot_load), walks the
+ *           same pages and compares PPNs and page sizes with <file>.ppns, then saves the restored
+ *           state to <file>.check and compares its allocator, swap cache and HugeTLBfs sections
+ *           (free lists, THP reservations, pools) byte for byte with the original
+ *
+ * Both report the host time of the simulator setup (which includes the restore in check mode)
+ * and of the save. The pages are 3 sequential runs, for large pages and dense page tables, plus
+ * random pages over 64 GB. test/mimicos-snapshot runs both modes for every page table and
+ * allocator that supports snapshots.
+ *
+ * Usage: lib/snapshot_bench -c config/base.cfg -c config/virtuoso_configs/virtuoso_baseline.cfg [--section/key=value]
+ *                           -- save <file> [pages]
+ *        lib/snapshot_bench -c ... --general/mimicos_snapshot_load=<file> -- check <file> [pages]
+ */
+#include "simulator.h"
+#include "handle_args.h"
+#include "config.hpp"
+#include "memory_management/mimicos.h"
+#include "memory_management/misc/snapshot.h"
+#include "pagetable.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <vector>
+
+using namespace ParametricDramDirectoryMSI;
+using BenchClock = std::chrono::steady_clock;
+
+static const int RUNS = 3;
+static const UInt64 RANDOM_PAGES = (64ULL << 30) >> 12;
+static const char *COMPARED_SECTIONS[] = { "allocator", "swap_cache", "hugetlbfs" };
+
+struct Translation
+{
+   IntPtr address;
+   IntPtr ppn;
+   int page_size;
+};
+
+static std::vector<IntPtr> buildAddresses(UInt64 count)
+{
+   std::mt19937_64 rng(1);
+   std::vector<IntPtr> addresses;
+   addresses.reserve(count);
+
+   IntPtr runs[RUNS];
+   for (int r = 0; r < RUNS; r++)
+      runs[r] = 0x100000 + r * (RANDOM_PAGES / RUNS);
+
+   for (UInt64 i = 0; i < count; i++)
+   {
+      if (i % 4 == 3)
+         addresses.push_back((0x100000 + rng() % RANDOM_PAGES) << 12);
+      else
+         addresses.push_back(runs[i % RUNS]++ << 12);
+   }
+   return addresses;
+}
+
+static double secondsSince(BenchClock::time_point start)
+{
+   return std::chrono::duration<double>(BenchClock::now() - start).count();
+}
+
+// Same steps as SniperExceptionHandler::handle_page_fault, without a thread behind the core
+static void mapPage(PhysicalMemoryAllocator *allocator, PageTable *pt, IntPtr address)
+{
+   PTWResult walk = pt->initializeWalk(address, false /* count */, false /* is_prefetch */, false /* restart_walk */);
+   if (!walk.fault_happened)
+      return; // Already mapped, by a large page
+
+   UInt64 ppn, page_size;
+   std::tie(ppn, page_size) = allocator->allocate(4096, address, 0);
+
+   std::vector<UInt64> frames;
+   for (int i = 0; i < walk.requested_frames; i++)
+      frames.push_back(allocator->handle_page_table_allocations(4096, 0));
+   int frames_used = pt->updatePageTableFrames(address, 0, ppn, page_size, frames);
+   for (size_t i = frames_used; i < frames.size(); i++)
+      allocator->handle_page_table_deallocations(4096);
+}
+
+static Translation translate(PageTable *pt, IntPtr address)
+{
+   PTWResult walk = pt->initializeWalk(address, false /* count */, false /* is_prefetch */, false /* restart_walk */);
+   return Translation{ address, walk.fault_happened ? -1 : walk.ppn, walk.fault_happened ? -1 : walk.page_size };
+}
+
+static bool compareSections(const std::string &original, const std::string &resaved)
+{
+   Snapshot::Reader a, b;
+   std::string error;
+   if (!a.open(original, error) || !b.open(resaved, error))
+   {
+      fprintf(stderr, "%s\n", error.c_str());
+      return false;
+   }
+
+   bool match = true;
+   for (const char *name : COMPARED_SECTIONS)
+   {
+      if (a.hasSection(name) != b.hasSection(name))
+      {
+         printf("section %-12s present in only one snapshot\n", name);
+         match = false;
+         continue;
+      }
+      if (!a.hasSection(name))
+         continue;
+
+      Snapshot::Section sa = a.section(name), sb = b.section(name);
+      const char *da = sa.getArray<char>(sa.size());
+      const char *db = sb.getArray<char>(sb.size());
+      bool equal = sa.size() == sb.size() && memcmp(da, db, sa.size()) == 0;
+      printf("section %-12s %10zu bytes  %s\n", name, sa.size(), equal ? "match" : "DIFFER");
+      match = match && equal;
+   }
+   return match;
+}
+
+int main(int argc, char* argv[])
+{
+   string_vec args;
+   String config_path = "carbon_sim.cfg";
+   parse_args(args, config_path, argc, argv);
+
+   // Benchmark arguments follow "--"
+   int first = 1;
+   while (first < argc && strcmp(argv[first], "--") != 0)
+      first++;
+   const char *mode = (first + 1 < argc) ? argv[first + 1] : "";
+   std::string path = (first + 2 < argc) ? argv[first + 2] : "";
+   UInt64 count = (first + 3 < argc) ? strtoull(argv[first + 3], NULL, 10) : 200000;
+   bool save = strcmp(mode, "save") == 0;
+   if ((!save && strcmp(mode, "check") != 0) || path.empty())
+   {
+      fprintf(stderr, "Usage: %s [simulator options] -- save|check <file> [pages]\n", argv[0]);
+      return 1;
+   }
+
+   config::ConfigFile *cfg = new config::ConfigFile();
+   cfg->load(config_path);
+   handle_args(args, *cfg);
+
+   // MimicOS restores the snapshot while the simulator is set up; no application is run
+   BenchClock::time_point start = BenchClock::now();
+   Simulator::setConfig(cfg, Config::STANDALONE);
+   Simulator::allocate();
+   Sim()->start();
+   MimicOS *os = Sim()->getMimicOS();
+   os->createApplication(0);
+   printf("setup  %8.3f s%s\n", secondsSince(start), save ? "" : " (including the restore)");
+
+   PageTable *pt = os->getPageTable(0);
+   std::vector<IntPtr> addresses = buildAddresses(count);
+   std::string ppns_path = path + ".ppns";
+   bool ok = true;
+
+   if (save)
+   {
+      start = BenchClock::now();
+      for (IntPtr address : addresses)
+         mapPage(os->getMemoryAllocator(), pt, address);
+      printf("map    %8.3f s  %lu pages\n", secondsSince(start), count);
+
+      std::ofstream ppns(ppns_path);
+      for (IntPtr address : addresses)
+      {
+         Translation t = translate(pt, address);
+         ppns << t.address << " " << t.ppn << " " << t.page_size << "\n";
+      }
+
+      start = BenchClock::now();
+      os->saveSnapshot(path);
+      printf("save   %8.3f s\n", secondsSince(start));
+   }
+   else
+   {
+      std::ifstream ppns(ppns_path);
+      UInt64 mismatches = 0;
+      for (IntPtr address : addresses)
+      {
+         Translation expected = { 0, 0, 0 };
+         if (!(ppns >> expected.address >> expected.ppn >> expected.page_size) || expected.address != address)
+         {
+            fprintf(stderr, "%s does not match this page set (run save with the same pages)\n", ppns_path.c_str());
+            return 1;
+         }
+         Translation t = translate(pt, address);
+         if (t.ppn != expected.ppn || t.page_size != expected.page_size)
+         {
+            if (mismatches++ < 10)
+               printf("mismatch at %#lx: ppn %#lx page size %d, expected ppn %#lx page size %d\n",
+                      address, t.ppn, t.page_size, expected.ppn, expected.page_size);
+         }
+      }
+      printf("pages  %10lu checked  %lu mismatches\n", count, mismatches);
+      ok = mismatches == 0;
+
+      start = BenchClock::now();
+      os->saveSnapshot(path + ".check");
+      printf("save   %8.3f s\n", secondsSince(start));
+      ok = compareSections(path, path + ".check") && ok;
+      printf("%s\n", ok ? "snapshot round trip: restored state matches" : "snapshot round trip: FAILED");
+   }
+
+   // The simulator never ran an application: leave the cleanup to process exit
+   return ok ? 0 : 1;
+}
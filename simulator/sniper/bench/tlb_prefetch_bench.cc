@@ -0,0 +1,182 @@
+/*
+ * TLB prefetcher microbenchmark
+ *
+ * Drives a prefetch-queue TLB with one TLB prefetcher at a time, the way TLB::lookup() does
+ * during simulation, and reports the host time per TLB access. "none" runs the same TLB
+ * without a prefetcher, as the baseline.
+ *
+ * The address stream mixes 4 strided streams, each from its own instruction, with 1 in 8
+ * random pages over 1 GB, so that stride, distance and recency prefetchers all get to predict.
+ * Prefetch walks go through the MMU and page table of core 0 and application 0, as in the
+ * simulator, so the host time includes the modeled walks.
+ *
+ * Prefetchers without a configuration section are skipped: mmu_recency.cfg sets up all of them
+ * but atp, which mmu_atp.cfg sets up.
+ *
+ * Usage: lib/tlb_prefetch_bench -c config/base.cfg -c config/mmu_configs/mmu_recency.cfg [--section/key=value]
+ *                               -- [accesses] [none|stride|h2|asp|atp|recency|dp]
+ */
+#include "simulator.h"
+#include "handle_args.h"
+#include "config.hpp"
+#include "core_manager.h"
+#include "core.h"
+#include "dvfs_manager.h"
+#include "shmem_perf_model.h"
+#include "memory_management/mimicos.h"
+#include "tlb.h"
+#include "tlb_prefetcher_factory.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace ParametricDramDirectoryMSI;
+using BenchClock = std::chrono::steady_clock;
+
+static const String MMU_NAME = "mmu";
+static const String PQ_CFG = "perf_model/" + MMU_NAME + "/tlb_prefetch/pq1";
+static const int STREAMS = 4;
+static const UInt64 RANDOM_PAGES = (1ULL << 30) >> 12;
+
+struct Access
+{
+   IntPtr address;
+   IntPtr eip;
+};
+
+// Prefetcher name, and a key of its configuration section ("" if it has none)
+static const struct
+{
+   const char *name;
+   const char *key;
+} PREFETCHERS[] = {
+   { "none", "" },
+   { "stride", "/stride_prefetcher/length" },
+   { "h2", "" },
+   { "asp", "/asp_prefetcher/table_size" },
+   { "atp", "/atp_prefetcher/pq_size" },
+   { "recency", "/recency_prefetcher/page_shift" },
+   { "dp", "/dp_prefetcher/page_shift" },
+};
+
+static std::vector<Access> buildAccesses(UInt64 count)
+{
+   std::mt19937_64 rng(1);
+   std::vector<Access> accesses;
+   accesses.reserve(count);
+
+   IntPtr streams[STREAMS];
+   const IntPtr strides[STREAMS] = { 1, 2, 3, 5 };
+   for (int s = 0; s < STREAMS; s++)
+      streams[s] = 0x100000 + s * (RANDOM_PAGES / STREAMS);
+
+   for (UInt64 i = 0; i < count; i++)
+   {
+      Access access;
+      if (i % 8 == 7)
+      {
+         access.address = (0x100000 + rng() % RANDOM_PAGES) << 12;
+         access.eip = 0x400000;
+      }
+      else
+      {
+         int s = i % STREAMS;
+         access.address = streams[s] << 12;
+         access.eip = 0x401000 + s * 0x10;
+         streams[s] += strides[s];
+      }
+      accesses.push_back(access);
+   }
+   return accesses;
+}
+
+static void run(const char *name, const std::vector<Access> &accesses, Core *core, PageTable *pt)
+{
+   TLBPrefetcherBase *prefetcher = NULL;
+   if (strcmp(name, "none") != 0)
+      prefetcher = TLBprefetcherFactory::createTLBPrefetcher(MMU_NAME, name, "1", core, core->getMemoryManager(), core->getShmemPerfModel());
+
+   // Both stay allocated: their statistics are registered with the simulator
+   int page_sizes[] = { 12, 21 };
+   TLBPrefetcherBase **prefetchers = prefetcher ? new TLBPrefetcherBase*[1] { prefetcher } : NULL;
+   TLB *tlb = new TLB(String("bench_pq_") + name, PQ_CFG, core->getId(), ComponentLatency(core->getDvfsDomain(), 0),
+                      Sim()->getCfg()->getInt(PQ_CFG + "/size"), Sim()->getCfg()->getInt(PQ_CFG + "/assoc"),
+                      page_sizes, 2, "Data", false, true, prefetchers, prefetcher ? 1 : 0);
+   if (prefetcher)
+      prefetcher->setTLBHierarchy(std::vector<TLB *>(1, tlb));
+
+   ShmemPerfModel *shmem_perf_model = core->getShmemPerfModel();
+   SubsecondTime now = shmem_perf_model->getElapsedTime(ShmemPerfModel::_USER_THREAD);
+   UInt64 hits = 0;
+
+   BenchClock::time_point start = BenchClock::now();
+   for (const Access &access : accesses)
+   {
+      now += SubsecondTime::NS(1);
+      shmem_perf_model->setElapsedTime(ShmemPerfModel::_USER_THREAD, now);
+      if (tlb->lookup(access.address, now, true, Core::NONE, access.eip, true, false, pt))
+         hits++;
+   }
+   double seconds = std::chrono::duration<double>(BenchClock::now() - start).count();
+
+   printf("%-8s %12zu accesses  %8.1f ns/access  %6.2f%% prefetch hits\n", name, accesses.size(),
+          seconds * 1e9 / accesses.size(), 100.0 * hits / accesses.size());
+}
+
+int main(int argc, char* argv[])
+{
+   string_vec args;
+   String config_path = "carbon_sim.cfg";
+   parse_args(args, config_path, argc, argv);
+
+   // Benchmark arguments follow "--"
+   int first = 1;
+   while (first < argc && strcmp(argv[first], "--") != 0)
+      first++;
+   UInt64 count = (first + 1 < argc) ? strtoull(argv[first + 1], NULL, 10) : 1000000;
+   const char *prefetcher = (first + 2 < argc) ? argv[first + 2] : NULL;
+
+   config::ConfigFile *cfg = new config::ConfigFile();
+   cfg->load(config_path);
+   handle_args(args, *cfg);
+   // The MMUs keep their prefetch queue but not its prefetchers: those would register the same
+   // statistics for core 0 as the ones benchmarked here
+   if (cfg->hasKey(PQ_CFG + "/number_of_prefetchers"))
+      cfg->set(PQ_CFG + "/number_of_prefetchers", (SInt64)0);
+
+   // Cores, MMUs and MimicOS are needed for the prefetch walks; no application is run
+   Simulator::setConfig(cfg, Config::STANDALONE);
+   Simulator::allocate();
+   Sim()->start();
+
+   Sim()->getMimicOS()->createApplication(0);
+   PageTable *pt = Sim()->getMimicOS()->getPageTable(0);
+   Core *core = Sim()->getCoreManager()->getCoreFromID(0);
+   std::vector<Access> accesses = buildAccesses(count);
+
+   bool found = false;
+   for (const auto &p : PREFETCHERS)
+   {
+      if (prefetcher && strcmp(prefetcher, p.name) != 0)
+         continue;
+      found = true;
+      if (p.key[0] && !Sim()->getCfg()->hasKey(PQ_CFG + p.key))
+      {
+         printf("%-8s skipped, no %s%s in the configuration\n", p.name, PQ_CFG.c_str(), p.key);
+         continue;
+      }
+      run(p.name, accesses, core, pt);
+   }
+   if (!found)
+   {
+      fprintf(stderr, "Unknown prefetcher %s (none, stride, h2, asp, atp, recency or dp)\n", prefetcher);
+      return 1;
+   }
+
+   // The simulator never ran an application: leave the cleanup to process exit
+   return 0;
+}
@@ -138,6 +138,8 @@ public:
 	void enable() { m_enabled = true; }
 	void disable() { m_enabled = false; }
 
+	CacheSetInfo *getSetInfo() { return m_set_info; }
+
 	CacheSet *getCacheSet(UInt32 set_index);
 
 	void measureStats();
@@ -9,6 +9,7 @@ const char *CacheBlockInfo::option_names[] =
     {
         "prefetch",
         "warmup",
+        "cross-page-prefetch",
 };
 
 const char *CacheBlockInfo::getOptionName(option_t option)
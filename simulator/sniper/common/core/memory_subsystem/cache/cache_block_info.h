@@ -12,6 +12,7 @@ public:
 	{
 		PREFETCH,
 		WARMUP,
+		CROSS_PAGE_PREFETCH, // Prefetched from another page than the access that triggered it
 		NUM_OPTIONS
 	};
 
@@ -203,12 +203,13 @@ void
 DramCache::callPrefetcher(IntPtr train_address, bool cache_hit, bool prefetch_hit, SubsecondTime t_issue)
 {
    // Always train the prefetcher
-   std::vector<IntPtr> prefetchList = m_prefetcher->getNextAddress(train_address, INVALID_CORE_ID,Core::INVALID_MEM_OP, cache_hit, prefetch_hit, 0xdeadbeef);
+   m_prefetch_list.clear();
+   m_prefetcher->getNextAddress(train_address, INVALID_CORE_ID,Core::INVALID_MEM_OP, cache_hit, prefetch_hit, 0xdeadbeef, m_prefetch_list);
 
    // Only do prefetches on misses, or on hits to lines previously brought in by the prefetcher (if enabled)
    if (!cache_hit || (m_prefetch_on_prefetch_hit && prefetch_hit))
    {
-      for(std::vector<IntPtr>::iterator it = prefetchList.begin(); it != prefetchList.end(); ++it)
+      for(std::vector<IntPtr>::iterator it = m_prefetch_list.begin(); it != m_prefetch_list.end(); ++it)
       {
          IntPtr prefetch_address = *it;
          if (!m_cache->peekSingleLine(prefetch_address))
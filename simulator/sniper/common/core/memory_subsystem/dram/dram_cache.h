@@ -30,6 +30,7 @@ class DramCache : public DramCntlrInterface
       Cache* m_cache;
       QueueModel* m_queue_model;
       Prefetcher* m_prefetcher;
+      std::vector<IntPtr> m_prefetch_list; // Prefetcher output, reused across calls
       bool m_prefetch_on_prefetch_hit;
       ContentionModel m_prefetch_mshr;
 
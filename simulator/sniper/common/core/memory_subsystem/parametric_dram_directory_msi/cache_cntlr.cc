@@ -204,6 +204,7 @@
 #include "debug_config.h"
 #include "log.h"
 #include "memory_manager.h"
+#include "mmu_base.h"
 #include "core_manager.h"
 #include "simulator.h"
 #include "subsecond_time.h"
@@ -380,6 +381,7 @@ namespace ParametricDramDirectoryMSI
 	CacheMasterCntlr::~CacheMasterCntlr()
 	{
 		delete m_cache;
+		delete m_prefetch_mshr;
 		for (std::vector<ATD *>::iterator it = m_atds.begin(); it != m_atds.end(); ++it)
 		{
 			delete *it;
@@ -451,6 +453,24 @@ namespace ParametricDramDirectoryMSI
 
 			m_master->m_prefetcher = Prefetcher::createPrefetcher(cache_params.prefetcher, cache_params.configName, m_core_id, m_shared_cores);
 
+			if (m_master->m_prefetcher)
+			{
+				// Prefetch queue and issue bandwidth; by default at most one prefetch per ns, without an MSHR limit
+				String prefix = "perf_model/" + cache_params.configName + "/prefetcher/";
+				config::Config *cfg = Sim()->getCfg();
+				UInt32 queue_size = cfg->hasKey(prefix + "queue_size") ? cfg->getIntArray(prefix + "queue_size", core_id) : PREFETCH_MAX_QUEUE_LENGTH;
+				LOG_ASSERT_ERROR(queue_size > 0, "%squeue_size must be positive", prefix.c_str());
+				m_master->m_prefetch_queue = PrefetchQueue(queue_size);
+				if (cfg->hasKey(prefix + "issue_interval"))
+					m_master->m_prefetch_interval = SubsecondTime::NS(cfg->getIntArray(prefix + "issue_interval", core_id));
+				if (cfg->hasKey(prefix + "issue_degree"))
+					m_master->m_prefetch_issue_degree = cfg->getIntArray(prefix + "issue_degree", core_id);
+				UInt32 prefetch_mshrs = cfg->hasKey(prefix + "mshrs") ? cfg->getIntArray(prefix + "mshrs", core_id) : 0;
+				if (prefetch_mshrs > 0)
+					m_master->m_prefetch_mshr = new ContentionModel(name + ".prefetch-mshr", core_id, prefetch_mshrs);
+				m_master->m_prefetch_cross_page = cfg->getBoolDefault(prefix + "cross_page", false);
+			}
+
 			if (Sim()->getCfg()->getBoolDefault("perf_model/" + cache_params.configName + "/atd/enabled", false))
 			{
 				m_master->createATDs(name,
@@ -497,6 +517,7 @@ namespace ParametricDramDirectoryMSI
 			registerStatsMetric(name, core_id, String("stores-prefetch-") + BlockTypeString(type), &stats.stores_prefetch[type]);
 		}
 		registerStatsMetric(name, core_id, "hits-prefetch", &stats.hits_prefetch);
+		registerStatsMetric(name, core_id, "hits-prefetch-cross-page", &stats.hits_prefetch_cross_page);
 		registerStatsMetric(name, core_id, "evict-prefetch", &stats.evict_prefetch);
 		registerStatsMetric(name, core_id, "invalidate-prefetch", &stats.invalidate_prefetch);
 		registerStatsMetric(name, core_id, "hits-warmup", &stats.hits_warmup);
@@ -512,6 +533,11 @@ namespace ParametricDramDirectoryMSI
 		registerStatsMetric(name, core_id, "prefetches", &stats.prefetches);
 		registerStatsMetric(name, core_id, "prefetches-fillup", &stats.prefetches_fillup);
 		registerStatsMetric(name, core_id, "late-metadata-prefetches", &stats.late_metadata_prefetches);
+		registerStatsMetric(name, core_id, "prefetches-dropped", &stats.prefetches_dropped);
+		registerStatsMetric(name, core_id, "prefetches-mshr-throttled", &stats.prefetches_mshr_throttled);
+		registerStatsMetric(name, core_id, "prefetches-cross-page", &stats.prefetches_cross_page);
+		registerStatsMetric(name, core_id, "prefetches-cross-page-unmapped", &stats.prefetches_cross_page_unmapped);
+		registerStatsMetric(name, core_id, "prefetches-cross-page-untranslated", &stats.prefetches_cross_page_untranslated);
 		registerStatsMetric(name, core_id, "spec-evict-total", &stats.spec_evict_total);
 		registerStatsMetric(name, core_id, "spec-evict-harmful", &stats.spec_evict_harmful);
 
@@ -744,6 +770,11 @@ namespace ParametricDramDirectoryMSI
 				stats.hits_prefetch++;
 				prefetch_hit = true;
 				cache_block_info->clearOption(CacheBlockInfo::PREFETCH);
+				if (cache_block_info->hasOption(CacheBlockInfo::CROSS_PAGE_PREFETCH))
+				{
+					stats.hits_prefetch_cross_page++;
+					cache_block_info->clearOption(CacheBlockInfo::CROSS_PAGE_PREFETCH);
+				}
 			}
 
 			if (modeled && m_l1_mshr && m_l1_metadata_mshr)
@@ -1135,22 +1166,41 @@ namespace ParametricDramDirectoryMSI
 		ScopedLock sl(getLock());
 
 		// Always train the prefetcher
-		std::vector<IntPtr> prefetchList = m_master->m_prefetcher->getNextAddress(address, m_core_id, mem_op_type, cache_hit, prefetch_hit, eip);
+		std::vector<IntPtr> &candidates = m_master->m_prefetch_candidates;
+		candidates.clear();
+		m_master->m_prefetcher->getNextAddress(address, m_core_id, mem_op_type, cache_hit, prefetch_hit, eip, candidates);
 
 		// Only do prefetches on misses, or on hits to lines previously brought in by the prefetcher (if enabled)
 		if (!cache_hit || (m_prefetch_on_prefetch_hit && prefetch_hit))
 		{
-			m_master->m_prefetch_list.clear();
+			// The new prefetches replace those not issued yet
+			stats.prefetches_dropped += m_master->m_prefetch_queue.size();
+			m_master->m_prefetch_queue.clear();
 			// Just talked to the next-level cache, wait a bit before we start to prefetch
-			m_master->m_prefetch_next = t_issue + PREFETCH_INTERVAL;
+			m_master->m_prefetch_next = t_issue + m_master->m_prefetch_interval;
+			int page_size = m_master->m_prefetch_cross_page ? getMemoryManager()->getDemandPageSize(address) : 12;
 
-			for (std::vector<IntPtr>::iterator it = prefetchList.begin(); it != prefetchList.end(); ++it)
+			for (std::vector<IntPtr>::iterator it = candidates.begin(); it != candidates.end(); ++it)
 			{
-				// Keep at most PREFETCH_MAX_QUEUE_LENGTH entries in the prefetch queue
-				if (m_master->m_prefetch_list.size() > PREFETCH_MAX_QUEUE_LENGTH)
+				// Keep what fits in the prefetch queue
+				if (m_master->m_prefetch_queue.full())
+				{
+					stats.prefetches_dropped += candidates.end() - it;
 					break;
-				if (!operationPermissibleinCache(*it, Core::READ))
-					m_master->m_prefetch_list.push_back(*it);
+				}
+				// A candidate in another physical page is not in the next virtual page: queue the virtual
+				// address it has relative to the access in flight, if that access trained the prefetcher.
+				// Candidates in the same large page as the access are physically contiguous with it
+				if (m_master->m_prefetch_cross_page && (*it >> page_size) != (address >> page_size))
+				{
+					IntPtr virtual_address;
+					if (getMemoryManager()->getDemandVirtualAddress(address, *it, virtual_address))
+						m_master->m_prefetch_queue.push(virtual_address, true);
+					else
+						stats.prefetches_cross_page_unmapped++;
+				}
+				else if (!operationPermissibleinCache(*it, Core::READ))
+					m_master->m_prefetch_queue.push(*it);
 			}
 		}
 	}
@@ -1158,34 +1208,75 @@ namespace ParametricDramDirectoryMSI
 	void
 	CacheCntlr::Prefetch(IntPtr eip, SubsecondTime t_now)
 	{
-		IntPtr address_to_prefetch = INVALID_ADDRESS;
 		eip = 0xdeadbeef;
 
+		// Issue at most one prefetch per issue interval, and at most issue_degree now; save the rest for a future call
+		for (UInt32 issued = 0; issued < m_master->m_prefetch_issue_degree; ++issued)
 		{
-			ScopedLock sl(getLock());
+			IntPtr address_to_prefetch = INVALID_ADDRESS;
+			SubsecondTime t_prefetch;
+			bool cross_page = false;
 
-			if (m_master->m_prefetch_next <= t_now)
 			{
-				while (!m_master->m_prefetch_list.empty())
+				ScopedLock sl(getLock());
+
+				// Without a free prefetch MSHR, wait for one
+				if (m_master->m_prefetch_mshr && !m_master->m_prefetch_queue.empty())
 				{
-					IntPtr address = m_master->m_prefetch_list.front();
-					m_master->m_prefetch_list.pop_front();
+					SubsecondTime t_mshr = m_master->m_prefetch_mshr->getStartTime(m_master->m_prefetch_next);
+					if (t_mshr > m_master->m_prefetch_next)
+					{
+						stats.prefetches_mshr_throttled++;
+						m_master->m_prefetch_next = t_mshr;
+					}
+				}
 
-					// Check address again, maybe some other core already brought it into the cache
-					if (!operationPermissibleinCache(address, Core::READ))
+				if (m_master->m_prefetch_next <= t_now)
+				{
+					while (!m_master->m_prefetch_queue.empty())
 					{
-						address_to_prefetch = address;
-						// Do at most one prefetch now, save the rest for a future call
-						break;
+						PrefetchQueue::Entry entry = m_master->m_prefetch_queue.front();
+						m_master->m_prefetch_queue.pop();
+
+						// Virtual addresses are checked once translated
+						if (entry.is_virtual)
+						{
+							address_to_prefetch = entry.address;
+							cross_page = true;
+							break;
+						}
+						// Check address again, maybe some other core already brought it into the cache
+						if (!operationPermissibleinCache(entry.address, Core::READ))
+						{
+							address_to_prefetch = entry.address;
+							break;
+						}
 					}
 				}
+				t_prefetch = m_master->m_prefetch_next;
 			}
-		}
 
-		if (address_to_prefetch != INVALID_ADDRESS)
-		{
-			doPrefetch(eip, address_to_prefetch, m_master->m_prefetch_next, CacheBlockInfo::block_type_t::DATA);
-			atomic_add_subsecondtime(m_master->m_prefetch_next, PREFETCH_INTERVAL);
+			if (address_to_prefetch == INVALID_ADDRESS)
+				break;
+
+			// The walk takes the issue slot, also if the translation fails
+			if (cross_page && !translatePrefetch(eip, address_to_prefetch, t_prefetch))
+				continue;
+
+			doPrefetch(eip, address_to_prefetch, t_prefetch, CacheBlockInfo::block_type_t::DATA);
+			if (cross_page)
+			{
+				ScopedLock sl(getLock());
+				CacheBlockInfo *cache_block_info = getCacheBlockInfo(address_to_prefetch);
+				if (cache_block_info && cache_block_info->hasOption(CacheBlockInfo::PREFETCH))
+					cache_block_info->setOption(CacheBlockInfo::CROSS_PAGE_PREFETCH);
+			}
+			if (m_master->m_prefetch_mshr)
+			{
+				ScopedLock sl(getLock());
+				m_master->m_prefetch_mshr->getCompletionTime(t_prefetch, m_last_prefetch_completion - t_prefetch, address_to_prefetch);
+			}
+			atomic_add_subsecondtime(m_master->m_prefetch_next, m_master->m_prefetch_interval);
 		}
 
 		// In case the next-level cache has a prefetcher, run it
@@ -1193,6 +1284,28 @@ namespace ParametricDramDirectoryMSI
 			m_next_cache_cntlr->Prefetch(eip, t_now);
 	}
 
+	bool
+	CacheCntlr::translatePrefetch(IntPtr eip, IntPtr &address, SubsecondTime &t_prefetch)
+	{
+		// Translate the virtual address of a prefetch into another page; the prefetch waits for a walk
+		IntPtr physical_address;
+		SubsecondTime t_translated;
+		if (!getMemoryManager()->getMMU()->translatePrefetchAddress(eip, address, t_prefetch, physical_address, t_translated))
+		{
+			stats.prefetches_cross_page_untranslated++;
+			return false;
+		}
+
+		address = physical_address & ~(IntPtr(getCacheBlockSize()) - 1);
+		t_prefetch = t_translated;
+
+		ScopedLock sl(getLock());
+		if (operationPermissibleinCache(address, Core::READ))
+			return false;
+		stats.prefetches_cross_page++;
+		return true;
+	}
+
 	void
 	CacheCntlr::doPrefetch(IntPtr eip, IntPtr prefetch_address, SubsecondTime t_start, CacheBlockInfo::block_type_t block_type)
 	{
@@ -1319,6 +1432,11 @@ namespace ParametricDramDirectoryMSI
 				stats.hits_prefetch++;
 				prefetch_hit = true;
 				cache_block_info->clearOption(CacheBlockInfo::PREFETCH);
+				if (cache_block_info->hasOption(CacheBlockInfo::CROSS_PAGE_PREFETCH))
+				{
+					stats.hits_prefetch_cross_page++;
+					cache_block_info->clearOption(CacheBlockInfo::CROSS_PAGE_PREFETCH);
+				}
 
 			}
 			if (cache_block_info->hasOption(CacheBlockInfo::WARMUP) && Sim()->getInstrumentationMode() != InstMode::CACHE_ONLY)
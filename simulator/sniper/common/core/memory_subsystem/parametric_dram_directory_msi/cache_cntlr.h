@@ -3,6 +3,7 @@
 #include "core.h"
 #include "cache.h"
 #include "prefetcher.h"
+#include "prefetch_queue.h"
 #include "shared_cache_block_info.h"
 #include "address_home_lookup.h"
 #include "../pr_l1_pr_l2_dram_directory_msi/shmem_msg.h"
@@ -33,10 +34,12 @@ namespace ParametricDramDirectoryMSI
 class FaultInjector;
 class ShmemPerf;
 
-// Maximum size of the list of addresses to prefetch
+// Maximum size of the list of addresses to prefetch (default of prefetcher/queue_size)
 #define PREFETCH_MAX_QUEUE_LENGTH 32
-// Time between prefetches
+// Time between prefetches (default of prefetcher/issue_interval)
 #define PREFETCH_INTERVAL SubsecondTime::NS(1)
+// Maximum number of prefetches issued per access (default of prefetcher/issue_degree)
+#define PREFETCH_ISSUE_DEGREE 1
 
 namespace ParametricDramDirectoryMSI
 {
@@ -169,8 +172,13 @@ namespace ParametricDramDirectoryMSI
          UInt32 m_log_blocksize;
          UInt32 m_num_sets;
 
-         std::deque<IntPtr> m_prefetch_list;
+         std::vector<IntPtr> m_prefetch_candidates; // Prefetcher output, reused across calls
+         PrefetchQueue m_prefetch_queue;
          SubsecondTime m_prefetch_next;
+         SubsecondTime m_prefetch_interval;
+         UInt32 m_prefetch_issue_degree;
+         ContentionModel* m_prefetch_mshr;            // MSHRs prefetches may occupy, NULL if unlimited
+         bool m_prefetch_cross_page;                  // Follow candidates into other pages through the MMU
 
          // Speculative-prefetch eviction tracking (L2 only)
          // 4-way set-associative software cache of recently evicted addresses
@@ -238,8 +246,13 @@ namespace ParametricDramDirectoryMSI
             , m_evicting_address(0)
             , m_evicting_buf(NULL)
             , m_atds()
-            , m_prefetch_list()
+            , m_prefetch_candidates()
+            , m_prefetch_queue()
             , m_prefetch_next(SubsecondTime::Zero())
+            , m_prefetch_interval(PREFETCH_INTERVAL)
+            , m_prefetch_issue_degree(PREFETCH_ISSUE_DEGREE)
+            , m_prefetch_mshr(NULL)
+            , m_prefetch_cross_page(false)
             , m_l2_demand_count(0)
          {
             memset(m_spec_evict_table, 0, sizeof(m_spec_evict_table));
@@ -286,6 +299,7 @@ namespace ParametricDramDirectoryMSI
            UInt64 load_misses_state[CacheState::NUM_CSTATE_STATES][CacheBlockInfo::block_type_t::NUM_BLOCK_TYPES], store_misses_state[CacheState::NUM_CSTATE_STATES][CacheBlockInfo::block_type_t::NUM_BLOCK_TYPES];
            UInt64 loads_prefetch[CacheBlockInfo::block_type_t::NUM_BLOCK_TYPES], stores_prefetch[CacheBlockInfo::block_type_t::NUM_BLOCK_TYPES];
            UInt64 hits_prefetch, // lines which were prefetched and subsequently used by a non-prefetch access
+                  hits_prefetch_cross_page, // of those, lines prefetched from another page than the access that triggered them
                   evict_prefetch, // lines which were prefetched and evicted before being used
                   invalidate_prefetch; // lines which were prefetched and invalidated before being used
                   // Note: hits_prefetch+evict_prefetch+invalidate_prefetch will not account for all prefetched lines,
@@ -309,6 +323,11 @@ namespace ParametricDramDirectoryMSI
            UInt64 prefetches;
            UInt64 prefetches_fillup; // We track only the prefetches that actually caused a fillup in the L2 cache
            UInt64 late_metadata_prefetches;
+           UInt64 prefetches_dropped;       // Discarded from (or never entered) the prefetch queue
+           UInt64 prefetches_mshr_throttled; // Times the next prefetch waited for a free prefetch MSHR
+           UInt64 prefetches_cross_page;     // Issued into another page, after translating its virtual address
+           UInt64 prefetches_cross_page_unmapped;      // Candidates in another page without a known virtual address
+           UInt64 prefetches_cross_page_untranslated;  // Dropped by the MMU (busy walkers or no mapping)
 
 
            UInt64 spec_evict_total;    // L2 evictions caused by speculative prefetches
@@ -369,6 +388,7 @@ namespace ParametricDramDirectoryMSI
          void copyDataFromNextLevel(Core::mem_op_t mem_op_type, IntPtr address, bool modeled, SubsecondTime t_start, CacheBlockInfo::block_type_t block_type);
          void trainPrefetcher(IntPtr eip, IntPtr address, Core::mem_op_t mem_op_type,  bool cache_hit, bool prefetch_hit, SubsecondTime t_issue);
          void Prefetch(IntPtr eip, SubsecondTime t_start);
+         bool translatePrefetch(IntPtr eip, IntPtr &address, SubsecondTime &t_prefetch);
          bool specDoPrefetch(IntPtr eip, IntPtr prefetch_address, SubsecondTime t_start);
          // Cache meta-data operationsz
          SharedCacheBlockInfo* getCacheBlockInfo(IntPtr address);
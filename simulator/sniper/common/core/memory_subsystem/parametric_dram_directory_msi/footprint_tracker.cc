@@ -0,0 +1,122 @@
+#include "footprint_tracker.h"
+#include "simulator.h"
+#include "config.hpp"
+#include "stats.h"
+#include "log.h"
+#include "utils.h"
+#include "itostr.h"
+
+namespace ParametricDramDirectoryMSI
+{
+	const char* const FootprintTracker::PAGE_SIZE_NAMES[NUM_PAGE_SIZES] = { "4KB", "2MB", "1GB" };
+
+	static UInt64 getCfgIntDefault(const String &key, UInt64 default_value)
+	{
+		return Sim()->getCfg()->hasKey(key) ? Sim()->getCfg()->getInt(key) : default_value;
+	}
+
+	FootprintTracker::FootprintTracker(core_id_t core_id, UInt32 line_size)
+		: m_core_id(core_id)
+		, m_log_line_size(floorLog2(line_size))
+		, m_precision(getCfgIntDefault("perf_model/footprint/precision", 14))
+		, m_lines(m_precision)
+		, m_pages(m_precision)
+		, m_size_lines(NUM_PAGE_SIZES, HyperLogLog(m_precision))
+		, m_size_pages(NUM_PAGE_SIZES, HyperLogLog(m_precision))
+		, m_vma_breakdown(Sim()->getCfg()->getBoolDefault("perf_model/footprint/vma_breakdown", false))
+		, m_max_vmas(getCfgIntDefault("perf_model/footprint/max_vmas", 16))
+		, m_last_vma(NULL)
+		, m_exact(Sim()->getCfg()->getBoolDefault("perf_model/footprint/exact", false))
+		, m_exact_max_pages(getCfgIntDefault("perf_model/footprint/exact_max_pages", 262144))
+		, m_exact_lines(0)
+		, m_exact_page_count(0)
+	{
+		LOG_ASSERT_ERROR(m_precision >= 4 && m_precision <= 24, "perf_model/footprint/precision must be between 4 and 24 (got %d)", m_precision);
+		// One 64-bit bitmap per 4KB page
+		LOG_ASSERT_ERROR(!m_exact || line_size >= 64, "perf_model/footprint/exact needs cache lines of at least 64 bytes (got %u)", line_size);
+
+		Sim()->getStatsManager()->registerMetric(new StatsMetricCallback("footprint", core_id, "unique_lines", estimateCallback, (UInt64)&m_lines));
+		Sim()->getStatsManager()->registerMetric(new StatsMetricCallback("footprint", core_id, "unique_pages", estimateCallback, (UInt64)&m_pages));
+		for (int i = 0; i < NUM_PAGE_SIZES; i++)
+		{
+			Sim()->getStatsManager()->registerMetric(new StatsMetricCallback("footprint", core_id, String("unique_lines_") + PAGE_SIZE_NAMES[i], estimateCallback, (UInt64)&m_size_lines[i]));
+			Sim()->getStatsManager()->registerMetric(new StatsMetricCallback("footprint", core_id, String("unique_pages_") + PAGE_SIZE_NAMES[i], estimateCallback, (UInt64)&m_size_pages[i]));
+		}
+		if (m_exact)
+		{
+			m_exact_pages.reserve(m_exact_max_pages);
+			registerStatsMetric("footprint", core_id, "exact_unique_lines", &m_exact_lines);
+			registerStatsMetric("footprint", core_id, "exact_unique_pages", &m_exact_page_count);
+		}
+
+		// Kept under its old name: the exact count while there is one, the estimate otherwise
+		Sim()->getStatsManager()->registerMetric(new StatsMetricCallback("memory_manager", core_id, "unique_data_cache_lines", uniqueLinesCallback, (UInt64)this));
+	}
+
+	void FootprintTracker::accessVMA(int app_id, int vma_index, IntPtr pa)
+	{
+		if (vma_index < 0)
+			return;
+
+		VMASketch *sketch = m_last_vma;
+		if (!sketch || sketch->vma_index != vma_index || sketch->app_id != app_id)
+		{
+			sketch = NULL;
+			for (auto &vma : m_vmas)
+			{
+				if (vma->vma_index == vma_index && vma->app_id == app_id)
+				{
+					sketch = vma.get();
+					break;
+				}
+			}
+			if (!sketch)
+			{
+				if (m_vmas.size() >= m_max_vmas)
+					return;
+				m_vmas.emplace_back(new VMASketch(app_id, vma_index, m_precision));
+				sketch = m_vmas.back().get();
+				Sim()->getStatsManager()->registerMetric(new StatsMetricCallback("footprint", m_core_id,
+					"unique_lines_app" + itostr(app_id) + "_vma" + itostr(vma_index), estimateCallback, (UInt64)&sketch->lines));
+			}
+			m_last_vma = sketch;
+		}
+		sketch->lines.insert(pa >> m_log_line_size);
+	}
+
+	void FootprintTracker::accessExact(IntPtr pa)
+	{
+		auto page = m_exact_pages.emplace(pa >> 12, 0);
+		if (page.second && ++m_exact_page_count > m_exact_max_pages)
+		{
+			LOG_PRINT_WARNING("Core %d: data footprint exceeds perf_model/footprint/exact_max_pages (%lu), only estimates are reported from now on", m_core_id, m_exact_max_pages);
+			m_exact = false;
+			m_exact_pages.clear();
+			m_exact_lines = 0;
+			m_exact_page_count = 0;
+			return;
+		}
+
+		UInt64 bit = 1ULL << ((pa & 0xfff) >> m_log_line_size);
+		if (!(page.first->second & bit))
+		{
+			page.first->second |= bit;
+			m_exact_lines++;
+		}
+	}
+
+	UInt64 FootprintTracker::getUniqueLines() const
+	{
+		return m_exact ? m_exact_lines : m_lines.estimate();
+	}
+
+	UInt64 FootprintTracker::estimateCallback(String objectName, UInt32 index, String metricName, UInt64 arg)
+	{
+		return ((const HyperLogLog *)arg)->estimate();
+	}
+
+	UInt64 FootprintTracker::uniqueLinesCallback(String objectName, UInt32 index, String metricName, UInt64 arg)
+	{
+		return ((const FootprintTracker *)arg)->getUniqueLines();
+	}
+}
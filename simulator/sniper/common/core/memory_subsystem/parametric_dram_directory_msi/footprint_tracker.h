@@ -0,0 +1,101 @@
+#ifndef FOOTPRINT_TRACKER_H
+#define FOOTPRINT_TRACKER_H
+
+#include "fixed_types.h"
+#include "hyperloglog.h"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace ParametricDramDirectoryMSI
+{
+	/**
+	 * @brief Data footprint of one core: distinct cache lines and pages it accessed.
+	 *
+	 * Counted with HyperLogLog sketches, so memory is fixed (a few sketches of 2^precision bytes)
+	 * and an access costs a few hashes, whatever the footprint. Breakdowns:
+	 *
+	 * - by page size of the translation (4KB, 2MB, 1GB): lines, and pages of that size
+	 * - by VMA (vma_breakdown): lines, for the first max_vmas VMAs seen; needs a VMA lookup
+	 *   per access, so it is off by default
+	 *
+	 * For small regions of interest, exact = true also keeps a bitmap of the lines of every 4KB
+	 * page touched, up to exact_max_pages pages; beyond that the exact counts stop (and read 0).
+	 *
+	 * Configured in [perf_model/footprint]; statistics are reported under footprint.
+	 */
+	class FootprintTracker
+	{
+	public:
+		FootprintTracker(core_id_t core_id, UInt32 line_size);
+
+		/**
+		 * @brief Count an access to the line at physical address pa
+		 * @param page_size Page size (bits) of the translation that produced pa
+		 */
+		void access(IntPtr pa, int page_size)
+		{
+			m_lines.insert(pa >> m_log_line_size);
+			m_pages.insert(pa >> 12);
+			int size_index = pageSizeIndex(page_size);
+			if (size_index >= 0)
+			{
+				m_size_lines[size_index].insert(pa >> m_log_line_size);
+				m_size_pages[size_index].insert(pa >> page_size);
+			}
+			if (m_exact)
+				accessExact(pa);
+		}
+
+		bool isVMABreakdownEnabled() const { return m_vma_breakdown; }
+		// Count the access to pa towards VMA vma_index of application app_id
+		void accessVMA(int app_id, int vma_index, IntPtr pa);
+
+		// Distinct data lines accessed: exact while the exact bitmaps cover the footprint, estimated otherwise
+		UInt64 getUniqueLines() const;
+
+	private:
+		static const int NUM_PAGE_SIZES = 3;        // 4KB, 2MB, 1GB
+		static const char* const PAGE_SIZE_NAMES[NUM_PAGE_SIZES];
+
+		static int pageSizeIndex(int page_size)
+		{
+			return page_size == 12 ? 0 : page_size == 21 ? 1 : page_size == 30 ? 2 : -1;
+		}
+
+		void accessExact(IntPtr pa);
+
+		static UInt64 estimateCallback(String objectName, UInt32 index, String metricName, UInt64 arg);
+		static UInt64 uniqueLinesCallback(String objectName, UInt32 index, String metricName, UInt64 arg);
+
+		const core_id_t m_core_id;
+		int m_log_line_size;
+		int m_precision;
+
+		HyperLogLog m_lines;
+		HyperLogLog m_pages;                        // 4KB frames
+		std::vector<HyperLogLog> m_size_lines;      // Indexed by pageSizeIndex()
+		std::vector<HyperLogLog> m_size_pages;      // Pages of that size
+
+		bool m_vma_breakdown;
+		UInt32 m_max_vmas;
+		struct VMASketch
+		{
+			int app_id;
+			int vma_index;
+			HyperLogLog lines;
+			VMASketch(int _app_id, int _vma_index, int precision) : app_id(_app_id), vma_index(_vma_index), lines(precision) {}
+		};
+		std::vector<std::unique_ptr<VMASketch>> m_vmas;
+		VMASketch *m_last_vma;                      // Accesses mostly stay in one VMA
+
+		bool m_exact;
+		UInt64 m_exact_max_pages;
+		std::unordered_map<IntPtr, UInt64> m_exact_pages;   // 4KB frame -> bitmap of its lines
+		UInt64 m_exact_lines;
+		UInt64 m_exact_page_count;
+	};
+}
+
+#endif // FOOTPRINT_TRACKER_H
@@ -58,7 +58,11 @@ namespace ParametricDramDirectoryMSI
 																					   m_dram_cache(NULL),
 																					   m_dram_directory_cntlr(NULL),
 																					   m_dram_cntlr(NULL),
-																					   m_dram_cntlr_present(false)
+																					   m_dram_cntlr_present(false),
+																					   m_demand_translation_valid(false),
+																					   m_demand_virtual_address(0),
+																					   m_demand_physical_address(0),
+																					   m_demand_page_size(12)
 
 	{
 
@@ -457,7 +461,7 @@ namespace ParametricDramDirectoryMSI
 
 		registerStatsMetric("memory_manager", core->getId(), "translation_slower_than_memory_access", &memory_access_stats.translation_slower_than_memory_access);
 		registerStatsMetric("memory_manager", core->getId(), "translation_faster_than_memory_access", &memory_access_stats.translation_faster_than_memory_access);
-		registerStatsMetric("memory_manager", core->getId(), "unique_data_cache_lines", &memory_access_stats.unique_data_cache_lines);
+		m_footprint = new FootprintTracker(core->getId(), m_cache_block_size);
 
 
 		std::cout << std::endl;
@@ -502,8 +506,9 @@ namespace ParametricDramDirectoryMSI
 
 		// Print unique data cache lines accessed
 		std::cout << "[Memory Manager] Core " << getCore()->getId() 
-		          << " accessed " << m_unique_data_cache_lines.size() 
+		          << " accessed " << m_footprint->getUniqueLines() 
 		          << " unique data cache lines" << std::endl;
+		delete m_footprint;
 	}
 
 	/* Core ships the memory request to the memory manager */
@@ -611,6 +616,9 @@ namespace ParametricDramDirectoryMSI
 		bool is_instruction = (mem_component == MemComponent::L1_ICACHE);
 		IntPtr translation_result; // Pair < How much time the translation took, the physical address >
 
+		if (!skip_translation)
+			receiveTLBShootdowns();
+
 		SubsecondTime t_start_translation = getShmemPerfModel()->getElapsedTime(ShmemPerfModel::_USER_THREAD);
 		if (!skip_translation)
 		{
@@ -660,8 +668,12 @@ namespace ParametricDramDirectoryMSI
 
 		// Track unique data cache lines (not instruction fetches)
 		if (!is_instruction) {
-			m_unique_data_cache_lines.insert(physical_address);
-			memory_access_stats.unique_data_cache_lines = m_unique_data_cache_lines.size();
+			m_footprint->access(physical_address, skip_translation ? 12 : m_mmu->getLastPageSize());
+			if (m_footprint->isVMABreakdownEnabled() && !skip_translation)
+			{
+				int app_id = getCore()->getThread()->getAppId();
+				m_footprint->accessVMA(app_id, Sim()->getMimicOS()->lookupVMA(app_id, address, getCore()->getId()), physical_address);
+			}
 		}
 
 
@@ -682,6 +694,12 @@ namespace ParametricDramDirectoryMSI
 				dram_accesses_during_translation));
 		}
 		
+		// Let the cache prefetchers map their candidates back to virtual addresses
+		m_demand_translation_valid = !skip_translation && !is_instruction;
+		m_demand_virtual_address = address & ~(getCacheBlockSize() - 1);
+		m_demand_physical_address = physical_address;
+		m_demand_page_size = m_mmu->getLastPageSize();
+
 		// Perform the memory access -> send the request to the cache hierarchy
 		HitWhere::where_t result = m_cache_cntlrs[mem_component]->processMemOpFromCore(
 			eip,
@@ -691,6 +709,7 @@ namespace ParametricDramDirectoryMSI
 			data_buf, data_length,
 			modeled == Core::MEM_MODELED_NONE || modeled == Core::MEM_MODELED_COUNT ? false : true,
 			modeled == Core::MEM_MODELED_NONE ? false : true, CacheBlockInfo::block_type_t::DATA, SubsecondTime::Zero());
+		m_demand_translation_valid = false;
 
 		// Clear the MetadataContext after the data access
 		MetadataContext::clear(getCore()->getId());
@@ -949,6 +968,24 @@ namespace ParametricDramDirectoryMSI
 		return m_cache_perf_models[mem_component]->getLatency(access_type);
 	}
 
+	// Apply the invalidations other cores (or this one) sent to this core through MimicOS
+	// TLB shootdowns, and stall for the interrupts and invalidations
+	void
+	MemoryManager::receiveTLBShootdowns()
+	{
+		for (MimicOS *os : { Sim()->getMimicOS(), Sim()->getMimicOS_VM() })
+		{
+			TLBShootdown *shootdown = os ? os->getTLBShootdown() : NULL;
+			if (!shootdown || !shootdown->hasPending(getCore()->getId()))
+				continue;
+
+			SubsecondTime stall = shootdown->receive(getCore()->getId(), m_shootdown_requests);
+			for (const TLBShootdown::Request &request : m_shootdown_requests)
+				m_mmu->invalidateTranslations(request);
+			incrElapsedTime(stall, ShmemPerfModel::_USER_THREAD);
+		}
+	}
+
 	void
 	MemoryManager::incrElapsedTime(SubsecondTime latency, ShmemPerfModel::Thread_t thread_num)
 	{
@@ -15,6 +15,7 @@
 #include "subsecond_time.h"
 #include "contention_model.h"
 #include "mmu_base.h"
+#include "footprint_tracker.h"
 
 #include <map>
 #include <unordered_set>
@@ -97,12 +98,22 @@ namespace ParametricDramDirectoryMSI
 			
 			UInt64 translation_slower_than_memory_access;
 			UInt64 translation_faster_than_memory_access;
-			UInt64 unique_data_cache_lines;
 
 		} memory_access_stats;
 
-		// Track unique data cache lines accessed
-		std::unordered_set<IntPtr> m_unique_data_cache_lines;
+		// Distinct data lines and pages accessed, in fixed memory
+		FootprintTracker *m_footprint;
+
+		// Invalidations delivered by TLB shootdowns, reused across translations
+		std::vector<TLBShootdown::Request> m_shootdown_requests;
+		void receiveTLBShootdowns();
+
+		// Virtual and physical address and page size of the translated data access in flight (invalid outside of one),
+		// so that cache prefetchers can follow it into the next virtual page
+		bool m_demand_translation_valid;
+		IntPtr m_demand_virtual_address;
+		IntPtr m_demand_physical_address;
+		int m_demand_page_size;           // Page size (bits) of the translated data access in flight
 
 	public:
 		MemoryManager(Core *core, Network *network, ShmemPerfModel *shmem_perf_model);
@@ -134,6 +145,25 @@ namespace ParametricDramDirectoryMSI
 		SubsecondTime getTranslationLatency() const { return memory_access_stats.m_translation_latency; }
 		SubsecondTime getMemoryAccessLatency() const { return memory_access_stats.m_memory_access_latency; }
 
+		// Virtual address of physical_address, taken as an offset from the translated data access in flight.
+		// False outside of such an access, or if reference (the address that trained the prefetcher) does
+		// not lie in its page.
+		bool getDemandVirtualAddress(IntPtr reference, IntPtr physical_address, IntPtr &virtual_address) const
+		{
+			if (!m_demand_translation_valid || (reference >> 12) != (m_demand_physical_address >> 12))
+				return false;
+			virtual_address = m_demand_virtual_address + (physical_address - m_demand_physical_address);
+			return true;
+		}
+
+		// Page size (bits) that maps reference: that of the translated data access in flight, 4KB outside of it
+		int getDemandPageSize(IntPtr reference) const
+		{
+			if (!m_demand_translation_valid || (reference >> 12) != (m_demand_physical_address >> 12))
+				return 12;
+			return m_demand_page_size;
+		}
+
 		HitWhere::where_t coreInitiateMemoryAccess(
 			IntPtr eip,
 			MemComponent::component_t mem_component,
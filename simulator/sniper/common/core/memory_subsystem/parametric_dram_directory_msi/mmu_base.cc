@@ -14,6 +14,10 @@
 #include "simulator.h"
 #include "config.hpp"
 #include "sim_log.h"
+#include "hooks_manager.h"
+#include "thread_manager.h"
+#include "thread.h"
+#include "base_filter.h"
 
 #include "debug_config.h"
 
@@ -133,6 +137,85 @@ namespace ParametricDramDirectoryMSI
         registerStatsMetric("mmu_walker", core->getId(), "L1D_accesses_prefetch", &walker_stats.L1D_accesses_prefetch);
         registerStatsMetric("mmu_walker", core->getId(), "L2_accesses_prefetch", &walker_stats.L2_accesses_prefetch);
         registerStatsMetric("mmu_walker", core->getId(), "NUCA_accesses_prefetch", &walker_stats.NUCA_accesses_prefetch);
+
+        // Context switches between applications: pcid keeps the TLB and PWC entries of other
+        // address spaces (tagged with their ASID), flush invalidates them
+        String context_switch = Sim()->getCfg()->hasKey("perf_model/tlb/context_switch") ? Sim()->getCfg()->getString("perf_model/tlb/context_switch") : "pcid";
+        LOG_ASSERT_ERROR(context_switch == "pcid" || context_switch == "flush", "Invalid perf_model/tlb/context_switch %s (pcid or flush)", context_switch.c_str());
+        m_asid = 0;
+        m_asid_flush = (context_switch == "flush");
+        m_asid_switches = 0;
+        m_last_page_size = 12;
+        registerStatsMetric(name, core->getId(), "asid_switches", &m_asid_switches);
+
+        bzero(&prefetch_translation_stats, sizeof(prefetch_translation_stats));
+        registerStatsMetric(name, core->getId(), "prefetch_translations", &prefetch_translation_stats.requests);
+        registerStatsMetric(name, core->getId(), "prefetch_translation_tlb_hits", &prefetch_translation_stats.tlb_hits);
+        registerStatsMetric(name, core->getId(), "prefetch_page_table_walks", &prefetch_translation_stats.walks);
+        registerStatsMetric(name, core->getId(), "prefetch_walk_faults", &prefetch_translation_stats.faults);
+        registerStatsMetric(name, core->getId(), "prefetch_walks_walker_busy", &prefetch_translation_stats.walker_busy);
+        registerStatsMetric(name, core->getId(), "prefetch_walk_latency", &prefetch_translation_stats.walk_latency);
+        Sim()->getHooksManager()->registerHook(HookType::HOOK_THREAD_MIGRATE, MemoryManagementUnitBase::hookThreadMigrate, (UInt64)this);
+    }
+
+    SInt64 MemoryManagementUnitBase::hookThreadMigrate(UInt64 object, UInt64 argument)
+    {
+        MemoryManagementUnitBase *mmu = (MemoryManagementUnitBase *)object;
+        HooksManager::ThreadMigrate *args = (HooksManager::ThreadMigrate *)argument;
+        if (args->core_id == mmu->core->getId())
+            mmu->switchAddressSpace(Sim()->getThreadManager()->getThreadFromID(args->thread_id)->getAppId());
+        return 0;
+    }
+
+    void MemoryManagementUnitBase::switchAddressSpace(UInt16 asid)
+    {
+        if (asid == m_asid)
+            return;
+
+        SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "Switching from ASID", m_asid, "to ASID", asid, m_asid_flush ? "(flush)" : "(pcid)");
+        if (TLBHierarchy *tlb_hierarchy = getTLBHierarchy())
+            tlb_hierarchy->switchAddressSpace(asid, m_asid_flush);
+        if (BaseFilter *ptw_filter = getPTWFilter())
+            ptw_filter->switchAddressSpace(asid, m_asid_flush);
+        m_asid = asid;
+        m_asid_switches++;
+    }
+
+    void MemoryManagementUnitBase::invalidateTranslations(const TLBShootdown::Request &request)
+    {
+        SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "Shootdown type", (int)request.type, "ASID", request.asid, "address", SimLog::hex(request.address));
+        TLBHierarchy *tlb_hierarchy = getTLBHierarchy();
+        BaseFilter *ptw_filter = getPTWFilter();
+        switch (request.type)
+        {
+            case TLBShootdown::Request::PAGE:
+                if (tlb_hierarchy)
+                    tlb_hierarchy->invalidatePage(request.asid, request.address);
+                // INVLPG also drops the cached walks of the address space
+                if (ptw_filter)
+                    ptw_filter->flushAddressSpace(request.asid);
+                break;
+            case TLBShootdown::Request::PHYSICAL:
+                // The page-table pages are unchanged, the walk caches stay valid
+                if (tlb_hierarchy)
+                    tlb_hierarchy->invalidatePhysical(request.address);
+                break;
+            case TLBShootdown::Request::ADDRESS_SPACE:
+                if (tlb_hierarchy)
+                    tlb_hierarchy->flushAddressSpace(request.asid);
+                if (ptw_filter)
+                    ptw_filter->flushAddressSpace(request.asid);
+                break;
+            case TLBShootdown::Request::ALL:
+                if (tlb_hierarchy)
+                    tlb_hierarchy->flush();
+                // Flush the walk caches, staying in the current address space
+                if (ptw_filter)
+                    ptw_filter->switchAddressSpace(m_asid, true);
+                break;
+        }
+        if (nested_mmu)
+            nested_mmu->invalidateTranslations(request);
     }
 
 	MemoryManagementUnitBase::~MemoryManagementUnitBase()
@@ -207,7 +290,7 @@ namespace ParametricDramDirectoryMSI
 	SubsecondTime MemoryManagementUnitBase::accessCache(translationPacket packet, SubsecondTime t_start, bool is_prefetch, HitWhere::where_t& out_hit_where)
 	{
 
-		mmu_base_log->debug("---- Starting cache access from MMU");
+		SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "---- Starting cache access from MMU");
 		SubsecondTime host_translation_latency = SubsecondTime::Zero();
 		IntPtr host_physical_address = packet.address;
 		// If there is a nested MMU, perform address translation to translate the guest physical address to the host physical address
@@ -243,11 +326,11 @@ namespace ParametricDramDirectoryMSI
 
 		shmem_perf_model->setElapsedTime(ShmemPerfModel::_USER_THREAD, t_start);
 
-		mmu_base_log->debug("Accessing cache with address:", SimLog::hex(packet.address), "at time", t_start.getNS(), "ns");
+		SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "Accessing cache with address:", SimLog::hex(packet.address), "at time", t_start.getNS(), "ns");
 		HitWhere::where_t hit_where = HitWhere::UNKNOWN;
 		if(is_prefetch){
 
-			mmu_base_log->debug("Prefetching address:", SimLog::hex(packet.address), "at time", t_start.getNS(), "ns");
+			SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "Prefetching address:", SimLog::hex(packet.address), "at time", t_start.getNS(), "ns");
 			IntPtr cache_address = ((IntPtr)(packet.address)) & (~((64 - 1)));
 
 			MMUCacheInterface *l2_cache = memory_manager->getCacheCntlrAt(core->getId(), MemComponent::L2_CACHE);
@@ -266,7 +349,7 @@ namespace ParametricDramDirectoryMSI
 			packet.count, packet.type, host_translation_latency);
 			
 			stats.memory_accesses++;
-			mmu_base_log->debug("Cache hit where:", HitWhereString(hit_where));
+			SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "Cache hit where:", HitWhereString(hit_where));
 			
 			if (hit_where == HitWhere::where_t::L2_OWN)
 				walker_stats.L2_accesses++;
@@ -308,7 +391,7 @@ namespace ParametricDramDirectoryMSI
 		// Tag the cache block with the block type (e.g., page table data)
 		memory_manager->tagCachesBlockType(packet.address, packet.type);
 
-		mmu_base_log->debug("---- Finished cache access from MMU");
+		SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "---- Finished cache access from MMU");
 
 		return t_end - t_start;
 	}
@@ -328,10 +411,10 @@ namespace ParametricDramDirectoryMSI
 	 * @param lock The lock signal for the core.
 	 * @return SubsecondTime The total latency incurred during the page table walk.
 	 */
-    SubsecondTime MemoryManagementUnitBase::calculatePTWCycles(PTWResult ptw_result, bool count, bool modeled, IntPtr eip, Core::lock_signal_t lock, IntPtr original_va, bool instruction, bool is_prefetch)
+    SubsecondTime MemoryManagementUnitBase::calculatePTWCycles(const PTWResult& ptw_result, bool count, bool modeled, IntPtr eip, Core::lock_signal_t lock, IntPtr original_va, bool instruction, bool is_prefetch)
 	{
 
-		accessedAddresses accesses = ptw_result.accesses;
+		const accessedAddresses& accesses = ptw_result.accesses;
 
 		translationPacket packet;
 		packet.eip = eip; 
@@ -374,8 +457,8 @@ namespace ParametricDramDirectoryMSI
 		/* iterate through the accesses and calculate the latency for each table and level */
 		SubsecondTime t_now =  shmem_perf_model->getElapsedTime(ShmemPerfModel::_USER_THREAD);
 
-		mmu_base_log->debug("Starting PTW at time:", t_now.getNS(), "ns");
-		mmu_base_log->debug("We need to access", accesses.size(), "addresses");
+		SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "Starting PTW at time:", t_now.getNS(), "ns");
+		SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "We need to access", accesses.size(), "addresses");
 
 		// There are two options here: we will either charge the latency of the page fault before the PTW or after the PTW
 		// In this case, we will charge the page fault latency after the PTW -> this will happen in the mmu_base.cc
@@ -406,7 +489,7 @@ namespace ParametricDramDirectoryMSI
 
 		for (int level = 0; level < (levels + 1); level++)
 		{
-			mmu_base_log->debug("We start performing all the accesses for level:", level);
+			SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "We start performing all the accesses for level:", level);
 			for (int tab = 0; tab < (tables + 1); tab++)
 			{
 
@@ -444,7 +527,7 @@ namespace ParametricDramDirectoryMSI
 							
 							MetadataContext::set(core->getId(), ptw_info);
 							
-							mmu_base_log->debug("Metadata context set for PTW access - address:", SimLog::hex(current_address), "level:", level, "table:", tab, "ptw_id:", current_ptw_id);
+							SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "Metadata context set for PTW access - address:", SimLog::hex(current_address), "level:", level, "table:", tab, "ptw_id:", current_ptw_id);
 							latency = accessCache(packet, t_now+fetch_delay[tab], false, temp_hit_where);
 							
 							// Track prefetch-specific walker stats
@@ -470,7 +553,7 @@ namespace ParametricDramDirectoryMSI
 						else{
 							latency = SubsecondTime::Zero();
 						}
-						mmu_base_log->debug("Accessed address:", SimLog::hex(current_address), "level:", level, "table:", tab, "latency:", latency.getNS(), "ns");
+						SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "Accessed address:", SimLog::hex(current_address), "level:", level, "table:", tab, "latency:", latency.getNS(), "ns");
 					
 						if (accesses[req].is_pte == true)
 						{
@@ -490,11 +573,11 @@ namespace ParametricDramDirectoryMSI
 				}
 				// We need to update the fetch delay for the next level 
 				fetch_delay[tab] += latency_per_table_per_level[tab][level];
-				mmu_base_log->trace("Finished PTW for table:", tab, "level:", level, "at time:", (t_now+fetch_delay[tab]).getNS(), "ns");
+				SIM_LOG_TRACE_AT(DEBUG_MMU_BASE, mmu_base_log, "Finished PTW for table:", tab, "level:", level, "at time:", (t_now+fetch_delay[tab]).getNS(), "ns");
 			}
 		}
 
-		mmu_base_log->debug("Finding latency for correct translation");
+		SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "Finding latency for correct translation");
 
 		// Walking the correct table leads to the calculation of the total walk latency
 		// The requests for the other tables will be sent to the cache hierarchy to model the contention 
@@ -509,7 +592,7 @@ namespace ParametricDramDirectoryMSI
             int cnt_nuca = 0;
             int cnt_dram = 0;
 
-			mmu_base_log->debug("Found correct translation - table:", correct_table, "level:", correct_level);
+			SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "Found correct translation - table:", correct_table, "level:", correct_level);
 			for (int level = 0; level < (levels + 1); level++)
 			{
 
@@ -522,7 +605,7 @@ namespace ParametricDramDirectoryMSI
                 else if (loc == HitWhere::where_t::NUCA_CACHE) cnt_nuca++;
                 else if (loc == HitWhere::where_t::DRAM_LOCAL) cnt_dram++;
 
-				mmu_base_log->trace("Adding latency for level:", level, "table:", correct_table, "latency:", latency_per_table_per_level[correct_table][level].getNS(), "ns, total:", walk_latency.getNS(), "ns");
+				SIM_LOG_TRACE_AT(DEBUG_MMU_BASE, mmu_base_log, "Adding latency for level:", level, "table:", correct_table, "latency:", latency_per_table_per_level[correct_table][level].getNS(), "ns, total:", walk_latency.getNS(), "ns");
 			}
 
 			#if ENABLE_MMU_CSV_LOGS
@@ -539,7 +622,7 @@ namespace ParametricDramDirectoryMSI
 			#endif
 		}
 		else {
-			mmu_base_log->debug("No correct translation found - using max latency from slowest table");
+			SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "No correct translation found - using max latency from slowest table");
 			SubsecondTime max_latency = SubsecondTime::Zero();
 			for (int tab = 0; tab < (tables + 1); tab++)
 			{
@@ -577,28 +660,25 @@ namespace ParametricDramDirectoryMSI
 	 */
 	PTWOutcome MemoryManagementUnitBase::performPTW(IntPtr address, bool modeled, bool count, bool is_prefetch, IntPtr eip, Core::lock_signal_t lock, PageTable *page_table, bool restart_walk, bool instruction)
 	{
-			mmu_base_log->section("Starting PTW");
-			mmu_base_log->debug("PTW for address:", SimLog::hex(address));
+			SIM_LOG_SECTION_AT(DEBUG_MMU_BASE, mmu_base_log, "Starting PTW");
+			SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "PTW for address:", SimLog::hex(address));
 
 			auto ptw_result = page_table->initializeWalk(address, count, is_prefetch, restart_walk);
 
 			// We will filter out the re-walked addresses which anyways either hit in the PWC or are redundant
-			accessedAddresses visited_pts = ptw_result.accesses;
+			accessedAddresses &visited_pts = ptw_result.accesses;
 			std::sort(visited_pts.begin(), visited_pts.end());
 			visited_pts.erase(std::unique(visited_pts.begin(), visited_pts.end()), visited_pts.end());
 
-			ptw_result.accesses = visited_pts;
-
 			// Filter the PTW result based on the page table type
 			// This filtering is necessary to remove any redundant accesses that may hit in the PWC
 
 
-			mmu_base_log->debug("Accessed", ptw_result.accesses.size(), "addresses");
+			SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "Accessed", ptw_result.accesses.size(), "addresses");
 			if (mmu_base_log->isEnabled(SimLog::LEVEL_TRACE)) {
-				visited_pts = ptw_result.accesses;
 				for (UInt32 i = 0; i < visited_pts.size(); i++)
 				{
-					mmu_base_log->trace("Address:", SimLog::hex(visited_pts[i].physical_addr), "Level:", visited_pts[i].depth, "Table:", visited_pts[i].table_level, "Correct:", visited_pts[i].is_pte);
+					SIM_LOG_TRACE_AT(DEBUG_MMU_BASE, mmu_base_log, "Address:", SimLog::hex(visited_pts[i].physical_addr), "Level:", visited_pts[i].depth, "Table:", visited_pts[i].table_level, "Correct:", visited_pts[i].is_pte);
 				}
 			}
 
@@ -619,17 +699,22 @@ namespace ParametricDramDirectoryMSI
 			mimicos->setIsPageFault(pf_core_id, is_pagefault); //  propagate down the call stack that page fault occurred, so that we can mark the instruction to be replayed in trace_thread.cc/run()
 			mimicos->setNumRequestedFrames(pf_core_id, requested_frames); // Propagate requested frames for backward compatibility
 			
-			mmu_base_log->trace("PTW result - is_pagefault:", (is_pagefault ? "True" : "False"));
+			SIM_LOG_TRACE_AT(DEBUG_MMU_BASE, mmu_base_log, "PTW result - is_pagefault:", (is_pagefault ? "True" : "False"));
 
 			if(is_pagefault){
 
 				mimicos->setVaTriggeredPageFault(pf_core_id, address); // Store the virtual address that caused the page fault
-				mmu_base_log->debug("Page fault for address:", SimLog::hex(address));
-				mmu_base_log->debug("Requested frames:", requested_frames);
+				SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "Page fault for address:", SimLog::hex(address));
+				SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "Requested frames:", requested_frames);
 			}
 
 			SubsecondTime ptw_cycles = SubsecondTime::Zero();
 
+			// Let the page walk caches tell the entries of prefetch walks apart
+			BaseFilter *prefetch_filter = is_prefetch ? getPTWFilter() : nullptr;
+			if (prefetch_filter)
+				prefetch_filter->setPrefetchWalk(true);
+
 
 			// Page fault comes: we do not want to charge the PTW latency for the page fault
 			// BUT if we do not charge the PTW latency, we should also NOT insert entries in the PWCs
@@ -655,18 +740,73 @@ namespace ParametricDramDirectoryMSI
 				}
 				ptw_cycles = calculatePTWCycles(ptw_result, count, modeled, eip, lock, address, instruction, is_prefetch);
 			}	
+
+			if (prefetch_filter)
+				prefetch_filter->setPrefetchWalk(false);
 			
 
 			
-			mmu_base_log->debug("Finished PTW for address: ", address);
-			mmu_base_log->debug("PTW latency: ", ptw_cycles);
-			mmu_base_log->debug("Physical Page Number: ", ppn_result);
-			mmu_base_log->debug("Page Size: ", page_size);
-			mmu_base_log->debug("-------------- End of PTW");
+			SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "Finished PTW for address: ", address);
+			SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "PTW latency: ", ptw_cycles);
+			SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "Physical Page Number: ", ppn_result);
+			SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "Page Size: ", page_size);
+			SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "-------------- End of PTW");
 
 			return PTWOutcome(ptw_cycles, is_pagefault, ppn_result, page_size, requested_frames, leaf_payload_bits);
 	}
 
+	bool MemoryManagementUnitBase::translatePrefetchAddress(IntPtr eip, IntPtr address, SubsecondTime t_start, IntPtr &physical_address, SubsecondTime &t_done)
+	{
+		prefetch_translation_stats.requests++;
+
+		// Probed without a page table, so that the TLB prefetchers do not train on it
+		TLBHierarchy *tlb_hierarchy = getTLBHierarchy();
+		if (tlb_hierarchy)
+		{
+			TLBHit hit = tlb_hierarchy->lookup(address, false, t_start, false, Core::NONE, eip, true, NULL);
+			if (hit.tlb != NULL)
+			{
+				prefetch_translation_stats.tlb_hits++;
+				physical_address = hit.ppn * 4096 + (address & ((IntPtr(1) << hit.page_size) - 1));
+				t_done = t_start;
+				return true;
+			}
+		}
+
+		if (!isPrefetchWalkerFree(t_start))
+		{
+			prefetch_translation_stats.walker_busy++;
+			return false;
+		}
+
+		int app_id = core->getThread()->getAppId();
+		PageTable *page_table = Sim()->getMimicOS()->getPageTable(app_id);
+
+		// The walk is counted here only, not in the page table's walk and fault statistics. performPTW
+		// reports its outcome to MimicOS as the core's page-fault state, which must stay the demand access's
+		auto* mimicos = Sim()->getMimicOS();
+		const PageFaultState pf_state = mimicos->getPageFaultState(core->getId());
+		SubsecondTime t_caller = shmem_perf_model->getElapsedTime(ShmemPerfModel::_USER_THREAD);
+		shmem_perf_model->setElapsedTime(ShmemPerfModel::_USER_THREAD, t_start);
+		PTWOutcome outcome = performPTW(address, true, false /* count */, true /* is_prefetch */, eip, Core::NONE, page_table, false /* restart_walk */);
+		shmem_perf_model->setElapsedTime(ShmemPerfModel::_USER_THREAD, t_caller);
+		mimicos->getPageFaultState(core->getId()) = pf_state;
+
+		prefetch_translation_stats.walks++;
+		prefetch_translation_stats.walk_latency += outcome.latency;
+		t_done = t_start + outcome.latency;
+		occupyPrefetchWalker(t_start, t_done);
+
+		if (outcome.page_fault)
+		{
+			prefetch_translation_stats.faults++;
+			return false;
+		}
+
+		physical_address = outcome.ppn * 4096 + (address & ((IntPtr(1) << outcome.page_size) - 1));
+		return true;
+	}
+
 	/**
 	 * @brief Perform translation without any timing overhead
 	 * 
@@ -683,7 +823,7 @@ namespace ParametricDramDirectoryMSI
 	 */
 	std::pair<IntPtr, int> MemoryManagementUnitBase::translateWithoutTiming(IntPtr address, PageTable *page_table)
 	{
-		mmu_base_log->debug("Perfect translation (zero latency) for address:", SimLog::hex(address));
+		SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "Perfect translation (zero latency) for address:", SimLog::hex(address));
 
 		// Perform the page table walk - this handles page faults and returns PPN
 		// We use restart_walk_after_fault=true so faults are handled automatically
@@ -698,7 +838,7 @@ namespace ParametricDramDirectoryMSI
 		IntPtr page_offset = address & ((1ULL << page_size) - 1);
 		IntPtr physical_address = (ppn * base_page_size) + page_offset;
 
-		mmu_base_log->debug("Perfect translation result: PA=", SimLog::hex(physical_address), 
+		SIM_LOG_DEBUG_AT(DEBUG_MMU_BASE, mmu_base_log, "Perfect translation result: PA=", SimLog::hex(physical_address), 
 		                    " PPN=", ppn, " page_size=", page_size);
 
 		return std::make_pair(physical_address, page_size);
@@ -10,6 +10,7 @@
 #include "stats.h"
 #include "sim_log.h"
 #include "metadata_info.h"
+#include "tlb_shootdown.h"
 
 #define MMU_MAX_NUMA_NODES 8
 
@@ -90,6 +91,14 @@ namespace ParametricDramDirectoryMSI
         UInt32 m_num_numa_nodes;
         bool m_numa_enabled;
 
+        // Address space (ASID) of the application running on the core. On a switch the TLBs and
+        // PWCs either keep the entries of other address spaces (PCID-style) or are flushed.
+        UInt16 m_asid;
+        bool m_asid_flush;
+        UInt64 m_asid_switches;
+
+        int m_last_page_size;  // Page size (bits) of the last translation, set by the MMU designs
+
         bool count_page_fault_latency_enabled;
         bool perfect_translation_enabled;  // If true: translation happens (PA remapping) but with zero latency
 
@@ -100,6 +109,26 @@ namespace ParametricDramDirectoryMSI
             UInt64 memory_accesses_before_filtering;
         } stats;
 
+        // Translations of cache prefetches that cross into another page (see translatePrefetchAddress)
+        struct {
+            UInt64 requests;
+            UInt64 tlb_hits;
+            UInt64 walks;               // Prefetch-induced page table walks
+            UInt64 faults;              // Walks that found no mapping: the prefetch is dropped, no fault is raised
+            UInt64 walker_busy;         // Dropped as no page table walker was free
+            SubsecondTime walk_latency;
+        } prefetch_translation_stats;
+
+        /**
+         * @brief Walker arbitration for prefetch walks.
+         *
+         * Demand walks have priority: designs with a pool of page table walkers only hand one to
+         * a prefetch walk if it is free at t_start, and keep it busy until t_end. By default any
+         * number of prefetch walks may run.
+         */
+        virtual bool isPrefetchWalkerFree(SubsecondTime t_start) { return true; }
+        virtual void occupyPrefetchWalker(SubsecondTime t_start, SubsecondTime t_end) {}
+
     public:
         struct translationPacket
         {
@@ -131,7 +160,7 @@ namespace ParametricDramDirectoryMSI
 		void instantiatePageTableWalker();
 		void instantiateTLBSubsystem();
 		virtual void registerMMUStats() = 0;
-		accessedAddresses getAccessesForNest()
+		const accessedAddresses& getAccessesForNest() const
         {
 			return accesses_for_nest;
         }
@@ -144,11 +173,43 @@ namespace ParametricDramDirectoryMSI
 		virtual IntPtr performAddressTranslationFrontend(IntPtr eip, IntPtr address, bool instruction, Core::lock_signal_t lock, bool modeled, bool count){ return IntPtr(0); };
 		virtual IntPtr performAddressTranslationBackend(IntPtr eip, IntPtr address, bool instruction, Core::lock_signal_t lock, bool modeled, bool count){ return IntPtr(0); };
         virtual SubsecondTime accessCache(translationPacket packet, SubsecondTime t_start, bool is_prefetch, HitWhere::where_t& out_hit_where);		
-        virtual PTWResult filterPTWResult(IntPtr address, PTWResult ptw_result, PageTable *page_table, bool count) = 0;
+        virtual PTWResult filterPTWResult(IntPtr address, const PTWResult& ptw_result, PageTable *page_table, bool count) = 0;
 		virtual BaseFilter* getPTWFilter() { return nullptr; }
+		virtual TLBHierarchy* getTLBHierarchy() { return nullptr; }
+
+		/**
+		 * @brief Make asid the address space of the TLB hierarchy and the page walk caches.
+		 *
+		 * Called when the scheduler moves a thread of another application onto this core.
+		 */
+		void switchAddressSpace(UInt16 asid);
+
+		/**
+		 * @brief Apply an invalidation delivered by a TLB shootdown to the TLB hierarchy and
+		 * the page walk caches, and to those of the nested MMU.
+		 *
+		 * The host and guest page tables are not told apart: in a virtualized system both MMUs
+		 * drop the translation, as hardware drops combined translations on a host change.
+		 */
+		void invalidateTranslations(const TLBShootdown::Request &request);
 		virtual void discoverVMAs() = 0;
         
 		virtual PTWOutcome performPTW(IntPtr address, bool modeled, bool count, bool is_prefetch, IntPtr eip, Core::lock_signal_t lock, PageTable *page_table, bool restart_walk, bool instruction = false);
+
+		/**
+		 * @brief Translate the virtual address of a cache prefetch that crosses into another page.
+		 *
+		 * The TLBs are probed without training the TLB prefetchers. On a miss the page table is
+		 * walked from t_start as a low-priority, non-faulting prefetch walk (is_prefetch): it is
+		 * dropped if no page table walker is free, and a missing mapping drops the prefetch instead
+		 * of raising a page fault. The walk fills the page walk caches, the TLBs are left alone, and
+		 * it is counted in the prefetch_* statistics only. The time of the calling thread and its
+		 * page-fault state in MimicOS are not changed.
+		 *
+		 * @param t_done Set to the time at which the physical address is known
+		 * @return False if the prefetch should be dropped
+		 */
+		virtual bool translatePrefetchAddress(IntPtr eip, IntPtr address, SubsecondTime t_start, IntPtr &physical_address, SubsecondTime &t_done);
         
         /**
          * @brief Perform translation without timing overhead (for perfect_translation mode)
@@ -163,14 +224,17 @@ namespace ParametricDramDirectoryMSI
          */
         std::pair<IntPtr, int> translateWithoutTiming(IntPtr address, PageTable *page_table);
         
-        pair<SubsecondTime, SubsecondTime> calculatePFCycles(PTWResult ptw_result, bool count, bool modeled, IntPtr eip, Core::lock_signal_t lock);
-        SubsecondTime calculatePTWCycles(PTWResult ptw_result, bool count, bool modeled, IntPtr eip, Core::lock_signal_t lock, IntPtr original_va, bool instruction = false, bool is_prefetch = false);		
+        pair<SubsecondTime, SubsecondTime> calculatePFCycles(const PTWResult& ptw_result, bool count, bool modeled, IntPtr eip, Core::lock_signal_t lock);
+        SubsecondTime calculatePTWCycles(const PTWResult& ptw_result, bool count, bool modeled, IntPtr eip, Core::lock_signal_t lock, IntPtr original_va, bool instruction = false, bool is_prefetch = false);		
         Core *getCore() { return core; }
 		String getName() { return name; }
         int getDramAccessesDuringLastWalk() { return dram_accesses_during_last_walk; }
         UInt64 getLastPtwId() { return m_ptw_id_counter; }  // Get the last PTW ID for correlation
+        int getLastPageSize() const { return m_last_page_size; }
 
     protected:
+        static SInt64 hookThreadMigrate(UInt64 object, UInt64 argument);
+
         /**
          * @brief Virtual hook for logging individual PTW cache accesses
          * 
@@ -118,7 +118,7 @@ namespace ParametricDramDirectoryMSI
         
         // Initialize centralized logging
         mmu_log = new SimLog("MMU", core->getId(), DEBUG_MMU);
-        mmu_log->log("Initializing MMU for core " + std::to_string(core->getId()));
+        SIM_LOG_INFO_AT(DEBUG_MMU, mmu_log, "Initializing MMU for core " + std::to_string(core->getId()));
 
         // Initialize CSV logs for detailed per-page analysis
 #if ENABLE_MMU_CSV_LOGS
@@ -427,6 +427,7 @@ namespace ParametricDramDirectoryMSI
             
             // Use the zero-latency translation path from mmu_base
             auto [physical_address, page_size] = translateWithoutTiming(address, page_table);
+            m_last_page_size = page_size;
             
             // Update only the basic translation count (no latency stats)
             if (count) {
@@ -457,14 +458,14 @@ namespace ParametricDramDirectoryMSI
                 translation_stats.total_translation_latency += l1_dtlb_latency;
             }
             
-            mmu_log->debug("Perfect translation: VA " + mmu_log->hex(address) + 
+            SIM_LOG_DEBUG_AT(DEBUG_MMU, mmu_log, "Perfect translation: VA " + mmu_log->hex(address) + 
                           " -> PA " + mmu_log->hex(physical_address) + 
                           " (L1 dTLB latency: " + std::to_string(l1_dtlb_latency.getNS()) + "ns)");
             
             return physical_address;
         }
 
-        mmu_log->section("Starting address translation for virtual address: " + 
+        SIM_LOG_SECTION_AT(DEBUG_MMU, mmu_log, "Starting address translation for virtual address: " + 
                         mmu_log->hex(address) + " at time " + 
                         std::to_string(shmem_perf_model->getElapsedTime(ShmemPerfModel::_USER_THREAD).getNS()) + "ns");
 
@@ -509,8 +510,6 @@ namespace ParametricDramDirectoryMSI
 
         bool hit = false;                        // Did we find a cached translation?
         TLB *hit_tlb = NULL;                     // Which TLB had the hit?
-        CacheBlockInfo *tlb_block_info_hit = NULL;  // Block info from hitting TLB
-        CacheBlockInfo *tlb_block_info = NULL;      // Temporary for lookup results
         int hit_level = -1;                      // Level where hit occurred (-1 = miss)
         int page_size = -1;                      // Page size: 12 for 4KB, 21 for 2MB
         IntPtr ppn_result = 0;                   // Physical Page Number result
@@ -521,59 +520,18 @@ namespace ParametricDramDirectoryMSI
 		if (page_size_prediction_enabled)
 			predicted_page_size = tlb_subsystem->predictPagesize(address);
 
-		
-        // Iterate through TLB hierarchy levels (0 = L1, 1 = L2, ...)
-        for (UInt32 i = 0; i < tlbs.size(); i++)
+        // One pass per level: tags for every page size are computed once, all TLBs of a
+        // level are probed in parallel, and the hit level, page size and PPN come back together.
+        // @kanellok: Passing the page table to the TLB lookup function is a legacy from the old TLB implementation.
+        // It is not used in the current implementation.
+        TLBHit tlb_hit = tlb_subsystem->lookup(address, instruction, time, count, lock, eip, modeled, page_table);
+        if (tlb_hit.tlb != NULL) // TLB HIT!
         {
-            mmu_log->debug("Searching TLB at level: " + std::to_string(i));
-            
-            // Search all TLBs at this level (may have separate i/d TLBs)
-            for (UInt32 j = 0; j < tlbs[i].size(); j++)
-            {
-                // Check if this TLB handles instruction addresses
-                bool tlb_stores_instructions = (tlbs[i][j]->getType() == TLBtype::Instruction) || (tlbs[i][j]->getType() == TLBtype::Unified);
-
-                // For instruction fetches, only check iTLB or unified TLB
-                if (tlb_stores_instructions && instruction)
-                {
-                    // @kanellok: Passing the page table to the TLB lookup function is a legacy from the old TLB implementation. 
-                    // It is not used in the current implementation.
-
-                    tlb_block_info = tlbs[i][j]->lookup(address, time, count, lock, eip, modeled, count, page_table, true /* instruction */);
-
-                    if (tlb_block_info != NULL) // TLB HIT!
-                    {
-                        tlb_block_info_hit = tlb_block_info;
-                        hit_tlb = tlbs[i][j];
-                        hit_level = i;
-                        hit = true;
-                    }
-                }
-                // For data accesses, check dTLB or unified TLB
-                else if (!instruction)
-                {
-                    bool tlb_stores_data = !(tlbs[i][j]->getType() == TLBtype::Instruction);
-                    if (tlb_stores_data)
-                    {
-                        tlb_block_info = tlbs[i][j]->lookup(address, time, count, lock, eip, modeled, count, page_table, false /* data */);
-                        if (tlb_block_info != NULL)  // TLB HIT!
-                        {
-                            tlb_block_info_hit = tlb_block_info;
-                            hit_tlb = tlbs[i][j];
-                            hit_level = i;
-                            hit = true;
-                        }
-                    }
-                }
-            }
-            // Stop searching once we find a hit at any level
-            // (we search all TLBs at the same level in parallel, but levels are serial)
-            if (hit)
-            {
-                mmu_log->log("TLB Hit at level " + std::to_string(hit_level) + 
-                           " at TLB " + std::string(hit_tlb->getName().c_str()));
-                break;
-            }
+            hit = true;
+            hit_tlb = tlb_hit.tlb;
+            hit_level = tlb_hit.level;
+            SIM_LOG_INFO_AT(DEBUG_MMU, mmu_log, "TLB Hit at level " + std::to_string(hit_level) + 
+                       " at TLB " + std::string(hit_tlb->getName().c_str()));
         }
 
 
@@ -614,10 +572,10 @@ namespace ParametricDramDirectoryMSI
         if (hit)
         {
             // Extract translation data from the hitting TLB entry
-            ppn_result = tlb_block_info_hit->getPPN();
-            page_size = tlb_block_info_hit->getPageSize();
+            ppn_result = tlb_hit.ppn;
+            page_size = tlb_hit.page_size;
 
-            mmu_log->log("TLB Hit at level " + std::to_string(hit_level) + 
+            SIM_LOG_INFO_AT(DEBUG_MMU, mmu_log, "TLB Hit at level " + std::to_string(hit_level) + 
                         " at TLB " + std::string(hit_tlb->getName().c_str()));
             
             // Get the appropriate TLB path (instruction or data) for latency
@@ -637,7 +595,7 @@ namespace ParametricDramDirectoryMSI
                 {
                     tlb_latency[i] = max(tlb_path[i][j]->getLatency(), tlb_latency[i]);
                 }
-                mmu_log->debug("Charging TLB Latency: " + std::to_string(tlb_latency[i].getNS()) + 
+                SIM_LOG_DEBUG_AT(DEBUG_MMU, mmu_log, "Charging TLB Latency: " + std::to_string(tlb_latency[i].getNS()) + 
                              "ns at level " + std::to_string(i));
                 translation_stats.total_tlb_latency += tlb_latency[i];
                 translation_stats.tlb_latency_per_level[i] += tlb_latency[i];
@@ -657,7 +615,7 @@ namespace ParametricDramDirectoryMSI
 						charged_tlb_latency += hit_tlb->getLatency();
 						translation_stats.tlb_latency_per_level[hit_level] += hit_tlb->getLatency();
 					}
-                    mmu_log->debug("Charging TLB Hit Latency: " + std::to_string(hit_tlb->getLatency().getNS()) + 
+                    SIM_LOG_DEBUG_AT(DEBUG_MMU, mmu_log, "Charging TLB Hit Latency: " + std::to_string(hit_tlb->getLatency().getNS()) + 
                                  "ns at level " + std::to_string(hit_level));
                 }
 
@@ -699,7 +657,7 @@ namespace ParametricDramDirectoryMSI
             // This ensures PTW (if any) starts after TLB lookup completes
             // @kanellok: Be very careful if you want to play around with the timing model
             shmem_perf_model->setElapsedTime(ShmemPerfModel::_USER_THREAD, time + charged_tlb_latency); 
-            mmu_log->debug("New time after charging TLB latency: " + 
+            SIM_LOG_DEBUG_AT(DEBUG_MMU, mmu_log, "New time after charging TLB latency: " + 
                           std::to_string(shmem_perf_model->getElapsedTime(ShmemPerfModel::_USER_THREAD).getNS()) + "ns");
 
             // Track instruction vs data TLB hits and latency
@@ -726,7 +684,7 @@ namespace ParametricDramDirectoryMSI
         {
             SubsecondTime tlb_latency[tlbs.size()];  // VLA for TLB latencies
             
-            mmu_log->log("TLB Miss");
+            SIM_LOG_INFO_AT(DEBUG_MMU, mmu_log, "TLB Miss");
             for (UInt32 i = 0; i < tlbs.size(); i++) 
             {
                 tlb_latency[i] = SubsecondTime::Zero();
@@ -735,7 +693,7 @@ namespace ParametricDramDirectoryMSI
                 {
                     tlb_latency[i] = max(tlbs[i][j]->getLatency(), tlb_latency[i]);
                 }
-                mmu_log->debug("Charging TLB Latency: " + std::to_string(tlb_latency[i].getNS()) + 
+                SIM_LOG_DEBUG_AT(DEBUG_MMU, mmu_log, "Charging TLB Latency: " + std::to_string(tlb_latency[i].getNS()) + 
                              "ns at level " + std::to_string(i));
                 translation_stats.total_tlb_latency += tlb_latency[i];
                 charged_tlb_latency += tlb_latency[i];
@@ -743,7 +701,7 @@ namespace ParametricDramDirectoryMSI
             
             // Advance time so PTW starts after TLB miss is confirmed
             shmem_perf_model->setElapsedTime(ShmemPerfModel::_USER_THREAD, time + charged_tlb_latency);
-            mmu_log->debug("New time after charging TLB latency: " + 
+            SIM_LOG_DEBUG_AT(DEBUG_MMU, mmu_log, "New time after charging TLB latency: " + 
                           std::to_string(shmem_perf_model->getElapsedTime(ShmemPerfModel::_USER_THREAD).getNS()) + "ns");
 
             // Track instruction vs data TLB misses and latency
@@ -800,7 +758,7 @@ namespace ParametricDramDirectoryMSI
 
             // Advance time to when a walker becomes available
             shmem_perf_model->setElapsedTime(ShmemPerfModel::_USER_THREAD, time_for_pt + delay);
-            mmu_log->debug("New time after charging PTW allocation delay: " + 
+            SIM_LOG_DEBUG_AT(DEBUG_MMU, mmu_log, "New time after charging PTW allocation delay: " + 
                           std::to_string(shmem_perf_model->getElapsedTime(ShmemPerfModel::_USER_THREAD).getNS()) + "ns");
 
             // Determine page fault handling mode
@@ -845,7 +803,7 @@ namespace ParametricDramDirectoryMSI
                 if (caused_page_fault)
                 {
                     had_page_fault = true;  // Track that a fault occurred (persists after retry)
-                    mmu_log->log("Page Fault caused by address " + mmu_log->hex(address) + 
+                    SIM_LOG_INFO_AT(DEBUG_MMU, mmu_log, "Page Fault caused by address " + mmu_log->hex(address) + 
                                " at time " + std::to_string(shmem_perf_model->getElapsedTime(ShmemPerfModel::_USER_THREAD).getNS()) + "ns");
                     translation_stats.page_faults++;
                     if (instruction)
@@ -857,7 +815,7 @@ namespace ParametricDramDirectoryMSI
                     // This avoids context switch overhead for better simulation speed
                     if (!userspace_mimicos_enabled)
                     {
-                        mmu_log->log("Handling page fault in sniper-space mode, calling exception handler");
+                        SIM_LOG_INFO_AT(DEBUG_MMU, mmu_log, "Handling page fault in sniper-space mode, calling exception handler");
 
                         // Get the exception handler for this core (works with any handler type:
                         // SniperExceptionHandler, SpotExceptionHandler, UtopiaExceptionHandler, etc.)
@@ -871,7 +829,7 @@ namespace ParametricDramDirectoryMSI
                         fault_ctx.alloc_in.is_instruction = instruction;
                         handler->handle_page_fault(fault_ctx);
                         
-                        mmu_log->log("Page fault handled, restarting PTW for address " + mmu_log->hex(address));
+                        SIM_LOG_INFO_AT(DEBUG_MMU, mmu_log, "Page fault handled, restarting PTW for address " + mmu_log->hex(address));
                         // Loop will retry PTW now that page is mapped
                     }
                 }
@@ -886,9 +844,9 @@ namespace ParametricDramDirectoryMSI
             // is needed to handle the page fault.
             if(caused_page_fault && userspace_mimicos_enabled)
             {
-                mmu_log->log("Page Fault in userspace mode - address " + mmu_log->hex(address) + 
+                SIM_LOG_INFO_AT(DEBUG_MMU, mmu_log, "Page Fault in userspace mode - address " + mmu_log->hex(address) + 
                            " at time " + std::to_string(shmem_perf_model->getElapsedTime(ShmemPerfModel::_USER_THREAD).getNS()) + "ns");
-                mmu_log->log("Will trigger context switch to VirtuOS");
+                SIM_LOG_INFO_AT(DEBUG_MMU, mmu_log, "Will trigger context switch to VirtuOS");
 #if ENABLE_MMU_CSV_LOGS
                 if (count)
                 {
@@ -934,14 +892,14 @@ namespace ParametricDramDirectoryMSI
             ppn_result = ptw_result.ppn;  // Physical Page Number
             page_size = ptw_result.page_size;    // Page size (12=4KB, 21=2MB)
 
-            mmu_log->debug("New time after charging PTW completion: " + 
+            SIM_LOG_DEBUG_AT(DEBUG_MMU, mmu_log, "New time after charging PTW completion: " + 
                           std::to_string(shmem_perf_model->getElapsedTime(ShmemPerfModel::_USER_THREAD).getNS()) + "ns");
 
         }
 
 
-        mmu_log->debug("Total Walk Latency: " + std::to_string(total_walk_latency.getNS()) + "ns");
-        mmu_log->debug("Total Fault Latency: " + std::to_string(total_fault_latency.getNS()) + "ns");
+        SIM_LOG_DEBUG_AT(DEBUG_MMU, mmu_log, "Total Walk Latency: " + std::to_string(total_walk_latency.getNS()) + "ns");
+        SIM_LOG_DEBUG_AT(DEBUG_MMU, mmu_log, "Total Fault Latency: " + std::to_string(total_fault_latency.getNS()) + "ns");
 
         // ====================================================================
         // PHASE 4: TLB Allocation (populate TLBs with new translation)
@@ -996,13 +954,13 @@ namespace ParametricDramDirectoryMSI
                 {
                     TLBAllocResult result;
 
-                    mmu_log->debug("Processing evicted translations from level " + std::to_string(i - 1));
+                    SIM_LOG_DEBUG_AT(DEBUG_MMU, mmu_log, "Processing evicted translations from level " + std::to_string(i - 1));
                     
                     // Try to allocate each evicted translation
                     for (UInt32 k = 0; k < evicted_translations[i - 1].size(); k++)
                     {
                         const EvictedTranslation& evicted = evicted_translations[i - 1][k];
-                        mmu_log->detailed("Evicted Translation: " + mmu_log->hex(evicted.address));
+                        SIM_LOG_TRACE_AT(DEBUG_MMU, mmu_log, "Evicted Translation: " + mmu_log->hex(evicted.address));
                         
                         IntPtr evicted_address = evicted.address;
                         int evicted_page_size = evicted.page_size;
@@ -1011,7 +969,7 @@ namespace ParametricDramDirectoryMSI
                         // Only allocate if TLB supports this page size
                         if (alloc_tlbs[i][j]->supportsPageSize(evicted_page_size))
                         {
-                            mmu_log->detailed("Allocating evicted entry in TLB: Level=" + std::to_string(i) + 
+                            SIM_LOG_TRACE_AT(DEBUG_MMU, mmu_log, "Allocating evicted entry in TLB: Level=" + std::to_string(i) + 
                                            " Index=" + std::to_string(j));
 
                             result = alloc_tlbs[i][j]->allocate(evicted_address, time, count, lock, evicted_page_size, evicted_ppn, false /* not self_alloc */, instruction);
@@ -1042,8 +1000,8 @@ namespace ParametricDramDirectoryMSI
                 
                 if (alloc_tlbs[i][j]->supportsPageSize(page_size) && alloc_tlbs[i][j]->getAllocateOnMiss() && (!hit || hit_level > i))
                 {
-                    mmu_log->detailed(std::string(alloc_tlbs[i][j]->getName().c_str()) + " supports page size " + std::to_string(page_size));
-                    mmu_log->detailed("Allocating in TLB: Level=" + std::to_string(i) + " Index=" + std::to_string(j) + 
+                    SIM_LOG_TRACE_AT(DEBUG_MMU, mmu_log, std::string(alloc_tlbs[i][j]->getName().c_str()) + " supports page size " + std::to_string(page_size));
+                    SIM_LOG_TRACE_AT(DEBUG_MMU, mmu_log, "Allocating in TLB: Level=" + std::to_string(i) + " Index=" + std::to_string(j) + 
                                     " PageSize=" + std::to_string(page_size) + " VPN=" + mmu_log->hex(address >> page_size));
                     TLBAllocResult result;
 
@@ -1134,6 +1092,7 @@ namespace ParametricDramDirectoryMSI
         // Calculate page size in bytes using bit shift (much faster than pow())
         // page_size=12 → 4KB (1 << 12 = 4096)
         // page_size=21 → 2MB (1 << 21 = 2097152)
+        m_last_page_size = page_size;
         IntPtr page_size_in_bytes = 1ULL << page_size;
         constexpr IntPtr base_page_size_in_bytes = 1ULL << 12;  // 4KB base
 
@@ -1146,7 +1105,7 @@ namespace ParametricDramDirectoryMSI
         // PPN is stored at 4KB granularity, so multiply by base page size
         IntPtr final_physical_address = (ppn_result * base_page_size_in_bytes) + offset;
 
-        mmu_log->debug("Physical Address: " + mmu_log->hex(final_physical_address) + 
+        SIM_LOG_DEBUG_AT(DEBUG_MMU, mmu_log, "Physical Address: " + mmu_log->hex(final_physical_address) + 
                       " PPN: " + mmu_log->hex(ppn_result * base_page_size_in_bytes) + 
                       " Page Size: " + std::to_string(page_size) + " Offset: " + mmu_log->hex(offset));
         // Track instruction vs data total translation latency
@@ -1159,9 +1118,9 @@ namespace ParametricDramDirectoryMSI
                 translation_stats.total_translation_latency_data += total_latency;
         }
 
-        mmu_log->debug("Total translation latency: " + std::to_string((charged_tlb_latency + total_walk_latency).getNS()) + "ns");
-        mmu_log->debug("Total fault latency: " + std::to_string(total_fault_latency.getNS()) + "ns");
-        mmu_log->section("Ending address translation for virtual address " + mmu_log->hex(address));
+        SIM_LOG_DEBUG_AT(DEBUG_MMU, mmu_log, "Total translation latency: " + std::to_string((charged_tlb_latency + total_walk_latency).getNS()) + "ns");
+        SIM_LOG_DEBUG_AT(DEBUG_MMU, mmu_log, "Total fault latency: " + std::to_string(total_fault_latency.getNS()) + "ns");
+        SIM_LOG_SECTION_AT(DEBUG_MMU, mmu_log, "Ending address translation for virtual address " + mmu_log->hex(address));
 
         // ====================================================================
         // Sanity Checks: Verify VA-PA mapping consistency
@@ -1221,6 +1180,30 @@ namespace ParametricDramDirectoryMSI
 // Helper Methods
 // ============================================================================
 
+    /**
+     * @brief Whether a prefetch walk may start at t_start.
+     *
+     * Prefetch walks have the lowest priority: they get a page table walker only
+     * if one is idle, so that they never delay a demand walk that is already waiting.
+     */
+    bool MemoryManagementUnit::isPrefetchWalkerFree(SubsecondTime t_start)
+    {
+        pt_walkers->removeCompletedEntries(t_start);
+        return pt_walkers->canAllocate();
+    }
+
+    /**
+     * @brief Keep a page table walker busy with a prefetch walk until t_end,
+     * so that demand walks arriving meanwhile queue behind it.
+     */
+    void MemoryManagementUnit::occupyPrefetchWalker(SubsecondTime t_start, SubsecondTime t_end)
+    {
+        struct MSHREntry pt_walker_entry;
+        pt_walker_entry.request_time = t_start;
+        pt_walker_entry.completion_time = t_end;
+        pt_walkers->allocate(pt_walker_entry);
+    }
+
     /**
      * @brief Filter PTW results through the PTW filter subsystem.
      * 
@@ -1233,7 +1216,7 @@ namespace ParametricDramDirectoryMSI
      * @param count           Whether to count this in statistics
      * @return Filtered PTW result
      */
-    PTWResult MemoryManagementUnit::filterPTWResult(IntPtr virtual_address, PTWResult ptw_result, PageTable *page_table, bool count) 
+    PTWResult MemoryManagementUnit::filterPTWResult(IntPtr virtual_address, const PTWResult& ptw_result, PageTable *page_table, bool count) 
     {
         return ptw_filter->filterPTWResult(virtual_address, ptw_result, page_table, count);
     }
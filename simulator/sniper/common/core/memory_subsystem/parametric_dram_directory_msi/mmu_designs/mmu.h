@@ -166,12 +166,20 @@ namespace ParametricDramDirectoryMSI
 		void instantiateMetadataTable();
 		void instantiateTLBSubsystem();
 		void registerMMUStats();
+		TLBHierarchy *getTLBHierarchy() override { return tlb_subsystem; }
 		void discoverVMAs();
 		
 		// Translation helpers
 		BaseFilter *getPTWFilter() override { return ptw_filter; }
-		PTWResult filterPTWResult(IntPtr virtual_address, PTWResult ptw_result, PageTable *page_table, bool count);
+		PTWResult filterPTWResult(IntPtr virtual_address, const PTWResult& ptw_result, PageTable *page_table, bool count);
 		IntPtr performAddressTranslation(IntPtr eip, IntPtr virtual_address, bool instruction, Core::lock_signal_t lock, bool modeled, bool count);
+
+	protected:
+		// Prefetch walks only take a page table walker that no demand walk is waiting for
+		bool isPrefetchWalkerFree(SubsecondTime t_start) override;
+		void occupyPrefetchWalker(SubsecondTime t_start, SubsecondTime t_end) override;
+
+	public:
 		
 		// Per-page translation metrics
 		void updatePageMetrics(IntPtr virtual_address, SubsecondTime translation_latency, bool performed_ptw, SubsecondTime translation_start_time, UInt64 translation_index, SubsecondTime walk_latency, SubsecondTime tlb_hit_latency, SubsecondTime tlb_miss_latency);
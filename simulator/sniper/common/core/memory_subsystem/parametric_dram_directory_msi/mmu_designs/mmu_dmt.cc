@@ -646,6 +646,7 @@ mmu_dmt_log->debug("[MMU] Total Walk Latency: %lu", total_walk_latency.getNS());
 		// ====================================================================
 		// Physical address = PPN * base_page_size + offset
 
+		m_last_page_size = page_size;
 		IntPtr page_size_in_bytes = 1ULL << page_size;      // 2^12 = 4KB or 2^21 = 2MB
 		constexpr IntPtr base_page_size_in_bytes = 4096;    // 4KB base
 
@@ -696,7 +697,7 @@ mmu_dmt_log->debug("[MMU] Total Walk Latency: %lu", total_walk_latency.getNS());
      * @param count        Whether to count statistics
      * @return Filtered PTW result with cached entries removed
      */
-	PTWResult MemoryManagementUnitDMT::filterPTWResult(IntPtr address, PTWResult ptw_result, PageTable *page_table, bool count)
+	PTWResult MemoryManagementUnitDMT::filterPTWResult(IntPtr address, const PTWResult& ptw_result, PageTable *page_table, bool count)
 	{
 		return ptw_filter->filterPTWResult(address, ptw_result, page_table, count);
 	}
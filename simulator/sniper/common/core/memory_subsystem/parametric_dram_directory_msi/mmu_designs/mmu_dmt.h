@@ -57,9 +57,10 @@ namespace ParametricDramDirectoryMSI
 		void instantiateMetadataTable();
 		void instantiateTLBSubsystem();
 		void registerMMUStats();
+		TLBHierarchy *getTLBHierarchy() override { return tlb_subsystem; }
 		void discoverVMAs();
 
-		PTWResult filterPTWResult(IntPtr address, PTWResult ptw_result, PageTable *page_table, bool count);
+		PTWResult filterPTWResult(IntPtr address, const PTWResult& ptw_result, PageTable *page_table, bool count);
 		IntPtr performAddressTranslation(IntPtr eip, IntPtr address, bool instruction, Core::lock_signal_t lock, bool modeled, bool count);
 		PageTable* getPageTable();
 
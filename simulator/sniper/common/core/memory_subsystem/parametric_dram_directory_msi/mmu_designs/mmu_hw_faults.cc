@@ -709,6 +709,7 @@ namespace ParametricDramDirectoryMSI
 		// ====================================================================
 		// Physical address = PPN * base_page_size + offset
 
+		m_last_page_size = page_size;
 		IntPtr page_size_in_bytes = 1ULL << page_size;      // 2^12 = 4KB or 2^21 = 2MB
 		constexpr IntPtr base_page_size_in_bytes = 4096;    // 4KB base
 
@@ -744,7 +745,7 @@ namespace ParametricDramDirectoryMSI
      * @param count            Whether to count statistics
      * @return Filtered PTW result with cached entries removed
      */
-	PTWResult MemoryManagementUnitHWFault::filterPTWResult(IntPtr virtual_address, PTWResult ptw_result, PageTable *page_table, bool count) 
+	PTWResult MemoryManagementUnitHWFault::filterPTWResult(IntPtr virtual_address, const PTWResult& ptw_result, PageTable *page_table, bool count) 
 	{
 		return ptw_filter->filterPTWResult(virtual_address,ptw_result, page_table, count);
 	}
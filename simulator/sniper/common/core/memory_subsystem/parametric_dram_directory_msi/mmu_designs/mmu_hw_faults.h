@@ -127,11 +127,12 @@ namespace ParametricDramDirectoryMSI
 		void instantiateTLBSubsystem();
         void instantiateHWFaultHandler();
 		void registerMMUStats();
+		TLBHierarchy *getTLBHierarchy() override { return tlb_subsystem; }
 		void discoverVMAs();
 
 		BaseFilter *getPTWFilter() override { return ptw_filter; }
 
-		PTWResult filterPTWResult(IntPtr virtual_address, PTWResult ptw_result, PageTable *page_table, bool count);
+		PTWResult filterPTWResult(IntPtr virtual_address, const PTWResult& ptw_result, PageTable *page_table, bool count);
 		IntPtr performAddressTranslation(IntPtr eip, IntPtr virtual_address, bool instruction, Core::lock_signal_t lock, bool modeled, bool count);
 
 	};
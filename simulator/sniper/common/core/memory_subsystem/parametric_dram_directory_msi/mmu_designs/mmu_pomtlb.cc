@@ -796,6 +796,7 @@ mmu_pomtlb_log->debug("[MMU] Total Walk Latency: %lu", total_walk_latency.getNS(
 		// PPN is always at 4KB granularity
 		// Offset is extracted based on actual page size (4KB or 2MB)
 
+		m_last_page_size = page_size_result;
 		const int page_size_in_bytes = 1 << page_size_result;      // 2^page_size (optimized from pow())
 		constexpr int base_page_size_in_bytes = 1 << 12;           // 4KB base page
 
@@ -827,7 +828,7 @@ mmu_pomtlb_log->debug("[MMU] Offset: %lx", (address % page_size_in_bytes));
      * @param count       Whether to count statistics
      * @return Filtered PTW result with cached entries removed
      */
-	PTWResult MemoryManagementUnitPOMTLB::filterPTWResult(IntPtr address, PTWResult ptw_result,
+	PTWResult MemoryManagementUnitPOMTLB::filterPTWResult(IntPtr address, const PTWResult& ptw_result,
 	                                                      PageTable *page_table,
 	                                                      bool count)
 	{
@@ -690,6 +690,7 @@ namespace ParametricDramDirectoryMSI
 		// PHASE 5: Calculate Physical Address
 		// ====================================================================
 
+		m_last_page_size = page_size;
 		constexpr IntPtr base_page_size = 4096;  // 4KB base page
 		IntPtr physical_address = ppn_result * base_page_size + (address % page_size);
 
@@ -712,7 +713,7 @@ namespace ParametricDramDirectoryMSI
      * @param count       Whether to count statistics
      * @return Filtered PTW result with cached entries removed
      */
-	PTWResult RangeMMU::filterPTWResult(IntPtr address, PTWResult ptw_result,
+	PTWResult RangeMMU::filterPTWResult(IntPtr address, const PTWResult& ptw_result,
 										PageTable *page_table,
 										bool count)
 	{
@@ -820,27 +821,22 @@ namespace ParametricDramDirectoryMSI
     /**
      * @brief Find the VMA containing a virtual address.
      *
-     * Searches through the application's VMA list to find which region
-     * contains the given virtual address. Used for range tracking.
+     * Looks the address up in the application's VMA index, through this
+     * core's last-hit cache. Used for range tracking. The lookup is safe
+     * against VMA inference republishing the index from another core.
      *
      * @param address Virtual address to look up
-     * @return VMA containing the address (asserts if not found)
+     * @return Index of the VMA containing the address (asserts if not found)
      */
-	VMA RangeMMU::findVMA(IntPtr address)
+	int RangeMMU::findVMA(IntPtr address)
 	{
 		int app_id = core->getThread()->getAppId();
-		std::vector<VMA> vma_list = Sim()->getMimicOS()->getVMA(app_id);
+		IntPtr base = 0, end = 0;
+		int vma_index = Sim()->getMimicOS()->lookupVMA(app_id, address, core->getId(), &base, &end);
 
-		for (UInt32 i = 0; i < vma_list.size(); i++)
-		{
-			if (address >= vma_list[i].getBase() && address < vma_list[i].getEnd())
-			{
-				mmu_range_log->debug("VMA found for address: %lx in VMA: %lx - %lx", address, vma_list[i].getBase(), vma_list[i].getEnd());
-				return vma_list[i];
-			}
-		}
-		assert(false);  // Address must belong to some VMA
-		return VMA(-1, -1);
+		assert(vma_index >= 0);  // Address must belong to some VMA
+		mmu_range_log->debug("VMA found for address: %lx in VMA: %lx - %lx", address, base, end);
+		return vma_index;
 	}
 
 } // namespace ParametricDramDirectoryMSI
@@ -73,11 +73,12 @@ namespace ParametricDramDirectoryMSI
         void instantiateRangeTableWalker();
 		void instantiateTLBSubsystem();
 		void registerMMUStats();
+		TLBHierarchy *getTLBHierarchy() override { return tlb_subsystem; }
 
 		IntPtr performAddressTranslation(IntPtr eip, IntPtr address, bool instruction, Core::lock_signal_t lock, bool modeled, bool count);
 		void discoverVMAs();
-		PTWResult filterPTWResult(IntPtr address, PTWResult ptw_result, PageTable *page_table, bool count);
+		PTWResult filterPTWResult(IntPtr address, const PTWResult& ptw_result, PageTable *page_table, bool count);
 		std::tuple<SubsecondTime, IntPtr, int> performRangeWalk(IntPtr address, IntPtr eip, Core::lock_signal_t lock, bool modeled, bool count);
-		VMA findVMA(IntPtr address);
+		int findVMA(IntPtr address);
 	};
 } // namespace ParametricDramDirectoryMSI
\ No newline at end of file
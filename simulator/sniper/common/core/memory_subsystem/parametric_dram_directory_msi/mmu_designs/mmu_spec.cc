@@ -713,6 +713,7 @@ namespace ParametricDramDirectoryMSI
         // PPN is always at 4KB granularity
         // Offset is extracted based on actual page size (4KB or 2MB)
         
+        m_last_page_size = page_size;
         const int page_size_in_bytes = 1 << page_size;           // 2^page_size (optimized from pow())
         constexpr int base_page_size_in_bytes = 1 << 12;         // 4KB base page
 
@@ -744,7 +745,7 @@ namespace ParametricDramDirectoryMSI
      * @param count       Whether to count statistics
      * @return Filtered PTW result with cached entries removed
      */
-    PTWResult MemoryManagementUnitSpec::filterPTWResult(IntPtr address, PTWResult ptw_result, PageTable *page_table, bool count)
+    PTWResult MemoryManagementUnitSpec::filterPTWResult(IntPtr address, const PTWResult& ptw_result, PageTable *page_table, bool count)
     {
         return ptw_filter->filterPTWResult(address, ptw_result, page_table, count);
     }
@@ -813,8 +814,8 @@ namespace ParametricDramDirectoryMSI
         // Initialize page table walk and get visited entries
         auto ptw_result = page_table->initializeWalk(address, count, is_prefetch, restart_walk);
         
-        // Get list of page table entries visited during walk
-        accessedAddresses visited_pts = ptw_result.accesses;
+        // Get list of page table entries visited during walk (deduplicated in place)
+        accessedAddresses &visited_pts = ptw_result.accesses;
 
         // Remove duplicate entries (same PT entry may be visited multiple times)
         std::sort(visited_pts.begin(), visited_pts.end());
@@ -836,9 +837,6 @@ namespace ParametricDramDirectoryMSI
         if (page_table->getType() == "radix" && !ptw_result.fault_happened)
             spec_engine->invokeSpecEngine(address, count, lock, eip, modeled, time_for_pt, physical_result_last_level, true);
 
-        // Rebuild result with deduplicated visited entries (preserve requested_frames)
-        ptw_result = PTWResult(ptw_result.page_size, visited_pts, ptw_result.ppn, ptw_result.pwc_latency, ptw_result.fault_happened, ptw_result.requested_frames);
-
         assert(ptw_result.ppn != static_cast<IntPtr>(-1)); // Ensure PPN is valid
 
         // Save requested_frames BEFORE filterPTWResult (filter doesn't preserve it)
@@ -848,7 +846,6 @@ namespace ParametricDramDirectoryMSI
         ptw_result = filterPTWResult(address, ptw_result, page_table, count);
 
         mmu_spec_log->debug("[MMU_BASE] We accessed ", ptw_result.accesses.size(), " addresses");
-        visited_pts = ptw_result.accesses;
         for (UInt32 i = 0; i < visited_pts.size(); i++)
         {
             mmu_spec_log->debug("[MMU_BASE] Address: ", visited_pts[i].physical_addr, " Level: ", visited_pts[i].depth, " Table: ", visited_pts[i].table_level, " Correct Translation: ", visited_pts[i].is_pte);
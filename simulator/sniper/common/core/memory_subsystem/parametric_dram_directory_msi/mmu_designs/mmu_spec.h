@@ -75,12 +75,13 @@ namespace ParametricDramDirectoryMSI
 
         // Register MMU-related performance statistics.
         void registerMMUStats();
+        TLBHierarchy *getTLBHierarchy() override { return tlb_subsystem; }
 
         // Discover Virtual Memory Areas (VMAs) for address translation.
         void discoverVMAs();
 
         // Filters the result of a page table walk based on given parameters.
-        PTWResult filterPTWResult(IntPtr virtual_address, PTWResult ptw_result, PageTable *page_table, bool count);
+        PTWResult filterPTWResult(IntPtr virtual_address, const PTWResult& ptw_result, PageTable *page_table, bool count);
 
         // Performs address translation for a given instruction or data address.
         IntPtr performAddressTranslation(IntPtr eip, IntPtr address, bool instruction, Core::lock_signal_t lock, bool modeled, bool count);
@@ -1534,6 +1534,7 @@ namespace ParametricDramDirectoryMSI
 		// Calculate Physical Address
 		// ====================================================================
 		constexpr IntPtr base_page_size_in_bytes = 1ULL << 12;  // 4KB
+		m_last_page_size = page_size;
 		IntPtr page_size_in_bytes = 1ULL << page_size;
 		IntPtr offset = address & (page_size_in_bytes - 1);
 		IntPtr final_physical_address = (ppn_result * base_page_size_in_bytes) + offset;
@@ -2860,7 +2861,7 @@ namespace ParametricDramDirectoryMSI
 // PTW Filter
 // ============================================================================
 
-	PTWResult MemoryManagementUnitUtopia::filterPTWResult(IntPtr virtual_address, PTWResult ptw_result, PageTable *page_table, bool count)
+	PTWResult MemoryManagementUnitUtopia::filterPTWResult(IntPtr virtual_address, const PTWResult& ptw_result, PageTable *page_table, bool count)
 	{
 		return ptw_filter->filterPTWResult(virtual_address, ptw_result, page_table, count);
 	}
@@ -418,6 +418,7 @@ namespace ParametricDramDirectoryMSI
 		void instantiateRestSegWalker();
 		void instantiateUTLB();  ///< Initialize the compact UTLB for RestSeg
 		void registerMMUStats();
+		TLBHierarchy *getTLBHierarchy() override { return tlb_subsystem; }
 		IntPtr performAddressTranslation(IntPtr eip, IntPtr address, bool instruction, Core::lock_signal_t lock, bool modeled, bool count);
 		
 		// RestSeg Walk methods
@@ -452,7 +453,7 @@ namespace ParametricDramDirectoryMSI
 		SubsecondTime chargeRSWLatency(const RSWLookupResult& lookup_result, bool instruction, 
 		                               IntPtr eip, Core::lock_signal_t lock, bool modeled, bool count);
 		
-        PTWResult filterPTWResult(IntPtr virtual_address, PTWResult ptw_result, PageTable *page_table, bool count);
+        PTWResult filterPTWResult(IntPtr virtual_address, const PTWResult& ptw_result, PageTable *page_table, bool count);
 
 		/**
 		 * @brief Perform TLB shootdown for a migrated page
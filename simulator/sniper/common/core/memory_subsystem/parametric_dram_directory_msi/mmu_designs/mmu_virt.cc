@@ -640,6 +640,7 @@ namespace ParametricDramDirectoryMSI
 		SubsecondTime total_translation_latency = charged_tlb_latency + total_walk_latency;
 		translation_stats.total_translation_latency += total_translation_latency;
 
+		m_last_page_size = page_size;
 		int page_size_in_bytes = 1 << page_size;         // Convert page size bits to bytes
 		int base_page_size_in_bytes = 1 << 12;           // 4KB base page
 
@@ -762,7 +763,7 @@ namespace ParametricDramDirectoryMSI
      *
      * @return Empty PTWResult (placeholder for interface compatibility)
      */
-	PTWResult MemoryManagementUnitVirt::filterPTWResult(IntPtr address, PTWResult ptw_result, PageTable *page_table, bool count)
+	PTWResult MemoryManagementUnitVirt::filterPTWResult(IntPtr address, const PTWResult& ptw_result, PageTable *page_table, bool count)
 	{
 		return PTWResult();
 	}
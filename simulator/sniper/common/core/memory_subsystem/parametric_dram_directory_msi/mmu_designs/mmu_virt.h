@@ -45,8 +45,9 @@ namespace ParametricDramDirectoryMSI
 		void instantiatePageTableWalker();
 		void instantiateTLBSubsystem();
 		void registerMMUStats();
+		TLBHierarchy *getTLBHierarchy() override { return tlb_subsystem; }
 		void discoverVMAs();
-		PTWResult filterPTWResult(IntPtr virtual_address, PTWResult ptw_result, PageTable *page_table, bool count);
+		PTWResult filterPTWResult(IntPtr virtual_address, const PTWResult& ptw_result, PageTable *page_table, bool count);
 
         SubsecondTime accessCache(translationPacket packet, SubsecondTime t_start, bool is_prefetch, HitWhere::where_t &hit_where) override;
 		IntPtr performAddressTranslation(IntPtr eip, IntPtr address, bool instruction, Core::lock_signal_t lock, bool modeled, bool count);
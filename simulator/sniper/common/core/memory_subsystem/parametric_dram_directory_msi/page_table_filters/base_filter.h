@@ -11,7 +11,7 @@ namespace ParametricDramDirectoryMSI
         public:
 
             // Returns true if the filter accepts the given address
-            virtual PTWResult filterPTWResult(IntPtr virtual_address, PTWResult ptw_result, PageTable *page_table, bool count) = 0;
+            virtual PTWResult filterPTWResult(IntPtr virtual_address, const PTWResult& ptw_result, PageTable *page_table, bool count) = 0;
 
             /**
              * @brief Look up a single address in the page walk cache (PWC)
@@ -29,6 +29,33 @@ namespace ParametricDramDirectoryMSI
                 return false;  // Default: no caching
             }
 
+            /**
+             * @brief Mark the walks filtered until the next call as prefetch walks
+             * @param prefetch True while a prefetch walk is filtered
+             *
+             * Lets the page walk caches count what prefetch walks fill into them.
+             */
+            virtual void setPrefetchWalk(bool prefetch) {
+                (void)prefetch;
+            }
+
+            /**
+             * @brief Switch the caches of the filter to another address space
+             * @param asid Address space identifier of the application now running
+             * @param flush Invalidate all entries first (no PCIDs)
+             */
+            virtual void switchAddressSpace(UInt16 asid, bool flush) {
+                (void)asid; (void)flush;
+            }
+
+            /**
+             * @brief Invalidate the cached walks of an address space (TLB shootdown)
+             * @param asid Address space identifier
+             */
+            virtual void flushAddressSpace(UInt16 asid) {
+                (void)asid;
+            }
+
             BaseFilter(String _name, Core* _core):
                 name(_name), core(_core) {}
             
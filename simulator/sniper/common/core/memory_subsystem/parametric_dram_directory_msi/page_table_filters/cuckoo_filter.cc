@@ -55,7 +55,7 @@ namespace ParametricDramDirectoryMSI
     }
 
 
-    PTWResult CuckooFilter::filterPTWResult(IntPtr virtual_address, PTWResult ptw_result, PageTable *page_table, bool count) 
+    PTWResult CuckooFilter::filterPTWResult(IntPtr virtual_address, const PTWResult& ptw_result, PageTable *page_table, bool count) 
     {
 
         CWCRow cwc_row;
@@ -69,7 +69,7 @@ namespace ParametricDramDirectoryMSI
 #endif
         
         bool hit_cwc = cwc->lookup(tag, cwc_row);
-        accessedAddresses original_ptw_accesses = ptw_result.accesses;
+        const accessedAddresses& original_ptw_accesses = ptw_result.accesses;
         accessedAddresses filtered_ptw_accesses;
 
         // Get the pointer to the page table 
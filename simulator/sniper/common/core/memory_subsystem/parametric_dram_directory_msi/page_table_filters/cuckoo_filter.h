@@ -15,7 +15,7 @@ namespace ParametricDramDirectoryMSI
             CuckooFilter(String name, Core* core); 
             ~CuckooFilter();
 
-            PTWResult filterPTWResult(IntPtr virtual_address, PTWResult ptw_result, PageTable *page_table, bool count);
+            PTWResult filterPTWResult(IntPtr virtual_address, const PTWResult& ptw_result, PageTable *page_table, bool count);
 
         private:
             CWCache *cwc;
@@ -24,7 +24,7 @@ namespace ParametricDramDirectoryMSI
     }
 
 
-    PTWResult DefaultFilter::filterPTWResult(IntPtr virtual_address, PTWResult ptw_result, PageTable *page_table, bool count) 
+    PTWResult DefaultFilter::filterPTWResult(IntPtr virtual_address, const PTWResult& ptw_result, PageTable *page_table, bool count) 
     {
         return ptw_result;
     }
@@ -14,7 +14,7 @@ namespace ParametricDramDirectoryMSI
             DefaultFilter(String name, Core* core); 
             ~DefaultFilter();
 
-            PTWResult filterPTWResult(IntPtr virtual_address, PTWResult ptw_result, PageTable *page_table, bool count);
+            PTWResult filterPTWResult(IntPtr virtual_address, const PTWResult& ptw_result, PageTable *page_table, bool count);
 
 
     };
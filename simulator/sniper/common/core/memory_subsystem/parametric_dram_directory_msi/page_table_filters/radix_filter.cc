@@ -44,13 +44,13 @@ namespace ParametricDramDirectoryMSI
     }
 
 
-    PTWResult RadixFilter::filterPTWResult(IntPtr virtual_address, PTWResult ptw_result, PageTable *page_table, bool count) 
+    PTWResult RadixFilter::filterPTWResult(IntPtr virtual_address, const PTWResult& ptw_result, PageTable *page_table, bool count) 
     {
         accessedAddresses ptw_accesses;
 
         if (m_pwc_enabled)
         {
-            accessedAddresses original_ptw_accesses = ptw_result.accesses;
+            const accessedAddresses& original_ptw_accesses = ptw_result.accesses;
             // We need to filter based on the page walk caches
             for (UInt32 i = 0; i < ptw_result.accesses.size(); i++)
             {
@@ -105,4 +105,25 @@ namespace ParametricDramDirectoryMSI
         // Perform PWC lookup - allocates on miss automatically
         return pwc->lookup(address, now, true /* allocate_on_miss */, level, count);
     }
+
+    void RadixFilter::setPrefetchWalk(bool prefetch)
+    {
+        if (m_pwc_enabled && pwc)
+            pwc->setPrefetching(prefetch);
+    }
+
+    void RadixFilter::switchAddressSpace(UInt16 asid, bool flush)
+    {
+        if (!m_pwc_enabled || !pwc)
+            return;
+        if (flush)
+            pwc->flush();
+        pwc->setASID(asid);
+    }
+
+    void RadixFilter::flushAddressSpace(UInt16 asid)
+    {
+        if (m_pwc_enabled && pwc)
+            pwc->flushASID(asid);
+    }
 }
@@ -11,7 +11,7 @@ namespace ParametricDramDirectoryMSI
             RadixFilter(String _name, Core* _core);
             ~RadixFilter();
 
-            PTWResult filterPTWResult(IntPtr virtual_address, PTWResult ptw_result, PageTable *page_table, bool count);
+            PTWResult filterPTWResult(IntPtr virtual_address, const PTWResult& ptw_result, PageTable *page_table, bool count);
 
             /**
              * @brief Look up a single address in the page walk cache (PWC)
@@ -23,6 +23,10 @@ namespace ParametricDramDirectoryMSI
              */
             bool lookupPWC(IntPtr address, SubsecondTime now, int level, bool count) override;
 
+            void setPrefetchWalk(bool prefetch) override;
+            void switchAddressSpace(UInt16 asid, bool flush) override;
+            void flushAddressSpace(UInt16 asid) override;
+
             void setPWC(PWC *_pwc) {
                 pwc = _pwc;
                 m_pwc_enabled = true;
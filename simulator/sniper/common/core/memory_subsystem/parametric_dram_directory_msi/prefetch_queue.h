@@ -0,0 +1,72 @@
+#ifndef PREFETCH_QUEUE_H
+#define PREFETCH_QUEUE_H
+
+#include "fixed_types.h"
+#include "log.h"
+
+#include <vector>
+
+/**
+ * @brief Addresses a cache is about to prefetch, oldest first.
+ *
+ * A ring buffer whose storage is allocated once, for at most capacity addresses, so that
+ * queueing and issuing prefetches allocates nothing. Prefetches into another page are queued
+ * by virtual address, and translated when they are issued.
+ */
+class PrefetchQueue
+{
+   public:
+      struct Entry
+      {
+         IntPtr address;
+         bool is_virtual;
+      };
+
+      explicit PrefetchQueue(UInt32 capacity = 0)
+         : m_entries(capacity)
+         , m_head(0)
+         , m_size(0)
+      {}
+
+      bool empty() const { return m_size == 0; }
+      bool full() const { return m_size == m_entries.size(); }
+      UInt32 size() const { return m_size; }
+
+      // Queue address, unless the queue is full
+      bool push(IntPtr address, bool is_virtual = false)
+      {
+         if (full())
+            return false;
+         Entry &entry = m_entries[(m_head + m_size) % m_entries.size()];
+         entry.address = address;
+         entry.is_virtual = is_virtual;
+         m_size++;
+         return true;
+      }
+
+      const Entry &front() const
+      {
+         LOG_ASSERT_ERROR(m_size, "Prefetch queue is empty");
+         return m_entries[m_head];
+      }
+
+      void pop()
+      {
+         LOG_ASSERT_ERROR(m_size, "Prefetch queue is empty");
+         m_head = (m_head + 1) % m_entries.size();
+         m_size--;
+      }
+
+      void clear()
+      {
+         m_head = 0;
+         m_size = 0;
+      }
+
+   private:
+      std::vector<Entry> m_entries;
+      UInt32 m_head;
+      UInt32 m_size;
+};
+
+#endif // PREFETCH_QUEUE_H
@@ -11,7 +11,9 @@ class Prefetcher
    public:
       static Prefetcher* createPrefetcher(String type, String configName, core_id_t core_id, UInt32 shared_cores);
 
-      virtual std::vector<IntPtr> getNextAddress(IntPtr current_address, core_id_t core_id,Core::mem_op_t mem_op_type, bool cache_hit, bool prefetch_hit, IntPtr eip) = 0;
+      // Append the addresses to prefetch after an access to current_address to prefetches. Callers pass
+      // it in empty and reuse it across calls, so that training a prefetcher allocates nothing.
+      virtual void getNextAddress(IntPtr current_address, core_id_t core_id,Core::mem_op_t mem_op_type, bool cache_hit, bool prefetch_hit, IntPtr eip, std::vector<IntPtr> &prefetches) = 0;
 };
 
 #endif // PREFETCHER_H
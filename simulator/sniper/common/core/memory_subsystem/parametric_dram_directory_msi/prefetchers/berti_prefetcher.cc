@@ -40,15 +40,14 @@ BertiPrefetcher::~BertiPrefetcher() {}
 // Main Prefetch Interface
 // =============================================================================
 
-std::vector<IntPtr> BertiPrefetcher::getNextAddress(IntPtr current_address, core_id_t core_id,
-                                                     Core::mem_op_t mem_op_type, bool cache_hit,
-                                                     bool prefetch_hit, IntPtr eip)
+void BertiPrefetcher::getNextAddress(IntPtr current_address, core_id_t core_id,
+                                     Core::mem_op_t mem_op_type, bool cache_hit,
+                                     bool prefetch_hit, IntPtr eip,
+                                     std::vector<IntPtr>& pref_addr)
 {
-    std::vector<IntPtr> pref_addr;
-    
     // Only prefetch on read operations
     if (mem_op_type == Core::WRITE) {
-        return pref_addr;
+        return;
     }
 
     stats.pref_called++;
@@ -69,7 +68,7 @@ std::vector<IntPtr> BertiPrefetcher::getNextAddress(IntPtr current_address, core
             stats.current_pages_hits++;
 
             if (requested_offset_current_pages(index, offset)) {
-                return pref_addr;
+                return;
             }
 
             uint64_t first_ip = update_demand_current_pages(index, offset);
@@ -196,8 +195,6 @@ std::vector<IntPtr> BertiPrefetcher::getNextAddress(IntPtr current_address, core
             }
         }
     }
-
-    return pref_addr;
 }
 
 // =============================================================================
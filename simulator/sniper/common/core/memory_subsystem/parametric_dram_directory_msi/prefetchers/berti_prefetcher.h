@@ -26,9 +26,10 @@ public:
     BertiPrefetcher(String configName, core_id_t core_id);
     ~BertiPrefetcher();
 
-    std::vector<IntPtr> getNextAddress(IntPtr current_address, core_id_t core_id,
-                                        Core::mem_op_t mem_op_type, bool cache_hit,
-                                        bool prefetch_hit, IntPtr eip) override;
+    void getNextAddress(IntPtr current_address, core_id_t core_id,
+                        Core::mem_op_t mem_op_type, bool cache_hit,
+                        bool prefetch_hit, IntPtr eip,
+                        std::vector<IntPtr>& pref_addr) override;
 
 private:
     core_id_t m_core_id;
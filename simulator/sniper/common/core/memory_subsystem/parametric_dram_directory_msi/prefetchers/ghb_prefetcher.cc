@@ -16,22 +16,67 @@ GhbPrefetcher::GhbPrefetcher(String configName, core_id_t core_id)
    , m_tableHead(0)
    , m_ghbTable(m_tableSize)
 {
+   UInt32 slots = 16;
+   while (slots < 2 * m_tableSize)
+      slots <<= 1;
+   m_deltaIndex.resize(slots, 0);
+   m_deltaIndexMask = slots - 1;
 }
 
 GhbPrefetcher::~GhbPrefetcher()
 {
 }
 
-std::vector<IntPtr>
-GhbPrefetcher::getNextAddress(IntPtr currentAddress, core_id_t core_id,Core::mem_op_t mem_op_type, bool cache_hit, bool prefetch_hit, IntPtr eip)
+UInt32
+GhbPrefetcher::findDelta(SInt64 delta) const
 {
-   std::vector<IntPtr> prefetchList;
+   for (UInt32 slot = deltaHome(delta); m_deltaIndex[slot]; slot = (slot + 1) & m_deltaIndexMask)
+   {
+      if (m_ghbTable[m_deltaIndex[slot] - 1].delta == delta)
+         return m_deltaIndex[slot] - 1;
+   }
+   return m_tableSize;
+}
+
+void
+GhbPrefetcher::insertDelta(UInt32 position)
+{
+   UInt32 slot = deltaHome(m_ghbTable[position].delta);
+   while (m_deltaIndex[slot])
+      slot = (slot + 1) & m_deltaIndexMask;
+   m_deltaIndex[slot] = position + 1;
+}
+
+void
+GhbPrefetcher::eraseDelta(SInt64 delta)
+{
+   UInt32 hole = deltaHome(delta);
+   while (m_ghbTable[m_deltaIndex[hole] - 1].delta != delta)
+      hole = (hole + 1) & m_deltaIndexMask;
+   m_deltaIndex[hole] = 0;
+
+   //move later slots of the probe sequence back into the hole, so lookups need no tombstones
+   for (UInt32 next = (hole + 1) & m_deltaIndexMask; m_deltaIndex[next]; next = (next + 1) & m_deltaIndexMask)
+   {
+      //a slot may fill the hole if its home does not lie cyclically in (hole, next]
+      UInt32 home = deltaHome(m_ghbTable[m_deltaIndex[next] - 1].delta);
+      if (((next - home) & m_deltaIndexMask) >= ((next - hole) & m_deltaIndexMask))
+      {
+         m_deltaIndex[hole] = m_deltaIndex[next];
+         m_deltaIndex[next] = 0;
+         hole = next;
+      }
+   }
+}
 
+void
+GhbPrefetcher::getNextAddress(IntPtr currentAddress, core_id_t core_id,Core::mem_op_t mem_op_type, bool cache_hit, bool prefetch_hit, IntPtr eip, std::vector<IntPtr> &prefetchList)
+{
    //deal with prefether initialization
    if (m_lastAddress == INVALID_ADDRESS)
    {
       m_lastAddress = currentAddress;
-      return prefetchList;
+      return;
    }
 
    //determine the delta with the last address
@@ -39,14 +84,9 @@ GhbPrefetcher::getNextAddress(IntPtr currentAddress, core_id_t core_id,Core::mem
    m_lastAddress = currentAddress;
 
    //look for the current delta in the table
-   UInt32 i = 0;
-   while (i < m_tableSize &&
-          m_ghbTable[i].delta != INVALID_DELTA &&
-          m_ghbTable[i].delta != delta)
-      ++i;
+   UInt32 i = findDelta(delta);
 
    if (i != m_tableSize &&
-       m_ghbTable[i].delta == delta &&
        m_ghbTable[i].generation == m_ghb[m_ghbTable[i].ghbIndex].generation) //check if the table still points to the current GHB 'generation'
    {
       UInt32 width = 0;
@@ -93,14 +133,9 @@ GhbPrefetcher::getNextAddress(IntPtr currentAddress, core_id_t core_id,Core::mem
 
    if (prevDelta != INVALID_DELTA)
    {
-      i = 0;
-      while (i < m_tableSize &&
-             m_ghbTable[i].delta != INVALID_DELTA &&
-             m_ghbTable[i].delta != prevDelta)
-         ++i;
-
-      if (i != m_tableSize &&
-          m_ghbTable[i].delta == prevDelta)
+      i = findDelta(prevDelta);
+
+      if (i != m_tableSize)
       { //update existing entry
 
          //if the current table entry refers to a live ghb entry,
@@ -117,9 +152,13 @@ GhbPrefetcher::getNextAddress(IntPtr currentAddress, core_id_t core_id,Core::mem
       }
       else
       { //prevDelta not found ==> add entry to table
+         if (m_ghbTable[m_tableHead].delta != INVALID_DELTA)
+            eraseDelta(m_ghbTable[m_tableHead].delta);
+
          m_ghbTable[m_tableHead].delta = prevDelta;
          m_ghbTable[m_tableHead].ghbIndex = m_ghbHead;
          m_ghbTable[m_tableHead].generation = m_generation;
+         insertDelta(m_tableHead);
 
          m_tableHead = (m_tableHead + 1) % m_tableSize;
       }
@@ -132,6 +171,4 @@ GhbPrefetcher::getNextAddress(IntPtr currentAddress, core_id_t core_id,Core::mem
       m_ghbHead = 0;
       m_generation = (m_generation + 1) % 4;
    }
-
-   return prefetchList;
 }
@@ -7,7 +7,7 @@ class GhbPrefetcher : public Prefetcher
 {
    public:
       GhbPrefetcher(String configName, core_id_t core_id);
-      std::vector<IntPtr> getNextAddress(IntPtr currentAddress, core_id_t core_id,Core::mem_op_t mem_op_type, bool cache_hit, bool prefetch_hit, IntPtr eip);
+      void getNextAddress(IntPtr currentAddress, core_id_t core_id,Core::mem_op_t mem_op_type, bool cache_hit, bool prefetch_hit, IntPtr eip, std::vector<IntPtr> &prefetchList);
 
       ~GhbPrefetcher();
 
@@ -45,6 +45,17 @@ class GhbPrefetcher : public Prefetcher
       UInt32 m_tableSize;
       UInt32 m_tableHead; //next table position to be overwritten (in lack of a better replacement policy at the moment)
       std::vector<TableEntry> m_ghbTable;
+
+      //table position of each delta in m_ghbTable (where deltas are unique), so that lookups need
+      //no table scan: open addressing with linear probing, over at least twice as many slots as
+      //table entries; a slot holds the table position + 1, or 0 when free
+      std::vector<UInt32> m_deltaIndex;
+      UInt32 m_deltaIndexMask;
+
+      UInt32 deltaHome(SInt64 delta) const { return (UInt64(delta) * 0x9e3779b97f4a7c15ULL) >> 32 & m_deltaIndexMask; }
+      UInt32 findDelta(SInt64 delta) const; //table position, or m_tableSize if absent
+      void insertDelta(UInt32 position);
+      void eraseDelta(SInt64 delta);
 };
 
 #endif // __GHB_PREFETCHER_H
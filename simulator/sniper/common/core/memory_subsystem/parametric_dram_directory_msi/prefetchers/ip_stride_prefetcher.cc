@@ -42,8 +42,8 @@ IPStridePrefetcher::~IPStridePrefetcher()
 }
 
 
-std::vector<IntPtr>
-IPStridePrefetcher::getNextAddress(IntPtr current_address, core_id_t _core_id, Core::mem_op_t mem_op_type, bool cache_hit, bool prefetch_hit, IntPtr eip)
+void
+IPStridePrefetcher::getNextAddress(IntPtr current_address, core_id_t _core_id, Core::mem_op_t mem_op_type, bool cache_hit, bool prefetch_hit, IntPtr eip, std::vector<IntPtr> &pref_addr)
 {
 	IntPtr current_page = current_address >> LOG2_PAGE_SIZE;
 	IntPtr current_offset = (current_address >> LOG2_CACHE_BLOCK_SIZE) & CACHE_BLOCK_MASK;
@@ -51,11 +51,9 @@ IPStridePrefetcher::getNextAddress(IntPtr current_address, core_id_t _core_id, C
 	// 			<< " current_address: " << std::hex << current_address << std::dec
 	// 			<< " current_page: " << std::hex << current_page << std::dec
 	// 			<< " current_offset: " << current_offset << std::endl;
-	std::vector<IntPtr> pref_addr;
-
 	if(mem_op_type == Core::WRITE)
 	{
-		return pref_addr;
+		return;
 	}
 
 	stats.pref_called++;
@@ -106,7 +104,7 @@ IPStridePrefetcher::getNextAddress(IntPtr current_address, core_id_t _core_id, C
 			if(rpt_entry->state == STEADY)
 			{
 				stats.steady++;
-				pref_addr = generatePrefetchAddress(rpt_entry, current_page, current_offset);
+				generatePrefetchAddress(rpt_entry, current_page, current_offset, pref_addr);
 			}
 		}
 	}
@@ -125,8 +123,6 @@ IPStridePrefetcher::getNextAddress(IntPtr current_address, core_id_t _core_id, C
 			update_age(index);
 		}
 	}
-
-	return pref_addr;
 }
 
 int32_t IPStridePrefetcher::find(IntPtr eip)
@@ -178,12 +174,11 @@ int32_t IPStridePrefetcher::find_replacement()
 	return replacement_index;
 }
 
-std::vector<IntPtr> IPStridePrefetcher::generatePrefetchAddress(RPTEntry *rpt_entry, IntPtr current_page, IntPtr current_offset)
+void IPStridePrefetcher::generatePrefetchAddress(RPTEntry *rpt_entry, IntPtr current_page, IntPtr current_offset, std::vector<IntPtr> &addresses)
 {
 	// std::cout << "curr_addr: " << std::hex << ((current_page << LOG2_PAGE_SIZE) + (current_offset << LOG2_CACHE_BLOCK_SIZE)) << std::dec 
 	// 			<< " stride: " << rpt_entry->stride
 	// 			<< " pref_addr:";
-	std::vector<IntPtr> addresses;
 	for(unsigned int index = 1; index <= m_num_prefetches; ++index)
 	{
 		int32_t prefetch_offset = current_offset + (m_lookahead + index ) * rpt_entry->stride;
@@ -197,5 +192,4 @@ std::vector<IntPtr> IPStridePrefetcher::generatePrefetchAddress(RPTEntry *rpt_en
 		}
 	}
 	// std::cout << std::endl;
-	return addresses;
 }
\ No newline at end of file
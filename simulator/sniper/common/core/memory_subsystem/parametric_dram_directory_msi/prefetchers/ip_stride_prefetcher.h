@@ -60,8 +60,8 @@ public:
 	int32_t find(IntPtr eip);
 	void update_age(int32_t current);
 	int32_t find_replacement();
-	std::vector<IntPtr> generatePrefetchAddress(RPTEntry *rpt_entry, IntPtr current_page, IntPtr current_offset);
-	std::vector<IntPtr> getNextAddress(IntPtr current_address, core_id_t core_id, Core::mem_op_t mem_op_type, bool cache_hit, bool prefetch_hit, IntPtr eip);
+	void generatePrefetchAddress(RPTEntry *rpt_entry, IntPtr current_page, IntPtr current_offset, std::vector<IntPtr> &addresses);
+	void getNextAddress(IntPtr current_address, core_id_t core_id, Core::mem_op_t mem_op_type, bool cache_hit, bool prefetch_hit, IntPtr eip, std::vector<IntPtr> &pref_addr);
 };
 
 #endif /* IP_STRIDE_PREFETCHER */
@@ -21,6 +21,7 @@ IPCPPrefetcher::IPCPPrefetcher(String configName, core_id_t core_id)
     : m_core_id(core_id)
     , m_prefetch_degree(3)
     , m_spec_nl_threshold(15)
+    , m_cross_page(Sim()->getCfg()->getBoolDefault("perf_model/" + configName + "/prefetcher/cross_page", false))
     , num_misses(0)
     , prev_cycle(0)
     , mpkc(0.0f)
@@ -44,15 +45,14 @@ IPCPPrefetcher::~IPCPPrefetcher() {}
 // Main Prefetch Interface
 // =============================================================================
 
-std::vector<IntPtr> IPCPPrefetcher::getNextAddress(IntPtr current_address, core_id_t core_id,
-                                                    Core::mem_op_t mem_op_type, bool cache_hit,
-                                                    bool prefetch_hit, IntPtr eip)
+void IPCPPrefetcher::getNextAddress(IntPtr current_address, core_id_t core_id,
+                                    Core::mem_op_t mem_op_type, bool cache_hit,
+                                    bool prefetch_hit, IntPtr eip,
+                                    std::vector<IntPtr>& pref_addr)
 {
-    std::vector<IntPtr> pref_addr;
-
     // Only prefetch on read operations
     if (mem_op_type == Core::WRITE) {
-        return pref_addr;
+        return;
     }
 
     stats.pref_called++;
@@ -112,12 +112,12 @@ std::vector<IntPtr> IPCPPrefetcher::getNextAddress(IntPtr current_address, core_
 
         // Issue next-line prefetch for new IP
         uint64_t pf_address = ((addr >> LOG2_BLOCK_SIZE) + 1) << LOG2_BLOCK_SIZE;
-        if ((pf_address >> LOG2_PAGE_SIZE) == curr_page) {
+        if (in_reach(pf_address, curr_page)) {
             pref_addr.push_back(pf_address);
             stats.nl_prefetches++;
             stats.prefetches_issued++;
         }
-        return pref_addr;
+        return;
     } else {
         // Same IP, set valid
         ip_table[index].ip_valid = 1;
@@ -134,7 +134,7 @@ std::vector<IntPtr> IPCPPrefetcher::getNextAddress(IntPtr current_address, core_
 
     // Skip if same address seen twice
     if (stride == 0) {
-        return pref_addr;
+        return;
     }
 
     // Page boundary learning
@@ -184,8 +184,8 @@ std::vector<IntPtr> IPCPPrefetcher::getNextAddress(IntPtr current_address, core_
                 pf_address = (cl_addr - i - 1) << LOG2_BLOCK_SIZE;
             }
 
-            // Check page boundary
-            if ((pf_address >> LOG2_PAGE_SIZE) != curr_page) {
+            // Check page boundary (unless the cache translates into the next page)
+            if (!in_reach(pf_address, curr_page)) {
                 break;
             }
 
@@ -198,8 +198,8 @@ std::vector<IntPtr> IPCPPrefetcher::getNextAddress(IntPtr current_address, core_
         for (unsigned i = 0; i < m_prefetch_degree; i++) {
             uint64_t pf_address = (cl_addr + (ip_table[index].last_stride * (i + 1))) << LOG2_BLOCK_SIZE;
 
-            // Check page boundary
-            if ((pf_address >> LOG2_PAGE_SIZE) != curr_page) {
+            // Check page boundary (unless the cache translates into the next page)
+            if (!in_reach(pf_address, curr_page)) {
                 break;
             }
 
@@ -216,7 +216,7 @@ std::vector<IntPtr> IPCPPrefetcher::getNextAddress(IntPtr current_address, core_
             uint64_t pf_address = ((cl_addr + pref_offset) << LOG2_BLOCK_SIZE);
 
             // Check page boundary and valid delta
-            if (((pf_address >> LOG2_PAGE_SIZE) != curr_page) ||
+            if (!in_reach(pf_address, curr_page) ||
                 (dpt[curr_sig].conf == -1) ||
                 (dpt[curr_sig].delta == 0)) {
                 break;
@@ -235,7 +235,7 @@ std::vector<IntPtr> IPCPPrefetcher::getNextAddress(IntPtr current_address, core_
     // Speculative next-line prefetch if no prefetches issued
     if (num_prefs == 0 && spec_nl == 1) {
         uint64_t pf_address = ((addr >> LOG2_BLOCK_SIZE) + 1) << LOG2_BLOCK_SIZE;
-        if ((pf_address >> LOG2_PAGE_SIZE) == curr_page) {
+        if (in_reach(pf_address, curr_page)) {
             pref_addr.push_back(pf_address);
             stats.nl_prefetches++;
         }
@@ -249,8 +249,6 @@ std::vector<IntPtr> IPCPPrefetcher::getNextAddress(IntPtr current_address, core_
 
     // Update GHB
     update_ghb(cl_addr);
-
-    return pref_addr;
 }
 
 // =============================================================================
@@ -28,9 +28,10 @@ public:
     IPCPPrefetcher(String configName, core_id_t core_id);
     ~IPCPPrefetcher();
 
-    std::vector<IntPtr> getNextAddress(IntPtr current_address, core_id_t core_id,
-                                        Core::mem_op_t mem_op_type, bool cache_hit,
-                                        bool prefetch_hit, IntPtr eip) override;
+    void getNextAddress(IntPtr current_address, core_id_t core_id,
+                        Core::mem_op_t mem_op_type, bool cache_hit,
+                        bool prefetch_hit, IntPtr eip,
+                        std::vector<IntPtr>& pref_addr) override;
 
 private:
     core_id_t m_core_id;
@@ -53,6 +54,7 @@ private:
     // Prefetching parameters
     unsigned m_prefetch_degree;
     unsigned m_spec_nl_threshold;
+    bool m_cross_page;  // Also prefetch beyond the page, translated by the cache (prefetcher/cross_page)
 
     // IP Table Entry
     struct IPTableEntry {
@@ -92,6 +94,12 @@ private:
     int spec_nl;
 
     // Helper functions
+    // The current page, or with cross_page also the page next to it in the direction of the stride
+    bool in_reach(uint64_t pf_address, uint64_t curr_page) const
+    {
+        uint64_t pf_page = pf_address >> LOG2_PAGE_SIZE;
+        return pf_page == curr_page || (m_cross_page && (pf_page == curr_page + 1 || pf_page == curr_page - 1));
+    }
     uint16_t update_signature(uint16_t old_sig, int delta);
     int update_conf(int stride, int pred_stride, int conf);
     void check_for_stream(int index, uint64_t cl_addr);
@@ -21,8 +21,8 @@ SimplePrefetcher::SimplePrefetcher(String configName, core_id_t _core_id, UInt32
       m_prev_address.at(idx).resize(n_flows);
 }
 
-std::vector<IntPtr>
-SimplePrefetcher::getNextAddress(IntPtr current_address, core_id_t _core_id,Core::mem_op_t mem_op_type, bool cache_hit, bool prefetch_hit, IntPtr eip)
+void
+SimplePrefetcher::getNextAddress(IntPtr current_address, core_id_t _core_id,Core::mem_op_t mem_op_type, bool cache_hit, bool prefetch_hit, IntPtr eip, std::vector<IntPtr> &addresses)
 {
    std::vector<IntPtr> &prev_address = m_prev_address.at(flows_per_core ? _core_id - core_id : 0);
 
@@ -48,7 +48,6 @@ SimplePrefetcher::getNextAddress(IntPtr current_address, core_id_t _core_id,Core
    IntPtr stride = current_address - prev_address[n_flow];
    prev_address[n_flow] = current_address;
 
-   std::vector<IntPtr> addresses;
    if (stride != 0)
    {
       for(unsigned int i = 0; i < num_prefetches; ++i)
@@ -59,6 +58,4 @@ SimplePrefetcher::getNextAddress(IntPtr current_address, core_id_t _core_id,Core
             addresses.push_back(prefetch_address);
       }
    }
-
-   return addresses;
 }
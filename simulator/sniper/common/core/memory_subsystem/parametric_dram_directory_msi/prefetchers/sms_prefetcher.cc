@@ -1,6 +1,6 @@
 /**
  * SMS (Spatial Memory Streaming) Prefetcher for Sniper
- * 
+ *
  * Ported from ChampSim's SMS implementation.
  * Original paper: "Spatial Memory Streaming" (ISCA'06)
  */
@@ -26,11 +26,15 @@ SMSPrefetcher::SMSPrefetcher(String configName, core_id_t core_id)
     , m_region_size(2048)
     , m_region_size_log(11)  // log2(2048)
     , m_pref_buffer_size(256)
+    , filter_table(m_ft_size)
+    , acc_table(m_at_size)
+    , pht(m_pht_size)
+    , m_pht_sets(m_pht_size / m_pht_assoc)
+    , m_stamp(0)
+    , pref_buffer(m_pref_buffer_size)
+    , m_pref_buffer_head(0)
+    , m_pref_buffer_count(0)
 {
-    // Initialize PHT with proper number of sets
-    uint32_t pht_sets = m_pht_size / m_pht_assoc;
-    pht.resize(pht_sets);
-
     bzero(&stats, sizeof(stats));
     registerStatsMetric("sms", m_core_id, "pref_called", &stats.pref_called);
     registerStatsMetric("sms", m_core_id, "ft_hits", &stats.ft_hits);
@@ -40,245 +44,203 @@ SMSPrefetcher::SMSPrefetcher(String configName, core_id_t core_id)
     registerStatsMetric("sms", m_core_id, "prefetches_issued", &stats.prefetches_issued);
 }
 
-SMSPrefetcher::~SMSPrefetcher()
-{
-    // Clean up filter table
-    for (auto* entry : filter_table) {
-        delete entry;
-    }
-    
-    // Clean up accumulation table
-    for (auto* entry : acc_table) {
-        delete entry;
-    }
-    
-    // Clean up PHT
-    for (auto& set : pht) {
-        for (auto* entry : set) {
-            delete entry;
-        }
-    }
-}
+SMSPrefetcher::~SMSPrefetcher() {}
 
 // =============================================================================
 // Main Prefetch Interface
 // =============================================================================
 
-std::vector<IntPtr> SMSPrefetcher::getNextAddress(IntPtr current_address, core_id_t core_id,
-                                                   Core::mem_op_t mem_op_type, bool cache_hit,
-                                                   bool prefetch_hit, IntPtr eip)
+void SMSPrefetcher::getNextAddress(IntPtr current_address, core_id_t core_id,
+                                   Core::mem_op_t mem_op_type, bool cache_hit,
+                                   bool prefetch_hit, IntPtr eip,
+                                   std::vector<IntPtr>& pref_addr)
 {
-    std::vector<IntPtr> pref_addr;
-    
     // Only prefetch on read operations
     if (mem_op_type == Core::WRITE) {
-        return issue_prefetch(); // Still issue buffered prefetches
+        issue_prefetch(pref_addr); // Still issue buffered prefetches
+        return;
     }
 
     stats.pref_called++;
 
     uint64_t page = current_address >> m_region_size_log;
-    uint32_t offset = static_cast<uint32_t>((current_address >> LOG2_BLOCK_SIZE) & 
+    uint32_t offset = static_cast<uint32_t>((current_address >> LOG2_BLOCK_SIZE) &
                       ((1ULL << (m_region_size_log - LOG2_BLOCK_SIZE)) - 1));
 
     // Search accumulation table first
-    auto at_index = search_acc_table(page);
-    if (at_index != acc_table.end()) {
+    ATEntry* at_entry = search_acc_table(page);
+    if (at_entry) {
         // Accumulation table hit - update pattern
         stats.at_hits++;
-        (*at_index)->pattern[offset] = 1;
-        update_age_acc_table(at_index);
+        at_entry->pattern[offset] = 1;
+        update_age_acc_table(at_entry);
     } else {
         // Search filter table
-        auto ft_index = search_filter_table(page);
-        if (ft_index != filter_table.end()) {
+        FTEntry* ft_entry = search_filter_table(page);
+        if (ft_entry) {
             // Filter table hit - move to accumulation table
             stats.ft_hits++;
-            insert_acc_table(*ft_index, offset);
-            evict_filter_table(ft_index);
+            insert_acc_table(*ft_entry, offset);
+            evict_filter_table(ft_entry);
         } else {
             // Filter table miss - new region access
             // Insert into filter table and generate prefetches from PHT
             insert_filter_table(eip, page, offset);
-            generate_prefetch(eip, current_address, page, offset, pref_addr);
-            buffer_prefetch(pref_addr);
+            generate_prefetch(eip, current_address, page, offset);
         }
     }
 
     // Return buffered prefetches (rate-limited)
-    return issue_prefetch();
+    issue_prefetch(pref_addr);
 }
 
 // =============================================================================
 // Filter Table Operations
 // =============================================================================
 
-std::deque<SMSPrefetcher::FTEntry*>::iterator SMSPrefetcher::search_filter_table(uint64_t page)
+SMSPrefetcher::FTEntry* SMSPrefetcher::search_filter_table(uint64_t page)
 {
-    return std::find_if(filter_table.begin(), filter_table.end(),
-        [page](FTEntry* entry) { return entry->page == page; });
+    for (auto& entry : filter_table) {
+        if (entry.valid && entry.page == page)
+            return &entry;
+    }
+    return NULL;
 }
 
 void SMSPrefetcher::insert_filter_table(uint64_t pc, uint64_t page, uint32_t offset)
 {
-    if (filter_table.size() >= m_ft_size) {
-        auto victim = search_victim_filter_table();
-        evict_filter_table(victim);
-    }
-
-    FTEntry* entry = new FTEntry();
+    FTEntry* entry = search_victim_filter_table();
+    entry->valid = true;
     entry->page = page;
     entry->pc = pc;
     entry->trigger_offset = offset;
-    filter_table.push_back(entry);
+    entry->inserted = ++m_stamp;
 }
 
-std::deque<SMSPrefetcher::FTEntry*>::iterator SMSPrefetcher::search_victim_filter_table()
+SMSPrefetcher::FTEntry* SMSPrefetcher::search_victim_filter_table()
 {
-    // FIFO replacement
-    return filter_table.begin();
+    // A free entry, or else FIFO replacement
+    FTEntry* victim = &filter_table[0];
+    for (auto& entry : filter_table) {
+        if (!entry.valid)
+            return &entry;
+        if (entry.inserted < victim->inserted)
+            victim = &entry;
+    }
+    return victim;
 }
 
-void SMSPrefetcher::evict_filter_table(std::deque<FTEntry*>::iterator victim)
+void SMSPrefetcher::evict_filter_table(FTEntry* victim)
 {
-    FTEntry* entry = *victim;
-    filter_table.erase(victim);
-    delete entry;
+    victim->valid = false;
 }
 
 // =============================================================================
 // Accumulation Table Operations
 // =============================================================================
 
-std::deque<SMSPrefetcher::ATEntry*>::iterator SMSPrefetcher::search_acc_table(uint64_t page)
+SMSPrefetcher::ATEntry* SMSPrefetcher::search_acc_table(uint64_t page)
 {
-    return std::find_if(acc_table.begin(), acc_table.end(),
-        [page](ATEntry* entry) { return entry->page == page; });
+    for (auto& entry : acc_table) {
+        if (entry.valid && entry.page == page)
+            return &entry;
+    }
+    return NULL;
 }
 
-void SMSPrefetcher::insert_acc_table(FTEntry* ftentry, uint32_t offset)
+void SMSPrefetcher::insert_acc_table(const FTEntry& ftentry, uint32_t offset)
 {
-    if (acc_table.size() >= m_at_size) {
-        auto victim = search_victim_acc_table();
-        evict_acc_table(victim);
+    ATEntry* entry = search_victim_acc_table();
+    if (entry->valid) {
+        evict_acc_table(entry);
     }
 
-    ATEntry* entry = new ATEntry();
-    entry->pc = ftentry->pc;
-    entry->page = ftentry->page;
-    entry->trigger_offset = ftentry->trigger_offset;
+    entry->valid = true;
+    entry->pc = ftentry.pc;
+    entry->page = ftentry.page;
+    entry->trigger_offset = ftentry.trigger_offset;
     entry->pattern.reset();
-    entry->pattern[ftentry->trigger_offset] = 1;
+    entry->pattern[ftentry.trigger_offset] = 1;
     entry->pattern[offset] = 1;
-    entry->age = 0;
-
-    // Age all existing entries
-    for (auto* e : acc_table) {
-        e->age++;
-    }
-    acc_table.push_back(entry);
+    update_age_acc_table(entry);
 }
 
-std::deque<SMSPrefetcher::ATEntry*>::iterator SMSPrefetcher::search_victim_acc_table()
+SMSPrefetcher::ATEntry* SMSPrefetcher::search_victim_acc_table()
 {
-    // LRU replacement
-    uint32_t max_age = 0;
-    auto victim = acc_table.begin();
-    
-    for (auto it = acc_table.begin(); it != acc_table.end(); ++it) {
-        if ((*it)->age >= max_age) {
-            max_age = (*it)->age;
-            victim = it;
-        }
+    // A free entry, or else LRU replacement
+    ATEntry* victim = &acc_table[0];
+    for (auto& entry : acc_table) {
+        if (!entry.valid)
+            return &entry;
+        if (entry.last_use < victim->last_use)
+            victim = &entry;
     }
     return victim;
 }
 
-void SMSPrefetcher::evict_acc_table(std::deque<ATEntry*>::iterator victim)
+void SMSPrefetcher::evict_acc_table(ATEntry* victim)
 {
-    ATEntry* entry = *victim;
     // Transfer pattern to PHT before eviction
-    insert_pht_table(entry);
-    acc_table.erase(victim);
-    delete entry;
+    insert_pht_table(*victim);
+    victim->valid = false;
 }
 
-void SMSPrefetcher::update_age_acc_table(std::deque<ATEntry*>::iterator current)
+void SMSPrefetcher::update_age_acc_table(ATEntry* current)
 {
-    for (auto* entry : acc_table) {
-        entry->age++;
-    }
-    (*current)->age = 0;
+    current->last_use = ++m_stamp;
 }
 
 // =============================================================================
 // Pattern History Table Operations
 // =============================================================================
 
-void SMSPrefetcher::insert_pht_table(ATEntry* atentry)
+void SMSPrefetcher::insert_pht_table(const ATEntry& atentry)
 {
-    uint64_t signature = create_signature(atentry->pc, atentry->trigger_offset);
+    uint64_t signature = create_signature(atentry.pc, atentry.trigger_offset);
     uint32_t set = 0;
-    
-    auto pht_index = search_pht(signature, set);
-    if (pht_index != pht[set].end()) {
+
+    PHTEntry* entry = search_pht(signature, set);
+    if (entry) {
         // PHT hit - update pattern
         stats.pht_hits++;
-        (*pht_index)->pattern = atentry->pattern;
-        update_age_pht(set, pht_index);
     } else {
         // PHT miss - insert new entry
-        if (pht[set].size() >= m_pht_assoc) {
-            auto victim = search_victim_pht(set);
-            evict_pht(set, victim);
-        }
-
-        PHTEntry* entry = new PHTEntry();
+        entry = search_victim_pht(set);
+        entry->valid = true;
         entry->signature = signature;
-        entry->pattern = atentry->pattern;
-        entry->age = 0;
-        
-        for (auto* e : pht[set]) {
-            e->age++;
-        }
-        pht[set].push_back(entry);
     }
+    entry->pattern = atentry.pattern;
+    update_age_pht(entry);
 }
 
-std::deque<SMSPrefetcher::PHTEntry*>::iterator SMSPrefetcher::search_pht(uint64_t signature, uint32_t& set)
+SMSPrefetcher::PHTEntry* SMSPrefetcher::search_pht(uint64_t signature, uint32_t& set)
 {
-    set = static_cast<uint32_t>(signature % pht.size());
-    return std::find_if(pht[set].begin(), pht[set].end(),
-        [signature](PHTEntry* entry) { return entry->signature == signature; });
+    set = static_cast<uint32_t>(signature % m_pht_sets);
+    PHTEntry* ways = &pht[set * m_pht_assoc];
+    for (uint32_t way = 0; way < m_pht_assoc; ++way) {
+        if (ways[way].valid && ways[way].signature == signature)
+            return &ways[way];
+    }
+    return NULL;
 }
 
-std::deque<SMSPrefetcher::PHTEntry*>::iterator SMSPrefetcher::search_victim_pht(int32_t set)
+SMSPrefetcher::PHTEntry* SMSPrefetcher::search_victim_pht(uint32_t set)
 {
-    uint32_t max_age = 0;
-    auto victim = pht[set].begin();
-    
-    for (auto it = pht[set].begin(); it != pht[set].end(); ++it) {
-        if ((*it)->age >= max_age) {
-            max_age = (*it)->age;
-            victim = it;
-        }
+    // A free way, or else LRU replacement
+    PHTEntry* ways = &pht[set * m_pht_assoc];
+    PHTEntry* victim = &ways[0];
+    for (uint32_t way = 0; way < m_pht_assoc; ++way) {
+        if (!ways[way].valid)
+            return &ways[way];
+        if (ways[way].last_use < victim->last_use)
+            victim = &ways[way];
     }
     return victim;
 }
 
-void SMSPrefetcher::evict_pht(int32_t set, std::deque<PHTEntry*>::iterator victim)
-{
-    PHTEntry* entry = *victim;
-    pht[set].erase(victim);
-    delete entry;
-}
-
-void SMSPrefetcher::update_age_pht(int32_t set, std::deque<PHTEntry*>::iterator current)
+void SMSPrefetcher::update_age_pht(PHTEntry* current)
 {
-    for (auto* entry : pht[set]) {
-        entry->age++;
-    }
-    (*current)->age = 0;
+    current->last_use = ++m_stamp;
 }
 
 // =============================================================================
@@ -293,54 +255,49 @@ uint64_t SMSPrefetcher::create_signature(uint64_t pc, uint32_t offset)
     return signature;
 }
 
-std::size_t SMSPrefetcher::generate_prefetch(uint64_t pc, uint64_t address, uint64_t page,
-                                              uint32_t offset, std::vector<IntPtr>& pref_addr)
+void SMSPrefetcher::generate_prefetch(uint64_t pc, uint64_t address, uint64_t page, uint32_t offset)
 {
     uint64_t signature = create_signature(pc, offset);
     uint32_t set = 0;
-    
-    auto pht_index = search_pht(signature, set);
-    if (pht_index == pht[set].end()) {
-        return 0; // No pattern found
+
+    PHTEntry* entry = search_pht(signature, set);
+    if (!entry) {
+        return; // No pattern found
     }
 
     stats.pht_hits++;
-    PHTEntry* entry = *pht_index;
-    
+
     // Generate prefetches based on stored pattern
     for (uint32_t i = 0; i < BITMAP_MAX_SIZE; ++i) {
         if (entry->pattern[i] && i != offset) {
             IntPtr addr = (page << m_region_size_log) + (i << LOG2_BLOCK_SIZE);
-            pref_addr.push_back(addr);
+            buffer_prefetch(addr);
             stats.prefetches_generated++;
         }
     }
-    
-    update_age_pht(set, pht_index);
-    return pref_addr.size();
+
+    update_age_pht(entry);
 }
 
-void SMSPrefetcher::buffer_prefetch(const std::vector<IntPtr>& pref_addr)
+void SMSPrefetcher::buffer_prefetch(IntPtr addr)
 {
-    for (const auto& addr : pref_addr) {
-        if (pref_buffer.size() >= m_pref_buffer_size) {
-            break;
-        }
-        pref_buffer.push_back(addr);
+    // Drop prefetches that do not fit
+    if (m_pref_buffer_count >= m_pref_buffer_size) {
+        return;
     }
+    pref_buffer[(m_pref_buffer_head + m_pref_buffer_count) % m_pref_buffer_size] = addr;
+    m_pref_buffer_count++;
 }
 
-std::vector<IntPtr> SMSPrefetcher::issue_prefetch()
+void SMSPrefetcher::issue_prefetch(std::vector<IntPtr>& pref_addr)
 {
-    std::vector<IntPtr> issued;
     uint32_t count = 0;
-    
-    while (!pref_buffer.empty() && count < m_pref_degree) {
-        issued.push_back(pref_buffer.front());
-        pref_buffer.pop_front();
+
+    while (m_pref_buffer_count > 0 && count < m_pref_degree) {
+        pref_addr.push_back(pref_buffer[m_pref_buffer_head]);
+        m_pref_buffer_head = (m_pref_buffer_head + 1) % m_pref_buffer_size;
+        m_pref_buffer_count--;
         count++;
         stats.prefetches_issued++;
     }
-    
-    return issued;
 }
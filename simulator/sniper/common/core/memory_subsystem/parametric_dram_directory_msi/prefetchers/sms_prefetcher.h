@@ -11,6 +11,10 @@
  * - Filter Table (FT): Detects first access to a region
  * - Accumulation Table (AT): Records access patterns within active regions
  * - Pattern History Table (PHT): Stores learned patterns indexed by (PC, offset)
+ *
+ * All tables are flat arrays allocated at construction. Instead of aging every
+ * entry on each access, entries carry the stamp of their insertion (FIFO) or
+ * last use (LRU), and the victim is the entry with the oldest stamp.
  */
 
 #ifndef SMS_PREFETCHER_H
@@ -20,7 +24,6 @@
 #include "fixed_types.h"
 #include "core.h"
 #include <vector>
-#include <deque>
 #include <bitset>
 #include <cstdint>
 
@@ -34,9 +37,10 @@ public:
     SMSPrefetcher(String configName, core_id_t core_id);
     ~SMSPrefetcher();
 
-    std::vector<IntPtr> getNextAddress(IntPtr current_address, core_id_t core_id,
-                                        Core::mem_op_t mem_op_type, bool cache_hit,
-                                        bool prefetch_hit, IntPtr eip) override;
+    void getNextAddress(IntPtr current_address, core_id_t core_id,
+                        Core::mem_op_t mem_op_type, bool cache_hit,
+                        bool prefetch_hit, IntPtr eip,
+                        std::vector<IntPtr>& pref_addr) override;
 
 private:
     core_id_t m_core_id;
@@ -58,65 +62,73 @@ private:
 
     // Filter Table Entry
     struct FTEntry {
+        bool valid;
         uint64_t page;
         uint64_t pc;
         uint32_t trigger_offset;
+        uint64_t inserted;      // Stamp at insertion, for FIFO replacement
 
-        FTEntry() : page(0), pc(0), trigger_offset(0) {}
+        FTEntry() : valid(false), page(0), pc(0), trigger_offset(0), inserted(0) {}
     };
 
     // Accumulation Table Entry
     struct ATEntry {
+        bool valid;
         uint64_t page;
         uint64_t pc;
         uint32_t trigger_offset;
         Bitmap pattern;
-        uint32_t age;
+        uint64_t last_use;      // Stamp at last use, for LRU replacement
 
-        ATEntry() : page(0), pc(0), trigger_offset(0), pattern(0), age(0) {}
+        ATEntry() : valid(false), page(0), pc(0), trigger_offset(0), pattern(0), last_use(0) {}
     };
 
     // Pattern History Table Entry
     struct PHTEntry {
+        bool valid;
         uint64_t signature;
         Bitmap pattern;
-        uint32_t age;
+        uint64_t last_use;
 
-        PHTEntry() : signature(0), pattern(0), age(0) {}
+        PHTEntry() : valid(false), signature(0), pattern(0), last_use(0) {}
     };
 
     // Data structures
-    std::deque<FTEntry*> filter_table;
-    std::deque<ATEntry*> acc_table;
-    std::vector<std::deque<PHTEntry*>> pht;
-    std::deque<IntPtr> pref_buffer;
+    std::vector<FTEntry> filter_table;
+    std::vector<ATEntry> acc_table;
+    std::vector<PHTEntry> pht;          // m_pht_sets sets of m_pht_assoc ways
+    uint32_t m_pht_sets;
+    uint64_t m_stamp;                   // Last stamp handed out to a table entry
+
+    // Prefetch buffer: ring of m_pref_buffer_size addresses
+    std::vector<IntPtr> pref_buffer;
+    uint32_t m_pref_buffer_head;
+    uint32_t m_pref_buffer_count;
 
     // Filter Table operations
-    std::deque<FTEntry*>::iterator search_filter_table(uint64_t page);
+    FTEntry* search_filter_table(uint64_t page);
     void insert_filter_table(uint64_t pc, uint64_t page, uint32_t offset);
-    std::deque<FTEntry*>::iterator search_victim_filter_table();
-    void evict_filter_table(std::deque<FTEntry*>::iterator victim);
+    FTEntry* search_victim_filter_table();
+    void evict_filter_table(FTEntry* victim);
 
     // Accumulation Table operations
-    std::deque<ATEntry*>::iterator search_acc_table(uint64_t page);
-    void insert_acc_table(FTEntry* ftentry, uint32_t offset);
-    std::deque<ATEntry*>::iterator search_victim_acc_table();
-    void evict_acc_table(std::deque<ATEntry*>::iterator victim);
-    void update_age_acc_table(std::deque<ATEntry*>::iterator current);
+    ATEntry* search_acc_table(uint64_t page);
+    void insert_acc_table(const FTEntry& ftentry, uint32_t offset);
+    ATEntry* search_victim_acc_table();
+    void evict_acc_table(ATEntry* victim);
+    void update_age_acc_table(ATEntry* current);
 
     // Pattern History Table operations
-    void insert_pht_table(ATEntry* atentry);
-    std::deque<PHTEntry*>::iterator search_pht(uint64_t signature, uint32_t& set);
-    std::deque<PHTEntry*>::iterator search_victim_pht(int32_t set);
-    void evict_pht(int32_t set, std::deque<PHTEntry*>::iterator victim);
-    void update_age_pht(int32_t set, std::deque<PHTEntry*>::iterator current);
+    void insert_pht_table(const ATEntry& atentry);
+    PHTEntry* search_pht(uint64_t signature, uint32_t& set);
+    PHTEntry* search_victim_pht(uint32_t set);
+    void update_age_pht(PHTEntry* current);
 
     // Helper functions
     uint64_t create_signature(uint64_t pc, uint32_t offset);
-    std::size_t generate_prefetch(uint64_t pc, uint64_t address, uint64_t page, 
-                                  uint32_t offset, std::vector<IntPtr>& pref_addr);
-    void buffer_prefetch(const std::vector<IntPtr>& pref_addr);
-    std::vector<IntPtr> issue_prefetch();
+    void generate_prefetch(uint64_t pc, uint64_t address, uint64_t page, uint32_t offset);
+    void buffer_prefetch(IntPtr addr);
+    void issue_prefetch(std::vector<IntPtr>& pref_addr);
 
     // Statistics
     struct {
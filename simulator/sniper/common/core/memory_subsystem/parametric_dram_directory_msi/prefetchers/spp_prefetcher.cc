@@ -20,6 +20,7 @@ SPPPrefetcher::SPPPrefetcher(String configName, core_id_t core_id)
     , m_lookahead_on(Sim()->getCfg()->getBoolDefault("perf_model/" + configName + "/prefetcher/spp/lookahead_on", true))
     , m_filter_on(Sim()->getCfg()->getBoolDefault("perf_model/" + configName + "/prefetcher/spp/filter_on", true))
     , m_ghr_on(Sim()->getCfg()->getBoolDefault("perf_model/" + configName + "/prefetcher/spp/ghr_on", true))
+    , m_cross_page(Sim()->getCfg()->getBoolDefault("perf_model/" + configName + "/prefetcher/cross_page", false))
 {
     bzero(&stats, sizeof(stats));
     registerStatsMetric("spp", m_core_id, "pref_called", &stats.pref_called);
@@ -35,15 +36,14 @@ SPPPrefetcher::~SPPPrefetcher() {}
 // Main Prefetch Interface
 // =============================================================================
 
-std::vector<IntPtr> SPPPrefetcher::getNextAddress(IntPtr current_address, core_id_t core_id,
-                                                   Core::mem_op_t mem_op_type, bool cache_hit,
-                                                   bool prefetch_hit, IntPtr eip)
+void SPPPrefetcher::getNextAddress(IntPtr current_address, core_id_t core_id,
+                                   Core::mem_op_t mem_op_type, bool cache_hit,
+                                   bool prefetch_hit, IntPtr eip,
+                                   std::vector<IntPtr>& pref_addr)
 {
-    std::vector<IntPtr> pref_addr;
-    
     // Only prefetch on read operations
     if (mem_op_type == Core::WRITE) {
-        return pref_addr;
+        return;
     }
 
     stats.pref_called++;
@@ -90,8 +90,8 @@ std::vector<IntPtr> SPPPrefetcher::getNextAddress(IntPtr current_address, core_i
                 IntPtr pf_address = pf_block << LOG2_BLOCK_SIZE;
                 IntPtr pf_page = pf_address >> LOG2_PAGE_SIZE;
 
-                if (pf_page == page) {
-                    // Prefetch within same page
+                // Prefetch within same page, or into the neighbouring one when the cache translates it
+                if (pf_page == page || (m_cross_page && (pf_page == page + 1 || pf_page == page - 1))) {
                     bool should_prefetch = true;
                     
                     if (m_filter_on) {
@@ -114,7 +114,8 @@ std::vector<IntPtr> SPPPrefetcher::getNextAddress(IntPtr current_address, core_i
                     } else {
                         stats.filter_hits++;
                     }
-                } else if (m_ghr_on) {
+                }
+                if (pf_page != page && m_ghr_on) {
                     // Cross-page: store in GHR for bootstrapping
                     uint32_t pf_offset = (pf_address >> LOG2_BLOCK_SIZE) & (BLOCKS_PER_PAGE - 1);
                     GHR.update_entry(curr_sig, confidence_q[i], pf_offset, delta_q[i]);
@@ -137,8 +138,6 @@ std::vector<IntPtr> SPPPrefetcher::getNextAddress(IntPtr current_address, core_i
         }
 
     } while (m_lookahead_on && do_lookahead);
-
-    return pref_addr;
 }
 
 // =============================================================================
@@ -27,9 +27,10 @@ public:
     SPPPrefetcher(String configName, core_id_t core_id);
     ~SPPPrefetcher();
 
-    std::vector<IntPtr> getNextAddress(IntPtr current_address, core_id_t core_id, 
-                                        Core::mem_op_t mem_op_type, bool cache_hit, 
-                                        bool prefetch_hit, IntPtr eip) override;
+    void getNextAddress(IntPtr current_address, core_id_t core_id, 
+                        Core::mem_op_t mem_op_type, bool cache_hit, 
+                        bool prefetch_hit, IntPtr eip,
+                        std::vector<IntPtr>& pref_addr) override;
 
 private:
     core_id_t m_core_id;
@@ -38,6 +39,7 @@ private:
     bool m_lookahead_on;
     bool m_filter_on;
     bool m_ghr_on;
+    bool m_cross_page;  // Also prefetch beyond the page, translated by the cache (prefetcher/cross_page)
 
     // Signature table parameters
     static constexpr std::size_t ST_SET = 1;
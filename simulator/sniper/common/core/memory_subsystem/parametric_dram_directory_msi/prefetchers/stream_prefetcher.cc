@@ -41,16 +41,14 @@ Streamer::~Streamer()
 
 }
 
-std::vector<IntPtr>
-Streamer::getNextAddress(IntPtr current_address, core_id_t _core_id, Core::mem_op_t mem_op_type, bool cache_hit, bool prefetch_hit, IntPtr eip)
+void
+Streamer::getNextAddress(IntPtr current_address, core_id_t _core_id, Core::mem_op_t mem_op_type, bool cache_hit, bool prefetch_hit, IntPtr eip, std::vector<IntPtr> &pref_addr)
 {
 	IntPtr current_page = current_address >> LOG2_PAGE_SIZE;
 	IntPtr current_offset = (current_address >> LOG2_CACHE_BLOCK_SIZE) & CACHE_BLOCK_MASK;
-	std::vector<IntPtr> pref_addr;
-
 	if(mem_op_type == Core::WRITE)
 	{
-		return pref_addr;
+		return;
 	}
 
 	stats.pref_called++;
@@ -78,7 +76,7 @@ Streamer::getNextAddress(IntPtr current_address, core_id_t _core_id, Core::mem_o
 			if(stream_entry->conf >= m_conf_thresh)
 			{
 				stats.steady++;
-				pref_addr = generatePrefetchAddress(stream_entry, current_page, current_offset);
+				generatePrefetchAddress(stream_entry, current_page, current_offset, pref_addr);
 			}
 		}
 	}
@@ -97,7 +95,6 @@ Streamer::getNextAddress(IntPtr current_address, core_id_t _core_id, Core::mem_o
 			update_age(index);
 		}
 	}
-	return pref_addr;
 }
 
 int32_t Streamer::find(IntPtr page)
@@ -147,9 +144,8 @@ int32_t Streamer::find_replacement()
 	return replacement_index;
 }
 
-std::vector<IntPtr> Streamer::generatePrefetchAddress(StreamEntry *stream_entry, IntPtr current_page, IntPtr current_offset)
+void Streamer::generatePrefetchAddress(StreamEntry *stream_entry, IntPtr current_page, IntPtr current_offset, std::vector<IntPtr> &addresses)
 {
-	std::vector<IntPtr> addresses;
 	for(unsigned int index = 1; index <= m_num_prefetches; ++index)
 	{
 		int32_t prefetch_offset = current_offset + (m_prefetch_front + index ) * stream_entry->dir;
@@ -160,5 +156,4 @@ std::vector<IntPtr> Streamer::generatePrefetchAddress(StreamEntry *stream_entry,
 			stats.gen_prefetch++;
 		}
 	}
-	return addresses;
 }
@@ -47,8 +47,8 @@ public:
 	int32_t find(IntPtr page);
 	void update_age(int32_t current);
 	int32_t find_replacement();
-	std::vector<IntPtr> generatePrefetchAddress(StreamEntry *stream_entry, IntPtr current_page, IntPtr current_offset);
-	std::vector<IntPtr> getNextAddress(IntPtr current_address, core_id_t core_id, Core::mem_op_t mem_op_type, bool cache_hit, bool prefetch_hit, IntPtr eip);
+	void generatePrefetchAddress(StreamEntry *stream_entry, IntPtr current_page, IntPtr current_offset, std::vector<IntPtr> &addresses);
+	void getNextAddress(IntPtr current_address, core_id_t core_id, Core::mem_op_t mem_op_type, bool cache_hit, bool prefetch_hit, IntPtr eip, std::vector<IntPtr> &pref_addr);
 	inline void incr_conf(StreamEntry *entry) {if(entry->conf < m_max_conf) entry->conf++;}
 	inline void decr_conf(StreamEntry *entry) {if(entry->conf) entry->conf--;}
 };
@@ -18,18 +18,72 @@ namespace ParametricDramDirectoryMSI
 		: m_core_id(core_id), access_latency(_access_latency), miss_latency(_miss_latency) // Assuming 8B granularity
 		  ,
 		  num_caches(_num_caches),
-		  perfect(_perfect)
+		  perfect(_perfect),
+		  m_prefetching(false),
+		  m_name(name),
+		  m_asid(0),
+		  m_current_asid_stats(NULL)
 	{
 		int page_sizes[1] = {0};
 		m_cache = (Cache **)malloc(sizeof(Cache *) * num_caches);
 		m_access = (UInt64 *)malloc(sizeof(UInt64) * num_caches);
 		m_miss = (UInt64 *)malloc(sizeof(UInt64) * num_caches);
+		m_prefetch_fill = (UInt64 *)calloc(num_caches, sizeof(UInt64));
+		m_prefetch_evict = (UInt64 *)calloc(num_caches, sizeof(UInt64));
 		for (int i = 0; i < num_caches; i++)
 		{
 
 			m_cache[i] = new Cache(name + "_L" + itostr((num_caches + 1) - i), cfgname, core_id, entries[i] / associativities[i], associativities[i], 8, "lru", CacheBase::PR_L1_CACHE, CacheBase::hash_t::HASH_MASK, NULL, NULL, true, page_sizes, 1);
 			registerStatsMetric(name + "_L" + itostr((num_caches + 1) - i), core_id, "access", &m_access[i]);
 			registerStatsMetric(name + "_L" + itostr((num_caches + 1) - i), core_id, "miss", &m_miss[i]);
+			registerStatsMetric(name + "_L" + itostr((num_caches + 1) - i), core_id, "prefetch_fill", &m_prefetch_fill[i]);
+			registerStatsMetric(name + "_L" + itostr((num_caches + 1) - i), core_id, "prefetch_evict", &m_prefetch_evict[i]);
+		}
+		setASID(0);
+	}
+
+	void PWC::setASID(UInt16 asid)
+	{
+		if (asid >= m_asid_stats.size())
+			m_asid_stats.resize(asid + 1);
+		if (!m_asid_stats[asid])
+		{
+			ASIDStats *stats = new ASIDStats();
+			stats->access.resize(num_caches, 0);
+			stats->miss.resize(num_caches, 0);
+			m_asid_stats[asid].reset(stats);
+			for (int i = 0; i < num_caches; i++)
+			{
+				registerStatsMetric(m_name + "_L" + itostr((num_caches + 1) - i), m_core_id, "access_asid" + itostr(asid), &stats->access[i]);
+				registerStatsMetric(m_name + "_L" + itostr((num_caches + 1) - i), m_core_id, "miss_asid" + itostr(asid), &stats->miss[i]);
+			}
+		}
+		m_current_asid_stats = m_asid_stats[asid].get();
+		m_asid = asid;
+	}
+
+	void PWC::flush()
+	{
+		for (int i = 0; i < num_caches; i++)
+			for (UInt32 set = 0; set < m_cache[i]->getNumSets(); set++)
+				for (UInt32 way = 0; way < m_cache[i]->getAssociativity(); way++)
+					m_cache[i]->peekBlock(set, way)->invalidate();
+	}
+
+	void PWC::flushASID(UInt16 asid)
+	{
+		const IntPtr asid_tag = IntPtr(asid + 1);
+		for (int i = 0; i < num_caches; i++)
+		{
+			for (UInt32 set = 0; set < m_cache[i]->getNumSets(); set++)
+			{
+				for (UInt32 way = 0; way < m_cache[i]->getAssociativity(); way++)
+				{
+					CacheBlockInfo *block = m_cache[i]->peekBlock(set, way);
+					if (block->isValid() && (m_cache[i]->tagToAddress(block->getTag()) >> ASID_SHIFT) == asid_tag)
+						block->invalidate();
+				}
+			}
 		}
 	}
 
@@ -37,19 +91,25 @@ namespace ParametricDramDirectoryMSI
 	{
 		bool hit;
 		// TODO model bitmap cache access here
-		hit = m_cache[level_index]->accessSingleLine(address, Cache::LOAD, NULL, 0, now, true);
+		hit = m_cache[level_index]->accessSingleLine(tagAddress(address), Cache::LOAD, NULL, 0, now, true);
 #ifdef DEBUG
 		std::cout << "Accessing address: " << address << " at level: " << level_index << " hit: " << hit << std::endl;
 #endif
 		if (count)
+		{
 			m_access[level_index]++;
+			m_current_asid_stats->access[level_index]++;
+		}
 		if (hit)
 			return hit;
 		else
 		{
 
 			if (count)
+			{
 				m_miss[level_index]++;
+				m_current_asid_stats->miss[level_index]++;
+			}
 			if (allocate_on_miss)
 				allocate(address, now, level_index, ppn);
 			return hit;
@@ -64,9 +124,15 @@ namespace ParametricDramDirectoryMSI
 
 		IntPtr tag;
 		UInt32 set_index;
-		m_cache[cache_index]->splitAddress(address, tag, set_index);
+		m_cache[cache_index]->splitAddress(tagAddress(address), tag, set_index);
 		// PWC entries are page table data
-		m_cache[cache_index]->insertSingleLine(address, NULL, &eviction, &evict_addr, &evict_block_info, NULL, now, NULL, CacheBlockInfo::block_type_t::PAGE_TABLE_DATA);
+		m_cache[cache_index]->insertSingleLine(tagAddress(address), NULL, &eviction, &evict_addr, &evict_block_info, NULL, now, NULL, CacheBlockInfo::block_type_t::PAGE_TABLE_DATA);
+		if (m_prefetching)
+		{
+			m_prefetch_fill[cache_index]++;
+			if (eviction)
+				m_prefetch_evict[cache_index]++;
+		}
 	}
 
 }
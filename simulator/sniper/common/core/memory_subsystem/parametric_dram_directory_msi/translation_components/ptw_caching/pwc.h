@@ -7,6 +7,7 @@
 #include <unordered_map>
 #include "lock.h"
 #include <vector>
+#include <memory>
 
 namespace ParametricDramDirectoryMSI
 {
@@ -26,6 +27,22 @@ namespace ParametricDramDirectoryMSI
 		UInt64 *m_access, *m_miss;
 		int num_caches;
 		bool perfect;
+		UInt64 *m_prefetch_fill, *m_prefetch_evict; // Entries filled by prefetch walks, and the valid entries they replaced
+		bool m_prefetching;                         // Set for the duration of a prefetch walk
+
+		// Entries are tagged with the address space that walked them, as the TLB entries are
+		// (ASID + 1 above the physical address bits, see TLB::tagAddress)
+		static const int ASID_SHIFT = 52;
+		String m_name;
+		UInt16 m_asid;
+		struct ASIDStats
+		{
+			std::vector<UInt64> access, miss; // Per level
+		};
+		std::vector<std::unique_ptr<ASIDStats>> m_asid_stats; // Indexed by ASID, created on first use
+		ASIDStats *m_current_asid_stats;
+
+		IntPtr tagAddress(IntPtr address) const { return address | (IntPtr(m_asid + 1) << ASID_SHIFT); }
 
 	public:
 		enum where_t
@@ -37,6 +54,14 @@ namespace ParametricDramDirectoryMSI
 		PWC(String name, String cfgname, core_id_t core_id, UInt32 *associativities, UInt32 *entries, int num_caches, ComponentLatency _access_latency, ComponentLatency _miss_latency, bool _perfect);
 		bool lookup(IntPtr address, SubsecondTime now, bool allocate_on_miss, int level, bool count, IntPtr ppn = 0);
 		void allocate(IntPtr address, SubsecondTime now, int cache_index, IntPtr ppn);
+		// Attribute the following fills to a prefetch walk, to measure how much prefetch walks pollute the PWC
+		void setPrefetching(bool prefetching) { m_prefetching = prefetching; }
+		// Switch to another address space, keeping the entries of the others (PCID-style)
+		void setASID(UInt16 asid);
+		// Invalidate the entries of all address spaces
+		void flush();
+		// Invalidate the entries of one address space (INVLPG/INVPCID drop its cached walks)
+		void flushASID(UInt16 asid);
 		static const UInt64 HASH_PRIME = 124183;
 	};
 }
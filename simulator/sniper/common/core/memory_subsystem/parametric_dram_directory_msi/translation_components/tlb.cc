@@ -40,6 +40,7 @@ namespace ParametricDramDirectoryMSI
                   CacheBase::PR_L1_CACHE, CacheBase::HASH_MASK,
                   NULL,
                   NULL, true, page_size_list, page_sizes),
+          m_fast_check(false),
           m_type(tlb_type),
           prefetchers(tpb),
           number_of_prefetchers(_number_of_prefetchers),
@@ -48,7 +49,9 @@ namespace ParametricDramDirectoryMSI
           m_allocate_miss(allocate_on_miss),
           m_prefetch(prefetch),
           max_prefetch_count(_max_prefetch_count),
-          m_access_latency(access_latency)
+          m_access_latency(access_latency),
+          m_current_asid_stats(NULL),
+          m_asid(0)
     {
         // Initialize SimLog for TLB (uses DEBUG_TLB flag)
         tlb_log = new SimLog(m_name.c_str(), core_id, DEBUG_TLB);
@@ -56,6 +59,19 @@ namespace ParametricDramDirectoryMSI
 
         LOG_ASSERT_ERROR((num_entries / associativity) * associativity == num_entries, "Invalid TLB configuration: num_entries(%d) must be a multiple of the associativity(%d)", num_entries, associativity);
 
+        // Plain LRU TLBs use the structure-of-arrays storage; other replacement policies
+        // (and perf_model/tlb/fast_path = false) keep going through the generic cache
+        String replacement_policy = Sim()->getCfg()->hasKey(cfgname + "/replacement_policy")
+                                       ? Sim()->getCfg()->getString(cfgname + "/replacement_policy") : "lru";
+        bool fast_path = Sim()->getCfg()->hasKey("perf_model/tlb/fast_path") ? Sim()->getCfg()->getBool("perf_model/tlb/fast_path") : true;
+        if (fast_path && replacement_policy == "lru" && associativity <= TLBStorage<TLBReplacementLRU>::MAX_WAYS)
+        {
+            m_fast_check = Sim()->getCfg()->hasKey("perf_model/tlb/fast_path_check") && Sim()->getCfg()->getBool("perf_model/tlb/fast_path_check");
+            // In check mode the generic cache is driven too and already counts the access-mru-* stats
+            CacheSetInfoLRU *set_info = m_fast_check ? NULL : dynamic_cast<CacheSetInfoLRU *>(m_cache.getSetInfo());
+            m_fast_storage.reset(new TLBStorage<TLBReplacementLRU>(num_entries / associativity, associativity, page_size_list, page_sizes, set_info));
+        }
+
         std::cout << "[MMU] Instantiating TLB: " << m_name << " "
                   << " Core ID: " << m_core_id << " "
                   << " Stores: " << tlb_type << " "
@@ -65,7 +81,8 @@ namespace ParametricDramDirectoryMSI
                   << " Allocate on miss: " << (m_allocate_miss ? "true" : "false") << " "
                   << " Number of prefetchers: " << number_of_prefetchers << " "
                   << " Access latency: " << m_access_latency.getLatency().getNS() << "ns "
-                  << " Page sizes: " << m_page_sizes << std::endl;
+                  << " Page sizes: " << m_page_sizes << " "
+                  << " Fast path: " << (m_fast_storage ? (m_fast_check ? "checked" : "true") : "false") << std::endl;
 
         m_page_size_list = std::unique_ptr<int[]>(new int[m_page_sizes]);
 
@@ -105,31 +122,155 @@ namespace ParametricDramDirectoryMSI
 
         if (m_prefetch)
         {
+            LOG_ASSERT_ERROR(max_prefetch_count > 0, "%s: the prefetch queue needs room for at least one entry", m_name.c_str());
+            m_prefetch_queue.reset(new TLBPrefetchQueue(max_prefetch_count));
+            m_prefetch_buffer.reset(new TLBPrefetchBuffer(max_prefetch_count));
             registerStatsMetric(name, core_id, "pq_dedup_skipped", &tlb_stats.m_pq_dedup_skipped);
         }
 
+        // Threads start in address space 0: set up its statistics (m_asid is already 0, so nothing is flushed)
+        setASID(0);
+    }
+
+    void TLB::setASID(UInt16 asid)
+    {
+        LOG_ASSERT_ERROR(asid < MAX_ASIDS, "%s: ASID %u out of range (at most %u address spaces)", m_name.c_str(), asid, MAX_ASIDS);
+
+        if (asid >= m_asid_stats.size())
+            m_asid_stats.resize(asid + 1);
+        if (!m_asid_stats[asid])
+        {
+            ASIDStats *stats = new ASIDStats();
+            stats->tlb = this;
+            stats->asid = asid;
+            m_asid_stats[asid].reset(stats);
+            registerStatsMetric(m_name, m_core_id, "hits_asid" + itostr(asid), &stats->m_hit);
+            registerStatsMetric(m_name, m_core_id, "misses_asid" + itostr(asid), &stats->m_miss);
+            Sim()->getStatsManager()->registerMetric(new StatsMetricCallback(m_name, m_core_id, "occupancy_asid" + itostr(asid), occupancyCallback, (UInt64)stats));
+        }
+        m_current_asid_stats = m_asid_stats[asid].get();
+
+        if (asid != m_asid)
+        {
+            clearPrefetchQueue();
+            m_asid = asid;
+        }
+    }
+
+    UInt64 TLB::occupancyCallback(String objectName, UInt32 index, String metricName, UInt64 arg)
+    {
+        ASIDStats *stats = (ASIDStats *)arg;
+        return stats->tlb->countEntries(stats->asid);
+    }
+
+    UInt32 TLB::countEntries(UInt16 asid) const
+    {
+        if (m_fast_storage)
+            return m_fast_storage->countEntries([asid](IntPtr address) { return addressASID(address) == asid; });
+
+        UInt32 entries = 0;
+        for (UInt32 set = 0; set < m_cache.getNumSets(); set++)
+        {
+            for (UInt32 way = 0; way < m_cache.getAssociativity(); way++)
+            {
+                CacheBlockInfo *block = m_cache.peekBlock(set, way);
+                if (block->isValid() && addressASID(block->getTag() << block->getPageSize()) == asid)
+                    entries++;
+            }
+        }
+        return entries;
+    }
+
+    void TLB::flush()
+    {
+        if (!m_fast_storage || m_fast_check)
+        {
+            for (UInt32 set = 0; set < m_cache.getNumSets(); set++)
+                for (UInt32 way = 0; way < m_cache.getAssociativity(); way++)
+                    m_cache.peekBlock(set, way)->invalidate();
+        }
+        if (m_fast_storage)
+            m_fast_storage->invalidateAll();
+
+        clearPrefetchQueue();
+
+        SIM_LOG_DEBUG_AT(DEBUG_TLB, tlb_log, "Flushed all entries");
+    }
+
+    template <class Pred>
+    UInt32 TLB::invalidateEntries(Pred pred)
+    {
+        UInt32 entries = 0;
+        if (!m_fast_storage || m_fast_check)
+        {
+            for (UInt32 set = 0; set < m_cache.getNumSets(); set++)
+            {
+                for (UInt32 way = 0; way < m_cache.getAssociativity(); way++)
+                {
+                    CacheBlockInfo *block = m_cache.peekBlock(set, way);
+                    if (block->isValid() && pred(block->getTag() << block->getPageSize(), block->getPageSize(), block->getPPN()))
+                    {
+                        block->invalidate();
+                        entries++;
+                    }
+                }
+            }
+        }
+        if (m_fast_storage)
+        {
+            UInt32 fast_entries = m_fast_storage->invalidateEntries(pred);
+            LOG_ASSERT_ERROR(!m_fast_check || fast_entries == entries, "%s: fast path and generic TLB disagree on invalidation (%u vs %u entries)", m_name.c_str(), fast_entries, entries);
+            entries = fast_entries;
+        }
+
+        // Queued prefetches may hold the same translations
+        clearPrefetchQueue();
+        return entries;
+    }
+
+    UInt32 TLB::flushASID(UInt16 asid)
+    {
+        UInt32 entries = invalidateEntries([asid](IntPtr address, int page_size, IntPtr ppn) { return addressASID(address) == asid; });
+        SIM_LOG_DEBUG_AT(DEBUG_TLB, tlb_log, "Flushed ", entries, " entries of ASID ", asid);
+        return entries;
+    }
+
+    UInt32 TLB::invalidatePage(IntPtr address)
+    {
+        const IntPtr tagged = tag(address);
+        UInt32 entries = invalidateEntries([tagged](IntPtr entry, int page_size, IntPtr ppn) { return entry == ((tagged >> page_size) << page_size); });
+        SIM_LOG_DEBUG_AT(DEBUG_TLB, tlb_log, "Invalidated ", entries, " entries for address ", tagged);
+        return entries;
+    }
+
+    UInt32 TLB::invalidatePhysical(IntPtr ppn)
+    {
+        // Entry PPNs are in 4KB frames; a large page covers 1 << (page_size - 12) of them
+        UInt32 entries = invalidateEntries([ppn](IntPtr address, int page_size, IntPtr entry_ppn) { return ppn >= entry_ppn && ppn - entry_ppn < (IntPtr(1) << (page_size - 12)); });
+        SIM_LOG_DEBUG_AT(DEBUG_TLB, tlb_log, "Invalidated ", entries, " entries for PPN ", ppn);
+        return entries;
     }
 
     CacheBlockInfo *TLB::lookup(IntPtr address, SubsecondTime now, bool model_count, Core::lock_signal_t lock_signal, IntPtr eip, bool modeled, bool count, PageTable *pt, bool instruction)
     {
+        return lookup(TLBProbe(tag(address), m_page_size_list.get(), m_page_sizes), now, model_count, lock_signal, eip, modeled, count, pt, instruction);
+    }
+
+    CacheBlockInfo *TLB::lookup(const TLBProbe &probe, SubsecondTime now, bool model_count, Core::lock_signal_t lock_signal, IntPtr eip, bool modeled, bool count, PageTable *pt, bool instruction)
+    {
+        // The probe is built from the tagged address; prefetchers and logs see the virtual address
+        const IntPtr address = untagAddress(probe.address);
 
         if (m_prefetch)
         {
-            tlb_log->debug("Prefetching enabled at time: ", now.getNS(), " ns");
+            SIM_LOG_DEBUG_AT(DEBUG_TLB, tlb_log, "Prefetching enabled at time: ", now.getNS(), " ns");
 
             // Materialize any prefetched translations whose walks have completed
-            while (!entry_priority_queue.empty() && entry_priority_queue.top().timestamp <= now)
+            while (!m_prefetch_queue->empty() && m_prefetch_queue->top().timestamp <= now)
             {
-                query_entry entry = entry_priority_queue.top();
-                entry_priority_queue.pop();
-                // Decrement region refcount on materialization
-                uint64_t region_id = static_cast<uint64_t>(entry.address) >> 15;  // 32KB region
-                auto it = m_pq_region_refcount.find(region_id);
-                if (it != m_pq_region_refcount.end()) {
-                    if (--it->second == 0)
-                        m_pq_region_refcount.erase(it);
-                }
-                tlb_log->debug("Materializing prefetch for address: ", entry.address, " at time: ", now.getNS(), " ns");
+                query_entry entry = m_prefetch_queue->top();
+                m_prefetch_queue->pop();
+                SIM_LOG_DEBUG_AT(DEBUG_TLB, tlb_log, "Materializing prefetch for address: ", entry.address, " at time: ", now.getNS(), " ns");
                 allocate(entry.address, entry.timestamp, false, lock_signal, entry.page_size, entry.ppn, true);
             }
         }
@@ -146,75 +287,50 @@ namespace ParametricDramDirectoryMSI
             }
         }
 
-        tlb_log->debug("Lookup for address: ", address, " at time: ", now.getNS(), " ns");
+        SIM_LOG_DEBUG_AT(DEBUG_TLB, tlb_log, "Lookup for address: ", address, " at time: ", now.getNS(), " ns");
 
-        CacheBlockInfo *hit = m_cache.accessSingleLineTLB(address, Cache::LOAD, NULL, 0, now, true);
-
-        // Detect whether the hit came from a prefetch-queue-sourced entry.
-        // PQ-materialized entries are tagged with CacheBlockInfo::PREFETCH in allocate().
-        // Clear the flag on demand consumption so the entry looks normal afterwards.
+        // pq_hit: the hit came from a prefetch-queue-sourced entry
         bool pq_hit = false;
-        if (hit && hit->hasOption(CacheBlockInfo::PREFETCH))
-        {
-            pq_hit = true;
-            hit->clearOption(CacheBlockInfo::PREFETCH);
-        }
+        CacheBlockInfo *hit = accessEntry(probe, now, pq_hit);
 
         if (hit)
-            tlb_log->debug("Hit at time: ", now.getNS(), " ns", pq_hit ? " (PQ)" : "");
+            SIM_LOG_DEBUG_AT(DEBUG_TLB, tlb_log, "Hit at time: ", now.getNS(), " ns", pq_hit ? " (PQ)" : "");
         if (!hit)
-            tlb_log->debug("Miss at time: ", now.getNS(), " ns");
+            SIM_LOG_DEBUG_AT(DEBUG_TLB, tlb_log, "Miss at time: ", now.getNS(), " ns");
 
         // Invoke prefetchers on EVERY access (hits + misses) so that:
         //   1. Timeliness tracking sees all demand accesses
         //   2. Predictions are generated based on hit type (miss / PQ hit / regular hit)
         if (m_prefetch && prefetchers != NULL && pt != NULL)
         {
-            tlb_log->debug("Generating prefetches at time: ", now.getNS(), " ns");
+            SIM_LOG_DEBUG_AT(DEBUG_TLB, tlb_log, "Generating prefetches at time: ", now.getNS(), " ns");
 
-            size_t current_prefetches = entry_priority_queue.size();
-            for (int i = 0; i < number_of_prefetchers && current_prefetches < static_cast<size_t>(max_prefetch_count); i++)
+            for (int i = 0; i < number_of_prefetchers && !m_prefetch_queue->full(); i++)
             {
-                tlb_log->debug("Using prefetcher ", i, " at time: ", now.getNS(), " ns");
+                SIM_LOG_DEBUG_AT(DEBUG_TLB, tlb_log, "Using prefetcher ", i, " at time: ", now.getNS(), " ns");
 
-                std::vector<query_entry> generated_prefetches = prefetchers[i]->performPrefetch(address, eip, lock_signal, modeled, count, pt, instruction, /*tlb_hit=*/(hit != NULL), /*pq_hit=*/pq_hit);
-                tlb_log->debug("Prefetcher ", i, " generated ", generated_prefetches.size(), " prefetches at time: ", now.getNS(), " ns");
+                // Failed walks (ppn == 0) never make it into the buffer
+                TLBPrefetchBuffer &generated_prefetches = *m_prefetch_buffer;
+                generated_prefetches.clear();
+                prefetchers[i]->performPrefetch(address, eip, lock_signal, modeled, count, pt, generated_prefetches, instruction, /*tlb_hit=*/(hit != NULL), /*pq_hit=*/pq_hit);
+                SIM_LOG_DEBUG_AT(DEBUG_TLB, tlb_log, "Prefetcher ", i, " generated ", generated_prefetches.size(), " prefetches at time: ", now.getNS(), " ns");
 
                 // PQ dedup: check at region granularity BEFORE inserting the batch.
                 // All PTEs from a single prediction share the same region (1 PTW → 8 PTEs).
                 // Only skip if this region was already pending from a prior prediction.
-                bool batch_deduped = false;
-                if (!generated_prefetches.empty())
+                if (!generated_prefetches.empty() && m_prefetch_queue->containsRegion(generated_prefetches[0].address))
                 {
-                    for (auto &first_valid : generated_prefetches)
-                    {
-                        if (first_valid.ppn == 0) continue;
-                        uint64_t region_id = static_cast<uint64_t>(first_valid.address) >> 15;
-                        if (m_pq_region_refcount.count(region_id) > 0)
-                        {
-                            tlb_stats.m_pq_dedup_skipped++;
-                            batch_deduped = true;
-                        }
-                        break;  // only need to check the first valid entry
-                    }
+                    tlb_stats.m_pq_dedup_skipped++;
+                    continue;
                 }
 
-                if (!batch_deduped)
+                for (const query_entry &pref : generated_prefetches)
                 {
-                    for (auto &pref : generated_prefetches)
-                    {
-                        if (pref.ppn == 0)
-                            continue;
-
-                        tlb_log->debug("Adding prefetch for address: ", pref.address, " at time: ", now.getNS(), " ns");
+                    SIM_LOG_DEBUG_AT(DEBUG_TLB, tlb_log, "Adding prefetch for address: ", pref.address, " at time: ", now.getNS(), " ns");
 
-                        if (current_prefetches >= static_cast<size_t>(max_prefetch_count))
-                            break;
-                        uint64_t region_id = static_cast<uint64_t>(pref.address) >> 15;
-                        entry_priority_queue.push(pref);
-                        m_pq_region_refcount[region_id]++;
-                        current_prefetches++;
-                    }
+                    if (m_prefetch_queue->full())
+                        break;
+                    m_prefetch_queue->push(pref);
                 }
             }
         }
@@ -222,6 +338,7 @@ namespace ParametricDramDirectoryMSI
         if (hit)
         {
             tlb_stats.m_hit++;
+            m_current_asid_stats->m_hit++;
             if (getType() == TLBtype::Unified)
             {
                 if (instruction)
@@ -235,6 +352,7 @@ namespace ParametricDramDirectoryMSI
         if (model_count)
         {
             tlb_stats.m_miss++; // We reach this point if L1 TLB Miss
+            m_current_asid_stats->m_miss++;
             if (getType() == TLBtype::Unified)
             {
                 if (instruction)
@@ -253,26 +371,18 @@ namespace ParametricDramDirectoryMSI
         {
             return TLBAllocResult(false, 0, 0, 0);
         }
-        IntPtr evict_addr;
-        CacheBlockInfo evict_block_info;
-
         IntPtr tag;
         UInt32 set_index;
 
-        m_cache.splitAddressTLB(address, tag, set_index, page_size);
+        // Evicted entries spilled from another level keep the ASID they were tagged with
+        const IntPtr tagged_address = this->tag(address);
+        m_cache.splitAddressTLB(tagged_address, tag, set_index, page_size);
 
-        tlb_log->debug("Allocate ", address, " at level: ", m_name.c_str(), " with page_size ", page_size, " and tag ", tag);
+        SIM_LOG_DEBUG_AT(DEBUG_TLB, tlb_log, "Allocate ", address, " at level: ", m_name.c_str(), " with page_size ", page_size, " and tag ", tag);
 
-        bool eviction = false;
-        m_cache.insertSingleLineTLB(address, NULL, &eviction, &evict_addr, &evict_block_info, NULL, now, NULL, CacheBlockInfo::block_type_t::DATA, page_size, ppn);
-
-        // Mark prefetch-queue-sourced entries so lookup() can detect PQ hits
-        if (self_alloc)
-        {
-            CacheBlockInfo *inserted = m_cache.accessSingleLineTLB(address, Cache::LOAD, NULL, 0, now, false);
-            if (inserted)
-                inserted->setOption(CacheBlockInfo::PREFETCH);
-        }
+        TLBAllocResult evicted = insertEntry(tagged_address, now, page_size, ppn, self_alloc);
+        bool eviction = evicted.evicted;
+        IntPtr evict_addr = untagAddress(evicted.address);
 
         if(count || self_alloc)
         {
@@ -299,14 +409,14 @@ namespace ParametricDramDirectoryMSI
         }
 
         if (eviction)
-            tlb_log->debug("Evicted ", evict_addr, " from level: ", m_name.c_str(), " with page_size ", page_size);
+            SIM_LOG_DEBUG_AT(DEBUG_TLB, tlb_log, "Evicted ", evict_addr, " from level: ", m_name.c_str(), " with page_size ", page_size);
 
         // Notify this TLB's own prefetchers about the evicted victim so they
         // can maintain eviction-aware structures (e.g., the recency list).
         if (eviction && prefetchers != NULL)
         {
             for (int i = 0; i < number_of_prefetchers; i++)
-                prefetchers[i]->notifyVictim(evict_addr, evict_block_info.getPageSize(), evict_block_info.getPPN());
+                prefetchers[i]->notifyVictim(evict_addr, evicted.page_size, evicted.ppn);
         }
 
         // Notify external victim observers (PQ prefetchers wired by the
@@ -316,20 +426,34 @@ namespace ParametricDramDirectoryMSI
         if (eviction && !m_victim_observers.empty())
         {
             for (auto *obs : m_victim_observers)
-                obs->notifyVictim(evict_addr, evict_block_info.getPageSize(), evict_block_info.getPPN());
+                obs->notifyVictim(evict_addr, evicted.page_size, evicted.ppn);
         }
 
-        return TLBAllocResult(eviction, evict_addr, evict_block_info.getPageSize(), evict_block_info.getPPN());
+        return evicted;
     }
 
     bool TLB::invalidate(IntPtr address, int page_size)
     {
-        // Use the TLB-specific invalidation method that uses splitAddressTLB
-        bool invalidated = m_cache.invalidateSingleLineTLB(address, page_size);
+        address = tag(address);
+        bool invalidated;
+        if (m_fast_storage)
+        {
+            invalidated = m_fast_storage->invalidate(address);
+            if (m_fast_check)
+            {
+                bool generic_invalidated = m_cache.invalidateSingleLineTLB(address, page_size);
+                LOG_ASSERT_ERROR(invalidated == generic_invalidated, "%s: fast path and generic TLB disagree on invalidation of %lx", m_name.c_str(), address);
+            }
+        }
+        else
+        {
+            // Use the TLB-specific invalidation method that uses splitAddressTLB
+            invalidated = m_cache.invalidateSingleLineTLB(address, page_size);
+        }
         
         if (invalidated)
         {
-            tlb_log->debug("Invalidated entry for address ", address, " page_size ", page_size);
+            SIM_LOG_DEBUG_AT(DEBUG_TLB, tlb_log, "Invalidated entry for address ", address, " page_size ", page_size);
         }
         
         return invalidated;
@@ -338,9 +462,105 @@ namespace ParametricDramDirectoryMSI
     bool TLB::contains(IntPtr address, int page_size) const
     {
         // Check if entry exists without modifying anything (for sanity checks)
+        address = tag(address);
+        if (m_fast_storage)
+            return m_fast_storage->contains(address);
         return m_cache.containsTLB(address, page_size);
     }
 
+    CacheBlockInfo *TLB::accessEntry(const TLBProbe &probe, SubsecondTime now, bool &pq_hit)
+    {
+        const IntPtr address = probe.address;
+        CacheBlockInfo *generic_hit = NULL;
+        bool generic_pq_hit = false;
+        if (!m_fast_storage || m_fast_check)
+        {
+            generic_hit = m_cache.accessSingleLineTLB(address, Cache::LOAD, NULL, 0, now, true);
+
+            // PQ-materialized entries are tagged with CacheBlockInfo::PREFETCH in allocate().
+            // Clear the flag on demand consumption so the entry looks normal afterwards.
+            if (generic_hit && generic_hit->hasOption(CacheBlockInfo::PREFETCH))
+            {
+                generic_pq_hit = true;
+                generic_hit->clearOption(CacheBlockInfo::PREFETCH);
+            }
+
+            if (!m_fast_storage)
+            {
+                pq_hit = generic_pq_hit;
+                return generic_hit;
+            }
+        }
+
+        typedef TLBStorage<TLBReplacementLRU> Storage;
+        SInt32 slot = m_fast_storage->lookup(probe, true);
+        pq_hit = slot >= 0 && m_fast_storage->hasFlag(slot, Storage::FLAG_PREFETCH);
+        if (pq_hit)
+            m_fast_storage->clearFlag(slot, Storage::FLAG_PREFETCH);
+
+        if (m_fast_check)
+        {
+            LOG_ASSERT_ERROR((slot >= 0) == (generic_hit != NULL) && pq_hit == generic_pq_hit,
+                             "%s: fast path and generic TLB disagree on lookup of %lx (hit %d/%d, pq_hit %d/%d)",
+                             m_name.c_str(), address, slot >= 0, generic_hit != NULL, pq_hit, generic_pq_hit);
+            LOG_ASSERT_ERROR(slot < 0 || (generic_hit->getPPN() == m_fast_storage->getPPN(slot) && generic_hit->getPageSize() == m_fast_storage->getPageSize(slot)),
+                             "%s: fast path and generic TLB disagree on the translation of %lx", m_name.c_str(), address);
+        }
+
+        if (slot < 0)
+            return NULL;
+
+        m_fast_hit.setTag(m_fast_storage->getTag(slot));
+        m_fast_hit.setCState(CacheState::SHARED);
+        m_fast_hit.setPageSize(m_fast_storage->getPageSize(slot));
+        m_fast_hit.setPPN(m_fast_storage->getPPN(slot));
+        return &m_fast_hit;
+    }
+
+    TLBAllocResult TLB::insertEntry(IntPtr address, SubsecondTime now, int page_size, IntPtr ppn, bool self_alloc)
+    {
+        TLBAllocResult generic_result;
+        if (!m_fast_storage || m_fast_check)
+        {
+            IntPtr evict_addr;
+            CacheBlockInfo evict_block_info;
+            bool eviction = false;
+            m_cache.insertSingleLineTLB(address, NULL, &eviction, &evict_addr, &evict_block_info, NULL, now, NULL, CacheBlockInfo::block_type_t::DATA, page_size, ppn);
+
+            // Mark prefetch-queue-sourced entries so lookup() can detect PQ hits
+            if (self_alloc)
+            {
+                CacheBlockInfo *inserted = m_cache.accessSingleLineTLB(address, Cache::LOAD, NULL, 0, now, false);
+                if (inserted)
+                    inserted->setOption(CacheBlockInfo::PREFETCH);
+            }
+
+            generic_result = TLBAllocResult(eviction, evict_addr, evict_block_info.getPageSize(), evict_block_info.getPPN());
+            if (!m_fast_storage)
+                return generic_result;
+        }
+
+        typedef TLBStorage<TLBReplacementLRU> Storage;
+        Storage::Eviction eviction = m_fast_storage->insert(address, page_size, ppn);
+        if (self_alloc)
+        {
+            // Same lookup as the generic path: the first page size that translates address gets the flag
+            SInt32 slot = m_fast_storage->lookup(address, false);
+            if (slot >= 0)
+                m_fast_storage->setFlag(slot, Storage::FLAG_PREFETCH);
+        }
+
+        TLBAllocResult result(eviction.evicted, eviction.address, eviction.page_size, eviction.ppn);
+        if (m_fast_check)
+        {
+            LOG_ASSERT_ERROR(result.evicted == generic_result.evicted && result.address == generic_result.address
+                                 && result.page_size == generic_result.page_size && result.ppn == generic_result.ppn,
+                             "%s: fast path and generic TLB disagree on the victim of %lx (evicted %d/%d, address %lx/%lx)",
+                             m_name.c_str(), address, result.evicted, generic_result.evicted, result.address, generic_result.address);
+        }
+        return result;
+    }
+
     TLB::~TLB()
     {
         delete tlb_log;
@@ -13,6 +13,8 @@
 #include <memory>
 #include "trans_defs.h"
 #include "tlb_prefetcher_base.h"
+#include "tlb_storage.h"
+#include "tlb_prefetch_queue.h"
 #include "sim_log.h"
 
 namespace ParametricDramDirectoryMSI
@@ -26,7 +28,7 @@ namespace ParametricDramDirectoryMSI
 	struct TLBAllocResult
 	{
 		bool evicted;          ///< True if an existing entry was evicted
-		IntPtr address;        ///< Virtual address of the evicted entry (if evicted)
+		IntPtr address;        ///< Virtual address of the evicted entry (if evicted), tagged with its ASID
 		int page_size;         ///< Page size in bits of the evicted entry
 		IntPtr ppn;            ///< Physical page number of the evicted entry
 
@@ -72,6 +74,10 @@ namespace ParametricDramDirectoryMSI
 		UInt32 entry_size;
 
 		Cache m_cache;
+		// Structure-of-arrays storage that replaces m_cache for plain LRU TLBs (NULL otherwise)
+		std::unique_ptr<TLBStorage<TLBReplacementLRU>> m_fast_storage;
+		bool m_fast_check;		   // Also drive m_cache and assert that both agree
+		CacheBlockInfo m_fast_hit; // Entry returned by lookup() when the fast storage hits
 		String m_type;
 		TLBPrefetcherBase **prefetchers;
 		int number_of_prefetchers;
@@ -87,8 +93,9 @@ namespace ParametricDramDirectoryMSI
 		
 		ComponentLatency m_access_latency;
 		
-		std::priority_queue<query_entry, std::vector<query_entry>, Compare> entry_priority_queue;
-		std::unordered_map<uint64_t, uint32_t> m_pq_region_refcount;  // Region ID → number of PQ entries (for dedup)
+		// Prefetch-queue TLBs only: translations being prefetched, and the prefetches emitted by one prefetcher
+		std::unique_ptr<TLBPrefetchQueue> m_prefetch_queue;
+		std::unique_ptr<TLBPrefetchBuffer> m_prefetch_buffer;
 
 		// External observers notified on TLB evictions (e.g., PQ prefetchers
 		// registered by the TLB subsystem so that main-TLB evictions reach
@@ -110,16 +117,54 @@ namespace ParametricDramDirectoryMSI
 
 		} tlb_stats;
 
+		// Per-address-space statistics, created when an ASID is first switched to
+		struct ASIDStats
+		{
+			TLB *tlb;
+			UInt16 asid;
+			UInt64 m_hit, m_miss;
+		};
+		std::vector<std::unique_ptr<ASIDStats>> m_asid_stats; // Indexed by ASID
+		ASIDStats *m_current_asid_stats;
+		UInt16 m_asid; // Address space of the running thread (the PCID)
+
 		SimLog *tlb_log;
 
+		static UInt64 occupancyCallback(String objectName, UInt32 index, String metricName, UInt64 arg);
+
+		// Storage-level access and fill, dispatched to the fast storage or the generic cache
+		CacheBlockInfo *accessEntry(const TLBProbe &probe, SubsecondTime now, bool &pq_hit);
+		TLBAllocResult insertEntry(IntPtr address, SubsecondTime now, int page_size, IntPtr ppn, bool self_alloc);
+		// Invalidate the entries for which pred(tagged address, page size, ppn) holds
+		template <class Pred> UInt32 invalidateEntries(Pred pred);
+		void clearPrefetchQueue() { if (m_prefetch_queue) m_prefetch_queue->clear(); }
+
 	public:
+		/**
+		 * Address space identifiers (PCIDs) are stored in the address bits above any user virtual
+		 * address, as ASID + 1: tags of different address spaces differ while set indices do not,
+		 * and a tagged address can be told apart from an untagged one. The addresses passed to
+		 * lookup(), allocate(), invalidate() and contains() are tagged with the current ASID
+		 * unless they carry a tag already, as the evicted addresses returned by allocate() do.
+		 */
+		static const int ASID_SHIFT = 52;
+		static const UInt32 MAX_ASIDS = (1 << (64 - ASID_SHIFT)) - 1;
+		static IntPtr tagAddress(IntPtr address, UInt16 asid) { return (address & ((IntPtr(1) << ASID_SHIFT) - 1)) | (IntPtr(asid + 1) << ASID_SHIFT); }
+		static IntPtr untagAddress(IntPtr address) { return address & ((IntPtr(1) << ASID_SHIFT) - 1); }
+		static bool isTagged(IntPtr address) { return (address >> ASID_SHIFT) != 0; }
+		static UInt16 addressASID(IntPtr address) { return (address >> ASID_SHIFT) - 1; }
+
 		TLB(String name, String cfgname, core_id_t core_id, ComponentLatency access_latency, UInt32 num_entries, UInt32 associativity, int *page_size_list, int page_sizes, String tlb_type, bool allocate_on_miss, bool prefetch = false, TLBPrefetcherBase **tpb = NULL, int number_of_prefetchers = 0, int max_prefetch_count = 1000);
 		CacheBlockInfo *lookup(IntPtr address, SubsecondTime now, bool model_count, Core::lock_signal_t lock, IntPtr eip, bool modeled, bool count, PageTable *pt, bool instruction = false);
+		// Same as above, with tags precomputed for all page sizes of the hierarchy (the probe must cover this TLB's page sizes)
+		CacheBlockInfo *lookup(const TLBProbe &probe, SubsecondTime now, bool model_count, Core::lock_signal_t lock, IntPtr eip, bool modeled, bool count, PageTable *pt, bool instruction = false);
 		// Returns: TLBAllocResult with eviction flag, evicted address, evicted page size, evicted PPN
 		TLBAllocResult allocate(IntPtr address, SubsecondTime now, bool count, Core::lock_signal_t lock, int page_size, IntPtr ppn, bool self_alloc = false, bool instruction = false);
 		TLBtype getType() { return (m_type == "Instruction") ? Instruction : (m_type == "Data") ? Data
 																								: Unified; };
 		String getName() { return m_name; };
+		const int *getPageSizeList() const { return m_page_size_list.get(); }
+		int getNumPageSizes() const { return m_page_sizes; }
 		Cache& getCache() { return m_cache; };
 		int getAssoc() { return m_associativity; };
 		bool getAllocateOnMiss() { return m_allocate_miss; };
@@ -161,6 +206,31 @@ namespace ParametricDramDirectoryMSI
 		 * @return True if an entry exists for this address
 		 */
 		bool contains(IntPtr address, int page_size) const;
+
+		/**
+		 * @brief Switch to another address space (PCID-style: entries of other ASIDs stay).
+		 *
+		 * Prefetches still in the prefetch queue were issued for the previous address space
+		 * and are dropped.
+		 */
+		void setASID(UInt16 asid);
+		UInt16 getASID() const { return m_asid; }
+		IntPtr tag(IntPtr address) const { return isTagged(address) ? address : tagAddress(address, m_asid); }
+
+		/** @brief Invalidate all entries, of all address spaces */
+		void flush();
+
+		/** @brief Invalidate the entries of address space asid (TLB shootdown of a whole address space) */
+		UInt32 flushASID(UInt16 asid);
+
+		/** @brief Invalidate the entries of any page size translating address (INVLPG) */
+		UInt32 invalidatePage(IntPtr address);
+
+		/** @brief Invalidate the entries, of all address spaces, mapping the 4KB physical page ppn */
+		UInt32 invalidatePhysical(IntPtr ppn);
+
+		/** @brief Number of valid entries of address space asid */
+		UInt32 countEntries(UInt16 asid) const;
 		
 		~TLB();
 	};
@@ -0,0 +1,136 @@
+#ifndef TLB_PREFETCH_QUEUE_H
+#define TLB_PREFETCH_QUEUE_H
+
+#include "fixed_types.h"
+#include "subsecond_time.h"
+#include "trans_defs.h"
+#include "log.h"
+#include <algorithm>
+#include <memory>
+
+namespace ParametricDramDirectoryMSI
+{
+	/**
+	 * @brief Prefetched translations of a prefetch-queue TLB, waiting for their walks to complete.
+	 *
+	 * A min-heap on completion time, kept with std::push_heap/pop_heap and the same comparator
+	 * as the std::priority_queue it replaces, so entries come out in the same order. All storage
+	 * is allocated up front for at most capacity entries.
+	 *
+	 * Prefetches are deduplicated per region: one page-table walk yields the 8 PTEs of a cache
+	 * line, which cover 32KB. The number of queued entries per region is kept in an open-addressed
+	 * table (linear probing, backward-shift deletion) with at least twice as many slots as entries,
+	 * so probe sequences stay short and nothing is allocated on push or pop.
+	 */
+	class TLBPrefetchQueue
+	{
+	public:
+		static const int REGION_SHIFT = 15;
+
+		explicit TLBPrefetchQueue(UInt32 capacity)
+			: m_heap(new query_entry[capacity])
+			, m_capacity(capacity)
+			, m_size(0)
+		{
+			UInt32 slots = 16;
+			while (slots < 2 * capacity)
+				slots <<= 1;
+			m_regions.reset(new Region[slots]());
+			m_region_mask = slots - 1;
+		}
+
+		bool empty() const { return m_size == 0; }
+		bool full() const { return m_size >= m_capacity; }
+		UInt32 size() const { return m_size; }
+
+		// Entry whose walk completes first
+		const query_entry &top() const { return m_heap[0]; }
+
+		void push(const query_entry &entry)
+		{
+			LOG_ASSERT_ERROR(!full(), "TLB prefetch queue overflow (%u entries)", m_capacity);
+			m_heap[m_size++] = entry;
+			std::push_heap(m_heap.get(), m_heap.get() + m_size, Compare());
+			addRegion(regionOf(entry.address));
+		}
+
+		void pop()
+		{
+			removeRegion(regionOf(m_heap[0].address));
+			std::pop_heap(m_heap.get(), m_heap.get() + m_size, Compare());
+			m_size--;
+		}
+
+		// Whether a prefetch for the 32KB region of address is queued
+		bool containsRegion(IntPtr address) const
+		{
+			const UInt64 region = regionOf(address);
+			for (UInt32 slot = home(region); m_regions[slot].count; slot = (slot + 1) & m_region_mask)
+			{
+				if (m_regions[slot].region == region)
+					return true;
+			}
+			return false;
+		}
+
+		void clear()
+		{
+			if (m_size == 0)
+				return;
+			m_size = 0;
+			std::fill(m_regions.get(), m_regions.get() + m_region_mask + 1, Region());
+		}
+
+	private:
+		struct Region
+		{
+			UInt64 region;
+			UInt32 count; // Queued entries of the region, 0 for a free slot
+		};
+
+		std::unique_ptr<query_entry[]> m_heap;
+		UInt32 m_capacity;
+		UInt32 m_size;
+		std::unique_ptr<Region[]> m_regions;
+		UInt32 m_region_mask;
+
+		static UInt64 regionOf(IntPtr address) { return UInt64(address) >> REGION_SHIFT; }
+		UInt32 home(UInt64 region) const { return (region * 0x9e3779b97f4a7c15ULL) >> 32 & m_region_mask; }
+
+		void addRegion(UInt64 region)
+		{
+			UInt32 slot = home(region);
+			while (m_regions[slot].count && m_regions[slot].region != region)
+				slot = (slot + 1) & m_region_mask;
+			m_regions[slot].region = region;
+			m_regions[slot].count++;
+		}
+
+		void removeRegion(UInt64 region)
+		{
+			UInt32 slot = home(region);
+			while (m_regions[slot].region != region || !m_regions[slot].count)
+			{
+				LOG_ASSERT_ERROR(m_regions[slot].count, "TLB prefetch queue region %lx not found", region);
+				slot = (slot + 1) & m_region_mask;
+			}
+			if (--m_regions[slot].count)
+				return;
+
+			// Move later entries of the probe sequence back into the hole, so lookups need no tombstones
+			UInt32 hole = slot;
+			for (UInt32 next = (hole + 1) & m_region_mask; m_regions[next].count; next = (next + 1) & m_region_mask)
+			{
+				// An entry may fill the hole if its home does not lie cyclically in (hole, next]
+				if (((next - home(m_regions[next].region)) & m_region_mask) >= ((next - hole) & m_region_mask))
+				{
+					m_regions[hole] = m_regions[next];
+					m_regions[next].count = 0;
+					hole = next;
+				}
+			}
+		}
+	};
+}
+
+#endif // TLB_PREFETCH_QUEUE_H
@@ -554,7 +554,7 @@ void AgileTLBPrefetcher::processFreePTEsFromCompletedWalk(
 	PageTable *pt, bool insert_into_real_pq,
 	std::vector<uint64_t> *fake_targets_out,
 	SubsecondTime walk_completion_time,
-	std::vector<query_entry> *result_out)
+	TLBPrefetchBuffer *result_out)
 {
 	// SBFP free-neighbor math only applies to 4KB leaf PTEs.
 	// For 2MB / 1GB pages the PTE is at a different radix level
@@ -608,7 +608,7 @@ void AgileTLBPrefetcher::processFreePTEsFromCompletedWalk(
 						fq.ppn       = static_cast<IntPtr>(neighbor_ppn);
 						fq.page_size = static_cast<int>(neighbor_page_size);
 						fq.timestamp = walk_completion_time;
-						result_out->push_back(fq);
+						result_out->push(fq);
 					}
 				}
 			}
@@ -746,16 +746,15 @@ AgileTLBPrefetcher::ATPChild AgileTLBPrefetcher::chooseATPChild() const
 //     (including SBFP free neighbors that would be admitted).
 //  9. Update H2P miss history and MASP stride table.
 //
-// Returns query_entries for the TLB's priority queue (both PQ hits
-// and newly-issued prefetch translations).
+// Pushes the translations for the TLB's priority queue (SBFP free
+// neighbors and newly-issued prefetch translations) into prefetches.
 
-std::vector<query_entry> AgileTLBPrefetcher::performPrefetch(
+void AgileTLBPrefetcher::performPrefetch(
 	IntPtr address, IntPtr eip, Core::lock_signal_t lock,
 	bool modeled, bool count, PageTable *pt,
+	TLBPrefetchBuffer &prefetches,
 	bool instruction, bool tlb_hit, bool pq_hit)
 {
-	std::vector<query_entry> result;
-
 	m_current_instruction = instruction;
 
 	uint64_t vpn = static_cast<uint64_t>(address) >> m_page_shift;
@@ -781,7 +780,7 @@ std::vector<query_entry> AgileTLBPrefetcher::performPrefetch(
 
 	// On any TLB hit (regular or PQ-sourced), skip the demand walk
 	// and all prediction / FPQ logic.
-	if (tlb_hit) return result;
+	if (tlb_hit) return;
 
 	m_stats.queries++;
 
@@ -813,7 +812,7 @@ std::vector<query_entry> AgileTLBPrefetcher::performPrefetch(
 			vpn, static_cast<uint64_t>(demand_q.ppn),
 			static_cast<uint32_t>(demand_q.page_size),
 			pt, /*insert_into_real_pq*/ true, /*fake_targets_out*/ nullptr,
-			demand_q.timestamp, &result);
+			demand_q.timestamp, &prefetches);
 	}
 	else
 	{
@@ -882,9 +881,9 @@ std::vector<query_entry> AgileTLBPrefetcher::performPrefetch(
 					target_vpn, static_cast<uint64_t>(q.ppn),
 					static_cast<uint32_t>(q.page_size),
 					pt, /*insert_into_real_pq*/ true, /*fake_targets_out*/ nullptr,
-					q.timestamp, &result);
+					q.timestamp, &prefetches);
 
-				result.push_back(q);
+				prefetches.push(q);
 			}
 			else
 			{
@@ -967,8 +966,6 @@ std::vector<query_entry> AgileTLBPrefetcher::performPrefetch(
 	// ── 9. Update histories / tables ────────────────────────────
 	updateH2PHistory(vpn);
 	updateMASP(vpn, static_cast<uint64_t>(eip));
-
-	return result;
 }
 
 } // namespace ParametricDramDirectoryMSI
@@ -177,10 +177,10 @@ public:
 	~AgileTLBPrefetcher() override;
 
 	// ── Main entry point ────────────────────────────────────────────
-	std::vector<query_entry> performPrefetch(
+	void performPrefetch(
 		IntPtr address, IntPtr eip, Core::lock_signal_t lock,
 		bool modeled, bool count, PageTable *pt,
-		bool instruction = false, bool tlb_hit = false,
+		TLBPrefetchBuffer &prefetches, bool instruction = false, bool tlb_hit = false,
 		bool pq_hit = false) override;
 
 private:
@@ -299,7 +299,7 @@ private:
 		PageTable *pt, bool insert_into_real_pq,
 		std::vector<uint64_t> *fake_targets_out,
 		SubsecondTime walk_completion_time = SubsecondTime::Zero(),
-		std::vector<query_entry> *result_out = nullptr);
+		TLBPrefetchBuffer *result_out = nullptr);
 
 	std::vector<uint64_t> getSBFPAdmittedFreeVPNs(uint64_t vpn, PageTable *pt);
 
@@ -96,6 +96,7 @@ DistanceTLBPrefetcher::DistanceTLBPrefetcher(
 		row.row_lru = 0;
 		row.slots.resize(m_num_slots);
 	}
+	m_slot_order.reserve(m_num_slots);
 
 	registerAllStats(_core->getId());
 }
@@ -326,11 +327,11 @@ void DistanceTLBPrefetcher::issuePredictionsFromRow(
 	const DPRow &row, uint64_t current_vpn,
 	IntPtr eip, Core::lock_signal_t lock,
 	bool modeled, bool count, PageTable *pt,
-	std::vector<query_entry> &result)
+	TLBPrefetchBuffer &prefetches)
 {
 	// Build sorted index: most recently used slot first (lowest lru).
-	std::vector<uint32_t> order;
-	order.reserve(m_num_slots);
+	std::vector<uint32_t> &order = m_slot_order;
+	order.clear();
 	for (uint32_t i = 0; i < m_num_slots; ++i)
 	{
 		if (row.slots[i].valid)
@@ -376,7 +377,7 @@ void DistanceTLBPrefetcher::issuePredictionsFromRow(
 				m_stats.prefetch_failed++;
 				continue;
 			}
-			result.push_back(q);
+			prefetches.push(q);
 		}
 		else
 		{
@@ -395,7 +396,7 @@ void DistanceTLBPrefetcher::issuePredictionsFromRow(
 			q.page_size    = static_cast<int>(page_size);
 			q.timestamp    = now;
 			q.payload_bits = 0;
-			result.push_back(q);
+			prefetches.push(q);
 		}
 
 		m_stats.prefetch_successful++;
@@ -412,13 +413,13 @@ void DistanceTLBPrefetcher::issuePredictionsFromRow(
 //  performPrefetch – main entry point
 // ═══════════════════════════════════════════════════════════════════
 
-std::vector<query_entry> DistanceTLBPrefetcher::performPrefetch(
+void DistanceTLBPrefetcher::performPrefetch(
 	IntPtr address, IntPtr eip, Core::lock_signal_t lock,
 	bool modeled, bool count, PageTable *pt,
+	TLBPrefetchBuffer &prefetches,
 	bool instruction, bool tlb_hit, bool pq_hit)
 {
-	std::vector<query_entry> result;
-	if (!pt) return result;
+	if (!pt) return;
 
 	uint64_t vpn = static_cast<uint64_t>(address) >> m_page_shift;
 
@@ -430,7 +431,7 @@ std::vector<query_entry> DistanceTLBPrefetcher::performPrefetch(
 
 	// DP only observes the TLB miss stream.
 	if (tlb_hit)
-		return result;
+		return;
 
 	m_stats.tlb_misses++;
 
@@ -440,7 +441,7 @@ std::vector<query_entry> DistanceTLBPrefetcher::performPrefetch(
 		m_have_last_miss = true;
 		m_last_miss_vpn = vpn;
 		m_stats.first_miss_no_distance++;
-		return result;
+		return;
 	}
 
 	// ── Compute current distance ─────────────────────────────────
@@ -462,7 +463,7 @@ std::vector<query_entry> DistanceTLBPrefetcher::performPrefetch(
 	{
 		m_stats.table_hits++;
 		issuePredictionsFromRow(*hit_row, vpn, eip, lock,
-								modeled, count, pt, result);
+								modeled, count, pt, prefetches);
 	}
 	else
 	{
@@ -480,8 +481,6 @@ std::vector<query_entry> DistanceTLBPrefetcher::performPrefetch(
 	m_last_distance = current_distance;
 	m_have_last_distance = true;
 	m_last_miss_vpn = vpn;
-
-	return result;
 }
 
 } // namespace ParametricDramDirectoryMSI
@@ -38,10 +38,10 @@ public:
 
 	~DistanceTLBPrefetcher() override;
 
-	std::vector<query_entry> performPrefetch(
+	void performPrefetch(
 		IntPtr address, IntPtr eip, Core::lock_signal_t lock,
 		bool modeled, bool count, PageTable *pt,
-		bool instruction = false, bool tlb_hit = false,
+		TLBPrefetchBuffer &prefetches, bool instruction = false, bool tlb_hit = false,
 		bool pq_hit = false) override;
 
 private:
@@ -57,7 +57,7 @@ private:
 	void issuePredictionsFromRow(const DPRow &row, uint64_t current_vpn,
 								IntPtr eip, Core::lock_signal_t lock,
 								bool modeled, bool count, PageTable *pt,
-								std::vector<query_entry> &result);
+								TLBPrefetchBuffer &prefetches);
 
 	// ── PT / TLB helpers ─────────────────────────────────────────
 	bool directPageTableLookupVPN(PageTable *pt, uint64_t vpn,
@@ -76,6 +76,7 @@ private:
 
 	// ── Prediction table ─────────────────────────────────────────
 	std::vector<DPRow> m_table;   // size = m_num_rows
+	std::vector<uint32_t> m_slot_order;  // issuePredictionsFromRow() scratch, m_num_slots entries
 
 	// ── PQ duplicate suppression ─────────────────────────────────
 	std::unordered_set<uint64_t> m_recently_predicted;
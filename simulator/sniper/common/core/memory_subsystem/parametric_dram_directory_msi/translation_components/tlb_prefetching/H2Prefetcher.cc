@@ -13,9 +13,8 @@ namespace ParametricDramDirectoryMSI
 		B_address = 0;
 		C_address = 0;
 	}
-	std::vector<query_entry> H2Prefetcher::performPrefetch(IntPtr address, IntPtr eip, Core::lock_signal_t lock, bool modeled, bool count, PageTable *pt, bool instruction, bool tlb_hit, bool pq_hit)
+	void H2Prefetcher::performPrefetch(IntPtr address, IntPtr eip, Core::lock_signal_t lock, bool modeled, bool count, PageTable *pt, TLBPrefetchBuffer &prefetches, bool instruction, bool tlb_hit, bool pq_hit)
 	{
-		vector<query_entry> result;
 		A_address = B_address;
 		B_address = C_address;
 		C_address = address >> 12;
@@ -23,11 +22,9 @@ namespace ParametricDramDirectoryMSI
 
 		if (A_address != 0 && B_address != 0 && C_address != 0)
 		{
-			result.push_back(PTWTransparent((VPN + (C_address - B_address)) << 12, eip, lock, modeled, count, pt));
-			result.push_back(PTWTransparent((VPN + (B_address - A_address)) << 12, eip, lock, modeled, count, pt));
+			prefetches.push(PTWTransparent((VPN + (C_address - B_address)) << 12, eip, lock, modeled, count, pt));
+			prefetches.push(PTWTransparent((VPN + (B_address - A_address)) << 12, eip, lock, modeled, count, pt));
 		}
-		// std::cout << result.size() << std::endl;
-		return result;
 	}
 
 }
@@ -30,6 +30,6 @@ namespace ParametricDramDirectoryMSI
 		IntPtr C_address;
 
 		H2Prefetcher(Core *_core, MemoryManagerBase *_memory_manager, ShmemPerfModel *_shmem_perf_model, String name);
-		std::vector<query_entry> performPrefetch(IntPtr address, IntPtr eip, Core::lock_signal_t lock, bool modeled, bool count, PageTable *pt, bool instruction = false, bool tlb_hit = false, bool pq_hit = false) override;
+		void performPrefetch(IntPtr address, IntPtr eip, Core::lock_signal_t lock, bool modeled, bool count, PageTable *pt, TLBPrefetchBuffer &prefetches, bool instruction = false, bool tlb_hit = false, bool pq_hit = false) override;
 	};
 }
\ No newline at end of file
@@ -471,7 +471,7 @@ void RecencyTLBPrefetcher::issuePredictionCandidate(
 	Core::lock_signal_t lock,
 	bool modeled, bool count,
 	PageTable *pt,
-	std::vector<query_entry> &result,
+	TLBPrefetchBuffer &prefetches,
 	PredictionKind kind,
 	uint32_t extra_pointer_chases)
 {
@@ -497,11 +497,12 @@ void RecencyTLBPrefetcher::issuePredictionCandidate(
 
 	m_stats.prefetch_attempts++;
 
+	query_entry q{};
 	if (m_model_prefetch_walks)
 	{
 		// Use the base-class transparent PTW for a modeled walk.
 		IntPtr pref_addr = static_cast<IntPtr>(candidate_vpn) << m_page_shift;
-		query_entry q = PTWTransparent(pref_addr, eip, lock, modeled, count, pt);
+		q = PTWTransparent(pref_addr, eip, lock, modeled, count, pt);
 		if (q.ppn == 0)
 		{
 			m_stats.prefetch_failed++;
@@ -513,7 +514,6 @@ void RecencyTLBPrefetcher::issuePredictionCandidate(
 			}
 			return;
 		}
-		result.push_back(q);
 	}
 	else
 	{
@@ -532,7 +532,7 @@ void RecencyTLBPrefetcher::issuePredictionCandidate(
 			return;
 		}
 		SubsecondTime now = shmem_perf_model->getElapsedTime(ShmemPerfModel::_USER_THREAD);
-		result.push_back(makeQueryEntry(candidate_vpn, ppn, page_size, now));
+		q = makeQueryEntry(candidate_vpn, ppn, page_size, now);
 	}
 
 	// Charge pointer-chase latency for in-memory list traversal.
@@ -545,8 +545,9 @@ void RecencyTLBPrefetcher::issuePredictionCandidate(
 		SubsecondTime chase_cost = SubsecondTime::Zero();
 		for (uint32_t i = 0; i < extra_pointer_chases; i++)
 			chase_cost += modelPointerChase(candidate_vpn, pt, eip, lock, modeled, count);
-		result.back().timestamp += chase_cost;
+		q.timestamp += chase_cost;
 	}
+	prefetches.push(q);
 
 	m_stats.prefetch_successful++;
 	m_stats.predictions_returned_to_pq++;
@@ -568,13 +569,13 @@ void RecencyTLBPrefetcher::issuePredictionCandidate(
 //  performPrefetch – main entry point
 // ═══════════════════════════════════════════════════════════════════
 
-std::vector<query_entry> RecencyTLBPrefetcher::performPrefetch(
+void RecencyTLBPrefetcher::performPrefetch(
 	IntPtr address, IntPtr eip, Core::lock_signal_t lock,
 	bool modeled, bool count, PageTable *pt,
+	TLBPrefetchBuffer &prefetches,
 	bool instruction, bool tlb_hit, bool pq_hit)
 {
-	std::vector<query_entry> result;
-	if (!pt) return result;
+	if (!pt) return;
 
 	uint64_t vpn = static_cast<uint64_t>(address) >> m_page_shift;
 
@@ -588,7 +589,7 @@ std::vector<query_entry> RecencyTLBPrefetcher::performPrefetch(
 	if (tlb_hit && !m_prefetch_on_tlb_hit)
 	{
 		m_stats.tlb_hits++;
-		return result;
+		return;
 	}
 
 	if (!tlb_hit)
@@ -608,7 +609,7 @@ std::vector<query_entry> RecencyTLBPrefetcher::performPrefetch(
 	if (!node)
 	{
 		m_stats.recency_missing_node++;
-		return result;
+		return;
 	}
 
 	// ── Step 1: consume the pending victim from the prior miss ───
@@ -634,7 +635,7 @@ std::vector<query_entry> RecencyTLBPrefetcher::performPrefetch(
 		minus1_vpn == RECENCY_INVALID_VPN &&
 		plus1_vpn == RECENCY_INVALID_VPN)
 	{
-		return result;
+		return;
 	}
 
 	// ── Generate speculative prefetches → returned as query_entry
@@ -647,17 +648,15 @@ std::vector<query_entry> RecencyTLBPrefetcher::performPrefetch(
 	//   PTE(Y).next → plus1_vpn : 0 extra chases (part of PTE(Y))
 	if (m_prefetch_same_recency)
 		issuePredictionCandidate(same_vpn, eip, lock, modeled, count, pt,
-								result, PRED_SAME, /*extra_pointer_chases=*/0);
+								prefetches, PRED_SAME, /*extra_pointer_chases=*/0);
 
 	if (m_prefetch_recency_minus_1)
 		issuePredictionCandidate(minus1_vpn, eip, lock, modeled, count, pt,
-								result, PRED_MINUS1, /*extra_pointer_chases=*/1);
+								prefetches, PRED_MINUS1, /*extra_pointer_chases=*/1);
 
 	if (m_prefetch_recency_plus_1)
 		issuePredictionCandidate(plus1_vpn, eip, lock, modeled, count, pt,
-								result, PRED_PLUS1, /*extra_pointer_chases=*/0);
-
-	return result;
+								prefetches, PRED_PLUS1, /*extra_pointer_chases=*/0);
 }
 
 } // namespace ParametricDramDirectoryMSI
@@ -49,9 +49,9 @@ public:
 					 bool model_pointer_chase);
 	~RecencyTLBPrefetcher() override;
 
-	std::vector<query_entry> performPrefetch(IntPtr address, IntPtr eip,
+	void performPrefetch(IntPtr address, IntPtr eip,
 		Core::lock_signal_t lock, bool modeled, bool count,
-		PageTable *pt, bool instruction = false,
+		PageTable *pt, TLBPrefetchBuffer &prefetches, bool instruction = false,
 		bool tlb_hit = false, bool pq_hit = false) override;
 
 	void notifyVictim(IntPtr victim_address, int page_size, IntPtr ppn) override;
@@ -94,7 +94,7 @@ public:
 								  Core::lock_signal_t lock,
 								  bool modeled, bool count,
 								  PageTable *pt,
-								  std::vector<query_entry> &result,
+								  TLBPrefetchBuffer &prefetches,
 								 PredictionKind kind,
 								 uint32_t extra_pointer_chases);
 
@@ -72,10 +72,9 @@ namespace ParametricDramDirectoryMSI
 		registerStatsMetric("asp_tlb", core->getId(), "table_accesses", &stats.table_accesses);
 	}
 
-	std::vector<query_entry> ArbitraryStridePrefetcher::performPrefetch(
-		IntPtr address, IntPtr eip, Core::lock_signal_t lock, bool modeled, bool count, PageTable *pt, bool instruction, bool tlb_hit, bool pq_hit)
+	void ArbitraryStridePrefetcher::performPrefetch(
+		IntPtr address, IntPtr eip, Core::lock_signal_t lock, bool modeled, bool count, PageTable *pt, TLBPrefetchBuffer &prefetches, bool instruction, bool tlb_hit, bool pq_hit)
 	{
-		std::vector<query_entry> result;
 		int index = eip % table_size;
 		if (index < 0)
 			index = -index;
@@ -137,7 +136,7 @@ namespace ParametricDramDirectoryMSI
 				{
 					stats.successful_prefetches++;
 					stats.trained_entries++;
-					result.push_back(prefetch_result);
+					prefetches.push(prefetch_result);
 				}
 				else
 				{
@@ -156,7 +155,7 @@ namespace ParametricDramDirectoryMSI
 					{
 						stats.extra_prefetches_successful++;
 						stats.successful_prefetches++;
-						result.push_back(extra_result);
+						prefetches.push(extra_result);
 					}
 					else
 					{
@@ -179,8 +178,6 @@ namespace ParametricDramDirectoryMSI
 			table[index].stride = -1;
 			table[index].saturation_counter = 0;
 		}
-
-		return result;
 	}
 
 }
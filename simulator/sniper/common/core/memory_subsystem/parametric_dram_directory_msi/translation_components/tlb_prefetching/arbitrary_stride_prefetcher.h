@@ -84,6 +84,6 @@ namespace ParametricDramDirectoryMSI
 		std::ofstream log_file;
 
 		ArbitraryStridePrefetcher(Core *_core, MemoryManagerBase *_memory_manager, ShmemPerfModel *_shmem_perf_model, int table_bits, int prefetch_threshold, bool extra_prefetch, int lookahead, int degree, String name);
-		std::vector<query_entry> performPrefetch(IntPtr address, IntPtr eip, Core::lock_signal_t lock, bool modeled, bool count, PageTable *pt, bool instruction = false, bool tlb_hit = false, bool pq_hit = false) override;
+		void performPrefetch(IntPtr address, IntPtr eip, Core::lock_signal_t lock, bool modeled, bool count, PageTable *pt, TLBPrefetchBuffer &prefetches, bool instruction = false, bool tlb_hit = false, bool pq_hit = false) override;
 	};
 }
@@ -22,9 +22,8 @@ namespace ParametricDramDirectoryMSI
 		registerStatsMetric("tlb_stride", core->getId(), "failed_prefetches", &stats.failed_prefetches);
 
 	}
-	std::vector<query_entry> StridePrefetcher::performPrefetch(IntPtr address, IntPtr eip, Core::lock_signal_t lock, bool modeled, bool count, PageTable *pt, bool instruction, bool tlb_hit, bool pq_hit)
+	void StridePrefetcher::performPrefetch(IntPtr address, IntPtr eip, Core::lock_signal_t lock, bool modeled, bool count, PageTable *pt, TLBPrefetchBuffer &prefetches, bool instruction, bool tlb_hit, bool pq_hit)
 	{
-		vector<query_entry> result;
 		IntPtr VPN = address >> 12; // We assume that the page size is 4KB
 		for (int i = -length; i <= length; i++)
 		{
@@ -37,7 +36,7 @@ namespace ParametricDramDirectoryMSI
 				#endif 
 				if(result_ptw.ppn!=0){		
 					stats.successful_prefetches++;
-					result.push_back(result_ptw);
+					prefetches.push(result_ptw);
 				}
 				else{
 					stats.failed_prefetches++;
@@ -45,7 +44,6 @@ namespace ParametricDramDirectoryMSI
 
 			}
 		}
-		return result;
 	}
 
 }
\ No newline at end of file
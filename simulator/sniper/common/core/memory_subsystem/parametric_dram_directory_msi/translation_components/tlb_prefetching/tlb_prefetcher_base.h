@@ -8,6 +8,7 @@
 #include "pagetable.h"
 #include "cache_block_info.h"
 #include "trans_defs.h"
+#include <memory>
 #include <vector>
 
 namespace ParametricDramDirectoryMSI
@@ -15,6 +16,41 @@ namespace ParametricDramDirectoryMSI
 
 	class TLB;  // Forward declaration for TLB residency check
 
+	/**
+	 * @brief Prefetches emitted by one prefetcher during one TLB access.
+	 *
+	 * The storage is allocated once by the TLB that owns the buffer and reused on every access.
+	 * Failed translations (ppn == 0) are not kept, and prefetches beyond the capacity are
+	 * dropped, as the TLB's prefetch queue could not take them anyway.
+	 */
+	class TLBPrefetchBuffer
+	{
+	public:
+		explicit TLBPrefetchBuffer(UInt32 capacity)
+			: m_entries(new query_entry[capacity])
+			, m_capacity(capacity)
+			, m_size(0)
+		{}
+
+		void push(const query_entry &entry)
+		{
+			if (entry.ppn != 0 && m_size < m_capacity)
+				m_entries[m_size++] = entry;
+		}
+		void clear() { m_size = 0; }
+
+		bool empty() const { return m_size == 0; }
+		UInt32 size() const { return m_size; }
+		const query_entry &operator[](UInt32 index) const { return m_entries[index]; }
+		const query_entry *begin() const { return m_entries.get(); }
+		const query_entry *end() const { return m_entries.get() + m_size; }
+
+	private:
+		std::unique_ptr<query_entry[]> m_entries;
+		UInt32 m_capacity;
+		UInt32 m_size;
+	};
+
 	class TLBPrefetcherBase
 	{
 
@@ -48,6 +84,7 @@ namespace ParametricDramDirectoryMSI
 		virtual void notifyVictim(IntPtr /*victim_address*/, int /*page_size*/, IntPtr /*ppn*/) {}
 
 		virtual query_entry PTWTransparent(IntPtr address, IntPtr eip, Core::lock_signal_t lock, bool modeled, bool count, PageTable *pt);
-		virtual std::vector<query_entry> performPrefetch(IntPtr address, IntPtr eip, Core::lock_signal_t lock, bool modeled, bool count, PageTable *pt, bool instruction = false, bool tlb_hit = false, bool pq_hit = false) = 0;
+		// Called by the TLB on every access: push the translations to prefetch into prefetches
+		virtual void performPrefetch(IntPtr address, IntPtr eip, Core::lock_signal_t lock, bool modeled, bool count, PageTable *pt, TLBPrefetchBuffer &prefetches, bool instruction = false, bool tlb_hit = false, bool pq_hit = false) = 0;
 	};
 }
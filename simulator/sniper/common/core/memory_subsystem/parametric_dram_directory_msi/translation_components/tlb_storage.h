@@ -0,0 +1,321 @@
+#ifndef TLB_STORAGE_H
+#define TLB_STORAGE_H
+
+#include "fixed_types.h"
+#include "cache_set_lru.h"
+#include "log.h"
+#include <memory>
+
+namespace ParametricDramDirectoryMSI
+{
+	/**
+	 * @brief Virtual page numbers of one address for every page size probed during a translation.
+	 *
+	 * Built once per translation by the TLB hierarchy; every TLB level then reads its tags and
+	 * set indices from here instead of re-deriving them per page size and per structure. Only
+	 * the page sizes passed to the constructor are filled in.
+	 */
+	struct TLBProbe
+	{
+		static const int MAX_PAGE_SIZE_BITS = 64;
+
+		IntPtr address;
+		IntPtr vpn[MAX_PAGE_SIZE_BITS]; // Indexed by page size in bits
+
+		TLBProbe(IntPtr _address, const int *page_size_list, int page_sizes)
+			: address(_address)
+		{
+			for (int i = 0; i < page_sizes; i++)
+				vpn[page_size_list[i]] = _address >> page_size_list[i];
+		}
+	};
+
+	/**
+	 * @brief LRU replacement for TLBStorage.
+	 *
+	 * Mirrors CacheSetLRU (without QBS) bit for bit: same recency counters, same choice of
+	 * the lowest invalid way, same victim on ties, same access-mru-* statistics.
+	 */
+	class TLBReplacementLRU
+	{
+	public:
+		void init(UInt32 num_sets, UInt32 ways)
+		{
+			m_ways = ways;
+			m_bits.reset(new UInt8[num_sets * ways]);
+			for (UInt32 i = 0; i < num_sets * ways; i++)
+				m_bits[i] = i % ways;
+		}
+
+		// Demand hit with update_replacement (CacheSetLRU::updateReplacementIndex)
+		void touch(UInt32 set, UInt32 way, CacheSetInfoLRU *set_info)
+		{
+			if (set_info)
+				set_info->increment(m_bits[set * m_ways + way]);
+			moveToMRU(set, way);
+		}
+
+		// Way to fill given the mask of invalid ways (CacheSetLRU::getReplacementIndex)
+		UInt32 victim(UInt32 set, UInt64 invalid_mask)
+		{
+			UInt32 way;
+			if (invalid_mask)
+			{
+				way = __builtin_ctzll(invalid_mask);
+			}
+			else
+			{
+				const UInt8 *bits = &m_bits[set * m_ways];
+				UInt8 max_bits = 0;
+				way = 0;
+				for (UInt32 i = 0; i < m_ways; i++)
+				{
+					if (bits[i] > max_bits)
+					{
+						way = i;
+						max_bits = bits[i];
+					}
+				}
+			}
+			moveToMRU(set, way);
+			return way;
+		}
+
+	private:
+		void moveToMRU(UInt32 set, UInt32 way)
+		{
+			UInt8 *bits = &m_bits[set * m_ways];
+			const UInt8 accessed = bits[way];
+			for (UInt32 i = 0; i < m_ways; i++)
+				bits[i] += (bits[i] < accessed);
+			bits[way] = 0;
+		}
+
+		UInt32 m_ways;
+		std::unique_ptr<UInt8[]> m_bits;
+	};
+
+	/**
+	 * @brief Structure-of-arrays TLB storage.
+	 *
+	 * Host-side fast path for TLB::lookup/allocate. Each entry is reduced to one 64-bit key
+	 * (tag and page size packed together) stored contiguously per set, so a probe is a single
+	 * branch-free compare over all ways that the compiler vectorizes, instead of chasing one
+	 * CacheBlockInfo pointer per way. PPNs, page sizes and flags live in parallel arrays and
+	 * are only touched on a hit or a fill.
+	 *
+	 * The generic path keeps the highest matching way and treats a match on any page size in
+	 * list order as the hit; this storage reproduces that exactly, so hit/miss sequences and
+	 * evictions are identical to Cache::accessSingleLineTLB/insertSingleLineTLB.
+	 */
+	template <class Replacement>
+	class TLBStorage
+	{
+	public:
+		static const UInt8 FLAG_PREFETCH = 1 << 0; // Materialized from the prefetch queue, not yet demanded
+		static const UInt32 MAX_WAYS = 64;		   // Ways are tracked in a 64-bit mask
+		static const int MAX_PAGE_SIZES = 8;	   // Page sizes probed together in one lookup
+
+		struct Eviction
+		{
+			bool evicted;
+			IntPtr address;
+			int page_size;
+			IntPtr ppn;
+		};
+
+		TLBStorage(UInt32 num_sets, UInt32 ways, const int *page_size_list, int page_sizes, CacheSetInfoLRU *set_info)
+			: m_num_sets(num_sets)
+			, m_ways(ways)
+			, m_page_sizes(page_sizes)
+			, m_page_size_list(new int[page_sizes])
+			, m_keys(new UInt64[num_sets * ways])
+			, m_ppns(new IntPtr[num_sets * ways])
+			, m_entry_page_sizes(new UInt8[num_sets * ways]())
+			, m_flags(new UInt8[num_sets * ways]())
+			, m_set_info(set_info)
+		{
+			LOG_ASSERT_ERROR(ways <= MAX_WAYS, "TLBStorage supports at most %u ways (got %u)", MAX_WAYS, ways);
+			LOG_ASSERT_ERROR(page_sizes <= MAX_PAGE_SIZES, "TLBStorage supports at most %d page sizes (got %d)", MAX_PAGE_SIZES, page_sizes);
+			for (int i = 0; i < page_sizes; i++)
+				m_page_size_list[i] = page_size_list[i];
+			for (UInt32 i = 0; i < num_sets * ways; i++)
+			{
+				m_keys[i] = INVALID_KEY;
+				m_ppns[i] = 0;
+			}
+			m_replacement.init(num_sets, ways);
+		}
+
+		/**
+		 * Slot of the entry translating the probed address, or -1. update_replacement as in
+		 * Cache::accessSingleLineTLB. All page sizes are probed in one pass (the candidate sets
+		 * are independent), then the first page size in list order that hits wins.
+		 */
+		SInt32 lookup(const TLBProbe &probe, bool update_replacement)
+		{
+			UInt32 sets[MAX_PAGE_SIZES];
+			UInt64 masks[MAX_PAGE_SIZES];
+			for (int i = 0; i < m_page_sizes; i++)
+			{
+				const int page_size = m_page_size_list[i];
+				const IntPtr vpn = probe.vpn[page_size];
+				sets[i] = vpn & (m_num_sets - 1);
+				masks[i] = match(sets[i], (static_cast<UInt64>(vpn) << KEY_PAGE_SIZE_BITS) | page_size);
+			}
+
+			for (int i = 0; i < m_page_sizes; i++)
+			{
+				if (!masks[i])
+					continue;
+
+				const UInt32 way = 63 - __builtin_clzll(masks[i]); // Highest matching way, as CacheSet::findTLB
+				if (update_replacement)
+					m_replacement.touch(sets[i], way, m_set_info);
+				return sets[i] * m_ways + way;
+			}
+			return -1;
+		}
+
+		SInt32 lookup(IntPtr address, bool update_replacement)
+		{
+			return lookup(TLBProbe(address, m_page_size_list.get(), m_page_sizes), update_replacement);
+		}
+
+		bool contains(IntPtr address) const
+		{
+			for (int i = 0; i < m_page_sizes; i++)
+			{
+				const int page_size = m_page_size_list[i];
+				if (match(setIndex(address, page_size), makeKey(address, page_size)))
+					return true;
+			}
+			return false;
+		}
+
+		Eviction insert(IntPtr address, int page_size, IntPtr ppn)
+		{
+			const UInt32 set = setIndex(address, page_size);
+			const UInt32 way = m_replacement.victim(set, match(set, INVALID_KEY));
+			const UInt32 slot = set * m_ways + way;
+
+			// Same values Cache::insertSingleLineTLB reports through evict_addr/evict_block_info
+			Eviction eviction;
+			eviction.evicted = m_keys[slot] != INVALID_KEY;
+			if (eviction.evicted)
+			{
+				eviction.address = keyTag(m_keys[slot]) << m_entry_page_sizes[slot];
+				eviction.page_size = m_entry_page_sizes[slot];
+				eviction.ppn = m_ppns[slot];
+			}
+			else
+			{
+				eviction.address = static_cast<IntPtr>(~0) << page_size;
+				eviction.page_size = 0;
+				eviction.ppn = 0;
+			}
+
+			m_keys[slot] = makeKey(address, page_size);
+			m_ppns[slot] = ppn;
+			m_entry_page_sizes[slot] = page_size;
+			m_flags[slot] = 0;
+			return eviction;
+		}
+
+		/** Invalidates every entry translating address, at any page size */
+		bool invalidate(IntPtr address)
+		{
+			bool found = false;
+			for (int i = 0; i < m_page_sizes; i++)
+			{
+				const int page_size = m_page_size_list[i];
+				const UInt32 set = setIndex(address, page_size);
+				UInt64 mask = match(set, makeKey(address, page_size));
+				found |= (mask != 0);
+				for (; mask; mask &= mask - 1)
+					m_keys[set * m_ways + __builtin_ctzll(mask)] = INVALID_KEY;
+			}
+			return found;
+		}
+
+		void invalidateAll()
+		{
+			for (UInt32 i = 0; i < m_num_sets * m_ways; i++)
+				m_keys[i] = INVALID_KEY;
+		}
+
+		/** Invalidates every valid entry for which pred(address, page_size, ppn) holds, returns how many */
+		template <class Pred>
+		UInt32 invalidateEntries(Pred pred)
+		{
+			UInt32 entries = 0;
+			for (UInt32 i = 0; i < m_num_sets * m_ways; i++)
+			{
+				if (m_keys[i] != INVALID_KEY && pred(keyTag(m_keys[i]) << m_entry_page_sizes[i], m_entry_page_sizes[i], m_ppns[i]))
+				{
+					m_keys[i] = INVALID_KEY;
+					entries++;
+				}
+			}
+			return entries;
+		}
+
+		/** Number of valid entries whose (page-aligned) address satisfies pred */
+		template <class Pred>
+		UInt32 countEntries(Pred pred) const
+		{
+			UInt32 entries = 0;
+			for (UInt32 i = 0; i < m_num_sets * m_ways; i++)
+				if (m_keys[i] != INVALID_KEY && pred(keyTag(m_keys[i]) << m_entry_page_sizes[i]))
+					entries++;
+			return entries;
+		}
+
+		IntPtr getTag(SInt32 slot) const { return keyTag(m_keys[slot]); }
+		IntPtr getPPN(SInt32 slot) const { return m_ppns[slot]; }
+		int getPageSize(SInt32 slot) const { return m_entry_page_sizes[slot]; }
+		bool hasFlag(SInt32 slot, UInt8 flag) const { return m_flags[slot] & flag; }
+		void setFlag(SInt32 slot, UInt8 flag) { m_flags[slot] |= flag; }
+		void clearFlag(SInt32 slot, UInt8 flag) { m_flags[slot] &= ~flag; }
+
+	private:
+		// Tags are at most 52 bits (page size >= 12), leaving the low 6 bits for the page size;
+		// a valid key therefore never equals INVALID_KEY
+		static const UInt64 INVALID_KEY = ~0ULL;
+		static const int KEY_PAGE_SIZE_BITS = 6;
+
+		static UInt64 makeKey(IntPtr address, int page_size)
+		{
+			return (static_cast<UInt64>(address >> page_size) << KEY_PAGE_SIZE_BITS) | page_size;
+		}
+		static IntPtr keyTag(UInt64 key) { return key >> KEY_PAGE_SIZE_BITS; }
+
+		// CacheBase::HASH_MASK indexing, as used by every TLB
+		UInt32 setIndex(IntPtr address, int page_size) const { return (address >> page_size) & (m_num_sets - 1); }
+
+		// Bitmask of the ways of set holding key
+		UInt64 match(UInt32 set, UInt64 key) const
+		{
+			const UInt64 *keys = &m_keys[set * m_ways];
+			UInt64 mask = 0;
+			for (UInt32 i = 0; i < m_ways; i++)
+				mask |= static_cast<UInt64>(keys[i] == key) << i;
+			return mask;
+		}
+
+		const UInt32 m_num_sets;
+		const UInt32 m_ways;
+		const int m_page_sizes;
+		std::unique_ptr<int[]> m_page_size_list;
+
+		std::unique_ptr<UInt64[]> m_keys;
+		std::unique_ptr<IntPtr[]> m_ppns;
+		std::unique_ptr<UInt8[]> m_entry_page_sizes;
+		std::unique_ptr<UInt8[]> m_flags;
+
+		Replacement m_replacement;
+		CacheSetInfoLRU *m_set_info; // Owned by the backing Cache, NULL if it keeps its own statistics
+	};
+}
+
+#endif // TLB_STORAGE_H
@@ -8,6 +8,7 @@
 #include "tlb_prefetcher_factory.h"
 #include "pagesize_predictor_factory.h"
 #include "dvfs_manager.h"
+#include <algorithm>
 
 using namespace boost::algorithm;
 using namespace std;
@@ -20,6 +21,7 @@ namespace ParametricDramDirectoryMSI
         
             std::cout << "[MMU] Instantiating TLB Hierarchy" << std::endl;
             page_size_predictor = NULL;
+            m_asid = 0;
             numLevels = Sim()->getCfg()->getInt("perf_model/"+mmu_name+"/tlb_subsystem/number_of_levels");
         
             prefetch_enabled = Sim()->getCfg()->getBool("perf_model/"+mmu_name+"/tlb_subsystem/prefetch_enabled");
@@ -210,6 +212,86 @@ namespace ParametricDramDirectoryMSI
             }
         }
 
+        for (auto &level : tlbLevels)
+        {
+            for (auto *tlb : level)
+            {
+                for (int i = 0; i < tlb->getNumPageSizes(); i++)
+                {
+                    int page_size = tlb->getPageSizeList()[i];
+                    LOG_ASSERT_ERROR(page_size > 0 && page_size < TLBProbe::MAX_PAGE_SIZE_BITS, "Invalid TLB page size: %d bits", page_size);
+                    if (std::find(m_probe_page_sizes.begin(), m_probe_page_sizes.end(), page_size) == m_probe_page_sizes.end())
+                        m_probe_page_sizes.push_back(page_size);
+                }
+            }
+        }
+    }
+
+    TLBHit TLBHierarchy::lookup(IntPtr address, bool instruction, SubsecondTime now, bool count, Core::lock_signal_t lock, IntPtr eip, bool modeled, PageTable *pt)
+    {
+        const TLBProbe probe(TLB::tagAddress(address, m_asid), m_probe_page_sizes.data(), m_probe_page_sizes.size());
+        const TLBSubsystem &path = instruction ? instruction_path : data_path;
+
+        TLBHit result;
+        for (UInt32 level = 0; level < path.size(); level++)
+        {
+            for (TLB *tlb : path[level])
+            {
+                CacheBlockInfo *entry = tlb->lookup(probe, now, count, lock, eip, modeled, count, pt, instruction);
+                if (entry != NULL)
+                {
+                    result.tlb = tlb;
+                    result.level = level;
+                    result.page_size = entry->getPageSize();
+                    result.ppn = entry->getPPN();
+                }
+            }
+            if (result.tlb != NULL)
+                break;
+        }
+        return result;
+    }
+
+    void TLBHierarchy::switchAddressSpace(UInt16 asid, bool flush)
+    {
+        for (auto &level : tlbLevels)
+        {
+            for (auto *tlb : level)
+            {
+                if (flush)
+                    tlb->flush();
+                tlb->setASID(asid);
+            }
+        }
+        m_asid = asid;
+    }
+
+    void TLBHierarchy::invalidatePage(UInt16 asid, IntPtr address)
+    {
+        for (auto &level : tlbLevels)
+            for (auto *tlb : level)
+                tlb->invalidatePage(TLB::tagAddress(address, asid));
+    }
+
+    void TLBHierarchy::invalidatePhysical(IntPtr ppn)
+    {
+        for (auto &level : tlbLevels)
+            for (auto *tlb : level)
+                tlb->invalidatePhysical(ppn);
+    }
+
+    void TLBHierarchy::flushAddressSpace(UInt16 asid)
+    {
+        for (auto &level : tlbLevels)
+            for (auto *tlb : level)
+                tlb->flushASID(asid);
+    }
+
+    void TLBHierarchy::flush()
+    {
+        for (auto &level : tlbLevels)
+            for (auto *tlb : level)
+                tlb->flush();
     }
 
     /*
@@ -11,6 +11,21 @@ namespace ParametricDramDirectoryMSI
 
 	typedef std::vector<std::vector<TLB *>> TLBSubsystem;
 
+	/**
+	 * @brief Outcome of a search through the TLB hierarchy.
+	 *
+	 * On a miss, tlb is NULL and level is -1.
+	 */
+	struct TLBHit
+	{
+		TLB *tlb;       ///< TLB that provided the translation
+		int level;      ///< Level of that TLB (0 = L1)
+		int page_size;  ///< Page size in bits of the hitting entry
+		IntPtr ppn;     ///< Physical page number of the hitting entry
+
+		TLBHit() : tlb(NULL), level(-1), page_size(-1), ppn(0) {}
+	};
+
 	class TLBHierarchy
 	{
 
@@ -25,14 +40,43 @@ namespace ParametricDramDirectoryMSI
 		int numTLBsPerLevel;
 
 		std::vector<std::vector<ComponentLatency>> tlb_latencies;
+		std::vector<int> m_probe_page_sizes; // Union of the page sizes of all TLBs, precomputed by lookup()
+		UInt16 m_asid;                       // Address space the TLBs are looked up in
 
 	public:
 		bool prefetch_enabled;
 		TLBHierarchy(String mmu_name, Core *core, MemoryManagerBase *memory_manager, ShmemPerfModel *shmem_perf_model);
 		~TLBHierarchy();
-		TLBSubsystem getTLBSubsystem() { return tlbLevels; }
-		TLBSubsystem getDataPath() { return data_path; }
-		TLBSubsystem getInstructionPath() { return instruction_path; }
+		const TLBSubsystem& getTLBSubsystem() { return tlbLevels; }
+		const TLBSubsystem& getDataPath() { return data_path; }
+		const TLBSubsystem& getInstructionPath() { return instruction_path; }
+		/**
+		 * @brief Search the instruction or data path level by level until a TLB hits.
+		 *
+		 * Tags for every page size are computed once for the whole search. All TLBs of a
+		 * level are looked up (they are accessed in parallel); later levels are skipped
+		 * after a hit.
+		 */
+		TLBHit lookup(IntPtr address, bool instruction, SubsecondTime now, bool count, Core::lock_signal_t lock, IntPtr eip, bool modeled, PageTable *pt);
+		/**
+		 * @brief Make asid the current address space of all TLBs.
+		 *
+		 * With flush, all entries are invalidated first (a context switch without PCIDs);
+		 * otherwise entries of other address spaces stay, tagged with their ASID.
+		 */
+		void switchAddressSpace(UInt16 asid, bool flush);
+		UInt16 getASID() const { return m_asid; }
+		/**
+		 * @brief TLB shootdown targets, applied to every TLB.
+		 *
+		 * invalidatePage() removes the translations of address in address space asid at any page
+		 * size, invalidatePhysical() those mapping the 4KB physical page ppn in any address space,
+		 * flushAddressSpace() all translations of asid.
+		 */
+		void invalidatePage(UInt16 asid, IntPtr address);
+		void invalidatePhysical(IntPtr ppn);
+		void flushAddressSpace(UInt16 asid);
+		void flush();
 		bool isPrefetchEnabled() { return prefetch_enabled; }
 		int getNumLevels() { return numLevels; }
 		int predictPagesize(IntPtr eip);
@@ -0,0 +1,69 @@
+#ifndef __HYPERLOGLOG_H__
+#define __HYPERLOGLOG_H__
+
+#include "fixed_types.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+// Estimated number of distinct 64-bit keys, in fixed memory (HyperLogLog, Flajolet et al.)
+//
+// 2^precision one-byte registers each keep the longest run of leading zeros seen among the hashes
+// routed to them. The standard error is about 1.04 / sqrt(2^precision): 0.8% for the 16 KB of
+// precision 14. Inserting is a hash and a byte compare; estimating walks all registers, so it is
+// meant for statistics output, not for every insert.
+class HyperLogLog
+{
+   public:
+      HyperLogLog(int precision = 14)
+         : m_precision(precision)
+         , m_registers(1 << precision, 0)
+      {
+         assert(precision >= 4 && precision <= 24);
+      }
+
+      void insert(UInt64 key)
+      {
+         UInt64 hash = mix(key);
+         UInt32 index = hash >> (64 - m_precision);
+         // The guard bit bounds the rank when the remaining bits are all zero
+         UInt8 rank = __builtin_clzll((hash << m_precision) | (1ULL << (m_precision - 1))) + 1;
+         if (rank > m_registers[index])
+            m_registers[index] = rank;
+      }
+
+      UInt64 estimate() const
+      {
+         const double m = m_registers.size();
+         double sum = 0;
+         UInt32 zeros = 0;
+         for (UInt8 rank : m_registers)
+         {
+            sum += std::ldexp(1.0, -rank);
+            zeros += (rank == 0);
+         }
+         double estimate = (0.7213 / (1 + 1.079 / m)) * m * m / sum;
+         // Few keys: count the empty registers instead (linear counting), more accurate there
+         if (estimate <= 2.5 * m && zeros)
+            estimate = m * std::log(m / zeros);
+         return estimate + 0.5;
+      }
+
+      void clear() { std::fill(m_registers.begin(), m_registers.end(), 0); }
+
+   private:
+      const int m_precision;
+      std::vector<UInt8> m_registers;
+
+      // splitmix64 finalizer: line and page numbers differ in their low bits only
+      static UInt64 mix(UInt64 key)
+      {
+         key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+         key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+         return key ^ (key >> 31);
+      }
+};
+
+#endif /* __HYPERLOGLOG_H__ */
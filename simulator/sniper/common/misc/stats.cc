@@ -1,6 +1,7 @@
 #include "stats.h"
 #include "simulator.h"
 #include "hooks_manager.h"
+#include "config.hpp"
 #include "utils.h"
 #include "itostr.h"
 
@@ -32,6 +33,27 @@ const char db_insert_stmt_name[] = "INSERT INTO `names` (nameid, objectname, met
 const char db_insert_stmt_prefix[] = "INSERT INTO `prefixes` (prefixid, prefixname) VALUES (?, ?);";
 const char db_insert_stmt_value[] = "INSERT INTO `values` (prefixid, nameid, core, value) VALUES (?, ?, ?, ?);";
 
+// Binary backend (general/stats_backend = binary)
+//
+// Names, prefixes, topology and events still go into sim.stats.sqlite3, they are written rarely.
+// Values are appended to sim.stats.bin instead of the `values` table, which
+// tools/stats_bin2sqlite.py fills in after the run. The file is a header followed by records,
+// all fields in host byte order:
+//
+//   header:   char magic[8] = "SNSTATS", UInt32 version, UInt32 0
+//   metric:   UInt32 BIN_RECORD_METRIC, UInt32 slot, UInt64 nameid, UInt32 core, UInt32 flags
+//   snapshot: UInt32 BIN_RECORD_SNAPSHOT, UInt32 count, UInt64 prefixid,
+//             UInt32 slot[count], UInt64 delta[count]
+//
+// Metric records number the metrics in registration order (slots). A snapshot holds only the
+// slots whose value changed since the previous snapshot, with the change (modulo 2^64): the
+// value of a slot is the sum of its deltas so far. Like the sqlite backend, a snapshot has no
+// value for metrics with BIN_FLAG_DEFAULT_ZERO set that are zero.
+const char bin_magic[8] = "SNSTATS";
+const UInt32 bin_version = 1;
+enum { BIN_RECORD_METRIC = 1, BIN_RECORD_SNAPSHOT = 2 };
+enum { BIN_FLAG_DEFAULT_ZERO = 1 };
+
 UInt64 getWallclockTimeCallback(String objectName, UInt32 index, String metricName, UInt64 arg)
 {
    struct timeval tv = {0,0};
@@ -43,7 +65,9 @@ UInt64 getWallclockTimeCallback(String objectName, UInt32 index, String metricNa
 StatsManager::StatsManager()
    : m_keyid(0)
    , m_prefixnum(0)
+   , m_backend(BACKEND_SQLITE)
    , m_db(NULL)
+   , m_bin(NULL)
 {
    init();
 
@@ -64,6 +88,8 @@ StatsManager::~StatsManager()
       sqlite3_finalize(m_stmt_insert_value);
       sqlite3_close(m_db);
    }
+   if (m_bin)
+      fclose(m_bin);
 }
 
 void
@@ -99,6 +125,34 @@ StatsManager::init()
       }
    }
    sqlite3_exec(m_db, "END TRANSACTION", NULL, NULL, NULL);
+
+   String backend = Sim()->getCfg()->getString("general/stats_backend");
+   String bin_filename = Sim()->getConfig()->formatOutputFileName("sim.stats.bin");
+   unlink(bin_filename.c_str());
+   if (backend == "sqlite")
+   {
+      m_backend = BACKEND_SQLITE;
+   }
+   else if (backend == "binary")
+   {
+      m_backend = BACKEND_BINARY;
+      m_bin = fopen(bin_filename.c_str(), "wb");
+      LOG_ASSERT_ERROR(m_bin, "Cannot create %s", bin_filename.c_str());
+      setvbuf(m_bin, NULL, _IOFBF, 1 << 20);
+
+      UInt32 header[2] = { bin_version, 0 };
+      writeBinary(bin_magic, sizeof(bin_magic));
+      writeBinary(header, sizeof(header));
+      for(UInt32 slot = 0; slot < m_metrics.size(); ++slot)
+      {
+         std::string _objectName(m_metrics[slot]->objectName.c_str()), _metricName(m_metrics[slot]->metricName.c_str());
+         recordMetricSlot(slot, m_objects[_objectName][_metricName].first, m_metrics[slot]);
+      }
+   }
+   else
+   {
+      LOG_PRINT_ERROR("Invalid general/stats_backend %s, expected sqlite or binary", backend.c_str());
+   }
 }
 
 int
@@ -125,6 +179,20 @@ StatsManager::recordMetricName(UInt64 keyId, std::string objectName, std::string
    LOG_ASSERT_ERROR(res == SQLITE_DONE, "Error executing SQL statement");
 }
 
+void
+StatsManager::recordMetricSlot(UInt32 slot, UInt64 keyId, StatsMetricBase *metric)
+{
+   UInt32 record[6] = { BIN_RECORD_METRIC, slot, 0, 0, metric->index, metric->isDefaultZero() ? (UInt32)BIN_FLAG_DEFAULT_ZERO : 0 };
+   memcpy(&record[2], &keyId, sizeof(keyId));
+   writeBinary(record, sizeof(record));
+}
+
+void
+StatsManager::writeBinary(const void *data, size_t size)
+{
+   LOG_ASSERT_ERROR(fwrite(data, 1, size, m_bin) == size, "Error writing sim.stats.bin");
+}
+
 void
 StatsManager::recordStats(String prefix)
 {
@@ -145,6 +213,18 @@ StatsManager::recordStats(String prefix)
    res = sqlite3_step(m_stmt_insert_prefix);
    LOG_ASSERT_ERROR(res == SQLITE_DONE, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
 
+   if (m_backend == BACKEND_BINARY)
+      recordValuesBinary(prefixid);
+   else
+      recordValuesSqlite(prefixid);
+
+   res = sqlite3_exec(m_db, "END TRANSACTION", NULL, NULL, NULL);
+   LOG_ASSERT_ERROR(res == SQLITE_OK, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
+}
+
+void
+StatsManager::recordValuesSqlite(int prefixid)
+{
    for(StatsObjectList::iterator it1 = m_objects.begin(); it1 != m_objects.end(); ++it1)
    {
       for (StatsMetricList::iterator it2 = it1->second.begin(); it2 != it1->second.end(); ++it2)
@@ -158,14 +238,39 @@ StatsManager::recordStats(String prefix)
                sqlite3_bind_int(m_stmt_insert_value, 2, it2->second.first);   // Metric ID
                sqlite3_bind_int(m_stmt_insert_value, 3, it3->second->index);  // Core ID
                sqlite3_bind_int64(m_stmt_insert_value, 4, it3->second->recordMetric());
-               res = sqlite3_step(m_stmt_insert_value);
+               int res = sqlite3_step(m_stmt_insert_value);
                LOG_ASSERT_ERROR(res == SQLITE_DONE, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
             }
          }
       }
    }
-   res = sqlite3_exec(m_db, "END TRANSACTION", NULL, NULL, NULL);
-   LOG_ASSERT_ERROR(res == SQLITE_OK, "Error executing SQL statement: %s", sqlite3_errmsg(m_db));
+}
+
+void
+StatsManager::recordValuesBinary(int prefixid)
+{
+   // Read all metrics into the flat array, keeping the changes since the last snapshot
+   m_delta_slots.clear();
+   m_delta_values.clear();
+   for(UInt32 slot = 0; slot < m_metrics.size(); ++slot)
+   {
+      UInt64 value = m_metrics[slot]->recordMetric();
+      if (value != m_values[slot])
+      {
+         m_delta_slots.push_back(slot);
+         m_delta_values.push_back(value - m_values[slot]);
+         m_values[slot] = value;
+      }
+   }
+
+   UInt32 record[4] = { BIN_RECORD_SNAPSHOT, (UInt32)m_delta_slots.size(), 0, 0 };
+   UInt64 _prefixid = prefixid;
+   memcpy(&record[2], &_prefixid, sizeof(_prefixid));
+   writeBinary(record, sizeof(record));
+   writeBinary(m_delta_slots.data(), m_delta_slots.size() * sizeof(UInt32));
+   writeBinary(m_delta_values.data(), m_delta_values.size() * sizeof(UInt64));
+   // Keep the file usable if the simulation does not exit cleanly
+   fflush(m_bin);
 }
 
 void
@@ -176,6 +281,8 @@ StatsManager::registerMetric(StatsMetricBase *metric)
    LOG_ASSERT_ERROR(m_objects[_objectName][_metricName].second.count(metric->index) == 0,
       "Duplicate statistic %s.%s[%d]", _objectName.c_str(), _metricName.c_str(), metric->index);
    m_objects[_objectName][_metricName].second[metric->index] = metric;
+   m_metrics.push_back(metric);
+   m_values.push_back(0);
 
    if (m_objects[_objectName][_metricName].first == 0)
    {
@@ -186,6 +293,8 @@ StatsManager::registerMetric(StatsMetricBase *metric)
          recordMetricName(m_keyid, _objectName, _metricName);
       }
    }
+   if (m_bin)
+      recordMetricSlot(m_metrics.size() - 1, m_objects[_objectName][_metricName].first, metric);
 }
 
 StatsMetricBase *
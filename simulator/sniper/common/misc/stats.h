@@ -3,7 +3,9 @@
 #include "simulator.h"
 #include "itostr.h"
 
+#include <cstdio>
 #include <cstring>
+#include <vector>
 #include <sqlite3.h>
 
 class StatsMetricBase
@@ -18,6 +20,7 @@ class StatsMetricBase
       virtual ~StatsMetricBase() {}
       virtual UInt64 recordMetric() = 0;
       virtual bool isDefault() { return false; } // Return true when value hasn't changed from its initialization value
+      virtual bool isDefaultZero() { return false; } // Return true when isDefault() is recordMetric() == 0
 };
 
 template <class T> UInt64 makeStatsValue(T t);
@@ -37,6 +40,7 @@ template <class T> class StatsMetric : public StatsMetricBase
       {
          return recordMetric() == 0;
       }
+      virtual bool isDefaultZero() { return true; }
 };
 
 typedef UInt64 (*StatsCallback)(String objectName, UInt32 index, String metricName, UInt64 arg);
@@ -80,8 +84,14 @@ class StatsManager
       void logEvent(event_type_t event, SubsecondTime time, core_id_t core_id, thread_id_t thread_id, UInt64 value0, UInt64 value1, const char * description);
 
    private:
+      typedef enum {
+         BACKEND_SQLITE,         // Values are inserted into sim.stats.sqlite3 at every snapshot
+         BACKEND_BINARY,         // Values are appended to sim.stats.bin, see stats.cc
+      } backend_t;
+
       UInt64 m_keyid;
       UInt64 m_prefixnum;
+      backend_t m_backend;
 
       sqlite3 *m_db;
       sqlite3_stmt *m_stmt_insert_name;
@@ -95,10 +105,21 @@ class StatsManager
       typedef std::unordered_map<std::string, StatsMetricList> StatsObjectList;
       StatsObjectList m_objects;
 
+      // Binary backend: all metrics in registration order, and their values at the last snapshot
+      FILE *m_bin;
+      std::vector<StatsMetricBase *> m_metrics;
+      std::vector<UInt64> m_values;
+      std::vector<UInt32> m_delta_slots;
+      std::vector<UInt64> m_delta_values;
+
       static int __busy_handler(void* self, int count) { return ((StatsManager*)self)->busy_handler(count); }
       int busy_handler(int count);
 
       void recordMetricName(UInt64 keyId, std::string objectName, std::string metricName);
+      void recordMetricSlot(UInt32 slot, UInt64 keyId, StatsMetricBase *metric);
+      void recordValuesSqlite(int prefixid);
+      void recordValuesBinary(int prefixid);
+      void writeBinary(const void *data, size_t size);
 };
 
 template <class T> void registerStatsMetric(String objectName, UInt32 index, String metricName, T *metric)
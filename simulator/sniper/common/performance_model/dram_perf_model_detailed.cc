@@ -159,6 +159,8 @@ DramPerfModelDetailed::DramPerfModelDetailed(core_id_t core_id, UInt32 cache_blo
    , m_total_queue_depth_at_access_data(0)
    , m_total_queue_depth_at_access_metadata(0)
    // Hot row tracking
+   , m_hot_rows(HOT_ROW_TRACKING_SIZE)
+   , m_hot_rows_per_bank(m_total_banks, 0)
    , m_hot_row_accesses_data(0)
    , m_hot_row_accesses_metadata(0)
    , m_cold_row_accesses_data(0)
@@ -298,6 +300,7 @@ DramPerfModelDetailed::DramPerfModelDetailed(core_id_t core_id, UInt32 cache_blo
       m_banks[bank].max_time = SubsecondTime::Zero();
       m_banks[bank].max_page = -1;
       m_banks[bank].open_page_type = NOT_METADATA;
+      m_banks[bank].m_bank_busy_intervals = IntervalRing<IntervalNode>(MAX_BUSY_INTERVALS + 1);
       // Row buffer utilization tracking
       m_banks[bank].columns_accessed.reset();
       m_banks[bank].data_accesses = 0;
@@ -404,6 +407,9 @@ DramPerfModelDetailed::DramPerfModelDetailed(core_id_t core_id, UInt32 cache_blo
    registerStatsMetric(ddr_name, core_id, "hot-row-accesses-metadata", &m_hot_row_accesses_metadata);
    registerStatsMetric(ddr_name, core_id, "cold-row-accesses-data", &m_cold_row_accesses_data);
    registerStatsMetric(ddr_name, core_id, "cold-row-accesses-metadata", &m_cold_row_accesses_metadata);
+   // Per-bank histogram of the hot rows
+   for (UInt32 bank = 0; bank < m_total_banks; ++bank)
+      registerStatsMetric(ddr_name, core_id, "hot-rows-bank-" + itostr(bank), &m_hot_rows_per_bank[bank]);
 
    // Register same-bank co-residency statistics
    registerStatsMetric(ddr_name, core_id, "banks-with-mixed-access", &m_banks_with_mixed_access);
@@ -632,18 +638,16 @@ DramPerfModelDetailed::fallsWithinInterval(UInt64 page, SubsecondTime pkt_time,
       return {pkt_time, IntervalNode()};
    }
 
-   // Copy the priority queue to iterate without modifying original
-   std::priority_queue<IntervalNode> temp = m_banks[bank].m_bank_busy_intervals;
+   const IntervalRing<IntervalNode> &intervals = m_banks[bank].m_bank_busy_intervals;
 
    IntervalNode last_interval;
    last_interval.start_time = SubsecondTime::Zero();
    last_interval.end_time = SubsecondTime::Zero();
    last_interval.open_page = -1;
 
-   while (!temp.empty())
+   for (UInt32 i = 0; i < intervals.size(); ++i)
    {
-      IntervalNode interval = temp.top();
-      temp.pop();
+      const IntervalNode &interval = intervals[i];
 
       if (interval.start_time > pkt_time)
       {
@@ -681,29 +685,34 @@ DramPerfModelDetailed::fallsWithinInterval(UInt64 page, SubsecondTime pkt_time,
 }
 
 /**
- * @brief Remove the oldest busy interval from a bank
- * Called when the interval queue exceeds the maximum size limit.
+ * @brief Record a busy interval of a bank
+ * Only the MAX_BUSY_INTERVALS latest starting intervals are kept.
  */
-void DramPerfModelDetailed::cleanupBusyIntervals(IntPtr bank)
+void DramPerfModelDetailed::addBusyInterval(IntPtr bank, const IntervalNode &node)
 {
-   m_banks[bank].m_bank_busy_intervals.pop();
+   IntervalRing<IntervalNode> &intervals = m_banks[bank].m_bank_busy_intervals;
+
+   // Intervals mostly arrive in order: search for the insert position from the back
+   UInt32 index = intervals.size();
+   while (index > 0 && intervals[index - 1].start_time > node.start_time)
+      --index;
+   intervals.insert(index, node);
+
+   if (intervals.size() > MAX_BUSY_INTERVALS)
+      intervals.pop_front();
 }
 
 /**
  * @brief Debug helper to print all busy intervals for a bank
  */
-void DramPerfModelDetailed::printInterval(std::priority_queue<IntervalNode> intervals)
+void DramPerfModelDetailed::printInterval(const IntervalRing<IntervalNode> &intervals)
 {
-   if (!m_log.isEnabled(SimLog::LEVEL_TRACE)) {
-      (void)intervals;
+   if (!m_log.isEnabled(SimLog::LEVEL_TRACE))
       return;
-   }
 
-   std::priority_queue<IntervalNode> temp = intervals;
-   while (!temp.empty())
+   for (UInt32 i = 0; i < intervals.size(); ++i)
    {
-      IntervalNode interval = temp.top();
-      temp.pop();
+      const IntervalNode &interval = intervals[i];
       m_log.trace("Interval: [", interval.start_time.getNS(), "ns -",
                   interval.end_time.getNS(), "ns] Page:", interval.open_page);
    }
@@ -806,23 +815,26 @@ SubsecondTime DramPerfModelDetailed::getAccessLatency(SubsecondTime pkt_time, UI
 
    //--- Track hot/cold row accesses ---
    UInt64 full_page_id = (crb << 32) | addr.page;  // Combine bank and page for unique ID
-   auto page_it = m_page_access_count.find(full_page_id);
-   if (page_it != m_page_access_count.end()) {
-      // Hot row - seen before
-      page_it->second++;
-      if (is_metadata)
-         m_hot_row_accesses_metadata++;
-      else
-         m_hot_row_accesses_data++;
-   } else {
-      // Cold row - first access
-      if (m_page_access_count.size() < HOT_ROW_TRACKING_SIZE) {
-         m_page_access_count[full_page_id] = 1;
-      }
-      if (is_metadata)
-         m_cold_row_accesses_metadata++;
-      else
-         m_cold_row_accesses_data++;
+   UInt64 replaced_page_id = 0;
+   switch (m_hot_rows.access(full_page_id, &replaced_page_id)) {
+      case HotRowTracker::HOT:
+         // Hot row - seen before
+         if (is_metadata)
+            m_hot_row_accesses_metadata++;
+         else
+            m_hot_row_accesses_data++;
+         break;
+      case HotRowTracker::REPLACED:
+         m_hot_rows_per_bank[replaced_page_id >> 32]--;
+         // fall through
+      case HotRowTracker::INSERTED:
+         // Cold row - first access, or not accessed since it dropped out of the top N
+         m_hot_rows_per_bank[crb]++;
+         if (is_metadata)
+            m_cold_row_accesses_metadata++;
+         else
+            m_cold_row_accesses_data++;
+         break;
    }
    //--- Track PTW (Page Table Walk) bank access patterns ---
    // Use MetadataContext for explicit PTW info if available (indexed by requester core_id)
@@ -1169,13 +1181,9 @@ SubsecondTime DramPerfModelDetailed::getAccessLatency(SubsecondTime pkt_time, UI
 
    // Record this access interval for out-of-order handling
    IntervalNode node{t_avail, t_now, static_cast<IntPtr>(addr.page)};
-   bank_info.m_bank_busy_intervals.push(node);
+   addBusyInterval(crb, node);
    printInterval(bank_info.m_bank_busy_intervals);
 
-   // Limit interval history size to prevent memory growth
-   if (bank_info.m_bank_busy_intervals.size() > 100)
-      cleanupBusyIntervals(crb);
-
    // Add the larger of rank or bank group delay
    t_now += std::max(rank_avail_delay, group_avail_delay);
    perf->updateTime(t_now, ShmemPerf::DRAM_DEVICE);
@@ -8,6 +8,8 @@
 #include "dram_cntlr_interface.h"
 #include "address_home_lookup.h"
 #include "dram_address_mapping.h"
+#include "hot_row_tracker.h"
+#include "interval_ring.h"
 #include "sim_log.h"
 
 #include <vector>
@@ -83,12 +85,10 @@ class DramPerfModelDetailed : public DramPerfModel
          SubsecondTime start_time; // Start of the interval
          SubsecondTime end_time;   // End of the interval
          IntPtr open_page;         // Page that is open during this interval
-         // Priority: based on interval length (example)
-         bool operator<(const IntervalNode& node) const {
-            return (start_time) > (node.start_time);
-         }
       };
 
+      static const UInt32 MAX_BUSY_INTERVALS = 100;  // Busy intervals kept per bank, the latest starting ones
+
 
       struct BankInfo
       {
@@ -98,7 +98,7 @@ class DramPerfModelDetailed : public DramPerfModel
          SubsecondTime max_time;
          IntPtr max_page;
          page_type open_page_type;
-         std::priority_queue<IntervalNode> m_bank_busy_intervals;
+         IntervalRing<IntervalNode> m_bank_busy_intervals;  // Sorted by start_time
 
          // Row buffer utilization tracking
          std::bitset<128> columns_accessed;   // Bitmap of accessed columns (supports up to 128 columns)
@@ -246,7 +246,8 @@ class DramPerfModelDetailed : public DramPerfModel
       // Hot row tracking (per-page access frequency)
       //=========================================================================
       static const UInt32 HOT_ROW_TRACKING_SIZE = 1024;  // Track top N hot rows
-      std::map<UInt64, UInt64> m_page_access_count;       // page -> access count
+      HotRowTracker m_hot_rows;                           // (bank << 32 | page) -> access count, top N only
+      std::vector<UInt64> m_hot_rows_per_bank;            // Rows of m_hot_rows in each bank
       UInt64 m_hot_row_accesses_data;      // Accesses to rows that have been accessed before
       UInt64 m_hot_row_accesses_metadata;
       UInt64 m_cold_row_accesses_data;     // First access to a row
@@ -308,8 +309,8 @@ class DramPerfModelDetailed : public DramPerfModel
       bool m_csv_logging_enabled;
 
       std::pair<SubsecondTime, IntervalNode> fallsWithinInterval(UInt64 page, SubsecondTime pkt_time, IntPtr bank);
-      void cleanupBusyIntervals(IntPtr bank);
-      void printInterval(std::priority_queue<IntervalNode> intervals);
+      void addBusyInterval(IntPtr bank, const IntervalNode &node);
+      void printInterval(const IntervalRing<IntervalNode> &intervals);
       void recordRowClose(UInt32 bank, bool is_metadata);
       void recordPTWComplete();                 // Record completed PTW trace
 
@@ -0,0 +1,150 @@
+#include "hot_row_tracker.h"
+#include "log.h"
+
+#include <utility>
+
+const UInt32 HotRowTracker::EMPTY;
+
+HotRowTracker::HotRowTracker(UInt32 capacity)
+   : m_capacity(capacity)
+{
+   LOG_ASSERT_ERROR(capacity > 0, "Hot row tracker needs room for at least one row");
+   m_heap.reserve(capacity);
+
+   // At most half full, so probe sequences stay short
+   UInt32 slots = 16;
+   m_shift = 64 - 4;
+   while (slots < 2 * capacity)
+   {
+      slots *= 2;
+      m_shift--;
+   }
+   m_slots.assign(slots, EMPTY);
+   m_mask = slots - 1;
+}
+
+HotRowTracker::result_t
+HotRowTracker::access(UInt64 row, UInt64 *replaced)
+{
+   UInt32 slot = find(row);
+   if (slot != EMPTY)
+   {
+      UInt32 index = m_slots[slot];
+      m_heap[index].count++;
+      siftDown(index);
+      return HOT;
+   }
+
+   if (m_heap.size() < m_capacity)
+   {
+      Entry entry = { row, 1, 0, 0 };
+      m_heap.push_back(entry);
+      m_heap.back().slot = place(row, m_heap.size() - 1);
+      siftUp(m_heap.size() - 1);
+      return INSERTED;
+   }
+
+   // Take over the least counted row
+   Entry &victim = m_heap[0];
+   *replaced = victim.row;
+   erase(victim.slot);
+   victim.row = row;
+   victim.error = victim.count;
+   victim.count++;
+   victim.slot = place(row, 0);
+   siftDown(0);
+   return REPLACED;
+}
+
+UInt64
+HotRowTracker::getCount(UInt64 row) const
+{
+   UInt32 slot = find(row);
+   return slot == EMPTY ? 0 : m_heap[m_slots[slot]].count;
+}
+
+UInt64
+HotRowTracker::getError(UInt64 row) const
+{
+   UInt32 slot = find(row);
+   return slot == EMPTY ? 0 : m_heap[m_slots[slot]].error;
+}
+
+UInt32
+HotRowTracker::find(UInt64 row) const
+{
+   for (UInt32 slot = hash(row); m_slots[slot] != EMPTY; slot = (slot + 1) & m_mask)
+   {
+      if (m_heap[m_slots[slot]].row == row)
+         return slot;
+   }
+   return EMPTY;
+}
+
+UInt32
+HotRowTracker::place(UInt64 row, UInt32 index)
+{
+   UInt32 slot = hash(row);
+   while (m_slots[slot] != EMPTY)
+      slot = (slot + 1) & m_mask;
+   m_slots[slot] = index;
+   return slot;
+}
+
+void
+HotRowTracker::erase(UInt32 slot)
+{
+   // Backward-shift deletion: move up later entries of the probe sequence that may not
+   // sit before their home slot, so that lookups need no tombstones
+   m_slots[slot] = EMPTY;
+   for (UInt32 next = (slot + 1) & m_mask; m_slots[next] != EMPTY; next = (next + 1) & m_mask)
+   {
+      UInt32 home = hash(m_heap[m_slots[next]].row);
+      bool stays = (next > slot) ? (home > slot && home <= next) : (home > slot || home <= next);
+      if (stays)
+         continue;
+      m_slots[slot] = m_slots[next];
+      m_heap[m_slots[slot]].slot = slot;
+      m_slots[next] = EMPTY;
+      slot = next;
+   }
+}
+
+void
+HotRowTracker::swap(UInt32 a, UInt32 b)
+{
+   std::swap(m_heap[a], m_heap[b]);
+   m_slots[m_heap[a].slot] = a;
+   m_slots[m_heap[b].slot] = b;
+}
+
+void
+HotRowTracker::siftUp(UInt32 index)
+{
+   while (index > 0)
+   {
+      UInt32 parent = (index - 1) / 2;
+      if (m_heap[parent].count <= m_heap[index].count)
+         break;
+      swap(index, parent);
+      index = parent;
+   }
+}
+
+void
+HotRowTracker::siftDown(UInt32 index)
+{
+   while (true)
+   {
+      UInt32 smallest = index;
+      UInt32 left = 2 * index + 1, right = 2 * index + 2;
+      if (left < m_heap.size() && m_heap[left].count < m_heap[smallest].count)
+         smallest = left;
+      if (right < m_heap.size() && m_heap[right].count < m_heap[smallest].count)
+         smallest = right;
+      if (smallest == index)
+         break;
+      swap(index, smallest);
+      index = smallest;
+   }
+}
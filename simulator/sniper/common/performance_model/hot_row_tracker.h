@@ -0,0 +1,60 @@
+#ifndef __HOT_ROW_TRACKER_H__
+#define __HOT_ROW_TRACKER_H__
+
+#include "fixed_types.h"
+
+#include <vector>
+
+// Approximate top-K of the most accessed DRAM rows (Space-Saving, Metwally et al.)
+//
+// At most capacity rows are tracked. A row that is not tracked replaces the tracked row with the
+// lowest count and inherits that count plus one, so the counts are upper bounds, off by at most
+// the inherited part (getError()). Rows are kept in a min-heap on count, found through an
+// open-addressing table that points into the heap; all memory is allocated by the constructor.
+class HotRowTracker
+{
+   public:
+      typedef enum
+      {
+         HOT,        // row was tracked already
+         INSERTED,   // row is tracked now, there was room for it
+         REPLACED,   // row is tracked now, in place of *replaced
+      } result_t;
+
+      HotRowTracker(UInt32 capacity);
+
+      // Count one access to row
+      result_t access(UInt64 row, UInt64 *replaced);
+
+      UInt32 size() const { return m_heap.size(); }
+      // Estimated number of accesses to row, 0 if it is not tracked
+      UInt64 getCount(UInt64 row) const;
+      UInt64 getError(UInt64 row) const;
+
+   private:
+      struct Entry
+      {
+         UInt64 row;
+         UInt64 count;
+         UInt64 error;  // Part of count inherited from the row it replaced
+         UInt32 slot;   // Its slot in m_slots
+      };
+
+      static const UInt32 EMPTY = ~UInt32(0);
+
+      const UInt32 m_capacity;
+      std::vector<Entry> m_heap;    // Min-heap on count
+      std::vector<UInt32> m_slots;  // Index into m_heap, or EMPTY
+      UInt32 m_mask;
+      int m_shift;
+
+      UInt32 hash(UInt64 row) const { return (row * 0x9e3779b97f4a7c15ULL) >> m_shift; }
+      UInt32 find(UInt64 row) const;
+      void erase(UInt32 slot);
+      UInt32 place(UInt64 row, UInt32 index);
+      void swap(UInt32 a, UInt32 b);
+      void siftUp(UInt32 index);
+      void siftDown(UInt32 index);
+};
+
+#endif /* __HOT_ROW_TRACKER_H__ */
@@ -0,0 +1,77 @@
+#ifndef __INTERVAL_RING_H__
+#define __INTERVAL_RING_H__
+
+#include "fixed_types.h"
+
+#include <cassert>
+#include <vector>
+
+// Bounded, ordered sequence of time intervals in a ring buffer allocated up front
+//
+// The interval histories of the DRAM and queue models are short, ordered by time, and mostly
+// modified at their newest end: a ring buffer keeps them in one block of memory, without the node
+// allocations of std::list or std::priority_queue, and inserting near the back moves few elements.
+template <class T> class IntervalRing
+{
+   public:
+      IntervalRing(UInt32 capacity = 0)
+         : m_first(0)
+         , m_size(0)
+      {
+         UInt32 slots = 1;
+         while (slots < capacity)
+            slots *= 2;
+         m_slots.resize(slots);
+         m_mask = slots - 1;
+      }
+
+      UInt32 size() const { return m_size; }
+      bool empty() const { return m_size == 0; }
+      UInt32 capacity() const { return m_slots.size(); }
+
+      // Element index, counting from the front
+      T& operator[](UInt32 index) { return m_slots[(m_first + index) & m_mask]; }
+      const T& operator[](UInt32 index) const { return m_slots[(m_first + index) & m_mask]; }
+      T& front() { return (*this)[0]; }
+      T& back() { return (*this)[m_size - 1]; }
+
+      void push_back(const T& t)
+      {
+         assert(m_size < capacity());
+         (*this)[m_size++] = t;
+      }
+
+      void pop_front()
+      {
+         assert(m_size > 0);
+         m_first = (m_first + 1) & m_mask;
+         m_size--;
+      }
+
+      // Insert t before element index, moving the elements after it back
+      void insert(UInt32 index, const T& t)
+      {
+         assert(m_size < capacity() && index <= m_size);
+         for (UInt32 i = m_size; i > index; --i)
+            (*this)[i] = (*this)[i - 1];
+         (*this)[index] = t;
+         m_size++;
+      }
+
+      // Remove element index, moving the elements after it forward
+      void erase(UInt32 index)
+      {
+         assert(index < m_size);
+         for (UInt32 i = index; i + 1 < m_size; ++i)
+            (*this)[i] = (*this)[i + 1];
+         m_size--;
+      }
+
+   private:
+      std::vector<T> m_slots;
+      UInt32 m_mask;
+      UInt32 m_first;
+      UInt32 m_size;
+};
+
+#endif /* __INTERVAL_RING_H__ */
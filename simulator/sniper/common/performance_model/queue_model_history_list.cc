@@ -37,6 +37,8 @@ QueueModelHistoryList::QueueModelHistoryList(String name, UInt32 id, SubsecondTi
       LOG_PRINT_ERROR("Could not read parameters from cfg");
    }
    m_max_free_interval_list_size = max_list_size;
+   // One more than the maximum: a request splits a free interval in two before the oldest is dropped
+   m_free_interval_list = FreeIntervalList(max_list_size + 1);
    m_average_delay = MovingAverage<SubsecondTime>::createAvgType(MovingAverage<SubsecondTime>::ARITHMETIC_MEAN, max_list_size);
    SubsecondTime max_simulation_time = SubsecondTime::FS() << 63;
    m_free_interval_list.push_back(std::pair<const SubsecondTime,SubsecondTime>(SubsecondTime::Zero(), max_simulation_time));
@@ -176,28 +178,32 @@ QueueModelHistoryList::computeUsingHistoryList(SubsecondTime pkt_time, Subsecond
          "Free Interval list size(%u) > %u", m_free_interval_list.size(), m_max_free_interval_list_size);
    SubsecondTime queue_delay = SubsecondTime::MaxTime();
 
-   FreeIntervalList::iterator curr_it;
-
-   for (curr_it = m_free_interval_list.begin(); curr_it != m_free_interval_list.end();)
+   for (UInt32 index = 0; index < m_free_interval_list.size(); ++index)
    {
-      std::pair<SubsecondTime,SubsecondTime> interval = (*curr_it);
-      bool erase_current = false;
+      std::pair<SubsecondTime,SubsecondTime> interval = m_free_interval_list[index];
 
       if ((pkt_time >= interval.first) && ((pkt_time + processing_time) <= interval.second))
       {
          queue_delay = SubsecondTime::Zero();
-         // Adjust the data structure accordingly
+         // Adjust the data structure accordingly: the current interval is replaced by what is left of it
+         // before and after the request
+         UInt32 replace = index;
          if ((pkt_time - interval.first) >= m_min_processing_time)
          {
-            m_free_interval_list.insert(curr_it, std::pair<SubsecondTime,SubsecondTime>(interval.first, pkt_time));
+            m_free_interval_list[replace++] = std::pair<SubsecondTime,SubsecondTime>(interval.first, pkt_time);
          }
          if ((interval.second - (pkt_time + processing_time)) >= m_min_processing_time)
          {
-            m_free_interval_list.insert(curr_it, std::pair<SubsecondTime,SubsecondTime>(pkt_time + processing_time, interval.second));
+            std::pair<SubsecondTime,SubsecondTime> after(pkt_time + processing_time, interval.second);
+            if (replace == index)
+               m_free_interval_list[replace++] = after;
+            else
+               m_free_interval_list.insert(replace++, after);
          }
-         
-         erase_current = true;
+         if (replace == index)
+            m_free_interval_list.erase(index);
 
+         break; // Exit the loop after modifying the list
       }
       // WH: The request comes before this free part, but doesn't fit. It doesn't make sense to me to
       //     demand a fit and move this request down even further. In reality, this request would have most
@@ -212,30 +218,22 @@ QueueModelHistoryList::computeUsingHistoryList(SubsecondTime pkt_time, Subsecond
          // Adjust the data structure accordingly
          if ((interval.second - (interval.first + processing_time)) >= m_min_processing_time)
          {
-            m_free_interval_list.insert(curr_it, std::pair<SubsecondTime,SubsecondTime>(interval.first + processing_time, interval.second));
+            m_free_interval_list[index] = std::pair<SubsecondTime,SubsecondTime>(interval.first + processing_time, interval.second);
+         }
+         else
+         {
+            m_free_interval_list.erase(index);
          }
 
-         erase_current = true;
-
-      }
-
-      if (erase_current)
-      {
-         // Erase current interval and get the next iterator
-         curr_it = m_free_interval_list.erase(curr_it);
          break; // Exit the loop after modifying the list
       }
-      else
-      {
-         ++curr_it; // Move to the next element
-      }
    }
 
    LOG_ASSERT_ERROR(queue_delay != SubsecondTime::MaxTime(), "queue delay(%s), free interval not found", itostr(queue_delay).c_str());
 
    if (m_free_interval_list.size() > m_max_free_interval_list_size)
    {
-      m_free_interval_list.erase(m_free_interval_list.begin());
+      m_free_interval_list.pop_front();
    }
 
    LOG_PRINT("HistoryList: pkt_time(%s), processing_time(%s), queue_delay(%s)", itostr(pkt_time).c_str(), itostr(processing_time).c_str(), itostr(queue_delay).c_str());
@@ -1,16 +1,15 @@
 #ifndef __QUEUE_MODEL_HISTORY_LIST_H__
 #define __QUEUE_MODEL_HISTORY_LIST_H__
 
-#include <list>
-
 #include "queue_model.h"
 #include "fixed_types.h"
 #include "moving_average.h"
+#include "interval_ring.h"
 
 class QueueModelHistoryList : public QueueModel
 {
 public:
-   typedef std::list<std::pair<SubsecondTime,SubsecondTime> > FreeIntervalList;
+   typedef IntervalRing<std::pair<SubsecondTime,SubsecondTime> > FreeIntervalList;
 
    QueueModelHistoryList(String name, UInt32 id, SubsecondTime min_processing_time);
    ~QueueModelHistoryList();
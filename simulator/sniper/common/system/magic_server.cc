@@ -134,21 +134,14 @@ UInt64 MagicServer::Magic_unlocked(thread_id_t thread_id, core_id_t core_id, UIn
       std::cout << "[Virtuoso: Magic Instruction] We need to read the message from Sniper's MimicOS" << std::endl;
 #endif
       Core *core = Sim()->getCoreManager()->getCoreFromID(core_id);
-      MimicOS_NS::Message* message = Sim()->getMimicOS()->getMessage();
+      const MimicOSMessage &message = Sim()->getMimicOS()->getMessage(core_id);
 #if DEBUG_MAGIC_SERVER >= DEBUG_DETAILED
-      std::cout << "[Virtuoso: Magic Instruction] Received message with " << message->argc << " arguments" << std::endl;
+      std::cout << "[Virtuoso: Magic Instruction] Received " << MimicOSProtocol::name(message.view().opcode())
+                << " message with " << message.argc << " words" << std::endl;
 #endif
-      //Write the message to the core's memory - First write argc
-      core->accessMemory(Core::NONE, Core::WRITE, arg0, (char*)&message->argc, sizeof(int), Core::MEM_MODELED_NONE);
-
-      // Then write argv
-      for (int i = 0; i < message->argc; i++)
-      {
-         core->accessMemory(Core::NONE, Core::WRITE, arg1 + i * sizeof(uint64_t), (char*)&message->argv[i], sizeof(uint64_t), Core::MEM_MODELED_NONE);
-#if DEBUG_MAGIC_SERVER >= DEBUG_DETAILED
-         std::cout << "[Virtuoso: Magic Instruction] Argument " << i << ": " << message->argv[i] << std::endl;
-#endif
-      }
+      // Write the message to the core's memory - first argc, then all argv words at once
+      core->accessMemory(Core::NONE, Core::WRITE, arg0, (char*)&message.argc, sizeof(int), Core::MEM_MODELED_NONE);
+      core->accessMemory(Core::NONE, Core::WRITE, arg1, (char*)message.argv, message.argc * sizeof(uint64_t), Core::MEM_MODELED_NONE);
 
       return 0;
    }
@@ -162,66 +155,21 @@ UInt64 MagicServer::Magic_unlocked(thread_id_t thread_id, core_id_t core_id, UIn
 #endif
       Core *core = Sim()->getCoreManager()->getCoreFromID(core_id);
 
+      // The reply goes to the next slot of the core's ring, so the request stays readable
+      LOG_ASSERT_ERROR(arg0 > 0 && arg0 <= MimicOSProtocol::MAX_MESSAGE_WORDS,
+                       "MimicOS result of %lu words (at most %zu supported)", arg0, MimicOSProtocol::MAX_MESSAGE_WORDS);
+      MimicOSMessage &result = Sim()->getMimicOS()->nextMessage(core_id);
+      result.argc = arg0;
+      core->accessMemory(Core::NONE, Core::READ, arg1, (char*)result.argv, result.argc * sizeof(uint64_t));
 
-      // We need to access the memory to get the result
-      Sift::Message msg;
-      msg.argc = arg0;
-
-#if DEBUG_MAGIC_SERVER >= DEBUG_DETAILED
-      std::cout << "[Virtuoso: Magic Instruction] Page Fault - Reponse protocol: argc = " << msg.argc << std::endl;
-#endif
-
-      msg.argv = new uint64_t[msg.argc];
-
-#if DEBUG_MAGIC_SERVER >= DEBUG_DETAILED
-      std::cout << "[Virtuoso: Magic Instruction] Page Fault - Reponse protocol: argv_ptr = " << std::hex << arg1 << std::dec << std::endl;
-#endif
-
-
-
-      for (int i = 0; i < (msg.argc); i++)
-      {
-         core->accessMemory(Core::NONE, Core::READ, arg1+ i * sizeof(uint64_t), (char*)&msg.argv[i], sizeof(uint64_t));
-#if DEBUG_MAGIC_SERVER >= DEBUG_DETAILED
-         std::cout << "[Virtuoso: Magic Instruction] Argument " << i << ": " << msg.argv[i] << std::endl;
-#endif
-      }
-
-      // @vlnitu: virtuos.cc/poll_for_signal defines this protocol
-      int exception_type_code = msg.argv[0];
-      // The following arguments are deserialized in handle_exception
-      uint64_t vpn = msg.argv[1];
-      uint64_t ppn = msg.argv[2];
-      uint64_t page_size = msg.argv[3];
-      std::vector<UInt64> frames;
-      int num_requested_frames = msg.argc - 4; // 4 for exception_type
-      frames.reserve(num_requested_frames);
-      for (int i = 0; i < num_requested_frames; i++ )
-      {
-         frames.push_back(msg.argv[4 + i]);
-      }
-      
 #if DEBUG_MAGIC_SERVER >= DEBUG_BASIC
-      std::cout << "[Virtuoso: Magic Instruction] Page Fault - Response protocol: argv[0] = exception_type_code = " << exception_type_code << std::endl;
-      std::cout << "[Virtuoso: Magic Instruction] Page Fault - Response protocol: argv[1] = vpn = " << vpn << std::endl;
-      std::cout << "[Virtuoso: Magic Instruction] Page Fault - Response protocol: argv[2] = ppn = " << ppn << std::endl;
-      std::cout << "[Virtuoso: Magic Instruction] Page Fault - Response protocol: argv[3] = page_size = " << page_size << std::endl;
-
-      std::cout << "[Virtuoso: Magic Instruction] Page Fault - Response protocol: argv[4] = frames.size() = " << frames.size() << std::endl;
-      for (int i = 0; i < frames.size(); i++)
-      {
-         std::cout << "[Virtuoso: Magic Instruction] Page Fault - Response protocol: argv[4 + " << i << "] = frames[" << i << "] = " << frames[i] << std::endl;
-      }  
+      std::cout << "[Virtuoso: Magic Instruction] Response protocol: opcode = " << MimicOSProtocol::name(result.view().opcode())
+                << ", entries = " << result.view().count() << ", words = " << result.argc << std::endl;
 #endif
-      (void)vpn;
-      (void)ppn;
-      (void)page_size;
-
-      // Invoke page fault handler
-      // @vnitu: Invoke Exception Handler, w/ param0 = exception_type (i.e.,  PAGE_FAULT) + forward argv to exception_handler,
-      // @vlnitu: on the exception handler side, argv will be interpreted differently, depending on the protocol (i.e., PAGE_FAULT)
-      
-      core->getExceptionHandler()->handle_exception(exception_type_code, msg.argc, msg.argv);
+
+      // Invoke the exception handler, which decodes the entries according to the opcode
+      // (userspace MimicOS' poll_for_signal defines the reply of each protocol)
+      core->getExceptionHandler()->handle_exception(result.argv[0], result.argc, result.argv);
       return 0;
    }
    case SIM_CMD_MARKER:
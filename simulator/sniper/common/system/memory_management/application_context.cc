@@ -4,6 +4,8 @@
 #include "debug_config.h"
 #include "simulator.h"
 #include "config.hpp"
+#include "stats.h"
+#include "misc/exception_handler_base.h"
 #include <iterator>
 
 ApplicationContext::ApplicationContext(int app_id,
@@ -16,6 +18,9 @@ ApplicationContext::ApplicationContext(int app_id,
     , m_is_guest(is_guest)
     , m_page_table(nullptr)
     , m_range_table(nullptr)
+    , m_vmas(Sim()->getConfig()->getApplicationCores())
+    , m_vma_inference_lock(new SpinLock())
+    , m_page_table_lock(new SpinLock())
 {
     // Create page table using factory
     m_page_table = ParametricDramDirectoryMSI::PageTableFactory::createPageTable(
@@ -41,24 +46,37 @@ ApplicationContext::~ApplicationContext()
 #endif
 }
 
-VMA* ApplicationContext::findVMA(IntPtr address)
+VMA* ApplicationContext::findVMA(IntPtr address, int core_id)
 {
-    for (auto& vma : m_vmas) {
-        if (vma.contains(address)) {
-            return &vma;
-        }
-    }
-    return nullptr;
+    return m_vmas.lookup(address, core_id);
 }
 
-const VMA* ApplicationContext::findVMA(IntPtr address) const
+const VMA* ApplicationContext::findVMA(IntPtr address, int core_id) const
 {
-    for (const auto& vma : m_vmas) {
-        if (vma.contains(address)) {
-            return &vma;
+    return m_vmas.lookup(address, core_id);
+}
+
+int ApplicationContext::findVMAIndex(IntPtr address, int core_id) const
+{
+    return m_vmas.find(address, core_id);
+}
+
+int ApplicationContext::lookupVMA(IntPtr address, int core_id, IntPtr *base, IntPtr *end) const
+{
+    auto lookup = [&]() {
+        int index = m_vmas.find(address, core_id);
+        if (index >= 0 && base && end) {
+            *base = m_vmas[index].getBase();
+            *end = m_vmas[index].getEnd();
         }
-    }
-    return nullptr;
+        return index;
+    };
+
+    // Without inference the VMAs only change during setup
+    if (!m_vma_inference)
+        return lookup();
+    ScopedLock sl(*m_vma_inference_lock);
+    return lookup();
 }
 
 // ---------------------------------------------------------------------------
@@ -101,7 +119,8 @@ bool ApplicationContext::parseVMAsFromFile(const std::string& trace_file_path)
               << trace_file_path << std::endl;
     std::cerr << "[ApplicationContext]   Tried: " << plain_path << std::endl;
     std::cerr << "[ApplicationContext]   Tried: " << json_beside << std::endl;
-    std::cerr << "[ApplicationContext]   Hint:  Run `python -m vma_infer --trace <trace> --out <trace>.vma.json`" << std::endl;
+    std::cerr << "[ApplicationContext]   Hint:  Run `python -m vma_infer --trace <trace> --out <trace>.vma.json`,"
+              << " or enable vma_inference to infer them during the run" << std::endl;
     return false;
 }
 
@@ -118,7 +137,7 @@ bool ApplicationContext::parseVMAsFromPlainFile(const std::string& path)
 
     std::cout << "[ApplicationContext] Parsing VMAs (plain) from: " << path << std::endl;
 
-    m_vmas.clear();
+    std::vector<VMA> vmas;
     std::string line;
 
     while (std::getline(trace, line)) {
@@ -133,7 +152,7 @@ bool ApplicationContext::parseVMAsFromPlainFile(const std::string& path)
                 std::cout << "[ApplicationContext] VMA: 0x" << std::hex << start
                           << " - 0x" << end << std::dec << std::endl;
 #endif
-                m_vmas.emplace_back(start, end);
+                vmas.emplace_back(start, end);
             }
             catch (const std::invalid_argument&) {
                 std::cerr << "[ApplicationContext] Invalid VMA format: " << line << std::endl;
@@ -144,6 +163,8 @@ bool ApplicationContext::parseVMAsFromPlainFile(const std::string& path)
         }
     }
 
+    setVMAs(std::move(vmas));
+
     std::cout << "[ApplicationContext] Parsed " << m_vmas.size() << " VMAs (plain) for app " << m_app_id << std::endl;
     return !m_vmas.empty();
 }
@@ -232,7 +253,7 @@ bool ApplicationContext::parseVMAsFromJSON(const std::string& path)
 
     std::cout << "[ApplicationContext] Parsing VMAs (JSON) from: " << path << std::endl;
 
-    m_vmas.clear();
+    std::vector<VMA> vmas;
     size_t pos = arr_start;
 
     while (pos < arr_end) {
@@ -281,12 +302,14 @@ bool ApplicationContext::parseVMAsFromJSON(const std::string& path)
             std::cout << "[ApplicationContext] VMA (JSON): 0x" << std::hex
                       << start_addr << " - 0x" << end_addr << std::dec << std::endl;
 #endif
-            m_vmas.emplace_back(start_addr, end_addr);
+            vmas.emplace_back(start_addr, end_addr);
         }
 
         pos = obj_end + 1;
     }
 
+    setVMAs(std::move(vmas));
+
     std::cout << "[ApplicationContext] Parsed " << m_vmas.size()
               << " VMAs (JSON) for app " << m_app_id << std::endl;
     return !m_vmas.empty();
@@ -321,6 +344,47 @@ std::string ApplicationContext::traceNameStem(const std::string& trace_path)
     return name;
 }
 
+void ApplicationContext::setVMAs(std::vector<VMA> vmas)
+{
+    size_t merged = m_vmas.assign(std::move(vmas));
+    if (merged) {
+        std::cerr << "[ApplicationContext] WARNING: merged " << merged
+                  << " overlapping VMAs for app " << m_app_id << std::endl;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Online VMA inference – for traces without any VMA source
+// ---------------------------------------------------------------------------
+
+void ApplicationContext::enableVMAInference(const VMAInference::Params& params)
+{
+    m_vmas.clear();
+    m_vma_inference.reset(new VMAInference(params));
+
+    VMAInference::Stats& stats = m_vma_inference->getStats();
+    registerStatsMetric("vma_inference", m_app_id, "accesses", &stats.accesses);
+    registerStatsMetric("vma_inference", m_app_id, "new_regions", &stats.new_regions);
+    registerStatsMetric("vma_inference", m_app_id, "time_splits", &stats.time_splits);
+    registerStatsMetric("vma_inference", m_app_id, "wf_splits", &stats.wf_splits);
+    registerStatsMetric("vma_inference", m_app_id, "gap_merges", &stats.gap_merges);
+    registerStatsMetric("vma_inference", m_app_id, "capacity_merges", &stats.capacity_merges);
+    registerStatsMetric("vma_inference", m_app_id, "publications", &stats.publications);
+}
+
+void ApplicationContext::publishInferredVMAs()
+{
+    // Take what the fault handlers hold while they look VMAs up, in their order
+    if (ExceptionHandlerBase::s_fault_locking == ExceptionHandlerBase::FaultLocking::GLOBAL) {
+        ScopedLock fault_lock(ExceptionHandlerBase::s_page_fault_lock);
+        m_vma_inference->publish(m_vmas);
+    } else {
+        ScopedLock page_table_lock(*m_page_table_lock);
+        ScopedLock allocator_lock(ExceptionHandlerBase::s_allocator_lock);
+        m_vma_inference->publish(m_vmas);
+    }
+}
+
 void ApplicationContext::setVMAAllocated(size_t vma_index)
 {
     if (vma_index < m_vmas.size()) {
@@ -377,3 +441,59 @@ UInt64 ApplicationContext::getAccessesPerVPN(IntPtr vpn) const
     }
     return 0;
 }
+
+// ---------------------------------------------------------------------------
+// Snapshots
+// ---------------------------------------------------------------------------
+
+bool ApplicationContext::saveState(Snapshot::Writer& writer) const
+{
+    writer.put<UInt64>(m_vmas.size());
+    for (const auto& vma : m_vmas.vmas()) {
+        std::vector<Range> ranges = vma.getPhysicalRanges();
+        writer.put(SnapshotVMA{vma.getBase(), vma.getEnd(), vma.isAllocated(),
+                               vma.getSuccessfulOffsetBasedAllocations(), vma.getPhysicalOffset(), ranges.size()});
+        writer.putArray(ranges.data(), ranges.size());
+    }
+
+    writer.put<UInt64>(m_page_table != nullptr);
+    if (m_page_table && !m_page_table->saveState(writer))
+        return false;
+    writer.put<UInt64>(m_range_table != nullptr);
+    return !m_range_table || m_range_table->saveState(writer);
+}
+
+bool ApplicationContext::loadState(Snapshot::Section& section)
+{
+    UInt64 num_vmas = 0;
+    if (!section.get(num_vmas))
+        return false;
+
+    std::vector<VMA> vmas;
+    for (UInt64 i = 0; i < num_vmas; i++) {
+        SnapshotVMA record;
+        if (!section.get(record))
+            return false;
+        const Range* ranges = section.getArray<Range>(record.num_ranges);
+        if (!ranges)
+            return false;
+
+        VMA vma(record.base, record.end);
+        vma.setAllocated(record.allocated);
+        vma.setSuccessfulOffsetBasedAllocations(record.successful_offsetbased_allocations);
+        vma.setPhysicalOffset(record.physical_offset);
+        for (UInt64 r = 0; r < record.num_ranges; r++)
+            vma.addPhysicalRange(ranges[r]);
+        vmas.push_back(vma);
+    }
+    m_vmas.assign(std::move(vmas));
+
+    UInt64 has_page_table = 0, has_range_table = 0;
+    if (!section.get(has_page_table) || has_page_table != (m_page_table != nullptr))
+        return false;
+    if (m_page_table && !m_page_table->loadState(section))
+        return false;
+    if (!section.get(has_range_table) || has_range_table != (m_range_table != nullptr))
+        return false;
+    return (!m_range_table || m_range_table->loadState(section)) && section.ok();
+}
@@ -4,7 +4,10 @@
 #include "pagetable.h"
 #include "rangetable.h"
 #include "../../../include/memory_management/misc/vma.h"
+#include "../../../include/memory_management/misc/vma_index.h"
+#include "../../../include/memory_management/misc/vma_inference.h"
 #include "fixed_types.h"
+#include "lock.h"
 #include <vector>
 #include <memory>
 #include <fstream>
@@ -17,7 +20,7 @@
  * This class holds all memory-related state for a single application:
  * - Page table
  * - Range table
- * - Virtual Memory Areas (VMAs)
+ * - Virtual Memory Areas (VMAs), indexed by start address
  */
 class ApplicationContext {
 public:
@@ -58,8 +61,14 @@ public:
     ParametricDramDirectoryMSI::RangeTable* getRangeTable() { return m_range_table; }
     const ParametricDramDirectoryMSI::RangeTable* getRangeTable() const { return m_range_table; }
     
-    std::vector<VMA>& getVMAs() { return m_vmas; }
-    const std::vector<VMA>& getVMAs() const { return m_vmas; }
+    /** Sorted by base address */
+    const std::vector<VMA>& getVMAs() const { return m_vmas.vmas(); }
+
+    VMAIndex& getVMAIndex() { return m_vmas; }
+    const VMAIndex& getVMAIndex() const { return m_vmas; }
+
+    /** Serializes page-table updates of this app when page faults use fine-grained locking */
+    SpinLock& getPageTableLock() { return *m_page_table_lock; }
     
     // ============ VMA Operations ============
     
@@ -67,10 +76,30 @@ public:
      * @brief Find the VMA containing the given address
      * 
      * @param address Virtual address to look up
+     * @param core_id Core doing the lookup (selects its last-hit cache)
      * @return Pointer to VMA if found, nullptr otherwise
      */
-    VMA* findVMA(IntPtr address);
-    const VMA* findVMA(IntPtr address) const;
+    VMA* findVMA(IntPtr address, int core_id = 0);
+    const VMA* findVMA(IntPtr address, int core_id = 0) const;
+
+    /**
+     * @brief Index of the VMA containing the given address (position in getVMAs())
+     * 
+     * @return Index if found, -1 otherwise
+     */
+    int findVMAIndex(IntPtr address, int core_id = 0) const;
+
+    /**
+     * @brief findVMAIndex for callers that hold no page-fault lock (MMU, statistics)
+     *
+     * With VMA inference on, another core may republish the VMAs during the lookup, so it takes
+     * the inference lock, which publishing holds. Page-fault handlers must use findVMAIndex: they
+     * hold the locks that publishing takes after the inference lock.
+     *
+     * @param base, end If not NULL, set to the bounds of the VMA found
+     * @return Index if found, -1 otherwise
+     */
+    int lookupVMA(IntPtr address, int core_id, IntPtr *base = nullptr, IntPtr *end = nullptr) const;
     
     /**
      * @brief Parse VMAs from a trace file
@@ -85,6 +114,30 @@ public:
      */
     bool parseVMAsFromFile(const std::string& trace_file_path);
 
+    /**
+     * @brief Discover the VMAs from the memory accesses of the app (no VMA file needed)
+     *
+     * Replaces the current VMAs with the ones inferred as observeAccess is fed.
+     */
+    void enableVMAInference(const VMAInference::Params& params);
+
+    bool isInferringVMAs() const { return m_vma_inference != nullptr; }
+
+    /**
+     * @brief Feed one memory access of the app to the VMA inference
+     *
+     * Must run before the access is translated: a new VMA covering it is published
+     * right away, so that its page fault finds one.
+     *
+     * @param address Virtual address, as the MMU sees it
+     */
+    void observeAccess(IntPtr address, bool is_write)
+    {
+        ScopedLock sl(*m_vma_inference_lock);
+        if (m_vma_inference->observe(address, is_write))
+            publishInferredVMAs();
+    }
+
 private:
     /** Parse the simple hex-range .vma format. */
     bool parseVMAsFromPlainFile(const std::string& path);
@@ -92,9 +145,15 @@ private:
     /** Parse JSON produced by vma_infer (contains "regions" array). */
     bool parseVMAsFromJSON(const std::string& path);
 
+    /** Replace the VMAs with parsed ones (any order; overlapping ones are merged). */
+    void setVMAs(std::vector<VMA> vmas);
+
     /** Extract the trace name stem (e.g. "bravo.a_0000") from a full path. */
     static std::string traceNameStem(const std::string& trace_path);
 
+    /** Apply the inferred VMA changes while no page fault can look VMAs up */
+    void publishInferredVMAs();
+
 public:
     
     /**
@@ -153,7 +212,35 @@ public:
      */
     UInt64 getAccessesPerVPN(IntPtr vpn) const;
 
+    // ============ Snapshots ============
+
+    /**
+     * @brief Save the VMAs, page table and range table of this app
+     *
+     * @return false if the page table or range table type does not support snapshots
+     */
+    bool saveState(Snapshot::Writer& writer) const;
+
+    /**
+     * @brief Restore what saveState wrote into this freshly created context
+     *
+     * The VMAs are replaced, so no VMA file needs to be parsed.
+     *
+     * @return false if the snapshot does not match the configured tables
+     */
+    bool loadState(Snapshot::Section& section);
+
 private:
+    // Snapshot record of a VMA; its physical ranges follow it
+    struct SnapshotVMA {
+        IntPtr base;
+        IntPtr end;
+        UInt64 allocated;
+        SInt64 successful_offsetbased_allocations;
+        IntPtr physical_offset;
+        UInt64 num_ranges;
+    };
+
     int m_app_id;
     bool m_is_guest;
     
@@ -162,7 +249,14 @@ private:
     ParametricDramDirectoryMSI::RangeTable* m_range_table;
     
     // VMAs (owned)
-    std::vector<VMA> m_vmas;
+    VMAIndex m_vmas;
+
+    // Online VMA discovery, for apps without a VMA file
+    std::unique_ptr<VMAInference> m_vma_inference;
+    std::unique_ptr<SpinLock> m_vma_inference_lock;
+
+    // Held behind a pointer so the context stays movable
+    std::unique_ptr<SpinLock> m_page_table_lock;
 };
 
 #endif // APPLICATION_CONTEXT_H
@@ -10,6 +10,7 @@
 #include "config.hpp"
 #include "stats.h"
 #include "log.h"
+#include "mimicos.h"
 
 // Helper functions for safe config access with defaults
 static SInt64 getCfgIntSafe(const String& key, SInt64 default_val)
@@ -336,6 +337,7 @@ bool CXLMemoryTierManager::tryPromotePage(IntPtr page_num)
     local_tier.used_bytes += PAGE_SIZE;
     info.tier = Tier::LOCAL_DRAM;
     m_pages_promoted++;
+    shootDown(page_num);
     
     return true;
 }
@@ -358,10 +360,18 @@ bool CXLMemoryTierManager::tryDemotePage(IntPtr page_num)
     cxl_tier.used_bytes += PAGE_SIZE;
     info.tier = Tier::CXL_NEAR;
     m_pages_demoted++;
+    shootDown(page_num);
     
     return true;
 }
 
+// The page moved to another frame: translations to the old one are stale in every TLB
+void CXLMemoryTierManager::shootDown(IntPtr page_num)
+{
+    if (MimicOS *mimicos = Sim()->getMimicOS())
+        mimicos->getTLBShootdown()->invalidatePhysical(page_num, TLBShootdown::MIGRATE);
+}
+
 void CXLMemoryTierManager::checkMigration(SubsecondTime current_time)
 {
     if (!m_enabled || m_policy != PlacementPolicy::HOT_COLD)
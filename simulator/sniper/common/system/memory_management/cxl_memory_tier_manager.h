@@ -177,6 +177,7 @@ private:
     void updatePageAccess(IntPtr page_num, SubsecondTime time);
     bool tryPromotePage(IntPtr page_num);
     bool tryDemotePage(IntPtr page_num);
+    void shootDown(IntPtr page_num);
 
 public:
     CXLMemoryTierManager();
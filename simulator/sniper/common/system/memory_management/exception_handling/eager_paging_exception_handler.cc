@@ -34,8 +34,11 @@ void EagerPagingExceptionHandler::handle_exception(int exception_type_code, int
 
 void EagerPagingExceptionHandler::handle_page_fault(FaultCtx &ctx)
 {
-    // Acquire global lock for thread-safe page fault handling in multi-core
-    ScopedLock sl(ExceptionHandlerBase::s_page_fault_lock);
+    // Eager paging updates VMAs and range tables next to the allocator, so FINE locking still
+    // serializes the whole handler, just on the allocator lock instead of the global one.
+    // The page-table lock comes first, in the order VMA inference takes both.
+    FaultLockGuard page_table_guard(pageTableLock(Sim()->getMimicOS(), m_core->getThread()->getAppId()), m_fault_lock_stats);
+    FaultLockGuard fault_guard(faultLock() ? faultLock() : allocatorLock(), m_fault_lock_stats);
 
 #if DEBUG_EXCEPTION_HANDLER >= DEBUG_BASIC
     std::cout << "[EAGER_EXCEPTION_HANDLER] Handling page fault for address: " << (ctx.vpn << BASE_PAGE_SHIFT) << " in Sniper-space" << std::endl;
@@ -65,30 +68,20 @@ void EagerPagingExceptionHandler::allocate_vma_eagerly(FaultCtx& ctx, UInt64 add
 #endif
 
     // Find the VMA that contains this address
-    std::vector<VMA> vma_list = Sim()->getMimicOS()->getVMA(app_id);
-    VMA final_vma(0, 0);
-    bool found = false;
-    
-    for (UInt32 i = 0; i < vma_list.size(); i++)
-    {
-        if (address >= vma_list[i].getBase() && address < vma_list[i].getEnd())
-        {
-#if DEBUG_EXCEPTION_HANDLER >= DEBUG_BASIC
-            log_file << "[EAGER_EXCEPTION_HANDLER] VMA found for address: " << address 
-                     << " in VMA: " << vma_list[i].getBase() << " - " << vma_list[i].getEnd() << std::endl;
-#endif
-            final_vma = vma_list[i];
-            found = true;
-            break;
-        }
-    }
+    const VMA* vma = Sim()->getMimicOS()->findVMA(app_id, address, m_core->getId());
 
-    if (!found)
+    if (!vma)
     {
         std::cerr << "[FATAL] [EAGER_EXCEPTION_HANDLER] No VMA found for address: " << address << std::endl;
         assert(false);
     }
 
+#if DEBUG_EXCEPTION_HANDLER >= DEBUG_BASIC
+    log_file << "[EAGER_EXCEPTION_HANDLER] VMA found for address: " << address 
+             << " in VMA: " << vma->getBase() << " - " << vma->getEnd() << std::endl;
+#endif
+    VMA final_vma = *vma;
+
     assert(this->getAllocator() != NULL);
 
     // Allocate ranges for the entire VMA
@@ -0,0 +1,125 @@
+#include "misc/exception_handler_base.h"
+#include "simulator.h"
+#include "config.hpp"
+#include "core.h"
+#include "stats.h"
+#include "mimicos.h"
+
+// Static lock definitions for thread-safe page fault handling across all cores
+// SpinLock: non-fair, avoids FIFO ordering overhead of ticket lock
+SpinLock ExceptionHandlerBase::s_page_fault_lock;
+SpinLock ExceptionHandlerBase::s_allocator_lock;
+ExceptionHandlerBase::FaultLocking ExceptionHandlerBase::s_fault_locking = ExceptionHandlerBase::FaultLocking::GLOBAL;
+
+ExceptionHandlerBase::ExceptionHandlerBase(Core* core)
+    : m_core(core)
+    , m_allocator(NULL) // Instantiate on demand, when getAllocator is called
+    , m_pt_frame_cache_size(0)
+{
+    String locking = "global";
+    if (Sim()->getCfg()->hasKey("general/page_fault_locking"))
+        locking = Sim()->getCfg()->getString("general/page_fault_locking");
+
+    if (locking == "fine")
+        s_fault_locking = FaultLocking::FINE;
+    else if (locking == "global")
+        s_fault_locking = FaultLocking::GLOBAL;
+    else
+        LOG_PRINT_ERROR("Unknown general/page_fault_locking value: %s (expected global or fine)", locking.c_str());
+
+    // Without the global lock, cores can no longer hand unused frames back to the bump-pointer
+    // page-table allocator (another core may have bumped it in between), so FINE mode always
+    // goes through the per-core cache
+    if (s_fault_locking == FaultLocking::FINE)
+    {
+        m_pt_frame_cache_size = 16;
+        if (Sim()->getCfg()->hasKey("general/page_table_frame_cache"))
+            m_pt_frame_cache_size = Sim()->getCfg()->getInt("general/page_table_frame_cache");
+        LOG_ASSERT_ERROR(m_pt_frame_cache_size > 0, "general/page_table_frame_cache must be > 0 with fine-grained page-fault locking");
+    }
+    m_pt_frame_cache.reserve(m_pt_frame_cache_size);
+
+    // A restored allocator counts the frames this core had cached as allocated: take them back
+    if (Sim()->getMimicOS()->loadPageTableFrameCache(core->getId(), m_pt_frame_cache))
+    {
+        LOG_ASSERT_ERROR(m_pt_frame_cache.size() <= m_pt_frame_cache_size,
+                         "Snapshot has %zu page-table frames cached by core %d, more than general/page_table_frame_cache (%u) "
+                         "with general/page_fault_locking = %s",
+                         m_pt_frame_cache.size(), core->getId(), m_pt_frame_cache_size, locking.c_str());
+    }
+
+    registerStatsMetric("page_fault_locks", core->getId(), "acquisitions", &m_fault_lock_stats.acquisitions);
+    registerStatsMetric("page_fault_locks", core->getId(), "wait_ns", &m_fault_lock_stats.wait_ns);
+    registerStatsMetric("page_fault_locks", core->getId(), "max_wait_ns", &m_fault_lock_stats.max_wait_ns);
+    registerStatsMetric("page_fault_locks", core->getId(), "pt_frame_cache_hits", &m_fault_lock_stats.pt_frame_cache_hits);
+    registerStatsMetric("page_fault_locks", core->getId(), "pt_frame_cache_refills", &m_fault_lock_stats.pt_frame_cache_refills);
+}
+
+BaseLock* ExceptionHandlerBase::pageTableLock(MimicOS* os, int app_id)
+{
+    if (s_fault_locking != FaultLocking::FINE)
+        return NULL;
+
+    ApplicationContext* app = os->getApplication(app_id);
+    assert(app);
+    return &app->getPageTableLock();
+}
+
+BaseLock& ExceptionHandlerBase::pageTableUpdateLock(MimicOS* os, int app_id)
+{
+    if (s_fault_locking == FaultLocking::GLOBAL)
+        return s_page_fault_lock;
+
+    ApplicationContext* app = os->getApplication(app_id);
+    assert(app);
+    return app->getPageTableLock();
+}
+
+UInt64 ExceptionHandlerBase::allocatePageTableFrame(UInt64 core_id)
+{
+    if (m_pt_frame_cache_size == 0)
+        return getAllocator()->handle_page_table_allocations(FOUR_KIB, core_id);
+
+    if (m_pt_frame_cache.empty())
+    {
+        // Refill the whole batch under one allocator acquisition; frames are pushed in
+        // reverse so that the cache hands them out in allocation order
+        FaultLockGuard guard(allocatorLock(), m_fault_lock_stats);
+        std::vector<UInt64> batch;
+        for (UInt32 i = 0; i < m_pt_frame_cache_size; i++)
+        {
+            UInt64 frame = getAllocator()->handle_page_table_allocations(FOUR_KIB, core_id);
+            if (frame == static_cast<UInt64>(-1))
+                break;
+            batch.push_back(frame);
+        }
+        m_pt_frame_cache.assign(batch.rbegin(), batch.rend());
+        m_fault_lock_stats.pt_frame_cache_refills++;
+
+        if (m_pt_frame_cache.empty())
+            return static_cast<UInt64>(-1);
+    }
+    else
+    {
+        m_fault_lock_stats.pt_frame_cache_hits++;
+    }
+
+    UInt64 frame = m_pt_frame_cache.back();
+    m_pt_frame_cache.pop_back();
+    return frame;
+}
+
+void ExceptionHandlerBase::releasePageTableFrames(const std::vector<UInt64>& frames, int frames_used)
+{
+    if (m_pt_frame_cache_size == 0)
+    {
+        // The page-table allocator is a bump pointer: give back the tail of what we took
+        for (size_t i = frames_used; i < frames.size(); i++)
+            getAllocator()->handle_page_table_deallocations(FOUR_KIB);
+        return;
+    }
+
+    // Frames were consumed front to back, so the unused ones go back to the cache (last one on top)
+    for (size_t i = frames.size(); i > static_cast<size_t>(frames_used); i--)
+        m_pt_frame_cache.push_back(frames[i - 1]);
+}
@@ -3,10 +3,6 @@
 #include "thread.h"
 #include "debug_config.h"
 
-// Static lock definition for thread-safe page fault handling across all cores
-// SpinLock: non-fair, avoids FIFO ordering overhead of ticket lock
-SpinLock ExceptionHandlerBase::s_page_fault_lock;
-
 SniperExceptionHandler::SniperExceptionHandler(Core *core) : ExceptionHandlerBase(core)
 {
     // Initialise log structures
@@ -38,8 +34,9 @@ void SniperExceptionHandler::handle_exception(int exception_type_code, int argc,
 
 void SniperExceptionHandler::handle_page_fault(FaultCtx &ctx)
 {
-    // Acquire global lock for thread-safe page fault handling in multi-core
-    ScopedLock sl(ExceptionHandlerBase::s_page_fault_lock);
+    // GLOBAL locking serializes the whole handler across cores; FINE locking leaves it to the
+    // allocator and page-table scopes below
+    FaultLockGuard fault_guard(faultLock(), m_fault_lock_stats);
 
 #if DEBUG_EXCEPTION_HANDLER >= DEBUG_BASIC
     std::cout << "[EXCEPTION_HANDLER] Handling page fault for address: " << (ctx.vpn << BASE_PAGE_SHIFT) << " in Sniper-space" << std::endl;
@@ -65,7 +62,12 @@ void SniperExceptionHandler::handle_page_fault(FaultCtx &ctx)
 #endif
 
     assert(this->getAllocator() != NULL);
-    const auto &[ppn, page_size] = this->getAllocator()->allocate(FOUR_KIB, ctx.vpn << BASE_PAGE_SHIFT, core_id, false, ctx.alloc_in.is_instruction);
+    UInt64 ppn;
+    int page_size;
+    {
+        FaultLockGuard allocator_guard(allocatorLock(), m_fault_lock_stats);
+        std::tie(ppn, page_size) = this->getAllocator()->allocate(FOUR_KIB, ctx.vpn << BASE_PAGE_SHIFT, core_id, false, ctx.alloc_in.is_instruction);
+    }
 
 #if DEBUG_EXCEPTION_HANDLER >= DEBUG_BASIC
     log_file << "[EXCEPTION_HANDLER] Allocated page: " << ppn << " with page size: " << page_size << std::endl;
@@ -103,7 +105,7 @@ void SniperExceptionHandler::allocate_page_table_frames(FaultCtx &ctx,
     // TODO @vlnitu: migrate other allocators - allocate metadata frames stage (i.e., asap, etc.)
     for (int i = 0; i < page_table_frames; i++)
     {
-        UInt64 frame = this->getAllocator()->handle_page_table_allocations(FOUR_KIB, core_id);
+        UInt64 frame = allocatePageTableFrame(core_id);
 #if DEBUG_EXCEPTION_HANDLER >= DEBUG_BASIC
         log_file << "[EXCEPTION_HANDLER] Giving away page table frame: " << frame << std::endl;
         std::cout << "[EXCEPTION_HANDLER] Giving away page table frame: " << frame << std::endl;
@@ -138,10 +140,7 @@ void SniperExceptionHandler::allocate_page_table_frames(FaultCtx &ctx,
     log_file << "[EXCEPTION_HANDLER] Deallocating page table frames: " << (page_table_frames - frames_used) << std::endl;
     std::cout << "[EXCEPTION_HANDLER] Deallocating page table frames: " << (page_table_frames - frames_used) << std::endl;
 #endif
-    for (int i = 0; i < (page_table_frames - frames_used); i++)
-    {
-        this->getAllocator()->handle_page_table_deallocations(FOUR_KIB);
-    }
+    releasePageTableFrames(frames, frames_used);
     return;
 }
 
@@ -171,6 +170,7 @@ int SniperExceptionHandler::update_page_table_frames(UInt64 address, UInt64 core
     std::cout << "[EXCEPTION_HANDLER] Updating page table frames for address: " << address << " with ppn: " << ppn << " and page size: " << page_size << std::endl;
 #endif
     assert(os->getPageTable(app_id_faulter));
+    FaultLockGuard page_table_guard(pageTableLock(os, app_id_faulter), m_fault_lock_stats);
     int frames_used = os->getPageTable(app_id_faulter)->updatePageTableFrames(address, core_id, ppn, page_size, frames);
 #if DEBUG_EXCEPTION_HANDLER >= DEBUG_BASIC
     log_file << "[EXCEPTION_HANDLER] Frames used: " << frames_used << std::endl;
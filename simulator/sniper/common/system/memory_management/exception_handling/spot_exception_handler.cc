@@ -35,8 +35,9 @@ void SpotExceptionHandler::handle_exception(int exception_type_code, int argc, u
 
 void SpotExceptionHandler::handle_page_fault(FaultCtx &ctx)
 {
-    // Acquire global lock for thread-safe page fault handling in multi-core
-    ScopedLock sl(ExceptionHandlerBase::s_page_fault_lock);
+    // GLOBAL locking serializes the whole handler across cores; FINE locking leaves it to the
+    // allocator and page-table scopes below
+    FaultLockGuard fault_guard(faultLock(), m_fault_lock_stats);
 
 #if DEBUG_EXCEPTION_HANDLER >= DEBUG_BASIC
     std::cout << "[SPOT_EXCEPTION_HANDLER] Handling page fault for address: " << (ctx.vpn << BASE_PAGE_SHIFT) 
@@ -57,7 +58,12 @@ void SpotExceptionHandler::handle_page_fault(FaultCtx &ctx)
     assert(this->getAllocator() != NULL);
 
     // 1. Allocate the frame for the faulting page
-    const auto &[ppn, page_size] = this->getAllocator()->allocate(FOUR_KIB, ctx.vpn << BASE_PAGE_SHIFT, core_id, false);
+    UInt64 ppn;
+    int page_size;
+    {
+        FaultLockGuard allocator_guard(allocatorLock(), m_fault_lock_stats);
+        std::tie(ppn, page_size) = this->getAllocator()->allocate(FOUR_KIB, ctx.vpn << BASE_PAGE_SHIFT, core_id, false);
+    }
 
 #if DEBUG_EXCEPTION_HANDLER >= DEBUG_BASIC
     log_file << "[SPOT_EXCEPTION_HANDLER] Allocated page: " << ppn << " with page size: " << page_size << std::endl;
@@ -92,7 +98,7 @@ void SpotExceptionHandler::allocate_page_table_frames(FaultCtx &ctx,
 
     for (int i = 0; i < page_table_frames; i++)
     {
-        UInt64 frame = this->getAllocator()->handle_page_table_allocations(FOUR_KIB);
+        UInt64 frame = allocatePageTableFrame(core_id);
 
 #if DEBUG_EXCEPTION_HANDLER >= DEBUG_BASIC
         log_file << "[SPOT_EXCEPTION_HANDLER] Giving away page table frame: " << frame << std::endl;
@@ -114,10 +120,7 @@ void SpotExceptionHandler::allocate_page_table_frames(FaultCtx &ctx,
     log_file << "[SPOT_EXCEPTION_HANDLER] Deallocating unused frames: " << (page_table_frames - frames_used) << std::endl;
 #endif
 
-    for (int i = 0; i < (page_table_frames - frames_used); i++)
-    {
-        this->getAllocator()->handle_page_table_deallocations(FOUR_KIB);
-    }
+    releasePageTableFrames(frames, frames_used);
 
     return;
 }
@@ -148,6 +151,7 @@ int SpotExceptionHandler::update_page_table_frames(UInt64 address, UInt64 core_i
     log_file << "[SPOT_EXCEPTION_HANDLER] App ID of the faulter: " << app_id_faulter << std::endl;
 #endif
 
+    FaultLockGuard page_table_guard(pageTableLock(os, app_id_faulter), m_fault_lock_stats);
     int frames_used = os->getPageTable(app_id_faulter)->updatePageTableFrames(address, core_id, ppn, page_size, frames);
 
 #if DEBUG_EXCEPTION_HANDLER >= DEBUG_BASIC
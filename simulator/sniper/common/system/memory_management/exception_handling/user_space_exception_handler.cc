@@ -33,57 +33,58 @@ void VirtuosExceptionHandler::handle_exception(int exception_type_code, int argc
     std::cout << "[EXCEPTION_HANDLER] handle_exception " << std::endl;
 #endif
 
-    assert(MimicOS::protocol_codes_decode.find(exception_type_code) != MimicOS::protocol_codes_decode.end()); // Otherwise: exception is invalid
-
-    const std::string &exception_name = MimicOS::protocol_codes_decode[exception_type_code];
+    const MimicOSProtocol::MessageView message(argc, argv);
+    assert(message.opcode() == static_cast<MimicOSProtocol::Opcode>(exception_type_code));
 #if DEBUG_EXCEPTION_HANDLER >= DEBUG_DETAILED
-    std::cout << "[EXCEPTION_HANDLER] Handling exception: " << exception_name << std::endl;
+    std::cout << "[EXCEPTION_HANDLER] Handling exception: " << MimicOSProtocol::name(message.opcode()) << std::endl;
 #endif
 
-    if (exception_name == "page_fault")
+    switch (message.opcode())
+    {
+    case MimicOSProtocol::Opcode::PAGE_FAULT:
     {
+        LOG_ASSERT_ERROR(message.wellFormed<MimicOSProtocol::PageFaultResponse>(),
+                         "Malformed page-fault reply from userspace MimicOS (%d words, %u entries)", argc, message.count());
+
         int app_id = m_core->getThread()->getAppId();
         auto *page_table = Sim()->getMimicOS()->getPageTable(app_id);
-        assert(argc >= 4 && argv[0] == static_cast<uint64_t>(exception_type_code));
-        uint64_t vpn = argv[1];
-        uint64_t ppn = argv[2];
-        uint64_t page_size = argv[3];
-        std::vector<UInt64> frames_already_allocated_by_virtuos;
-        for (int i = 4; i < argc; ++i)
+
+        // One mapping per faulting address of the request, in request order
+        for (uint32_t i = 0; i < message.count(); i++)
         {
-            frames_already_allocated_by_virtuos.push_back(argv[i]);
+            const MimicOSProtocol::PageFaultResponse response = message.entry<MimicOSProtocol::PageFaultResponse>(i);
+            LOG_ASSERT_ERROR(response.num_frames <= MimicOSProtocol::MAX_FRAMES_PER_FAULT,
+                             "Page-fault reply carries %lu frames (at most %u supported)", response.num_frames, MimicOSProtocol::MAX_FRAMES_PER_FAULT);
+
+            // Populate FaultCtx
+            FaultCtx ctx{
+                .page_table = page_table,
+                .vpn = response.vpn,
+                .alloc_in = {
+                    .metadata_frames = -1, // UNUSED
+                    .is_instruction = false // Default to data for userspace page faults
+                },
+                .alloc_out = {
+                    .page_size = static_cast<int>(response.page_size),
+                    .prealloc_frames = std::vector<UInt64>(response.frames, response.frames + response.num_frames),
+                    .ppn = response.ppn,
+                },
+            };
+            handle_page_fault(ctx);
         }
-
-        // Populate FaultCtx
-        FaultCtx ctx{
-            .page_table = page_table,
-            .vpn = vpn,
-            .alloc_in = {
-                .metadata_frames = -1, // UNUSED
-                .is_instruction = false // Default to data for userspace page faults
-            },
-            .alloc_out = {
-                .page_size = static_cast<int>(page_size),
-                .prealloc_frames = std::move(frames_already_allocated_by_virtuos),
-                .ppn = ppn,
-            },
-        };
-
-        //   handle_page_fault(page_table, vpn, ppn, page_size, frames_already_allocated_by_virtuos);
-        // Call the handle_page_fault method
-        handle_page_fault(ctx);
+        break;
     }
-    else
-    {
-        std::cout << "[FATAL] [EXCEPTION_HANDLER] Exception " << exception_name << " was not implemented yet..." << std::endl;
-        assert(false);
+    default:
+        LOG_PRINT_ERROR("Exception %s (code %d) is not implemented for userspace MimicOS",
+                        MimicOSProtocol::name(message.opcode()), exception_type_code);
     }
 }
 
 void VirtuosExceptionHandler::handle_page_fault(FaultCtx &ctx)
 {
-    // Acquire global lock for thread-safe page fault handling in multi-core
-    ScopedLock sl(ExceptionHandlerBase::s_page_fault_lock);
+    // Frames come pre-allocated from the userspace MimicOS, so in FINE mode only the
+    // page-table update itself needs to be serialized (per application)
+    FaultLockGuard fault_guard(faultLock(), m_fault_lock_stats);
 
     // 1. Deserialize ctx
     auto* page_table = ctx.page_table;
@@ -102,6 +103,7 @@ void VirtuosExceptionHandler::handle_page_fault(FaultCtx &ctx)
 
     // 2. Update the page table with the frames that were already allocated by user-space MimicOS
     int core_id = m_core->getId();
+    FaultLockGuard page_table_guard(pageTableLock(Sim()->getMimicOS(), m_core->getThread()->getAppId()), m_fault_lock_stats);
     update_page_table_frames(page_table, vpn << BASE_PAGE_SHIFT, core_id, ppn, page_size, frames_already_allocated_by_virtuos);
 
 #if DEBUG_EXCEPTION_HANDLER >= DEBUG_BASIC
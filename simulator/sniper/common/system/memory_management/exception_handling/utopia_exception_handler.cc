@@ -41,8 +41,11 @@ void UtopiaExceptionHandler::handle_exception(int exception_type_code, int argc,
 
 void UtopiaExceptionHandler::handle_page_fault(FaultCtx &ctx)
 {
-    // Acquire global lock for thread-safe page fault handling in multi-core
-    ScopedLock sl(ExceptionHandlerBase::s_page_fault_lock);
+    // Utopia inspects the allocator's last-allocation state after allocating, so FINE locking
+    // still serializes the whole handler, just on the allocator lock instead of the global one.
+    // The page-table lock comes first, in the order VMA inference takes both.
+    FaultLockGuard page_table_guard(pageTableLock(Sim()->getMimicOS(), m_core->getThread()->getAppId()), m_fault_lock_stats);
+    FaultLockGuard fault_guard(faultLock() ? faultLock() : allocatorLock(), m_fault_lock_stats);
 
     UInt64 fault_address = ctx.vpn << BASE_PAGE_SHIFT;
 
@@ -2,22 +2,16 @@
 #include "config.hpp"
 #include "allocator_factory.h"
 #include "dvfs_manager.h"
+#include "hooks_manager.h"
+#include "log.h"
 #include "debug_config.h"
+#include "core_manager.h"
+#include "core.h"
+#include "misc/exception_handler_base.h"
 
 #include <iostream>
 #include <sstream>
 
-// Static member definitions (for backward compatibility)
-std::unordered_map<std::string, uint64_t> MimicOS::protocol_codes_encode = {
-    {"page_fault", 1},
-    {"syscall", 2}
-};
-
-std::unordered_map<uint64_t, std::string> MimicOS::protocol_codes_decode = {
-    {1, "page_fault"},
-    {2, "syscall"}
-};
-
 // ============ Construction/Destruction ============
 
 MimicOS::MimicOS(bool is_guest)
@@ -52,6 +46,11 @@ MimicOS::MimicOS(bool is_guest)
     
     bool swap_enabled = Sim()->getCfg()->getBool("perf_model/" + m_name + "/swap_enabled");
     m_userspace_enabled = Sim()->getCfg()->getBool("general/enable_userspace_mimicos");
+
+    String snapshot_load = snapshotPath("general/mimicos_snapshot_load");
+    m_snapshot_save_path = snapshotPath("general/mimicos_snapshot_save").c_str();
+    LOG_ASSERT_ERROR(!m_userspace_enabled || (snapshot_load == "" && m_snapshot_save_path.empty()),
+                     "MimicOS snapshots are not supported with general/enable_userspace_mimicos");
     
 #if DEBUG_MIMICOS >= DEBUG_BASIC
     m_log << "[MimicOS] Page Table Type: " << m_page_table_type << std::endl;
@@ -74,7 +73,10 @@ MimicOS::MimicOS(bool is_guest)
             frag_mode_str = Sim()->getCfg()->getString("perf_model/" + allocator_name + "/fragmentation_mode");
         }
         
-        if (frag_mode_str == "count") {
+        if (snapshot_load != "") {
+            // The free lists are restored below, as fragmented as the snapshotted run left them
+            std::cout << "[MimicOS] Skipping fragmentation, memory state comes from " << snapshot_load << std::endl;
+        } else if (frag_mode_str == "count") {
             // Count-based fragmentation: fragment to exact number of free 2MB pages
             UInt64 target_free_2mb = 0;
             if (Sim()->getCfg()->hasKey("perf_model/" + allocator_name + "/target_free_2mb_pages")) {
@@ -149,6 +151,41 @@ MimicOS::MimicOS(bool is_guest)
         }
     }
     
+    // TLB shootdowns for the mappings this OS removes
+    m_tlb_shootdown = std::make_unique<TLBShootdown>(m_is_guest ? "tlb_shootdown_guest" : "tlb_shootdown");
+    
+    // Online VMA inference, for traces that come without a VMA file
+    String vma_inference_key = "perf_model/" + m_name + "/vma_inference";
+    m_vma_inference = Sim()->getCfg()->getBoolDefault(vma_inference_key, false);
+    if (Sim()->getCfg()->hasKey(vma_inference_key + "_gap_pages"))
+        m_vma_inference_params.gap_pages = Sim()->getCfg()->getInt(vma_inference_key + "_gap_pages");
+    if (Sim()->getCfg()->hasKey(vma_inference_key + "_time_split"))
+        m_vma_inference_params.time_split = Sim()->getCfg()->getInt(vma_inference_key + "_time_split");
+    if (Sim()->getCfg()->hasKey(vma_inference_key + "_wf_window"))
+        m_vma_inference_params.wf_window = Sim()->getCfg()->getInt(vma_inference_key + "_wf_window");
+    if (Sim()->getCfg()->hasKey(vma_inference_key + "_wf_split_delta"))
+        m_vma_inference_params.wf_split_delta = Sim()->getCfg()->getFloat(vma_inference_key + "_wf_split_delta");
+    if (Sim()->getCfg()->hasKey(vma_inference_key + "_max_regions"))
+        m_vma_inference_params.max_regions = Sim()->getCfg()->getInt(vma_inference_key + "_max_regions");
+    
+    if (snapshot_load != "") {
+        loadSnapshot(snapshot_load.c_str());
+    }
+    
+    if (!m_snapshot_save_path.empty()) {
+        String save_at = "end";
+        if (Sim()->getCfg()->hasKey("general/mimicos_snapshot_save_at")) {
+            save_at = Sim()->getCfg()->getString("general/mimicos_snapshot_save_at");
+        }
+        if (save_at == "roi_begin") {
+            Sim()->getHooksManager()->registerHook(HookType::HOOK_ROI_BEGIN, MimicOS::hookSaveSnapshot, (UInt64)this);
+        } else if (save_at == "end") {
+            Sim()->getHooksManager()->registerHook(HookType::HOOK_SIM_END, MimicOS::hookSaveSnapshot, (UInt64)this);
+        } else {
+            LOG_PRINT_ERROR("Unknown general/mimicos_snapshot_save_at value: %s (expected roi_begin or end)", save_at.c_str());
+        }
+    }
+    
     std::cout << "[MimicOS] Initialization complete" << std::endl;
 }
 
@@ -184,6 +221,15 @@ void MimicOS::createApplication(int app_id)
         return;
     }
     
+    // Page-table constructors carve their initial tables out of the kernel area; when the
+    // app comes from the snapshot, the restored kernel area already holds them. Guest hashed
+    // tables allocate from the host, so both allocators are rewound.
+    std::string snapshot_section = "app/" + std::to_string(app_id);
+    bool restore = m_snapshot.isOpen() && m_snapshot.hasSection(snapshot_section);
+    PhysicalMemoryAllocator* host_allocator = Sim()->getMimicOS() ? Sim()->getMimicOS()->getMemoryAllocator() : nullptr;
+    UInt64 kernel_mark = restore ? m_memory_allocator->getKernelAreaMark() : 0;
+    UInt64 host_kernel_mark = (restore && host_allocator) ? host_allocator->getKernelAreaMark() : 0;
+    
     // Create application context
     auto app = std::make_unique<ApplicationContext>(
         app_id,
@@ -196,10 +242,24 @@ void MimicOS::createApplication(int app_id)
     // Parse VMAs from trace file
     String app_id_str = std::to_string(app_id).c_str();
     
-    if (Sim()->getCfg()->hasKey("traceinput/thread_" + app_id_str)) {
-        String trace_file = Sim()->getCfg()->getString("traceinput/thread_" + app_id_str);
-        app->parseVMAsFromFile(std::string(trace_file.c_str()));
+    if (restore) {
+        m_memory_allocator->rewindKernelArea(kernel_mark);
+        if (host_allocator)
+            host_allocator->rewindKernelArea(host_kernel_mark);
+        
+        Snapshot::Section section = m_snapshot.section(snapshot_section);
+        if (!app->loadState(section)) {
+            LOG_PRINT_ERROR("[MimicOS] Application %d in snapshot %s does not match the configured %s page table / %s range table",
+                            app_id, m_snapshot_load_path.c_str(), m_page_table_type.c_str(), m_range_table_type.c_str());
+        }
+        m_log << "[MimicOS] Application " << app_id << " restored from snapshot" << std::endl;
+    } else if (Sim()->getCfg()->hasKey("traceinput/thread_" + app_id_str)
+               && app->parseVMAsFromFile(std::string(Sim()->getCfg()->getString("traceinput/thread_" + app_id_str).c_str()))) {
         m_log << "[MimicOS] VMAs for application " << app_id << " have been parsed" << std::endl;
+    } else if (m_vma_inference) {
+        // The trace thread feeds the memory accesses of the app
+        app->enableVMAInference(m_vma_inference_params);
+        m_log << "[MimicOS] No VMA file provided for application " << app_id << ", inferring VMAs online" << std::endl;
     } else {
         m_log << "[MimicOS] No VMA file provided for application " << app_id << std::endl;
     }
@@ -229,6 +289,132 @@ const ApplicationContext* MimicOS::getApplication(int app_id) const
     return nullptr;
 }
 
+// ============ Snapshots ============
+
+String MimicOS::snapshotPath(const String& key) const
+{
+    if (!Sim()->getCfg()->hasKey(key))
+        return "";
+    String path = Sim()->getCfg()->getString(key);
+    // The guest OS keeps its own image next to the host's
+    if (path != "" && m_is_guest)
+        path = path + ".guest";
+    return path;
+}
+
+SInt64 MimicOS::hookSaveSnapshot(UInt64 object, UInt64 argument)
+{
+    MimicOS* os = (MimicOS*)object;
+    os->saveSnapshot(os->m_snapshot_save_path);
+    return 0;
+}
+
+void MimicOS::saveSnapshot(const std::string& path)
+{
+    LOG_ASSERT_ERROR(m_memory_allocator, "[MimicOS] Snapshots need the sniper-space memory allocator");
+    
+    Snapshot::Writer writer;
+    writer.beginSection("mimicos");
+    writer.putString(std::string(m_page_table_type.c_str()));
+    writer.putString(std::string(m_range_table_type.c_str()));
+    writer.putString(std::string(m_memory_allocator->getName().c_str()));
+    
+    writer.beginSection("allocator");
+    if (!m_memory_allocator->saveState(writer)) {
+        LOG_PRINT_ERROR("[MimicOS] Memory allocator %s does not support snapshots", m_memory_allocator->getName().c_str());
+    }
+    if (m_swap_cache) {
+        writer.beginSection("swap_cache");
+        m_swap_cache->saveState(writer);
+    }
+    if (m_hugetlbfs) {
+        writer.beginSection("hugetlbfs");
+        m_hugetlbfs->saveState(writer);
+    }
+    
+    for (const auto& kv : m_applications) {
+        writer.beginSection("app/" + std::to_string(kv.first));
+        if (!kv.second->saveState(writer)) {
+            LOG_PRINT_ERROR("[MimicOS] The %s page table / %s range table do not support snapshots",
+                            m_page_table_type.c_str(), m_range_table_type.c_str());
+        }
+    }
+
+    // Frames the cores took from the host allocator for page tables but have not used yet
+    // (FINE page-fault locking): the saved allocator no longer has them
+    for (UInt32 core_id = 0; !m_is_guest && core_id < Sim()->getConfig()->getApplicationCores(); core_id++) {
+        const ExceptionHandlerBase* handler = Sim()->getCoreManager()->getCoreFromID(core_id)->getExceptionHandler();
+        if (handler && !handler->getPageTableFrameCache().empty()) {
+            writer.beginSection("pt_frame_cache/" + std::to_string(core_id));
+            writer.putVector(handler->getPageTableFrameCache());
+        }
+    }
+    
+    std::string error;
+    if (!writer.write(path, error)) {
+        LOG_PRINT_ERROR("[MimicOS] Cannot save snapshot: %s", error.c_str());
+    }
+    std::cout << "[MimicOS] Snapshot of " << m_name << " (" << m_applications.size() << " applications) saved to " << path << std::endl;
+}
+
+void MimicOS::loadSnapshot(const std::string& path)
+{
+    std::string error;
+    if (!m_snapshot.open(path, error)) {
+        LOG_PRINT_ERROR("[MimicOS] Cannot load snapshot: %s", error.c_str());
+    }
+    m_snapshot_load_path = path;
+    
+    std::string page_table_type, range_table_type, allocator_name;
+    Snapshot::Section header = m_snapshot.section("mimicos");
+    if (!header.getString(page_table_type) || !header.getString(range_table_type) || !header.getString(allocator_name)
+        || page_table_type != m_page_table_type.c_str() || range_table_type != m_range_table_type.c_str()
+        || allocator_name != m_memory_allocator->getName().c_str()) {
+        LOG_PRINT_ERROR("[MimicOS] Snapshot %s was taken with the %s allocator, %s page table and %s range table",
+                        path.c_str(), allocator_name.c_str(), page_table_type.c_str(), range_table_type.c_str());
+    }
+    
+    Snapshot::Section allocator = m_snapshot.section("allocator");
+    if (!m_memory_allocator->loadState(allocator)) {
+        LOG_PRINT_ERROR("[MimicOS] Snapshot %s does not match the configured %s allocator (or it does not support snapshots)",
+                        path.c_str(), m_memory_allocator->getName().c_str());
+    }
+    
+    // Components present in only one of the runs would silently start cold
+    if ((m_swap_cache != nullptr) != m_snapshot.hasSection("swap_cache")
+        || (m_hugetlbfs != nullptr) != m_snapshot.hasSection("hugetlbfs")) {
+        LOG_PRINT_ERROR("[MimicOS] Snapshot %s was taken with a different swap / HugeTLBfs configuration", path.c_str());
+    }
+    if (m_swap_cache) {
+        Snapshot::Section section = m_snapshot.section("swap_cache");
+        if (!m_swap_cache->loadState(section)) {
+            LOG_PRINT_ERROR("[MimicOS] Snapshot %s does not match the configured swap space", path.c_str());
+        }
+    }
+    if (m_hugetlbfs) {
+        Snapshot::Section section = m_snapshot.section("hugetlbfs");
+        if (!m_hugetlbfs->loadState(section)) {
+            LOG_PRINT_ERROR("[MimicOS] Snapshot %s does not match the configured HugeTLBfs pools", path.c_str());
+        }
+    }
+    
+    std::cout << "[MimicOS] Restored " << m_name << " from snapshot " << path << std::endl;
+}
+
+bool MimicOS::loadPageTableFrameCache(core_id_t core_id, std::vector<UInt64>& frames)
+{
+    std::string name = "pt_frame_cache/" + std::to_string(core_id);
+    if (!m_snapshot.isOpen() || !m_snapshot.hasSection(name))
+        return false;
+
+    Snapshot::Section section = m_snapshot.section(name);
+    if (!section.getVector(frames)) {
+        LOG_PRINT_ERROR("[MimicOS] Snapshot %s has a corrupt page-table frame cache for core %d",
+                        m_snapshot_load_path.c_str(), core_id);
+    }
+    return true;
+}
+
 // ============ Page Table Access ============
 
 ParametricDramDirectoryMSI::PageTable* MimicOS::getPageTable(int app_id)
@@ -245,7 +431,7 @@ ParametricDramDirectoryMSI::RangeTable* MimicOS::getRangeTable(int app_id)
 
 // ============ VMA Access ============
 
-std::vector<VMA>& MimicOS::getVMA(int app_id)
+const std::vector<VMA>& MimicOS::getVMA(int app_id)
 {
     auto* app = getApplication(app_id);
     if (app) {
@@ -256,6 +442,24 @@ std::vector<VMA>& MimicOS::getVMA(int app_id)
     return empty;
 }
 
+const VMA* MimicOS::findVMA(int app_id, IntPtr va, int core_id)
+{
+    auto* app = getApplication(app_id);
+    return app ? app->findVMA(va, core_id) : nullptr;
+}
+
+int MimicOS::findVMAIndex(int app_id, IntPtr va, int core_id)
+{
+    auto* app = getApplication(app_id);
+    return app ? app->findVMAIndex(va, core_id) : -1;
+}
+
+int MimicOS::lookupVMA(int app_id, IntPtr va, int core_id, IntPtr *base, IntPtr *end)
+{
+    auto* app = getApplication(app_id);
+    return app ? app->lookupVMA(va, core_id, base, end) : -1;
+}
+
 void MimicOS::setAllocatedVMA(int app_id, int vma_index)
 {
     auto* app = getApplication(app_id);
@@ -323,12 +527,15 @@ bool MimicOS::swapOutPage(IntPtr vpn, int app_id)
         m_log << "[MimicOS] Swapping out page: " << vpn << " for app_id: " << app_id << std::endl;
 #endif
         bool is_memory_full = false;
-        return m_swap_cache->swapOut(vpn, app_id, is_memory_full);
+        if (!m_swap_cache->swapOut(vpn, app_id, is_memory_full))
+            return false;
+        m_tlb_shootdown->invalidate(app_id, vpn << 12, TLBShootdown::SWAP);
+        return true;
     }
     return false;
 }
 
-void MimicOS::deletePageTableEntry(IntPtr victim_address, int app_id)
+void MimicOS::deletePageTableEntry(IntPtr victim_address, int app_id, TLBShootdown::reason_t reason)
 {
 #if DEBUG_MIMICOS >= DEBUG_BASIC
     m_log << "[MimicOS] Deleting page table entry for address: 0x" << std::hex << victim_address 
@@ -338,6 +545,7 @@ void MimicOS::deletePageTableEntry(IntPtr victim_address, int app_id)
     auto* app = getApplication(app_id);
     if (app) {
         app->deletePageTableEntry(victim_address);
+        m_tlb_shootdown->invalidate(app_id, victim_address, reason);
     } else {
         m_log << "[MimicOS] Application " << app_id << " does not exist" << std::endl;
     }
@@ -431,6 +639,7 @@ void MimicOS::initPerCorePageFaultState(UInt32 num_cores)
 {
     if (m_pf_states.empty()) {
         m_pf_states.resize(num_cores);
+        m_messages.resize(num_cores);
     }
 }
 
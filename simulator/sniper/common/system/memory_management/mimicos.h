@@ -9,6 +9,7 @@
 #include "memory_management/policies/hugetlbfs_policy.h"
 #include "memory_management/swap_cache.h"
 #include "memory_management/policies/swap_cache_policy.h"
+#include "tlb_shootdown.h"
 #include "subsecond_time.h"
 #include "fixed_types.h"
 
@@ -17,11 +18,6 @@
 #include <vector>
 #include <fstream>
 
-// Backward compatibility: old code used MimicOS_NS::Message
-namespace MimicOS_NS {
-    using Message = MimicOSMessage;
-}
-
 // Type aliases for Sniper-space policy-based templates
 using SniperHugeTLBfs  = ::HugeTLBfs<Sniper::HugeTLBfs::MetricsPolicy>;
 using SniperSwapCache  = ::SwapCache<Sniper::SwapCache::MetricsPolicy>;
@@ -183,7 +179,13 @@ public:
     
     // ============ VMA Access (convenience methods) ============
     
-    std::vector<VMA>& getVMA(int app_id);
+    const std::vector<VMA>& getVMA(int app_id);
+    
+    // Lookups through the application's VMA index; core_id selects its last-hit cache
+    const VMA* findVMA(int app_id, IntPtr va, int core_id = 0);
+    int findVMAIndex(int app_id, IntPtr va, int core_id = 0);
+    // Same, for callers outside the page-fault path (see ApplicationContext::lookupVMA)
+    int lookupVMA(int app_id, IntPtr va, int core_id, IntPtr *base = nullptr, IntPtr *end = nullptr);
     
     void setAllocatedVMA(int app_id, int vma_index);
     void setPhysicalOffset(int app_id, int vma_index, IntPtr offset);
@@ -218,7 +220,8 @@ public:
     bool isSwapEnabled() const { return m_swap_cache != nullptr; }
     SniperSwapCache* getSwapCache() { return m_swap_cache.get(); }
     bool swapOutPage(IntPtr vpn, int app_id);
-    void deletePageTableEntry(IntPtr vpn, int app_id);
+    // Removes the mapping of vpn and shoots down its translations, charged to reason
+    void deletePageTableEntry(IntPtr vpn, int app_id, TLBShootdown::reason_t reason = TLBShootdown::UNMAP);
     
     void setLastPageFaultCausedSwapping(bool caused_swapping) {
         m_last_pf_caused_swapping = caused_swapping;
@@ -260,10 +263,20 @@ public:
      */
     bool deallocateHugePage(IntPtr base_ppn, bool size_2mb = true);
     
+    // ============ TLB Shootdowns ============
+    
+    /**
+     * @brief Invalidation engine for the translations of this OS's page tables
+     *
+     * Page-table changes made outside MimicOS (e.g. memory-tier migration) report
+     * their invalidations here as well.
+     */
+    TLBShootdown* getTLBShootdown() { return m_tlb_shootdown.get(); }
+    
     // ============ Page Fault State (per-core) ============
     
     /**
-     * @brief Initialize per-core page fault state vectors
+     * @brief Initialize per-core page fault state and message rings
      * @param num_cores Number of cores in the system
      */
     void initPerCorePageFaultState(UInt32 num_cores);
@@ -312,11 +325,15 @@ public:
     
     bool isUserspaceMimicosEnabled() const { return m_userspace_enabled; }
     
-    MimicOSMessage* getMessage() { return &m_message; }
-    
-    template <typename... Args>
-    void buildMessageWithArgs(const std::string& message_type, Args&&... args) {
-        MimicOSProtocol::buildMessage(m_message, message_type, std::forward<Args>(args)...);
+    // Claim a fresh message buffer of the core's ring (request or reply being built)
+    MimicOSMessage& nextMessage(core_id_t core_id) {
+        assert(core_id >= 0 && (size_t)core_id < m_messages.size());
+        return m_messages[core_id].next();
+    }
+    // Message most recently built for / received from the core
+    MimicOSMessage& getMessage(core_id_t core_id) {
+        assert(core_id >= 0 && (size_t)core_id < m_messages.size());
+        return m_messages[core_id].current();
     }
     
     // ============ Configuration ============
@@ -340,11 +357,6 @@ public:
     
     UInt64 getAccessesPerVPN(IntPtr vpn, int app_id);
     
-    // ============ Protocol Codes (static, for external access) ============
-    
-    static std::unordered_map<std::string, uint64_t> protocol_codes_encode;
-    static std::unordered_map<uint64_t, std::string> protocol_codes_decode;
-    
     // ============ Per-Core Statistics ============
     
     /**
@@ -403,6 +415,26 @@ public:
      */
     bool isPerCoreStatsInitialized() const { return !m_per_core_stats.empty(); }
     
+    // ============ Snapshots ============
+
+    /**
+     * @brief Write a snapshot of the OS state: allocator, swap cache, HugeTLBfs, every
+     * application (VMAs, page table, range table) and, for the host, the page-table frames
+     * each core holds in its frame cache.
+     *
+     * Called at the point selected by general/mimicos_snapshot_save_at. A run started with
+     * general/mimicos_snapshot_load pointing to the file skips fragmentation, VMA parsing
+     * and the page faults the snapshotted run already took. Statistics are not part of it.
+     */
+    void saveSnapshot(const std::string& path);
+
+    /**
+     * @brief Frames core_id had in its page-table frame cache in the snapshot being loaded.
+     * The restored allocator counts them as allocated, so the core has to get them back.
+     * Returns false if there is no snapshot or the core had none.
+     */
+    bool loadPageTableFrameCache(core_id_t core_id, std::vector<UInt64>& frames);
+
     // ============ Deprecated ============
     
     /**
@@ -411,6 +443,10 @@ public:
     void handle_page_fault(IntPtr address, IntPtr core_id, int frames);
 
 private:
+    void loadSnapshot(const std::string& path);
+    String snapshotPath(const String& key) const;
+    static SInt64 hookSaveSnapshot(UInt64 object, UInt64 argument);
+
     // ============ Identity ============
     String m_name;
     bool m_is_guest;
@@ -420,13 +456,14 @@ private:
     std::unique_ptr<PhysicalMemoryAllocator> m_memory_allocator;
     std::unique_ptr<SniperSwapCache> m_swap_cache;
     std::unique_ptr<SniperHugeTLBfs> m_hugetlbfs;
+    std::unique_ptr<TLBShootdown> m_tlb_shootdown;
     
     // ============ Per-Application State ============
     std::unordered_map<int, std::unique_ptr<ApplicationContext>> m_applications;
     
     // ============ Page Fault State (per-core) ============
     std::vector<PageFaultState> m_pf_states;
-    MimicOSMessage m_message;
+    std::vector<MimicOSMessageRing> m_messages;
     bool m_last_pf_caused_swapping;
     
     // ============ Configuration ============
@@ -437,6 +474,13 @@ private:
     std::vector<int> m_page_sizes;
     ComponentLatency m_page_fault_latency;
     double m_target_fragmentation;
+    bool m_vma_inference;               // Infer the VMAs of apps that have no VMA file
+    VMAInference::Params m_vma_inference_params;
+    
+    // ============ Snapshots ============
+    Snapshot::Reader m_snapshot;        // Applications are restored from it as they are created
+    std::string m_snapshot_load_path;
+    std::string m_snapshot_save_path;
     
     // ============ Per-Core Statistics ============
     std::vector<PerCoreStats> m_per_core_stats;
@@ -9,6 +9,9 @@
 #include <random>
 #include <cstdint>
 #include "pwc.h"
+#include "misc/inline_vector.h"
+#include "vpn_side_table.h"
+#include "stats.h"
 #include <bitset>
 
 // #define DEBUG
@@ -48,8 +51,12 @@ namespace ParametricDramDirectoryMSI
 		}
 	};
 
-	/// Vector of page table accesses made during a walk
-	typedef std::vector<PTWAccess> accessedAddresses;
+	/// Max accesses kept inline: a nested 4x4 radix walk (24), or a radix walk replayed after a fault
+	/// plus PWC-filtered leftovers, fit; hash-table walks with long probe chains spill to the heap
+	static const size_t PTW_INLINE_ACCESSES = 32;
+
+	/// Page table accesses made during a walk (no heap allocation for typical walks)
+	typedef InlineVector<PTWAccess, PTW_INLINE_ACCESSES> accessedAddresses;
 
 	/**
 	 * @brief Result of a page table walk operation.
@@ -109,15 +116,21 @@ namespace ParametricDramDirectoryMSI
 		Core *core;
 		bool is_guest;
 
+		// Host memory held by the per-VPN side tables below
+		UInt64 m_side_table_host_bytes;
+
 		// This is used to track the number of accesses per virtual page number (VPN)
-		std::unordered_map<IntPtr, UInt64> accesses_per_vpn;
+		VPNSideTable<UInt64> accesses_per_vpn;
 
 		// Shadow PTE payload: stores per-VPN temporal offset data for the
 		// TLB prefetcher.  Keyed by VPN (address >> 12).
-		std::unordered_map<uint64_t, __uint128_t> shadow_pte_payload;
+		VPNSideTable<__uint128_t> shadow_pte_payload;
 
 	public:
 		PageTable(int core_id, String name, String type, int page_sizes, int *page_size_list, bool is_guest = false)
+			: m_side_table_host_bytes(0)
+			, accesses_per_vpn(&m_side_table_host_bytes)
+			, shadow_pte_payload(&m_side_table_host_bytes)
 		{
 			this->m_page_sizes = page_sizes;
 			this->m_page_size_list = page_size_list;
@@ -125,6 +138,8 @@ namespace ParametricDramDirectoryMSI
 			this->name = name;
 			this->is_guest = is_guest;
 			this->type = type;
+
+			registerStatsMetric(name, core_id, "side_table_host_bytes", &m_side_table_host_bytes);
 		};
 
 		virtual PTWResult initializeWalk(IntPtr address, bool count, bool is_prefetch = false, bool restart_walk = false) = 0;
@@ -143,14 +158,13 @@ namespace ParametricDramDirectoryMSI
 		/** Read the shadow payload word for a given VPN. Returns 0 if none stored. */
 		__uint128_t readPayloadBits(uint64_t vpn) const
 		{
-			auto it = shadow_pte_payload.find(vpn);
-			return (it != shadow_pte_payload.end()) ? it->second : 0;
+			return shadow_pte_payload.get(vpn);
 		}
 
 		/** Write (overwrite) the shadow payload word for a given VPN. */
 		void writePayloadBits(uint64_t vpn, __uint128_t payload)
 		{
-			shadow_pte_payload[vpn] = payload;
+			shadow_pte_payload.at(vpn) = payload;
 		}
 
 		/** Convenience: read payload during a walk and set it in the PTWResult. */
@@ -160,14 +174,31 @@ namespace ParametricDramDirectoryMSI
 		}
 		UInt64 getAccessesPerVPN(IntPtr vpn)
 		{
-			if (accesses_per_vpn.find(vpn) != accesses_per_vpn.end())
-			{
-				return accesses_per_vpn[vpn];
-			}
-			else
-			{
-				return 0;
-			}
+			return accesses_per_vpn.get(vpn);
 		};
+
+		// ----------------------------------------------------------------
+		// Snapshots
+		// ----------------------------------------------------------------
+
+		/**
+		 * Page tables that support snapshots override both and return true; the default reports
+		 * the type as unsupported. loadState is called on a freshly constructed table, and
+		 * overrides include the side tables through saveSideTables/loadSideTables.
+		 */
+		virtual bool saveState(Snapshot::Writer & /*writer*/) const { return false; }
+		virtual bool loadState(Snapshot::Section & /*section*/) { return false; }
+
+	protected:
+		void saveSideTables(Snapshot::Writer &writer) const
+		{
+			accesses_per_vpn.saveState(writer);
+			shadow_pte_payload.saveState(writer);
+		}
+
+		bool loadSideTables(Snapshot::Section &section)
+		{
+			return accesses_per_vpn.loadState(section) && shadow_pte_payload.loadState(section);
+		}
 	};
 }
@@ -10,6 +10,7 @@
 #include "physical_memory_allocator.h"
 #include "mimicos.h"
 #include "city.h"
+#include "misc/exception_handler_base.h"
 
 #include <iostream>
 #include <stdlib.h>
@@ -44,6 +45,9 @@ namespace ParametricDramDirectoryMSI
 	 *   - Each table is an array of "Element" objects, where each Element can store 8 offsets.
 	 *   - Allocates stat counters to track hits, page walks, evictions, and rehashes.
 	 *   - table_ppns[] keeps track of the "physical address" base for each table array.
+	 *   - With incremental_resize, a table that crosses the load factor is resized the way
+	 *     elastic cuckoo hashing does it: old and new ways coexist and every insert and walk
+	 *     migrates migration_buckets buckets, instead of re-inserting everything at once.
 	 */
 	PageTableCuckoo::PageTableCuckoo(int core_id,
 									 String name,
@@ -54,9 +58,13 @@ namespace ParametricDramDirectoryMSI
 									 double rehash_threshold,
 									 float scale,
 									 int ways,
-									 bool is_guest)
+									 bool is_guest,
+									 bool incremental_resize,
+									 int migration_buckets)
 		: PageTable(core_id, name, type, page_sizes, page_size_list, is_guest),
-		  m_page_table_sizes(page_table_sizes)
+		  m_page_table_sizes(page_table_sizes),
+		  m_incremental_resize(incremental_resize),
+		  m_migration_buckets(migration_buckets)
 	{
 		log_file_name = "page_table_cuckoo.log";
 		log_file_name = std::string(Sim()->getConfig()->getOutputDirectory().c_str()) + "/" + log_file_name;
@@ -117,12 +125,18 @@ namespace ParametricDramDirectoryMSI
 			}
 		}
 
+		Migration idle = {false, 0, 0, NULL, NULL};
+		migrations.assign(page_sizes, idle);
+		grow_pending.assign(page_sizes, false);
+
 		std::cout << "[Cuckoo] Cuckoo initialized\n";
 
 		cuckoo_stats.cuckoo_hits = 0;
 		cuckoo_stats.page_walks_total = 0;
 		cuckoo_stats.cuckoo_evictions = 0;
 		cuckoo_stats.rehashes = 0;
+		cuckoo_stats.migrated_buckets = 0;
+		cuckoo_stats.resize_extra_accesses = 0;
 
 		std::cout << "[Cuckoo] Registering ECH Page Table stats with name " << name << " and core " << core_id << "\n";
 
@@ -130,6 +144,8 @@ namespace ParametricDramDirectoryMSI
 		registerStatsMetric(name, core_id, "ptws_total", &cuckoo_stats.page_walks_total);
 		registerStatsMetric(name, core_id, "evictions", &cuckoo_stats.cuckoo_evictions);
 		registerStatsMetric(name, core_id, "rehashes", &cuckoo_stats.rehashes);
+		registerStatsMetric(name, core_id, "migrated_buckets", &cuckoo_stats.migrated_buckets);
+		registerStatsMetric(name, core_id, "resize_extra_accesses", &cuckoo_stats.resize_extra_accesses);
 
 		// For each page size, track hits at that level and number of accesses
 		cuckoo_stats.cuckoo_hits_per_level = new UInt64[page_sizes];
@@ -551,6 +567,185 @@ namespace ParametricDramDirectoryMSI
 		return true;
 	}
 
+	/*
+	 * beginResize(...):
+	 *   - Incremental counterpart of rehash(): allocates the new ways and parks the old ones
+	 *     in migrations[page_size_index]. Nothing is moved yet.
+	 *   - From now on inserts go to the new ways, and walks probe both the new ways and the
+	 *     old buckets that have not been migrated.
+	 */
+	void PageTableCuckoo::beginResize(int page_size_index, int new_size)
+	{
+		log_file << "[Cuckoo] Incremental resize of page size " << m_page_size_list[page_size_index]
+				 << " from " << m_page_table_sizes[page_size_index] << " to " << new_size << " entries\n";
+
+		freeRetiredTables();
+
+		Migration &migration = migrations[page_size_index];
+		migration.active = true;
+		migration.old_size = m_page_table_sizes[page_size_index];
+		migration.next_bucket = 0;
+		migration.old_tables = tables[page_size_index];
+		migration.old_table_ppns = table_ppns[page_size_index];
+
+		tables[page_size_index] = (Element **)malloc(sizeof(Element *) * m_ways);
+		table_ppns[page_size_index] = (UInt64 *)malloc(sizeof(UInt64) * m_ways);
+		for (int i = 0; i < m_ways; i++)
+		{
+			tables[page_size_index][i] = (Element *)malloc(sizeof(Element) * new_size);
+			for (int j = 0; j < new_size; j++)
+			{
+				tables[page_size_index][i][j] = Element();
+			}
+			// Old and new ways are live at the same time, so the new ones need their own space
+			table_ppns[page_size_index][i] = getPhysicalSpace(new_size * 64);
+		}
+		m_page_table_sizes[page_size_index] = new_size;
+	}
+
+	/*
+	 * migrateBuckets(...):
+	 *   - Moves the next 'buckets' buckets (the same position in every old way) into the new ways.
+	 *   - Finishes the resize once the last bucket is moved.
+	 *   - Returns false if an element could not be placed (it is then in nonResidentEntries).
+	 */
+	bool PageTableCuckoo::migrateBuckets(int page_size_index, int buckets)
+	{
+		Migration &migration = migrations[page_size_index];
+		bool resident = true;
+		for (; buckets > 0 && migration.next_bucket < migration.old_size; buckets--)
+		{
+			for (int way = 0; way < m_ways; way++)
+			{
+				resident = migrateSlot(page_size_index, way, migration.next_bucket) && resident;
+			}
+			migration.next_bucket++;
+			cuckoo_stats.migrated_buckets++;
+		}
+
+		if (migration.next_bucket == migration.old_size)
+			finishResize(page_size_index);
+		return resident;
+	}
+
+	/*
+	 * migrateSlot(...) => re-inserts one old element in the new ways (one insert per valid
+	 * offset, the later ones merge into the first), then empties its old slot. Walks look
+	 * elements up without the page-table lock, so the element stays reachable in the old slot
+	 * until its copy is in place.
+	 */
+	bool PageTableCuckoo::migrateSlot(int page_size_index, int way, int pos)
+	{
+		Element element = migrations[page_size_index].old_tables[way][pos];
+		if (element.tag == static_cast<uint64_t>(-1))
+			return true;
+
+		bool resident = true;
+		for (int i = 0; i < 8; i++)
+		{
+			if (element.validityBits[i])
+			{
+				uint64_t VPN = (element.tag << 3) + i;
+				uint64_t address = VPN << m_page_size_list[page_size_index];
+				resident = get<0>(insertElement(page_size_index, element, address)) && resident;
+			}
+		}
+
+		migrations[page_size_index].old_tables[way][pos] = Element();
+		numItems[page_size_index]--; // Counted again when it landed in the new ways
+		return resident;
+	}
+
+	/*
+	 * migrateTag(...) => moves the element holding 'tag' out of the old ways ahead of the
+	 * migration pointer, so that an insert for that tag merges into a single element.
+	 */
+	bool PageTableCuckoo::migrateTag(int page_size_index, IntPtr tag)
+	{
+		const Migration &migration = migrations[page_size_index];
+		bool resident = true;
+		for (int way = 0; way < m_ways; way++)
+		{
+			int pos = hash(tag + way, migration.old_size);
+			if (pos >= migration.next_bucket && migration.old_tables[way][pos].tag == tag)
+				resident = migrateSlot(page_size_index, way, pos) && resident;
+		}
+		return resident;
+	}
+
+	/*
+	 * finishResize(...):
+	 *   - All old buckets are empty. Walks that started before may still be reading the old
+	 *     ways, so they are only freed when the next resize begins.
+	 */
+	void PageTableCuckoo::finishResize(int page_size_index)
+	{
+		Migration &migration = migrations[page_size_index];
+		retired_migrations.push_back(migration);
+		migration.active = false;
+		cuckoo_stats.rehashes++;
+		log_file << "[Cuckoo] Incremental resize of page size " << m_page_size_list[page_size_index] << " finished\n";
+	}
+
+	void PageTableCuckoo::freeRetiredTables()
+	{
+		for (const Migration &migration : retired_migrations)
+		{
+			for (int i = 0; i < m_ways; i++)
+			{
+				free(migration.old_tables[i]);
+			}
+			free(migration.old_tables);
+			free(migration.old_table_ppns);
+		}
+		retired_migrations.clear();
+	}
+
+	/*
+	 * growAfterOverflow(...):
+	 *   - An element could not be placed even after cuckooing. A pending incremental resize is
+	 *     completed at once, then the table grows stop-the-world until everything fits.
+	 *   - Never called from a walk: a walk that overflows sets grow_pending, and the next
+	 *     updatePageTableFrames() grows the table under the lock of the fault handler.
+	 */
+	void PageTableCuckoo::growAfterOverflow(int page_size_index)
+	{
+		grow_pending[page_size_index] = false;
+		if (migrations[page_size_index].active)
+			migrateBuckets(page_size_index, migrations[page_size_index].old_size);
+
+		int new_size = m_page_table_sizes[page_size_index] * m_scale;
+		while (!rehash(page_size_index, new_size))
+		{
+			new_size *= m_scale;
+			log_file << "[Cuckoo] Rehash failed, trying again with new size " << new_size << "\n";
+		}
+	}
+
+	/*
+	 * walkMigrationPending(...) => true if some page size has buckets that walks should migrate.
+	 * Read without the lock, so that walks only take it while a resize is in progress.
+	 */
+	bool PageTableCuckoo::walkMigrationPending() const
+	{
+		for (int i = 0; i < m_page_sizes; i++)
+		{
+			if (migrations[i].active && !grow_pending[i])
+				return true;
+		}
+		return false;
+	}
+
+	/*
+	 * updateLock(...) => the lock the fault handlers hold while they call updatePageTableFrames()
+	 * on this table (core_id is the application id, see PageTableFactory)
+	 */
+	BaseLock &PageTableCuckoo::updateLock() const
+	{
+		MimicOS *os = is_guest ? Sim()->getMimicOS_VM() : Sim()->getMimicOS();
+		return ExceptionHandlerBase::pageTableUpdateLock(os, core_id);
+	}
+
 	/*
 	 * currentLoadFactor(...) => calculates (numItems / (table_size * ways)).
 	 * If this exceeds 'loadFactor', we trigger rehash in updatePageTableFrames().
@@ -560,6 +755,134 @@ namespace ParametricDramDirectoryMSI
 		return (double)numItems[page_size_index] / (m_page_table_sizes[page_size_index] * m_ways);
 	}
 
+	/*
+	 * saveState(...) / loadState(...):
+	 *   - Per page size: table size, item count, and for every way its base PPN and raw
+	 *     Element array (positions are kept, so no re-insertion or cuckooing on restore).
+	 *   - A resize in progress is saved with its old ways, migration pointer and pending grow.
+	 *   - Then the elements that did not fit and the PMD-level CWT entries.
+	 */
+	bool PageTableCuckoo::saveState(Snapshot::Writer &writer) const
+	{
+		writer.put(m_page_sizes);
+		writer.putArray(m_page_size_list, m_page_sizes);
+		writer.put(m_ways);
+		for (int a = 0; a < m_page_sizes; a++)
+		{
+			writer.put(m_page_table_sizes[a]);
+			writer.put(numItems[a]);
+			writer.putArray(table_ppns[a], m_ways);
+			for (int i = 0; i < m_ways; i++)
+				writer.putArray(tables[a][i], m_page_table_sizes[a]);
+
+			const Migration &migration = migrations[a];
+			writer.put(migration.active);
+			if (migration.active)
+			{
+				writer.put(migration.old_size);
+				writer.put(migration.next_bucket);
+				writer.put<bool>(grow_pending[a]);
+				writer.putArray(migration.old_table_ppns, m_ways);
+				for (int i = 0; i < m_ways; i++)
+					writer.putArray(migration.old_tables[i], migration.old_size);
+			}
+		}
+		writer.putVector(nonResidentEntries);
+
+		std::vector<SnapshotCwtEntry> cwt_entries;
+		cwt_entries.reserve(pmd_cwt_entries.size());
+		for (const auto &kv : pmd_cwt_entries)
+			cwt_entries.push_back(SnapshotCwtEntry{kv.first, kv.second});
+		writer.putVector(cwt_entries);
+
+		saveSideTables(writer);
+		return true;
+	}
+
+	bool PageTableCuckoo::loadState(Snapshot::Section &section)
+	{
+		int page_sizes = 0, ways = 0;
+		const int *page_size_list = section.get(page_sizes) && page_sizes == m_page_sizes ? section.getArray<int>(page_sizes) : NULL;
+		if (!page_size_list || !std::equal(page_size_list, page_size_list + page_sizes, m_page_size_list)
+			|| !section.get(ways) || ways != m_ways)
+			return false;
+
+		for (int a = 0; a < m_page_sizes; a++)
+		{
+			int size = 0;
+			const UInt64 *ppns = NULL;
+			if (!section.get(size) || !section.get(numItems[a]) || !(ppns = section.getArray<UInt64>(m_ways)))
+				return false;
+
+			for (int i = 0; i < m_ways; i++)
+			{
+				const Element *elements = section.getArray<Element>(size);
+				if (!elements)
+					return false;
+				// Tables may have been rehashed to a larger size during warmup
+				if (size != m_page_table_sizes[a])
+				{
+					free(tables[a][i]);
+					tables[a][i] = (Element *)malloc(sizeof(Element) * size);
+				}
+				memcpy(tables[a][i], elements, sizeof(Element) * size);
+				table_ppns[a][i] = ppns[i];
+			}
+			m_page_table_sizes[a] = size;
+
+			bool active = false;
+			if (!section.get(active))
+				return false;
+			if (active)
+			{
+				Migration migration = {true, 0, 0, NULL, NULL};
+				const UInt64 *old_ppns = NULL;
+				bool pending = false;
+				if (!section.get(migration.old_size) || !section.get(migration.next_bucket) || !section.get(pending)
+					|| !(old_ppns = section.getArray<UInt64>(m_ways)))
+					return false;
+
+				std::vector<const Element *> old_elements;
+				for (int i = 0; i < m_ways; i++)
+				{
+					old_elements.push_back(section.getArray<Element>(migration.old_size));
+					if (!old_elements.back())
+						return false;
+				}
+
+				migration.old_table_ppns = (UInt64 *)malloc(sizeof(UInt64) * m_ways);
+				memcpy(migration.old_table_ppns, old_ppns, sizeof(UInt64) * m_ways);
+				migration.old_tables = (Element **)malloc(sizeof(Element *) * m_ways);
+				for (int i = 0; i < m_ways; i++)
+				{
+					migration.old_tables[i] = (Element *)malloc(sizeof(Element) * migration.old_size);
+					memcpy(migration.old_tables[i], old_elements[i], sizeof(Element) * migration.old_size);
+				}
+				migrations[a] = migration;
+				grow_pending[a] = pending;
+			}
+		}
+
+		std::vector<SnapshotCwtEntry> cwt_entries;
+		if (!section.getVector(nonResidentEntries) || !section.getVector(cwt_entries))
+			return false;
+
+		// Saved mid-resize by an incremental run: a stop-the-world one finishes it now
+		for (int a = 0; a < m_page_sizes && !m_incremental_resize; a++)
+		{
+			if (grow_pending[a])
+				growAfterOverflow(a);
+			else if (migrations[a].active)
+				migrateBuckets(a, migrations[a].old_size);
+		}
+
+		pmd_cwt_entries.clear();
+		for (const SnapshotCwtEntry &e : cwt_entries)
+			pmd_cwt_entries[e.key] = e.entry;
+
+		return loadSideTables(section);
+	}
+
 	/*
 	 * initializeWalk(...):
 	 *   - For each page size, compute a tag and offset from the address.
@@ -582,6 +905,19 @@ namespace ParametricDramDirectoryMSI
 		int page_size_result = -1;
 		IntPtr ppn_result = 0;
 
+		// Walks advance pending resizes too, so that they finish even when inserts stop. They move
+		// buckets under the lock the fault handlers update the table with. An element that does not
+		// fit waits in nonResidentEntries, and the table is grown by the next insert, not by the walk.
+		if (m_incremental_resize && walkMigrationPending())
+		{
+			ScopedLock sl(updateLock());
+			for (int i = 0; i < m_page_sizes; i++)
+			{
+				if (migrations[i].active && !grow_pending[i] && !migrateBuckets(i, m_migration_buckets))
+					grow_pending[i] = true;
+			}
+		}
+
 	restart_walk:
 
 		// Attempt a lookup in each page size
@@ -667,6 +1003,48 @@ namespace ParametricDramDirectoryMSI
 					cuckoo_stats.cuckoo_accesses[i]++;
 				}
 			}
+
+			// While this page size is being resized, the old buckets that have not been migrated
+			// yet may still hold the translation: they are probed too, after the new ways
+			const Migration &migration = migrations[i];
+			if (migration.active)
+			{
+				for (int a = 0; a < m_ways; ++a)
+				{
+					int old_pos = hash(tag + a, migration.old_size);
+					if (old_pos < migration.next_bucket)
+						continue; // Already moved to the new ways
+
+					Element &element = migration.old_tables[a][old_pos];
+					bool hit = element.tag == tag && element.validityBits[offset];
+					if (hit)
+					{
+						last_walked_element = &element;
+						ppn_result = element.frames[offset];
+						page_size_result = m_page_size_list[i];
+						if (count)
+							cuckoo_stats.cuckoo_hits_per_level[i]++;
+					}
+					visitedAddresses.push_back(PTWAccess(i, 0, (IntPtr)(migration.old_table_ppns[a] * 4096 + old_pos * 64), hit));
+					cuckoo_stats.cuckoo_accesses[i]++;
+					cuckoo_stats.resize_extra_accesses++;
+				}
+			}
+
+			// Elements a walk could not migrate stay mapped until the next insert grows the table
+			if (grow_pending[i])
+			{
+				ScopedLock sl(updateLock());
+				for (Element &element : nonResidentEntries)
+				{
+					if (element.tag == tag && element.validityBits[offset])
+					{
+						last_walked_element = &element;
+						ppn_result = element.frames[offset];
+						page_size_result = m_page_size_list[i];
+					}
+				}
+			}
 		}
 
 		// We want to assume perfect CWCs -> we find the page size for free
@@ -727,7 +1105,8 @@ namespace ParametricDramDirectoryMSI
 	/*
 	 * updatePageTableFrames(...):
 	 *   - Called whenever we need to map "address" -> "ppn" for a given page_size.
-	 *   - If the load factor is too high, we rehash with an increased table size.
+	 *   - If the load factor is too high, we rehash with an increased table size
+	 *     (or, with incremental_resize, begin a resize / migrate a few more buckets).
 	 *   - Then we build an Element object from the (tag, offset, and ppn) and attempt to insert it.
 	 *   - If insertion fails, we attempt to rehash repeatedly until successful.
 	 */
@@ -750,8 +1129,25 @@ namespace ParametricDramDirectoryMSI
 			}
 		}
 
+		// The caller holds updateLock(), so walks on other cores are not migrating buckets.
+		// Grow the tables they could not migrate into first.
+		for (int i = 0; i < m_page_sizes; i++)
+		{
+			if (grow_pending[i])
+				growAfterOverflow(i);
+		}
+
+		bool resident = true;
+		if (migrations[page_size_index].active)
+		{
+			resident = migrateBuckets(page_size_index, m_migration_buckets);
+		}
+		else if (m_incremental_resize && currentLoadFactor(page_size_index) > loadFactor)
+		{
+			beginResize(page_size_index, m_page_table_sizes[page_size_index] * m_scale);
+		}
 		// If we exceed loadFactor => rehash
-		if (currentLoadFactor(page_size_index) > loadFactor)
+		else if (currentLoadFactor(page_size_index) > loadFactor)
 		{
 			// Scale the size by m_scale factor
 			int new_size = m_page_table_sizes[page_size_index] * m_scale;
@@ -773,22 +1169,17 @@ namespace ParametricDramDirectoryMSI
 		entry.validityBits[offset] = true;
 		entry.frames[offset] = ppn;
 
-		int new_size = m_page_table_sizes[page_size_index];
+		// Other offsets of this tag may still sit in an old bucket: move them first, so that
+		// the tag lives in a single element
+		if (migrations[page_size_index].active)
+			resident = migrateTag(page_size_index, tag) && resident;
 
 		// Attempt to insert the new Element
 		std::tuple<bool, accessedAddresses> result = insertElement(page_size_index, entry, address);
 
-		// If it fails => keep rehashing with bigger sizes until success
-
-		if (get<0>(result) == false)
-		{
-			new_size *= m_scale;
-			while (!rehash(page_size_index, new_size))
-			{
-				new_size *= m_scale;
-				log_file << "[Cuckoo] Rehash failed, trying again with new size " << new_size << "\n";
-			}
-		}
+		// If it (or a migrated element) fails => keep rehashing with bigger sizes until success
+		if (get<0>(result) == false || !resident)
+			growAfterOverflow(page_size_index);
 
 		IntPtr offset_in_cwt = (address >> 24) & 0x3F;
 		IntPtr cwc_tag = address >> 30;
@@ -837,30 +1228,38 @@ namespace ParametricDramDirectoryMSI
 		IntPtr tag = VPN >> 3;
 		IntPtr indexInsideBlock = VPN % 8;
 
-		for (int a = 0; a < m_ways; ++a)
+		// During a resize the element may still be in an old bucket that was not migrated
+		Element *element = NULL;
+		for (int a = 0; a < m_ways && !element; ++a)
 		{
 			uint64_t pos = hash(tag + a, m_page_table_sizes[0]);
 			if (tables[0][a][pos].tag == tag)
-			{
-				tables[0][a][pos].validityBits[indexInsideBlock] = false;
-				tables[0][a][pos].frames[indexInsideBlock] = -1;
+				element = &tables[0][a][pos];
+		}
+		for (int a = 0; a < m_ways && !element && migrations[0].active; ++a)
+		{
+			int pos = hash(tag + a, migrations[0].old_size);
+			if (pos >= migrations[0].next_bucket && migrations[0].old_tables[a][pos].tag == tag)
+				element = &migrations[0].old_tables[a][pos];
+		}
+		if (!element)
+			return;
 
-				// If any offset remains valid, we keep the tag
-				for (int j = 0; j < 8; j++)
-				{
-					if (tables[0][a][pos].validityBits[j])
-					{
-						found = true;
-						break;
-					}
-				}
-				// If not found => occupant is fully empty
-				if (!found)
-					tables[0][a][pos].tag = -1;
+		element->validityBits[indexInsideBlock] = false;
+		element->frames[indexInsideBlock] = -1;
 
+		// If any offset remains valid, we keep the tag
+		for (int j = 0; j < 8; j++)
+		{
+			if (element->validityBits[j])
+			{
+				found = true;
 				break;
 			}
 		}
+		// If not found => occupant is fully empty
+		if (!found)
+			element->tag = -1;
 	}
 
 	/*
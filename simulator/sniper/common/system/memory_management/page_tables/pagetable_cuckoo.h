@@ -2,6 +2,7 @@
 #include "subsecond_time.h"
 #include "fixed_types.h"
 #include "city.h"
+#include "lock.h"
 #include <stdint.h>
 #include <vector>
 #include <fstream>
@@ -47,6 +48,22 @@ namespace ParametricDramDirectoryMSI
 
 		std::vector<Element> nonResidentEntries;
 
+		// Incremental (elastic) resizing: while a page size is being resized, tables[] holds the
+		// new, larger ways and the old ones stay reachable until all their buckets are migrated
+		struct Migration
+		{
+			bool active;
+			int old_size;
+			int next_bucket; // Buckets [0, next_bucket) of every old way have been moved
+			Element **old_tables;
+			UInt64 *old_table_ppns;
+		};
+
+		bool m_incremental_resize;
+		int m_migration_buckets;		// Old buckets moved per insert and per walk
+		std::vector<Migration> migrations; // One per page size
+		std::vector<Migration> retired_migrations; // Old ways of finished resizes, freed on the next one
+		std::vector<bool> grow_pending;	// A walk could not place a migrated element: the next insert grows the table
 
 
 
@@ -56,6 +73,8 @@ namespace ParametricDramDirectoryMSI
 			UInt64 cuckoo_hits;
 			UInt64 cuckoo_evictions;
 			UInt64 rehashes;
+			UInt64 migrated_buckets;
+			UInt64 resize_extra_accesses;
 			UInt64 *cuckoo_accesses;
 			UInt64 *cuckoo_hits_per_level;
 		} cuckoo_stats;
@@ -65,30 +84,51 @@ namespace ParametricDramDirectoryMSI
 
 		Element *last_walked_element;
 
+		// Snapshot record of one pmd_cwt_entries entry
+		struct SnapshotCwtEntry
+		{
+			IntPtr key;
+			PmdCwtEntry entry;
+		};
+
 		void accessTable(IntPtr address);
 
+		void beginResize(int page_size_index, int new_size);
+		bool migrateBuckets(int page_size_index, int buckets);
+		bool migrateSlot(int page_size_index, int way, int pos);
+		bool migrateTag(int page_size_index, IntPtr tag);
+		void finishResize(int page_size_index);
+		void freeRetiredTables();
+		void growAfterOverflow(int page_size_index);
+		bool walkMigrationPending() const;
+		BaseLock &updateLock() const;
+
 	public:
 
 		std::unordered_map<IntPtr, PmdCwtEntry> pmd_cwt_entries;
 
 
 		PageTableCuckoo(int core_id, String name, String type, int page_sizes, int *page_size_list,
-						int *page_table_sizes, double rehash_threshold, float scale, int ways, bool is_guest = false);
+						int *page_table_sizes, double rehash_threshold, float scale, int ways, bool is_guest = false,
+						bool incremental_resize = false, int migration_buckets = 4);
 
 		~PageTableCuckoo()
 		{
 			for (int i = 0; i < m_page_sizes; ++i)
 			{
+				if (migrations[i].active)
+					retired_migrations.push_back(migrations[i]);
 				for (int j = 0; j < m_ways; ++j)
 				{
-					delete[] tables[i][j];
+					free(tables[i][j]);
 				}
-				delete[] tables[i];
-				delete[] table_ppns[i];
+				free(tables[i]);
+				free(table_ppns[i]);
 			}
-			delete[] tables;
-			delete[] table_ppns;
-			delete[] numItems;
+			freeRetiredTables();
+			free(tables);
+			free(table_ppns);
+			free(numItems);
 			delete[] m_page_table_sizes;
 		}
 
@@ -108,5 +148,8 @@ namespace ParametricDramDirectoryMSI
 		
 		void display() const;
 		void deletePage(IntPtr address);
+
+		bool saveState(Snapshot::Writer &writer) const;
+		bool loadState(Snapshot::Section &section);
 	};
 }
@@ -12,9 +12,9 @@ namespace ParametricDramDirectoryMSI
 	class PageTableFactory
 	{
 	public:
-		static PageTable *createCuckooPageTable(int core_id, String name, String type, int page_sizes, int *page_size_list, int *page_table_sizes, double rehash_threshold, float scale, int ways, bool is_guest)
+		static PageTable *createCuckooPageTable(int core_id, String name, String type, int page_sizes, int *page_size_list, int *page_table_sizes, double rehash_threshold, float scale, int ways, bool is_guest, bool incremental_resize, int migration_buckets)
 		{
-			return new PageTableCuckoo(core_id, name, type, page_sizes, page_size_list, page_table_sizes, rehash_threshold, scale, ways, is_guest);
+			return new PageTableCuckoo(core_id, name, type, page_sizes, page_size_list, page_table_sizes, rehash_threshold, scale, ways, is_guest, incremental_resize, migration_buckets);
 		}
 
 		static PageTable *createRadixPageTable(int app_id, String name, String type, int page_sizes, int *page_size_list, int levels, int frame_size, bool is_guest)
@@ -82,7 +82,20 @@ namespace ParametricDramDirectoryMSI
 				{
 					page_table_size_list[i] = Sim()->getCfg()->getIntArray("perf_model/" + name + "/page_table_size_list", i);
 				}
-				return createCuckooPageTable(app_id, name, type, page_sizes, page_size_list, page_table_size_list, rehash_threshold, scale, ways, is_guest);
+				// stop_the_world re-inserts everything when a table grows, incremental migrates a few buckets per insert/walk
+				String resize_mode = "stop_the_world";
+				if (Sim()->getCfg()->hasKey("perf_model/" + name + "/resize_mode"))
+					resize_mode = Sim()->getCfg()->getString("perf_model/" + name + "/resize_mode");
+				LOG_ASSERT_ERROR(resize_mode == "stop_the_world" || resize_mode == "incremental",
+								 "Unknown perf_model/%s/resize_mode: %s (expected stop_the_world or incremental)", name.c_str(), resize_mode.c_str());
+
+				int migration_buckets = 4;
+				if (Sim()->getCfg()->hasKey("perf_model/" + name + "/migration_buckets"))
+					migration_buckets = Sim()->getCfg()->getInt("perf_model/" + name + "/migration_buckets");
+				LOG_ASSERT_ERROR(migration_buckets > 0, "perf_model/%s/migration_buckets must be > 0", name.c_str());
+
+				return createCuckooPageTable(app_id, name, type, page_sizes, page_size_list, page_table_size_list, rehash_threshold, scale, ways, is_guest,
+											 resize_mode == "incremental", migration_buckets);
 			}
 
 			if (type == "radix")
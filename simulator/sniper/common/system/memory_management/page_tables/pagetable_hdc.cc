@@ -183,6 +183,54 @@ namespace ParametricDramDirectoryMSI
 		free(emulated_table_address);
 	}
 
+	/*
+	 * saveState(...) / loadState(...):
+	 *   - Per page size: table size, emulated base address, occupancy and the raw entry array
+	 *     (positions are kept, so the linear-probe distances stay valid).
+	 */
+	bool PageTableHDC::saveState(Snapshot::Writer &writer) const
+	{
+		writer.put(m_page_sizes);
+		writer.putArray(m_page_size_list, m_page_sizes);
+		for (int i = 0; i < m_page_sizes; i++)
+		{
+			writer.put(m_page_table_sizes[i]);
+			writer.put(emulated_table_address[i]);
+			writer.put(m_entry_count[i]);
+			writer.putArray(page_tables[i], m_page_table_sizes[i]);
+		}
+		saveSideTables(writer);
+		return true;
+	}
+
+	bool PageTableHDC::loadState(Snapshot::Section &section)
+	{
+		int page_sizes = 0;
+		const int *page_size_list = section.get(page_sizes) && page_sizes == m_page_sizes ? section.getArray<int>(page_sizes) : NULL;
+		if (!page_size_list || !std::equal(page_size_list, page_size_list + page_sizes, m_page_size_list))
+			return false;
+
+		for (int i = 0; i < m_page_sizes; i++)
+		{
+			int size = 0;
+			if (!section.get(size) || !section.get(emulated_table_address[i]) || !section.get(m_entry_count[i]))
+				return false;
+			const Entry *entries = section.getArray<Entry>(size);
+			if (!entries)
+				return false;
+
+			// Tables may have been resized during warmup
+			if (size != m_page_table_sizes[i])
+			{
+				free(page_tables[i]);
+				page_tables[i] = (Entry *)malloc(sizeof(Entry) * size);
+				m_page_table_sizes[i] = size;
+			}
+			memcpy(page_tables[i], entries, sizeof(Entry) * size);
+		}
+		return loadSideTables(section);
+	}
+
 	/*
 	 * printVectorStatistics():
 	 *   - If using LOG_MEAN_STD, we write the latest standard deviation and mean to the 
@@ -221,7 +269,6 @@ namespace ParametricDramDirectoryMSI
 		log_file << "[HDC] Initializing page table walk for address " << address << std::endl;
 #endif
 		accessedAddresses visited_addresses;
-		visited_addresses.reserve(50); // Reserving space for optimization, not mandatory
 
 		bool is_pagefault_in_every_page_size = false;
 
@@ -56,6 +56,8 @@ namespace ParametricDramDirectoryMSI
 		PTWResult initializeWalk(IntPtr address, bool count, bool is_prefetch = false, bool restart_walk = false);
 		int updatePageTableFrames(IntPtr address, IntPtr core_id, IntPtr ppn, int page_size, std::vector<UInt64> frames);
 		void deletePage(IntPtr address);
+		bool saveState(Snapshot::Writer &writer) const;
+		bool loadState(Snapshot::Section &section);
 
 		void printPageTable();
 		void calculate_mean();
@@ -178,6 +178,105 @@ namespace ParametricDramDirectoryMSI
         free(table_pa);
     }
 
+    /*
+     * saveState(...) / loadState(...)
+     *   - Per page size: table size, table_pa, occupancy, then every root slot followed by its chain.
+     *   - Chained entries keep their emulated physical addresses, so walks touch the same lines.
+     */
+    bool PageTableHT::saveState(Snapshot::Writer &writer) const
+    {
+        writer.put(m_page_sizes);
+        writer.putArray(m_page_size_list, m_page_sizes);
+        for (int i = 0; i < m_page_sizes; i++)
+        {
+            writer.put(m_page_table_sizes[i]);
+            writer.put(table_pa[i]);
+            writer.put(m_entry_count[i]);
+
+            std::vector<SnapshotEntry> records;
+            for (int j = 0; j < m_page_table_sizes[i]; j++)
+            {
+                size_t root = records.size();
+                for (const Entry *entry = &page_tables[i][j]; entry != NULL; entry = entry->next_entry)
+                {
+                    SnapshotEntry record;
+                    record.tag = entry->tag;
+                    record.valid = 0;
+                    for (int k = 0; k < 8; k++)
+                    {
+                        record.ppn[k] = entry->ppn[k];
+                        if (entry->valid[k])
+                            record.valid |= 1ULL << k;
+                    }
+                    record.emulated_physical_address = entry->emulated_physical_address;
+                    record.distance_from_root = entry->distance_from_root;
+                    record.chain_length = 0;
+                    records.push_back(record);
+                }
+                records[root].chain_length = records.size() - root - 1;
+            }
+            writer.putVector(records);
+        }
+        saveSideTables(writer);
+        return true;
+    }
+
+    bool PageTableHT::loadState(Snapshot::Section &section)
+    {
+        int page_sizes = 0;
+        const int *page_size_list = section.get(page_sizes) && page_sizes == m_page_sizes ? section.getArray<int>(page_sizes) : NULL;
+        if (!page_size_list || !std::equal(page_size_list, page_size_list + page_sizes, m_page_size_list))
+            return false;
+
+        for (int i = 0; i < m_page_sizes; i++)
+        {
+            int size = 0;
+            UInt64 count = 0;
+            if (!section.get(size) || !section.get(table_pa[i]) || !section.get(m_entry_count[i]) || !section.get(count))
+                return false;
+            const SnapshotEntry *records = section.getArray<SnapshotEntry>(count);
+            if (!records)
+                return false;
+
+            // A freshly constructed table has no chains, only the root array to replace
+            free(page_tables[i]);
+            page_tables[i] = (Entry *)malloc(sizeof(Entry) * size);
+            m_page_table_sizes[i] = size;
+
+            UInt64 r = 0;
+            for (int j = 0; j < size; j++)
+            {
+                Entry *previous = NULL;
+                UInt64 chain_length = 0;
+                for (UInt64 c = 0; c == 0 || c <= chain_length; c++)
+                {
+                    if (r == count)
+                        return false;
+                    const SnapshotEntry &record = records[r++];
+                    if (c == 0)
+                        chain_length = record.chain_length;
+
+                    Entry *entry = previous ? (Entry *)malloc(sizeof(Entry)) : &page_tables[i][j];
+                    entry->tag = record.tag;
+                    for (int k = 0; k < 8; k++)
+                    {
+                        entry->ppn[k] = record.ppn[k];
+                        entry->valid[k] = (record.valid >> k) & 1;
+                    }
+                    entry->emulated_physical_address = record.emulated_physical_address;
+                    entry->distance_from_root = record.distance_from_root;
+                    entry->next_entry = NULL;
+                    if (previous)
+                        previous->next_entry = entry;
+                    previous = entry;
+                }
+            }
+            if (r != count)
+                return false;
+        }
+        return loadSideTables(section);
+    }
+
     /*
      * printVectorStatistics(...)
      *   - Currently unimplemented; can be used to output vector stats from each page table.
@@ -22,6 +22,17 @@ namespace ParametricDramDirectoryMSI
 			int distance_from_root;
 		};
 
+		// Snapshot record of one entry; a root slot is followed by the chain_length entries chained to it
+		struct SnapshotEntry
+		{
+			IntPtr tag;
+			IntPtr ppn[8];
+			UInt64 valid; // Bit k = valid[k]
+			IntPtr emulated_physical_address;
+			SInt64 distance_from_root;
+			UInt64 chain_length;
+		};
+
 		int extra_pages;
 
 		std::vector<Entry *> page_tables;
@@ -56,6 +67,8 @@ namespace ParametricDramDirectoryMSI
 		PTWResult initializeWalk(IntPtr address, bool count, bool is_prefetch = false, bool restart_walk = false);
 		int updatePageTableFrames(IntPtr address, IntPtr core_id, IntPtr ppn, int page_size, std::vector<UInt64> frames);
 		void deletePage(IntPtr address);
+		bool saveState(Snapshot::Writer &writer) const;
+		bool loadState(Snapshot::Section &section);
 
 		void calculate_mean();
 		void calculate_std();
@@ -29,6 +29,8 @@ namespace ParametricDramDirectoryMSI
 
         PageTableRadix::PageTableRadix(int core_id, String name, String type, int page_sizes, int *page_size_list, int levels, int frame_size, bool is_guest)
                 : PageTable(core_id, name, type, page_sizes, page_size_list, is_guest),
+                  m_num_frames(0),
+                  m_ppn_index_chunks(0),
                   m_frame_size(frame_size),
                   levels(levels)
         {
@@ -45,6 +47,9 @@ namespace ParametricDramDirectoryMSI
                 registerStatsMetric(name, core_id, "ptw_num_cache_accesses", &stats.ptw_num_cache_accesses);
                 registerStatsMetric(name, core_id, "pf_num_cache_accesses", &stats.pf_num_cache_accesses);
                 registerStatsMetric(name, core_id, "allocated_frames", &stats.allocated_frames);
+                registerStatsMetric(name, core_id, "mapped_pages", &stats.mapped_pages);
+                registerStatsMetric(name, core_id, "host_bytes", &stats.host_bytes);
+                registerStatsMetric(name, core_id, "host_bytes_per_mapped_page", &stats.host_bytes_per_mapped_page);
 
                 m_log->log("After registering stats");
 
@@ -58,31 +63,15 @@ namespace ParametricDramDirectoryMSI
 
                 m_log->log("After registering stats: page_size_discovery");
 
-                root = (PTFrame *)malloc(sizeof(PTFrame));
-                root->entries = (PTEntry *)malloc(sizeof(PTEntry) * m_frame_size);
-
-                m_log->log("After malloc of root & root->entries");
-
-                // @hsongara: Get the OS object
-                MimicOS* os;
-                if (is_guest)
-                        os = Sim()->getMimicOS_VM();
-                else
-                        os = Sim()->getMimicOS();
-
-                m_log->log("After init os = ", (void*)os);
-
-                m_log->log("Before root->emulated_ppn");
                 // TODO @vlnitu: revert, but this will not work if there's only a single allocator in the sys, on VirtuOS side
-                root->emulated_ppn = 0; // os->getMemoryAllocator()->handle_page_table_allocations(4096);
-                m_log->log("After root->emulated_ppn = ", root->emulated_ppn);
-                m_log->detailed("Root frame: ", (void*)root);
+                // The root lives at emulated PPN 0 (os->getMemoryAllocator()->handle_page_table_allocations(4096)).
+                // It is never reached through a PTE, so it is kept out of the PPN index.
+                m_slabs.emplace_back(new PTE[static_cast<size_t>(m_frame_size) << FRAMES_PER_SLAB_SHIFT]());
+                m_num_frames = 1;
+                root = frameEntries(0);
+                updateHostStats();
 
-                for (int i = 0; i < m_frame_size; i++)
-                {
-                        root->entries[i].is_pte = false;
-                        root->entries[i].data.next_level = NULL;
-                }
+                m_log->detailed("Root frame: ", (void*)root);
         }
 
         /**
@@ -99,6 +88,106 @@ namespace ParametricDramDirectoryMSI
                 // Note: page_size_discovery array cleanup is handled by base class
         }
 
+        /**
+         * @brief Hands out the next frame slot (zeroed) and records it under its emulated PPN.
+         */
+        PageTableRadix::PTE *PageTableRadix::allocateFrame(IntPtr emulated_ppn)
+        {
+                UInt32 slot = m_num_frames++;
+                if ((slot >> FRAMES_PER_SLAB_SHIFT) == m_slabs.size())
+                {
+                        m_slabs.emplace_back(new PTE[static_cast<size_t>(m_frame_size) << FRAMES_PER_SLAB_SHIFT]());
+                        updateHostStats();
+                }
+
+                size_t chunk = emulated_ppn >> PPN_INDEX_CHUNK_SHIFT;
+                if (chunk >= m_ppn_index.size())
+                        m_ppn_index.resize(chunk + 1);
+                if (!m_ppn_index[chunk])
+                {
+                        m_ppn_index[chunk].reset(new UInt32[1 << PPN_INDEX_CHUNK_SHIFT]());
+                        m_ppn_index_chunks++;
+                        updateHostStats();
+                }
+
+                UInt32 &entry = m_ppn_index[chunk][emulated_ppn & ((1 << PPN_INDEX_CHUNK_SHIFT) - 1)];
+                LOG_ASSERT_ERROR(entry == 0, "Page table frame with emulated PPN %lu is already in use", emulated_ppn);
+                entry = slot + 1;
+
+                return frameEntries(slot);
+        }
+
+        PageTableRadix::PTE *PageTableRadix::lookupFrame(IntPtr emulated_ppn)
+        {
+                size_t chunk = emulated_ppn >> PPN_INDEX_CHUNK_SHIFT;
+                if (chunk >= m_ppn_index.size() || !m_ppn_index[chunk])
+                        return NULL;
+
+                UInt32 entry = m_ppn_index[chunk][emulated_ppn & ((1 << PPN_INDEX_CHUNK_SHIFT) - 1)];
+                return entry ? frameEntries(entry - 1) : NULL;
+        }
+
+        void PageTableRadix::updateHostStats()
+        {
+                stats.host_bytes = m_slabs.size() * (sizeof(PTE) * (static_cast<UInt64>(m_frame_size) << FRAMES_PER_SLAB_SHIFT))
+                                 + m_ppn_index.size() * sizeof(m_ppn_index[0])
+                                 + m_ppn_index_chunks * sizeof(UInt32) * (1 << PPN_INDEX_CHUNK_SHIFT);
+                stats.host_bytes_per_mapped_page = stats.mapped_pages ? stats.host_bytes / stats.mapped_pages : 0;
+        }
+
+        /**
+         * @brief Saves the frames (emulated PPN and entries, in slot order) and the side tables.
+         */
+        bool PageTableRadix::saveState(Snapshot::Writer &writer) const
+        {
+                writer.put(m_frame_size);
+                writer.put(levels);
+
+                // Invert the PPN index; the root (slot 0) is not in it and keeps PPN 0
+                std::vector<UInt64> slot_ppns(m_num_frames, 0);
+                for (size_t chunk = 0; chunk < m_ppn_index.size(); chunk++)
+                {
+                        if (!m_ppn_index[chunk])
+                                continue;
+                        for (UInt32 i = 0; i < (1U << PPN_INDEX_CHUNK_SHIFT); i++)
+                                if (m_ppn_index[chunk][i])
+                                        slot_ppns[m_ppn_index[chunk][i] - 1] = (chunk << PPN_INDEX_CHUNK_SHIFT) | i;
+                }
+                writer.putVector(slot_ppns);
+                for (UInt32 slot = 0; slot < m_num_frames; slot++)
+                        writer.putArray(frameEntries(slot), m_frame_size);
+
+                writer.put(stats.allocated_frames);
+                writer.put(stats.mapped_pages);
+                saveSideTables(writer);
+                return true;
+        }
+
+        bool PageTableRadix::loadState(Snapshot::Section &section)
+        {
+                int frame_size = 0, saved_levels = 0;
+                std::vector<UInt64> slot_ppns;
+                if (!section.get(frame_size) || !section.get(saved_levels) || !section.getVector(slot_ppns)
+                    || frame_size != m_frame_size || saved_levels != levels || slot_ppns.empty())
+                        return false;
+                LOG_ASSERT_ERROR(m_num_frames == 1, "Radix page table %s can only be restored while empty", name.c_str());
+
+                for (UInt32 slot = 0; slot < slot_ppns.size(); slot++)
+                {
+                        const PTE *entries = section.getArray<PTE>(m_frame_size);
+                        if (!entries)
+                                return false;
+                        // Frames are handed out in slot order, so they land in the slots they were saved from
+                        PTE *frame = slot ? allocateFrame(slot_ppns[slot]) : root;
+                        memcpy(frame, entries, sizeof(PTE) * m_frame_size);
+                }
+
+                if (!section.get(stats.allocated_frames) || !section.get(stats.mapped_pages))
+                        return false;
+                updateHostStats();
+                return loadSideTables(section);
+        }
+
         /**
          * @brief Initializes a page table walk for a given address.
          *
@@ -130,7 +219,8 @@ namespace ParametricDramDirectoryMSI
                 IntPtr offset = (address >> 39) & 0x1FF;
 
                 // Start the walk from the root
-                PTFrame *current_frame = root;
+                PTE *current_frame = root;
+                IntPtr current_ppn = 0;
 
                 IntPtr ppn_result;
                 IntPtr page_size_result;
@@ -145,106 +235,71 @@ namespace ParametricDramDirectoryMSI
                 {
                         offset = (address >> (48 - 9 * (levels - level + 1))) & 0x1FF;
 
-                        m_log->detailed("Accessing PT address: ", (void*)current_frame, " at level: ", level, " with offset: ", offset, "and emulated ppn: ", current_frame->emulated_ppn);
-                        visited_pts.push_back(PTWAccess(i, counter, (IntPtr)(current_frame->emulated_ppn * 4096 + offset * 8), current_frame->entries[offset].is_pte && current_frame->entries[offset].data.translation.valid));
+                        PTE entry = current_frame[offset];
+                        bool is_leaf = isLeaf(entry, level);
 
-                        m_log->detailed("Pushed in visited: ", i, " ", counter, " ", (IntPtr)(current_frame->emulated_ppn * 4096 + offset * 8), " ", (current_frame->entries[offset].is_pte && current_frame->entries[offset].data.translation.valid));
-                        if (current_frame->entries[offset].is_pte)
-                        {
+                        m_log->detailed("Accessing PT address: ", (void*)current_frame, " at level: ", level, " with offset: ", offset, "and emulated ppn: ", current_ppn);
+                        visited_pts.push_back(PTWAccess(i, counter, (IntPtr)(current_ppn * 4096 + offset * 8), is_leaf && isPresent(entry)));
 
-                                // The entry is not valid, we need to handle a page fault
-                                if (current_frame->entries[offset].data.translation.valid == false)
-                                {
-                                        if (restart_walk_after_fault) {
-                                                bool userspace_mimicos_enabled = Sim()->getCfg()->getBool("general/enable_userspace_mimicos");
-                                                if (userspace_mimicos_enabled) {
-                                                        std::cout << "[FATAL] [RADIX] VirtuOS resolved Page Fault before...\n" << 
-                                                                "Now that we are replaying the instruction, no Page Fault (due to missing mapping VPN -> PPN for Data Frame) should occurr for address = " << address << std::endl;
-                                                        std::cout << "[FATAL] [RADIX] exiting with status code = 1" << std::endl;
-                                                        exit(1);
-                                                }
-
-                                                assert(!userspace_mimicos_enabled);
-                                                
-                                                ExceptionHandlerBase *base_handler = Sim()->getCoreManager()->getCoreFromID(core_id)->getExceptionHandler();
-                                                SniperExceptionHandler* sniper_handler = dynamic_cast<SniperExceptionHandler*>(base_handler);
-
-                                                
-                                                ExceptionHandlerBase::FaultCtx fault_ctx = sniper_handler->initFaultCtx(this, address, core_id, getMaxLevel());
-                                                sniper_handler->handle_page_fault(fault_ctx);
-                                        }
+                        m_log->detailed("Pushed in visited: ", i, " ", counter, " ", (IntPtr)(current_ppn * 4096 + offset * 8), " ", (is_leaf && isPresent(entry)));
 
-                                        stats.page_faults++;
-                                        is_pagefault = true;
+                        // A missing translation and a missing next-level frame are both a not-present entry
+                        PTE *next_frame = NULL;
+                        if (isPresent(entry) && !is_leaf)
+                                next_frame = lookupFrame(ptePPN(entry));
 
-                                        m_log->detailed("PAGE FAULT RESOLVED for address: ", SimLog::hex(address));
-                                        if (restart_walk_after_fault)
-                                                goto restart_walk;
-                                        else {
-                                                // level = number of frames needed: (level - 1) page table frames + 1 data frame
-                                                return PTWResult(page_size_result, visited_pts, ppn_result, pwc_latency, is_pagefault, level-1);
+                        if (!isPresent(entry) || (!is_leaf && next_frame == NULL))
+                        {
+                                m_log->detailed("Entry is not present at level: ", level, ", we need to handle a page fault");
+                                if (restart_walk_after_fault) {
+                                        bool userspace_mimicos_enabled = Sim()->getCfg()->getBool("general/enable_userspace_mimicos");
+                                        if (userspace_mimicos_enabled) {
+                                                std::cout << "[FATAL] [RADIX] VirtuOS resolved Page Fault before...\n" << 
+                                                        "Now that we are replaying the instruction, no Page Fault (due to missing mapping VPN -> PPN for Data Frame) should occurr for address = " << address << std::endl;
+                                                std::cout << "[FATAL] [RADIX] exiting with status code = 1" << std::endl;
+                                                exit(1);
                                         }
+
+                                        assert(!userspace_mimicos_enabled);
+                                        
+                                        ExceptionHandlerBase *base_handler = Sim()->getCoreManager()->getCoreFromID(core_id)->getExceptionHandler();
+                                        SniperExceptionHandler* sniper_handler = dynamic_cast<SniperExceptionHandler*>(base_handler);
+
+                                        
+                                        ExceptionHandlerBase::FaultCtx fault_ctx = sniper_handler->initFaultCtx(this, address, core_id, getMaxLevel());
+                                        sniper_handler->handle_page_fault(fault_ctx);
                                 }
-                                // We found the entry, we can return the result
 
+                                stats.page_faults++;
+                                is_pagefault = true;
+
+                                m_log->detailed("PAGE FAULT RESOLVED for address: ", SimLog::hex(address));
+                                if (restart_walk_after_fault)
+                                        goto restart_walk;
+                                else {
+                                        // level = number of frames needed: (level - 1) page table frames + 1 data frame
+                                        return PTWResult(page_size_result, visited_pts, ppn_result, pwc_latency, is_pagefault, level-1);
+                                }
+                        }
+
+                        if (is_leaf)
+                        {
+                                // We found the entry, we can return the result
                                 if (count)
                                         stats.page_size_discovery[level - 1]++;
-                                m_log->detailed("Found translation for address: ", SimLog::hex(address), " with ppn: ", current_frame->entries[offset].data.translation.ppn, " at level: ", level, " with page size: ", m_page_size_list[level - 1]);
+                                m_log->detailed("Found translation for address: ", SimLog::hex(address), " with ppn: ", ptePPN(entry), " at level: ", level, " with page size: ", m_page_size_list[level - 1]);
                                 // @kanellok: Be careful with the return values -> always return PPN_RESULT at page size granularity
-                                ppn_result = current_frame->entries[offset].data.translation.ppn;
-                                LOG_ASSERT_ERROR(ppn_result != static_cast<IntPtr>(-1), "PPN is invalid");
-                               
-                                accesses_per_vpn[address >> 12]++; // Increment the access count for the VPN
+                                ppn_result = ptePPN(entry);
+
+                                accesses_per_vpn.at(address >> 12)++; // Increment the access count for the VPN
 
                                 page_size_result = m_page_size_list[level - 1]; // If we hit at level 1 (last one), we return the page_size[1-1] = page_size[0] = 4KB
                                 break;
                         }
-                        else
-                        {
-                                m_log->detailed("Moving to the next level");
-                                // The entry was a pointer to the next level of the page table
-                                // We need to chase the pointer -> if the next level is NULL, we need to handle a page fault
-                                if (current_frame->entries[offset].data.next_level == NULL)
-                                {
-                                        m_log->detailed("Next level is NULL, we need to allocate a new frame");
-                                        if (restart_walk_after_fault) {
-                                                // TODO @vlnitu: remove code duplication, add it to a base function
-                                                bool userspace_mimicos_enabled = Sim()->getCfg()->getBool("general/enable_userspace_mimicos");
-                                                if (userspace_mimicos_enabled) {
-                                                        std::cout << "[FATAL] [RADIX] VirtuOS resolved Page Fault before...\n" << 
-                                                                "Now that we are replaying the instruction, no Page Fault (due to missing mapping VPN -> PPN for Data Frame) should occurr for address = " << address << std::endl;
-                                                        std::cout << "[FATAL] [RADIX] exiting with status code = 1" << std::endl;
-                                                        exit(1);
-                                                }
-
-                                                assert(!userspace_mimicos_enabled);
-                                                
-                                                ExceptionHandlerBase *base_handler = Sim()->getCoreManager()->getCoreFromID(core_id)->getExceptionHandler();
-                                                SniperExceptionHandler* sniper_handler = dynamic_cast<SniperExceptionHandler*>(base_handler);
-
-
-                                                ExceptionHandlerBase::FaultCtx fault_ctx = sniper_handler->initFaultCtx(this, address, core_id, getMaxLevel());
-                                                sniper_handler->handle_page_fault(fault_ctx);
-                                        }
 
-                                        stats.page_faults++;
-                                        is_pagefault = true;
-
-                                        m_log->detailed("Page fault resolved for address: ", SimLog::hex(address));
-                                        m_log->detailed("Restarting the walk");
-                                        if (restart_walk_after_fault) {
-                                                goto restart_walk;
-                                        }
-                                        else {
-                                                // level = number of frames needed: (level - 1) page table frames + 1 data frame
-                                                return PTWResult(page_size_result, visited_pts, ppn_result, pwc_latency, is_pagefault, level-1);
-                                        }
-                                }
-                                else
-                                {
-                                        current_frame = current_frame->entries[offset].data.next_level;
-                                }
-                        }
+                        m_log->detailed("Moving to the next level");
+                        current_frame = next_frame;
+                        current_ppn = ptePPN(entry);
 
                         // Move to the next level
                         // 4->3->2->1
@@ -267,22 +322,19 @@ namespace ParametricDramDirectoryMSI
              {
                      m_log->detailed("Frame: ", frames[i]);
              }
-                PTFrame *current_frame = root;
-                PTFrame *previous_frame = NULL;
+                PTE *current_frame = root;
+                PTE *parent_entry = NULL;
 
                 IntPtr offset = (address >> 39) & 0x1FF;
-                IntPtr previous_offset = static_cast<IntPtr>(-1);
 
                 int level = levels;
-                int counter = 0;
 
                 m_log->section("Update Page Table Frames");
                 m_log->detailed("Updating page table frames for address: ", SimLog::hex(address), " with ppn: ", ppn, " and page size: ", page_size);
 
-                accessedAddresses pagefault_addresses;
+                LOG_ASSERT_ERROR(static_cast<UInt64>(ppn) <= (PTE_PFN_MASK >> PTE_PFN_SHIFT), "PPN %lu does not fit in a PTE", ppn);
 
                 // Walk the page table to the last level and update the page table frames which are not yet allocated
-                int returned_frames = 0;
                 int frames_used = 0;
                 int frames_allocated = 0;
 
@@ -290,8 +342,6 @@ namespace ParametricDramDirectoryMSI
                 {
                         offset = (address >> (48 - 9 * (levels - level + 1))) & 0x1FF;
 
-                        // Move to the next level of the page table
-
                         m_log->detailed("Accessing: ", (void*)current_frame, " at level: ", level, " with offset: ", offset);
 
                         if (current_frame == NULL)
@@ -303,68 +353,43 @@ namespace ParametricDramDirectoryMSI
                                         "Out of bounds access to frames vector: frames_used (%d) >= frames.size() (%zu)", 
                                         frames_used, frames.size());
 
-                                PTFrame *new_pt_frame = new PTFrame;
-                                stats.allocated_frames++;
-
-                                new_pt_frame->entries = new PTEntry[m_frame_size];
+                                IntPtr frame_ppn = frames[frames_used];
                                 m_log->detailed("Frames used so far: ", frames_used);
-                                m_log->detailed("Allocating new page table frame at : ", frames[frames_used]);
-                                new_pt_frame->emulated_ppn = frames[frames_used];
+                                m_log->detailed("Allocating new page table frame at : ", frame_ppn);
                                 frames_used++;  // Increment after using the frame
                                 frames_allocated++;
-                                
-                                current_frame = new_pt_frame;
+                                stats.allocated_frames++;
 
-                                m_log->detailed("New frame allocated: ", (void*)current_frame, " with emulated ppn: ", new_pt_frame->emulated_ppn);
-                                m_log->detailed("Previous frame: ", (void*)previous_frame, " at offset ", previous_offset, " is updated with the new frame: ", (void*)current_frame);
-                                previous_frame->entries[previous_offset].data.next_level = current_frame;
-                                
+                                current_frame = allocateFrame(frame_ppn);
 
-                                bool is_pte = level == 1 ? true : false;
-                                for (int i = 0; i < m_frame_size; i++)
-                                {
+                                // A large page that used to cover this range is replaced by the new frame
+                                if (isPresent(*parent_entry) && isLeaf(*parent_entry, level + 1))
+                                        stats.mapped_pages -= pagesPerLeaf(level + 1);
+                                *parent_entry = makePTE(frame_ppn, PTE_PRESENT | PTE_WRITABLE | PTE_USER);
 
-                                        new_pt_frame->entries[i].is_pte = is_pte;
-                                        new_pt_frame->entries[i].data.next_level = NULL;
-                                }
+                                m_log->detailed("New frame allocated: ", (void*)current_frame, " with emulated ppn: ", frame_ppn);
+                                continue;
                         }
-                        else
-                        {
-
-                                // Allocate a new page table
-                                if (page_size == 21 && level == 2)
-                                {
-                                        m_log->detailed("[2MiB] Let's update the PTE: ", (void*)current_frame, " with vpn = ", (address >> 12), " and ppn: ", ppn, " at level: ", level, " with page size: ", page_size);
-                                        current_frame->entries[offset].data.translation.valid = true;
-                                        current_frame->entries[offset].data.translation.ppn = ppn;
-                                        current_frame->entries[offset].is_pte = true;
-                                        accesses_per_vpn[address >> 12] = 1; // Set the access count for the VPN to 1
 
-                                        break;
-                                }
-                                else if (page_size == 12 && level == 1)
-                                {
-
-                                        m_log->detailed("[4KiB] Let's update the PTE: ", (void*)current_frame, " with vpn = ", (address >> 12), " and ppn: ", ppn, " at level: ", level, " with page size: ", page_size);
-                                        current_frame->entries[offset].data.translation.valid = true;
-                                        current_frame->entries[offset].data.translation.ppn = ppn;
-                                        current_frame->entries[offset].is_pte = true;
-                                        accesses_per_vpn[address >> 12] = 1; // Set the access count for the VPN to 1
-
-                                        break;
-                                }
+                        if ((page_size == 21 && level == 2) || (page_size == 12 && level == 1))
+                        {
+                                m_log->detailed("Let's update the PTE: ", (void*)current_frame, " with vpn = ", (address >> 12), " and ppn: ", ppn, " at level: ", level, " with page size: ", page_size);
+                                PTE &entry = current_frame[offset];
+                                if (!isPresent(entry))
+                                        stats.mapped_pages += pagesPerLeaf(level);
+                                entry = makePTE(ppn, PTE_PRESENT | PTE_WRITABLE | PTE_USER | (level > 1 ? PTE_PAGE_SIZE : 0));
+                                accesses_per_vpn.at(address >> 12) = 1; // Set the access count for the VPN to 1
 
-                                previous_frame = current_frame;
-                                current_frame = current_frame->entries[offset].data.next_level;
-                                m_log->detailed("Let's jump to the next level: ", (void*)current_frame);
-                                previous_offset = offset;
-                                level--;
-                                counter++;
-                                // Note: frames_used is NOT incremented here - we only increment when we actually allocate a new frame
-                                returned_frames++;
-                                
+                                break;
                         }
+
+                        parent_entry = &current_frame[offset];
+                        current_frame = (isPresent(*parent_entry) && !isLeaf(*parent_entry, level)) ? lookupFrame(ptePPN(*parent_entry)) : NULL;
+                        m_log->detailed("Let's jump to the next level: ", (void*)current_frame);
+                        level--;
                 }
+
+                updateHostStats();
                 return frames_allocated;
         }
 
@@ -372,30 +397,31 @@ namespace ParametricDramDirectoryMSI
         {
 
                 m_log->detailed("Deleting page that corresponds to address: ", SimLog::hex(address));
-                PTFrame *current_frame = root;
+                PTE *current_frame = root;
                 IntPtr offset = (address >> 39) & 0x1FF;
 
                 int level = levels;
-                int counter = 0;
 
-                while (level > 0)
+                while (level > 0 && current_frame != NULL)
                 {
                         offset = (address >> (48 - 9 * (levels - level + 1))) & 0x1FF;
+                        PTE &entry = current_frame[offset];
+
+                        if (!isPresent(entry))
+                                break;
 
-                        if (current_frame->entries[offset].is_pte)
+                        if (isLeaf(entry, level))
                         {
                                 m_log->detailed("Found the PTE for address: ", SimLog::hex(address), " at level: ", level, " with offset: ", offset);
-                                current_frame->entries[offset].data.translation.valid = false;
-                                current_frame->entries[offset].data.translation.ppn = -1;
+                                entry = 0;
+                                stats.mapped_pages -= pagesPerLeaf(level);
+                                updateHostStats();
                                 break;
                         }
-                        else
-                        {
-                                // Move to the next level of the page table
-                                current_frame = current_frame->entries[offset].data.next_level;
-                        }
+
+                        // Move to the next level of the page table
+                        current_frame = lookupFrame(ptePPN(entry));
                         level--;
-                        counter++;
                 }
         }
 
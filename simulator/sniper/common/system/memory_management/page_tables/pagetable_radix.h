@@ -1,47 +1,64 @@
-
 #pragma once
 #include "pagetable.h"
 #include "sim_log.h"
+#include <memory>
 
 namespace ParametricDramDirectoryMSI
 {
 
+	/*
+	 * Radix page table with x86-64 style 8-byte PTEs.
+	 *
+	 * Frames are carved out of large host slabs and never move. Next-level entries store the
+	 * emulated PPN of the child frame (like real hardware), and the child is found through a
+	 * chunked PPN -> frame-slot index, so a walk is a handful of array lookups instead of a
+	 * chain of heap pointers.
+	 */
 	class PageTableRadix : public PageTable
 	{
 
 	private:
-		struct PTFrame;
+		typedef UInt64 PTE;
 
-		struct PTE
-		{
-			bool valid; // Valid bit
-			IntPtr ppn; // Physical page number
-		};
+		// x86-64 PTE bits (leaves and pointers to the next level share the same format)
+		static const PTE PTE_PRESENT = 1ULL << 0;
+		static const PTE PTE_WRITABLE = 1ULL << 1;
+		static const PTE PTE_USER = 1ULL << 2;
+		static const PTE PTE_PAGE_SIZE = 1ULL << 7; // Leaf above the last level (2MB/1GB page)
+		static const PTE PTE_PFN_MASK = 0x000FFFFFFFFFF000ULL;
+		static const int PTE_PFN_SHIFT = 12;
 
-	
-		struct PTEntry
-		{
-			bool is_pte; // Whether the entry is a PTE or a pointer to the next level of the page table
-			union
-			{
-				PTE translation;
-				PTFrame *next_level;
-			} data; // Stores whether the entry is a PTE or a pointer to the next level of the page table
-		};
+		static const int FRAMES_PER_SLAB_SHIFT = 8;	  // 256 frames per host slab
+		static const int PPN_INDEX_CHUNK_SHIFT = 12; // 4096 PPNs per index chunk
 
-		struct PTFrame
-		{
-			PTEntry *entries;	 // 512 entries, 4KB page table frames
-			IntPtr emulated_ppn; // Address of the frame in the physical memory (this is emulated)
-		};
+		static PTE makePTE(IntPtr ppn, PTE flags) { return ((static_cast<PTE>(ppn) << PTE_PFN_SHIFT) & PTE_PFN_MASK) | flags; }
+		static IntPtr ptePPN(PTE pte) { return (pte & PTE_PFN_MASK) >> PTE_PFN_SHIFT; }
+		static bool isPresent(PTE pte) { return pte & PTE_PRESENT; }
+		static bool isLeaf(PTE pte, int level) { return level == 1 || (pte & PTE_PAGE_SIZE); }
 
-		typedef struct PTFrame PT;
+		// Number of 4KB pages covered by a leaf at the given level
+		static UInt64 pagesPerLeaf(int level) { return 1ULL << (9 * (level - 1)); }
+
+		PTE *frameEntries(UInt32 slot)
+		{
+			return m_slabs[slot >> FRAMES_PER_SLAB_SHIFT].get() + static_cast<UInt64>(slot & ((1U << FRAMES_PER_SLAB_SHIFT) - 1)) * m_frame_size;
+		}
+		const PTE *frameEntries(UInt32 slot) const
+		{
+			return m_slabs[slot >> FRAMES_PER_SLAB_SHIFT].get() + static_cast<UInt64>(slot & ((1U << FRAMES_PER_SLAB_SHIFT) - 1)) * m_frame_size;
+		}
+		PTE *allocateFrame(IntPtr emulated_ppn); // Zeroed frame, registered in the PPN index
+		PTE *lookupFrame(IntPtr emulated_ppn);	 // NULL if the PPN is not a frame of this table
+		void updateHostStats();
 
-		PT *root;		  // Root of the radix tree
-		int m_frame_size; // Size of the frame in bytes
-		int levels;		  // Number of levels in the radix tree
+		std::vector<std::unique_ptr<PTE[]>> m_slabs;			   // Frame storage, slot 0 is the root
+		UInt32 m_num_frames;									   // Frame slots in use
+		std::vector<std::unique_ptr<UInt32[]>> m_ppn_index;	   // Emulated PPN -> slot + 1 (0 = not a frame)
+		UInt32 m_ppn_index_chunks;							   // Populated chunks of m_ppn_index
 
-		// We use 3 page walk caches, one for the first three levels of the radix tree
+		PTE *root;			   // Entries of the root frame (emulated PPN 0)
+		int m_frame_size;	   // Number of entries per frame
+		int levels;			   // Number of levels in the radix tree
 
 		SimLog* m_log;    // Logging instance for the page table
 
@@ -53,6 +70,9 @@ namespace ParametricDramDirectoryMSI
 			UInt64 page_faults;
 			UInt64 *page_size_discovery; // Number of times each page size is discovered
 			UInt64 allocated_frames;	 // Number of frames allocated for the page table
+			UInt64 mapped_pages;		 // Mapped memory in 4KB pages (a 2MB page counts as 512)
+			UInt64 host_bytes;			 // Host memory held by frame slabs and the PPN index
+			UInt64 host_bytes_per_mapped_page;
 		} stats;
 
 	public:
@@ -63,6 +83,8 @@ namespace ParametricDramDirectoryMSI
 		void deletePage(IntPtr address);
 		IntPtr getPhysicalSpace(int size);
 		String getType() { return "radix"; };
+		bool saveState(Snapshot::Writer &writer) const;
+		bool loadState(Snapshot::Section &section);
 		int getMaxLevel() { return levels; };
 	};
-}
\ No newline at end of file
+}
@@ -7,6 +7,7 @@
 #include "fixed_types.h"
 #include "stats.h"
 #include "simulator.h"
+#include "memory_management/misc/snapshot.h"
 #include <tuple>
 
 using namespace std;
@@ -31,6 +32,7 @@ namespace ParametricDramDirectoryMSI
         bool leaf;
         IntPtr emulated_ppn;
         TreeNode(int temp, bool bool_leaf);
+        TreeNode(int temp, bool bool_leaf, IntPtr emulated_ppn); // Node restored from a snapshot
 
         void insertNonFull(std::pair<uint64_t, uint64_t> k, RangeEntry value);
         void splitChild(int i, TreeNode *y);
@@ -62,6 +64,10 @@ namespace ParametricDramDirectoryMSI
         }
         virtual void insert(std::pair<uint64_t, uint64_t> key, RangeEntry value) = 0;
         virtual std::tuple<TreeNode *, int, std::vector<IntPtr>> lookup(uint64_t address) = 0;
+
+        // Snapshot support, see PageTable::saveState
+        virtual bool saveState(Snapshot::Writer & /*writer*/) const { return false; }
+        virtual bool loadState(Snapshot::Section & /*section*/) { return false; }
         ~RangeTable(){};
     };
 
@@ -38,6 +38,19 @@ namespace ParametricDramDirectoryMSI
         n = 0;
     }
 
+    TreeNode::TreeNode(int t1, bool leaf1, IntPtr emulated_ppn1)
+    {
+        t = t1;
+        leaf = leaf1;
+
+        keys = new std::pair<uint64_t, uint64_t>[2 * t - 1];
+        values = new RangeEntry[2 * t - 1];
+        C = new TreeNode *[2 * t];
+        emulated_ppn = emulated_ppn1;
+
+        n = 0;
+    }
+
     void TreeNode::traverse()
     {
         int i;
@@ -172,4 +185,61 @@ namespace ParametricDramDirectoryMSI
         n = n + 1;
     }
 
+    bool RangeTableBtree::saveState(Snapshot::Writer &writer) const
+    {
+        writer.put(t);
+        writer.put<UInt64>(root != NULL);
+        if (root != NULL)
+            saveNode(writer, root);
+        return true;
+    }
+
+    void RangeTableBtree::saveNode(Snapshot::Writer &writer, const TreeNode *node) const
+    {
+        writer.put(SnapshotNode{node->n, node->leaf, node->emulated_ppn});
+        for (int i = 0; i < node->n; i++)
+        {
+            writer.put(SnapshotKey{node->keys[i].first, node->keys[i].second});
+            writer.put(node->values[i]);
+        }
+        if (!node->leaf)
+            for (int i = 0; i <= node->n; i++)
+                saveNode(writer, node->C[i]);
+    }
+
+    bool RangeTableBtree::loadState(Snapshot::Section &section)
+    {
+        int saved_t = 0;
+        UInt64 has_root = 0;
+        if (!section.get(saved_t) || saved_t != t || !section.get(has_root))
+            return false;
+        LOG_ASSERT_ERROR(root == NULL, "Range table can only be restored while empty");
+        root = has_root ? loadNode(section) : NULL;
+        return section.ok();
+    }
+
+    TreeNode *RangeTableBtree::loadNode(Snapshot::Section &section)
+    {
+        SnapshotNode header;
+        if (!section.get(header) || header.n < 0 || header.n > 2 * t - 1)
+        {
+            section.fail();
+            return NULL;
+        }
+
+        // Keeps the emulated PPN it was saved with: the restored kernel area already accounts for it
+        TreeNode *node = new TreeNode(t, header.leaf, header.emulated_ppn);
+        node->n = header.n;
+        for (int i = 0; i < node->n; i++)
+        {
+            SnapshotKey key = {0, 0};
+            section.get(key);
+            section.get(node->values[i]);
+            node->keys[i] = std::make_pair(key.first, key.second);
+        }
+        if (!node->leaf)
+            for (int i = 0; i <= node->n && section.ok(); i++)
+                node->C[i] = loadNode(section);
+        return node;
+    }
 }
@@ -54,6 +54,26 @@ namespace ParametricDramDirectoryMSI
         }
 
         void insert(std::pair<uint64_t, uint64_t> key, RangeEntry value);
+
+        bool saveState(Snapshot::Writer &writer) const;
+        bool loadState(Snapshot::Section &section);
+
+    private:
+        // Snapshot record of a node; nodes are saved in pre-order, keys and values follow each record
+        struct SnapshotNode
+        {
+            SInt64 n;
+            UInt64 leaf;
+            IntPtr emulated_ppn;
+        };
+        struct SnapshotKey
+        {
+            UInt64 first;
+            UInt64 second;
+        };
+
+        void saveNode(Snapshot::Writer &writer, const TreeNode *node) const;
+        TreeNode *loadNode(Snapshot::Section &section);
     };
 
 }
@@ -0,0 +1,174 @@
+#pragma once
+#include "fixed_types.h"
+#include "memory_management/misc/snapshot.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace ParametricDramDirectoryMSI
+{
+	/**
+	 * @brief Sparse per-VPN side table, laid out like the radix page table it shadows.
+	 *
+	 * The 36-bit VPN of a 48-bit address is split 9/9/9/9 bits, exactly like PML4/PDPT/PD/PT:
+	 * three levels of 512-pointer directories lead to chunks of 512 values, one chunk per
+	 * leaf page-table frame (2MB of virtual address space). A value costs sizeof(T) once its
+	 * chunk exists, instead of a hash node per VPN, and a lookup is a few array indexations.
+	 * The chunk used last is remembered, so walks with spatial locality skip the directories.
+	 *
+	 * VPNs may carry tag bits above bit 36 (application id, ASID): chunks whose VPNs differ only
+	 * there share a directory slot and are chained, and every chunk is matched on its full id.
+	 *
+	 * Reads never allocate: a VPN whose chunk does not exist reads as T(). Nodes are never
+	 * freed, so the remembered chunk stays valid.
+	 */
+	template <class T>
+	class VPNSideTable
+	{
+	public:
+		static const int BITS_PER_LEVEL = 9;
+		static const int ENTRIES = 1 << BITS_PER_LEVEL;
+
+		/** host_bytes, if not NULL, is increased by the size of every node allocated */
+		explicit VPNSideTable(UInt64 *host_bytes = NULL)
+			: m_root(new Directory<MidDirectory>())
+			, m_host_bytes(host_bytes)
+			, m_last_chunk(NULL)
+		{
+			account(sizeof(Directory<MidDirectory>));
+		}
+
+		T get(UInt64 vpn) const
+		{
+			const Chunk *chunk = findChunk(vpn);
+			return chunk ? chunk->values[vpn & (ENTRIES - 1)] : T();
+		}
+
+		/** Reference to the value of vpn, allocating its chunk (zero-initialized) if needed */
+		T &at(UInt64 vpn)
+		{
+			Chunk *chunk = findChunk(vpn);
+			if (!chunk)
+				chunk = allocateChunk(vpn);
+			return chunk->values[vpn & (ENTRIES - 1)];
+		}
+
+		/** Appends the populated chunks to the current snapshot section */
+		void saveState(Snapshot::Writer &writer) const
+		{
+			std::vector<const Chunk *> chunks;
+			for (const auto &mid : m_root->children)
+				for (int i = 0; mid && i < ENTRIES; i++)
+					for (int j = 0; mid->children[i] && j < ENTRIES; j++)
+						for (const ChunkNode *node = mid->children[i]->children[j].get(); node; node = node->next.get())
+							chunks.push_back(&node->chunk);
+
+			writer.put<UInt64>(chunks.size());
+			for (const Chunk *chunk : chunks)
+				writer.put(*chunk);
+		}
+
+		/** Adds the chunks saved by saveState (on top of the current contents) */
+		bool loadState(Snapshot::Section &section)
+		{
+			UInt64 count = 0;
+			if (!section.get(count))
+				return false;
+			for (UInt64 i = 0; i < count; i++)
+			{
+				const Chunk *saved = section.getArray<Chunk>(1);
+				if (!saved)
+					return false;
+				Chunk *chunk = findChunk(saved->id << BITS_PER_LEVEL);
+				if (!chunk)
+					chunk = allocateChunk(saved->id << BITS_PER_LEVEL);
+				*chunk = *saved;
+			}
+			return true;
+		}
+
+	private:
+		struct Chunk
+		{
+			UInt64 id; // vpn >> BITS_PER_LEVEL
+			T values[ENTRIES];
+		};
+
+		// Chunks of one directory slot, whose VPNs differ above bit 36
+		struct ChunkNode
+		{
+			Chunk chunk;
+			std::unique_ptr<ChunkNode> next;
+		};
+
+		template <class Child>
+		struct Directory
+		{
+			std::unique_ptr<Child> children[ENTRIES];
+		};
+		typedef Directory<ChunkNode> LeafDirectory;	   // PD level
+		typedef Directory<LeafDirectory> MidDirectory; // PDPT level
+
+		static int index(UInt64 vpn, int level) { return (vpn >> (BITS_PER_LEVEL * level)) & (ENTRIES - 1); }
+
+		Chunk *findChunk(UInt64 vpn) const
+		{
+			const UInt64 chunk_id = vpn >> BITS_PER_LEVEL;
+			Chunk *last = m_last_chunk.load(std::memory_order_relaxed);
+			if (last && last->id == chunk_id)
+				return last;
+
+			const MidDirectory *mid = m_root->children[index(vpn, 3)].get();
+			if (!mid)
+				return NULL;
+			const LeafDirectory *leaf = mid->children[index(vpn, 2)].get();
+			if (!leaf)
+				return NULL;
+			for (ChunkNode *node = leaf->children[index(vpn, 1)].get(); node; node = node->next.get())
+			{
+				if (node->chunk.id == chunk_id)
+				{
+					m_last_chunk.store(&node->chunk, std::memory_order_relaxed);
+					return &node->chunk;
+				}
+			}
+			return NULL;
+		}
+
+		Chunk *allocateChunk(UInt64 vpn)
+		{
+			std::unique_ptr<MidDirectory> &mid = m_root->children[index(vpn, 3)];
+			if (!mid)
+			{
+				mid.reset(new MidDirectory());
+				account(sizeof(MidDirectory));
+			}
+			std::unique_ptr<LeafDirectory> &leaf = mid->children[index(vpn, 2)];
+			if (!leaf)
+			{
+				leaf.reset(new LeafDirectory());
+				account(sizeof(LeafDirectory));
+			}
+			std::unique_ptr<ChunkNode> *node = &leaf->children[index(vpn, 1)];
+			while (*node)
+				node = &(*node)->next;
+			node->reset(new ChunkNode());
+			Chunk *chunk = &(*node)->chunk;
+			chunk->id = vpn >> BITS_PER_LEVEL;
+			account(sizeof(ChunkNode));
+
+			m_last_chunk.store(chunk, std::memory_order_relaxed);
+			return chunk;
+		}
+
+		void account(UInt64 bytes)
+		{
+			if (m_host_bytes)
+				*m_host_bytes += bytes;
+		}
+
+		std::unique_ptr<Directory<MidDirectory>> m_root; // PML4 level
+		UInt64 *m_host_bytes;
+		mutable std::atomic<Chunk *> m_last_chunk;
+	};
+}
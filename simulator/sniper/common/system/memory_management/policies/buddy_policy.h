@@ -6,6 +6,7 @@
 #include <iostream>
 
 #include "memory_management/physical_memory_allocators/buddy_policy_traits.h"
+#include "memory_management/physical_memory_allocators/buddy_free_list.h"
 
 #include "memory_management/policies/reserve_thp_policy.h"
 #include "memory_management/policies/baseline_policy.h"
@@ -27,6 +28,14 @@ namespace Sniper {
                     log_file.close();
             }
 
+            static BuddyFreeListType free_list_type()
+            {
+                String key = "perf_model/buddy/free_list_type";
+                if (!Sim()->getCfg()->hasKey(key))
+                    return BuddyFreeListType::VECTOR;
+                return parseBuddyFreeListType(Sim()->getCfg()->getString(key).c_str());
+            }
+
             void on_init(int mem_size, int max_order, int kernel_size)
             {
                 std::string log_file_name =  std::string(Sim()->getConfig()->getOutputDirectory().c_str()) + "/buddy.log";
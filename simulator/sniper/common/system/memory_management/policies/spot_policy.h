@@ -42,38 +42,27 @@ namespace Sniper {
                                                                    int core_id,
                                                                    Alloc* alloc)
             {
-                auto& vma_list = Sim()->getMimicOS()->getVMA(core_id);
                 int64_t current_offset = static_cast<int64_t>(-1);
-                VMA* current_vma = nullptr;
 
-                int vma_index = 0;
+                // Find the VMA containing the address
+                int vma_index = Sim()->getMimicOS()->findVMAIndex(core_id, address);
 
-                // Iterate through the VMA list to find the VMA containing the address
-                for (auto& vma : vma_list)
+                // If no VMA found, return sentinel values
+                if (vma_index < 0)
                 {
-                    if (vma.getBase() <= address && vma.getEnd() > address)
-                    {
-                        if (!vma.isAllocated())
-                        {
-                            // Allocate VMA
-                            Sim()->getMimicOS()->setAllocatedVMA(core_id, vma_index);
-                            current_vma = &vma;
-                        }
-                        else
-                        {
-                            // VMA has been allocated, use existing offset
-                            current_offset = vma.getPhysicalOffset();
-                            current_vma = &vma;
-                        }
-                        break;
-                    }
-                    vma_index++;
+                    return std::make_tuple(-1, static_cast<int64_t>(-1), static_cast<IntPtr>(0));
                 }
 
-                // If no VMA found, return sentinel values
-                if (current_vma == nullptr)
+                const VMA* current_vma = &Sim()->getMimicOS()->getVMA(core_id)[vma_index];
+                if (!current_vma->isAllocated())
                 {
-                    return std::make_tuple(-1, static_cast<int64_t>(-1), static_cast<IntPtr>(0));
+                    // Allocate VMA
+                    Sim()->getMimicOS()->setAllocatedVMA(core_id, vma_index);
+                }
+                else
+                {
+                    // VMA has been allocated, use existing offset
+                    current_offset = current_vma->getPhysicalOffset();
                 }
 
                 IntPtr vma_size = current_vma->getEnd() - current_vma->getBase();
@@ -99,7 +88,7 @@ namespace Sniper {
             static void log_VMA_specs(int core_id, int vma_index, Alloc* alloc)
             {
                 auto& vma_list = Sim()->getMimicOS()->getVMA(core_id);
-                VMA& vma = vma_list[vma_index];
+                const VMA& vma = vma_list[vma_index];
 
 #if DEBUG_SPOT_ALLOCATOR >= DEBUG_BASIC
                 alloc->log_stream << "[SpotAllocator] Current VMA Base: " << vma.getBase() << std::endl;
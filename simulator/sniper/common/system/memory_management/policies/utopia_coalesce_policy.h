@@ -171,7 +171,7 @@ struct MetricsPolicy
     void deletePageTableEntry(IntPtr address, int app_id) const {
         MimicOS* mimicos = Sim()->getMimicOS();
         if (mimicos) {
-            mimicos->deletePageTableEntry(address, app_id);
+            mimicos->deletePageTableEntry(address, app_id, TLBShootdown::MIGRATE);
             if (sim_log) sim_log->debug("Deleted PT entry for VA=", SimLog::hex(address), " app=", app_id);
         }
     }
@@ -0,0 +1,304 @@
+/**
+ * TLB Shootdown Implementation
+ *
+ * Tracks which cores ran each address space, turns MimicOS invalidations into rounds of
+ * inter-processor interrupts and queues their effects in per-core mailboxes.
+ */
+
+#include "tlb_shootdown.h"
+#include "simulator.h"
+#include "config.hpp"
+#include "core_manager.h"
+#include "dvfs_manager.h"
+#include "hooks_manager.h"
+#include "thread_manager.h"
+#include "thread.h"
+#include "stats.h"
+#include "log.h"
+
+#include <algorithm>
+
+namespace
+{
+    const char* const REASON_NAMES[TLBShootdown::NUM_REASONS] = { "unmap", "swap", "migrate" };
+
+    // Marks an address space whose pages are flushed as a whole in the round being sent
+    const UInt32 ROUND_FLUSHED = ~UInt32(0);
+
+    UInt64 getCfgIntDefault(const String& key, UInt64 default_value)
+    {
+        return Sim()->getCfg()->hasKey(key) ? Sim()->getCfg()->getInt(key) : default_value;
+    }
+
+    ComponentLatency cycles(const String& key, UInt64 default_value)
+    {
+        return ComponentLatency(Sim()->getDvfsManager()->getGlobalDomain(), getCfgIntDefault(key, default_value));
+    }
+}
+
+TLBShootdown::TLBShootdown(String name)
+    : m_enabled(Sim()->getCfg()->getBoolDefault("perf_model/tlb_shootdown/enabled", false))
+    , m_policy(IMMEDIATE)
+    , m_batch_size(getCfgIntDefault("perf_model/tlb_shootdown/batch_size", 32))
+    , m_full_flush_threshold(getCfgIntDefault("perf_model/tlb_shootdown/full_flush_threshold", 33))
+    , m_ipi_latency(cycles("perf_model/tlb_shootdown/ipi_latency", 4000))
+    , m_ipi_handler_latency(cycles("perf_model/tlb_shootdown/ipi_handler_latency", 1500))
+    , m_invlpg_latency(cycles("perf_model/tlb_shootdown/invlpg_latency", 150))
+    , m_flush_latency(cycles("perf_model/tlb_shootdown/flush_latency", 500))
+    , m_num_cores(Sim()->getConfig()->getTotalCores())
+    , m_cpumask(m_num_cores)
+    , m_running(m_num_cores, -1)
+    , m_mailboxes(new Mailbox[m_num_cores])
+{
+    String policy = "immediate";
+    if (Sim()->getCfg()->hasKey("perf_model/tlb_shootdown/policy"))
+        policy = Sim()->getCfg()->getString("perf_model/tlb_shootdown/policy");
+    if (policy == "immediate")
+        m_policy = IMMEDIATE;
+    else if (policy == "batch")
+        m_policy = BATCH;
+    else if (policy == "lazy")
+        m_policy = LAZY;
+    else
+        LOG_PRINT_ERROR("Unknown perf_model/tlb_shootdown/policy %s (expected immediate, batch or lazy)", policy.c_str());
+
+    LOG_ASSERT_ERROR(m_batch_size > 0, "perf_model/tlb_shootdown/batch_size must be at least 1");
+    LOG_ASSERT_ERROR(m_full_flush_threshold > 0, "perf_model/tlb_shootdown/full_flush_threshold must be at least 1");
+
+    for (int reason = 0; reason < NUM_REASONS; reason++)
+    {
+        stats.requests[reason] = 0;
+        stats.cost[reason] = SubsecondTime::Zero();
+        registerStatsMetric(name, 0, String("requests_") + REASON_NAMES[reason], &stats.requests[reason]);
+        registerStatsMetric(name, 0, String("cost_") + REASON_NAMES[reason], &stats.cost[reason]);
+    }
+    stats.rounds = 0;
+    stats.ipis = 0;
+    stats.address_space_flushes = 0;
+    stats.initiator_stall = SubsecondTime::Zero();
+    stats.target_stall = SubsecondTime::Zero();
+    registerStatsMetric(name, 0, "rounds", &stats.rounds);
+    registerStatsMetric(name, 0, "ipis", &stats.ipis);
+    registerStatsMetric(name, 0, "address_space_flushes", &stats.address_space_flushes);
+    registerStatsMetric(name, 0, "initiator_stall", &stats.initiator_stall);
+    registerStatsMetric(name, 0, "target_stall", &stats.target_stall);
+    Sim()->getStatsManager()->registerMetric(new StatsMetricCallback(name, 0, "cost_per_migrated_page", costPerMigratedPageCallback, (UInt64)this));
+
+    if (m_enabled)
+        Sim()->getHooksManager()->registerHook(HookType::HOOK_THREAD_MIGRATE, TLBShootdown::hookThreadMigrate, (UInt64)this);
+}
+
+TLBShootdown::~TLBShootdown()
+{
+}
+
+SInt64 TLBShootdown::hookThreadMigrate(UInt64 object, UInt64 argument)
+{
+    TLBShootdown *shootdown = (TLBShootdown *)object;
+    HooksManager::ThreadMigrate *args = (HooksManager::ThreadMigrate *)argument;
+    if (args->core_id == INVALID_CORE_ID || (UInt32)args->core_id >= shootdown->m_num_cores)
+        return 0;
+
+    int app_id = Sim()->getThreadManager()->getThreadFromID(args->thread_id)->getAppId();
+    ScopedLock sl(shootdown->m_lock);
+    std::vector<bool>& mask = shootdown->m_cpumask[args->core_id];
+    if ((size_t)app_id >= mask.size())
+        mask.resize(app_id + 1, false);
+    mask[app_id] = true;
+    shootdown->m_running[args->core_id] = app_id;
+    return 0;
+}
+
+void TLBShootdown::invalidate(int app_id, IntPtr va, reason_t reason)
+{
+    if (!m_enabled)
+        return;
+    Request request = { Request::PAGE, (UInt16)app_id, va };
+    submit(request, reason);
+}
+
+void TLBShootdown::invalidatePhysical(IntPtr ppn, reason_t reason)
+{
+    if (!m_enabled)
+        return;
+    Request request = { Request::PHYSICAL, 0, ppn };
+    submit(request, reason);
+}
+
+void TLBShootdown::flush()
+{
+    if (!m_enabled)
+        return;
+    core_id_t initiator = Sim()->getCoreManager()->getCurrentCoreID();
+    ScopedLock sl(m_lock);
+    if (!m_round.empty())
+        sendRound(initiator);
+}
+
+void TLBShootdown::submit(const Request& request, reason_t reason)
+{
+    core_id_t initiator = Sim()->getCoreManager()->getCurrentCoreID();
+    ScopedLock sl(m_lock);
+    stats.requests[reason]++;
+    m_round.push_back({ request, reason });
+    if (m_policy != BATCH || m_round.size() >= m_batch_size)
+        sendRound(initiator);
+}
+
+// Deliver the invalidations of m_round to every core that may cache them (m_lock is held)
+void TLBShootdown::sendRound(core_id_t initiator)
+{
+    // Address spaces with full_flush_threshold pages or more in the round are flushed instead
+    for (const Pending& pending : m_round)
+    {
+        if (pending.request.type != Request::PAGE)
+            continue;
+        if (pending.request.asid >= m_round_pages.size())
+            m_round_pages.resize(pending.request.asid + 1, 0);
+        m_round_pages[pending.request.asid]++;
+    }
+    m_deliver.clear();
+    for (const Pending& pending : m_round)
+    {
+        const Request& request = pending.request;
+        if (request.type != Request::PAGE)
+        {
+            m_deliver.push_back(request);
+        }
+        else if (m_round_pages[request.asid] == ROUND_FLUSHED)
+        {
+            continue;
+        }
+        else if (m_round_pages[request.asid] >= m_full_flush_threshold)
+        {
+            m_deliver.push_back({ Request::ADDRESS_SPACE, request.asid, 0 });
+            m_round_pages[request.asid] = ROUND_FLUSHED;
+            stats.address_space_flushes++;
+        }
+        else
+        {
+            m_deliver.push_back(request);
+        }
+    }
+    for (const Pending& pending : m_round)
+        if (pending.request.type == Request::PAGE)
+            m_round_pages[pending.request.asid] = 0;
+
+    SubsecondTime initiator_stall = SubsecondTime::Zero();
+    SubsecondTime target_stall = SubsecondTime::Zero();
+    UInt64 ipis = 0;
+    bool initiator_posted = false;
+    for (core_id_t core_id = 0; core_id < (core_id_t)m_num_cores; core_id++)
+    {
+        UInt32 pages = 0, flushes = 0;
+        bool interrupt = false;
+        Mailbox& mailbox = m_mailboxes[core_id];
+        ScopedLock sl(mailbox.lock);
+        for (const Request& request : m_deliver)
+        {
+            if (!isTarget(core_id, request))
+                continue;
+            interrupt |= (m_policy != LAZY || isRunning(core_id, request));
+            if (request.type == Request::ADDRESS_SPACE)
+                flushes++;
+            else
+                pages++;
+            post(mailbox, request, m_full_flush_threshold);
+        }
+        if (pages == 0 && flushes == 0)
+            continue;
+
+        SubsecondTime cost = pages * m_invlpg_latency.getLatency() + flushes * m_flush_latency.getLatency();
+        if (core_id == initiator)
+        {
+            // Local invalidation, charged with the rest of the initiator's time below
+            initiator_stall += cost;
+            initiator_posted = true;
+            continue;
+        }
+        if (interrupt)
+        {
+            cost += m_ipi_handler_latency.getLatency();
+            ipis++;
+        }
+        mailbox.stall += cost;
+        mailbox.pending.store(true, std::memory_order_release);
+        target_stall += cost;
+    }
+
+    if (ipis)
+        initiator_stall += m_ipi_latency.getLatency();
+    // The initiator applies its own invalidations even when they cost nothing
+    if (initiator != INVALID_CORE_ID && (UInt32)initiator < m_num_cores && (initiator_posted || initiator_stall > SubsecondTime::Zero()))
+    {
+        Mailbox& mailbox = m_mailboxes[initiator];
+        ScopedLock sl(mailbox.lock);
+        mailbox.stall += initiator_stall;
+        mailbox.pending.store(true, std::memory_order_release);
+    }
+    else
+    {
+        initiator_stall = SubsecondTime::Zero();
+    }
+
+    stats.rounds++;
+    stats.ipis += ipis;
+    stats.initiator_stall += initiator_stall;
+    stats.target_stall += target_stall;
+    UInt64 per_reason[NUM_REASONS] = { 0 };
+    for (const Pending& pending : m_round)
+        per_reason[pending.reason]++;
+    for (int reason = 0; reason < NUM_REASONS; reason++)
+        stats.cost[reason] += (initiator_stall + target_stall) * per_reason[reason] / m_round.size();
+
+    m_round.clear();
+}
+
+bool TLBShootdown::isTarget(core_id_t core_id, const Request& request) const
+{
+    const std::vector<bool>& mask = m_cpumask[core_id];
+    if (request.type == Request::PHYSICAL)
+        return std::find(mask.begin(), mask.end(), true) != mask.end();
+    return request.asid < mask.size() && mask[request.asid];
+}
+
+bool TLBShootdown::isRunning(core_id_t core_id, const Request& request) const
+{
+    if (request.type == Request::PHYSICAL)
+        return m_running[core_id] >= 0;
+    return m_running[core_id] == request.asid;
+}
+
+// Queue request for a core. The backlog of a core that does not translate (its application
+// finished, or it idles) is bounded: beyond capacity requests it becomes a single full flush.
+void TLBShootdown::post(Mailbox& mailbox, const Request& request, UInt32 capacity)
+{
+    if (!mailbox.requests.empty() && mailbox.requests.back().type == Request::ALL)
+        return;
+    if (mailbox.requests.size() >= capacity)
+    {
+        mailbox.requests.clear();
+        mailbox.requests.push_back({ Request::ALL, 0, 0 });
+        return;
+    }
+    mailbox.requests.push_back(request);
+}
+
+SubsecondTime TLBShootdown::receive(core_id_t core_id, std::vector<Request>& requests)
+{
+    Mailbox& mailbox = m_mailboxes[core_id];
+    ScopedLock sl(mailbox.lock);
+    requests.assign(mailbox.requests.begin(), mailbox.requests.end());
+    mailbox.requests.clear();
+    SubsecondTime stall = mailbox.stall;
+    mailbox.stall = SubsecondTime::Zero();
+    mailbox.pending.store(false, std::memory_order_release);
+    return stall;
+}
+
+UInt64 TLBShootdown::costPerMigratedPageCallback(String objectName, UInt32 index, String metricName, UInt64 arg)
+{
+    TLBShootdown *shootdown = (TLBShootdown *)arg;
+    UInt64 pages = shootdown->stats.requests[MIGRATE];
+    return pages ? (shootdown->stats.cost[MIGRATE] / pages).getFS() : 0;
+}
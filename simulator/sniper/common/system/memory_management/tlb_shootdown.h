@@ -0,0 +1,184 @@
+#ifndef __TLB_SHOOTDOWN_H__
+#define __TLB_SHOOTDOWN_H__
+
+/**
+ * TLB Shootdown
+ *
+ * Keeps the TLBs and page walk caches of all cores coherent with the page tables of MimicOS.
+ * Whenever MimicOS removes or changes a mapping (unmap, swap-out, page migration), it asks for
+ * the translation to be invalidated; the request reaches every core that may cache it, i.e.
+ * every core that ran the address space (Linux's mm_cpumask), as an inter-processor interrupt.
+ *
+ * Cores simulate in parallel, so the invalidations are not applied to their TLBs directly:
+ * each core has a mailbox that it drains before its next translation, applying the
+ * invalidations and stalling for the time they cost it. Costs (global clock cycles):
+ *
+ *   initiator:  invlpg_latency per page invalidated locally, plus ipi_latency to send the
+ *               interrupts and wait for the acknowledgements if other cores are interrupted
+ *   target:     ipi_handler_latency to take the interrupt, plus invlpg_latency per page
+ *
+ * Rounds of full_flush_threshold pages or more of one address space flush its entries instead
+ * (flush_latency, as Linux does beyond tlb_single_page_flush_ceiling). Policies:
+ *
+ *   immediate:  one round per invalidation
+ *   batch:      invalidations are held back until batch_size are pending, then sent in one
+ *               round (deferred flushing, as page reclaim does)
+ *   lazy:       as immediate, but only cores currently running the address space are
+ *               interrupted; the others pick the invalidations up with their next translation
+ *               and pay for the invalidation only
+ *
+ * The translations of the initiator are invalidated like those of the other cores, through its
+ * mailbox. Cores are tracked by the thread migrations they see, so shootdowns that happen before
+ * a core ran anything reach no one.
+ */
+
+#include "fixed_types.h"
+#include "subsecond_time.h"
+#include "lock.h"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class TLBShootdown
+{
+public:
+    enum reason_t
+    {
+        UNMAP = 0,      // Page-table entry removed
+        SWAP,           // Page swapped out
+        MIGRATE,        // Page moved to another physical frame or memory tier
+        NUM_REASONS
+    };
+
+    enum policy_t
+    {
+        IMMEDIATE = 0,
+        BATCH,
+        LAZY
+    };
+
+    /**
+     * One invalidation, as delivered to a core
+     */
+    struct Request
+    {
+        enum type_t
+        {
+            PAGE,           // Translation of address (virtual) in address space asid, any page size
+            PHYSICAL,       // Translations to the 4KB frame address (physical page number), any address space
+            ADDRESS_SPACE,  // All translations of address space asid
+            ALL             // All translations
+        };
+
+        type_t type;
+        UInt16 asid;
+        IntPtr address;
+    };
+
+    /**
+     * @param name Statistics object name
+     */
+    explicit TLBShootdown(String name);
+    ~TLBShootdown();
+
+    TLBShootdown(const TLBShootdown&) = delete;
+    TLBShootdown& operator=(const TLBShootdown&) = delete;
+
+    bool isEnabled() const { return m_enabled; }
+
+    /**
+     * @brief Invalidate the translation of virtual address va in address space app_id
+     *
+     * The initiator is the core running the calling code, if any.
+     */
+    void invalidate(int app_id, IntPtr va, reason_t reason);
+
+    /**
+     * @brief Invalidate all translations to physical page ppn (4KB frame), in all address spaces
+     *
+     * For changes made below the page tables, such as memory-tier migration, which do not know
+     * the virtual addresses mapping the frame.
+     */
+    void invalidatePhysical(IntPtr ppn, reason_t reason);
+
+    /**
+     * @brief Send the invalidations held back by the batch policy
+     */
+    void flush();
+
+    /**
+     * @brief Whether invalidations are waiting for core_id (cheap, checked on every translation)
+     */
+    bool hasPending(core_id_t core_id) const
+    {
+        return (UInt32)core_id < m_num_cores && m_mailboxes[core_id].pending.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Take the invalidations delivered to core_id
+     *
+     * @param requests Filled with the invalidations to apply to the core's TLBs and PWCs
+     * @return Time the core stalls for the shootdowns (interrupt handling and invalidation)
+     */
+    SubsecondTime receive(core_id_t core_id, std::vector<Request>& requests);
+
+private:
+    struct Pending
+    {
+        Request request;
+        reason_t reason;
+    };
+
+    struct Mailbox
+    {
+        Lock lock;
+        std::vector<Request> requests;  // At most full_flush_threshold, then replaced by one ALL
+        SubsecondTime stall;
+        std::atomic<bool> pending;
+
+        Mailbox() : stall(SubsecondTime::Zero()), pending(false) {}
+    };
+
+    static SInt64 hookThreadMigrate(UInt64 object, UInt64 argument);
+
+    void submit(const Request& request, reason_t reason);
+    void sendRound(core_id_t initiator);
+    bool isTarget(core_id_t core_id, const Request& request) const;
+    bool isRunning(core_id_t core_id, const Request& request) const;
+    static void post(Mailbox& mailbox, const Request& request, UInt32 capacity);
+
+    bool m_enabled;
+    policy_t m_policy;
+    UInt32 m_batch_size;
+    UInt32 m_full_flush_threshold;
+
+    ComponentLatency m_ipi_latency;
+    ComponentLatency m_ipi_handler_latency;
+    ComponentLatency m_invlpg_latency;
+    ComponentLatency m_flush_latency;
+
+    Lock m_lock;                                // Protects everything below but the mailboxes
+    UInt32 m_num_cores;
+    std::vector<std::vector<bool>> m_cpumask;   // [core][asid]: core ran address space asid
+    std::vector<SInt32> m_running;              // Address space running on each core, or -1
+    std::vector<Pending> m_round;               // Invalidations of the next round
+    std::vector<Request> m_deliver;             // The round as delivered, with address-space flushes
+    std::vector<UInt32> m_round_pages;          // Pages per address space in the round being sent
+    std::unique_ptr<Mailbox[]> m_mailboxes;
+
+    struct
+    {
+        UInt64 requests[NUM_REASONS];
+        SubsecondTime cost[NUM_REASONS];    // Initiator and target time, shared out over the pages of each round
+        UInt64 rounds;
+        UInt64 ipis;
+        UInt64 address_space_flushes;
+        SubsecondTime initiator_stall;
+        SubsecondTime target_stall;
+    } stats;
+
+    static UInt64 costPerMigratedPageCallback(String objectName, UInt32 index, String metricName, UInt64 arg);
+};
+
+#endif // __TLB_SHOOTDOWN_H__
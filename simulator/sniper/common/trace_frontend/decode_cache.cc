@@ -0,0 +1,51 @@
+#include "decode_cache.h"
+#include "simulator.h"
+
+#include <cstring>
+
+DecodeCache::DecodeCache()
+   : m_table(16384)
+   , m_arena_used(ARENA_CHUNK_SIZE)
+{
+}
+
+DecodeCache::~DecodeCache()
+{
+   for (Entry &entry : m_entries)
+      delete entry.decoded;
+   for (uint8_t *chunk : m_arena)
+      delete [] chunk;
+}
+
+const dl::DecodedInst *DecodeCache::get(IntPtr pc, const uint8_t *code, UInt8 size, int isa, bool *shared)
+{
+   ScopedLock sl(m_lock);
+
+   Entry *&head = m_table.insert(pc);
+   for (Entry *entry = head; entry; entry = entry->next)
+   {
+      if (entry->size == size && entry->isa == isa && memcmp(entry->code, code, size) == 0)
+      {
+         *shared = true;
+         return entry->decoded;
+      }
+   }
+
+   if (m_arena_used + size > ARENA_CHUNK_SIZE)
+   {
+      m_arena.push_back(new uint8_t[ARENA_CHUNK_SIZE]);
+      m_arena_used = 0;
+   }
+   uint8_t *copy = m_arena.back() + m_arena_used;
+   memcpy(copy, code, size);
+   m_arena_used += size;
+
+   dl::DecodedInst *decoded = m_factory.CreateInstruction(Sim()->getDecoder(), copy, size, pc);
+   Sim()->getDecoder()->decode(decoded, (dl::dl_isa)isa);
+
+   m_entries.push_back(Entry{copy, size, isa, decoded, head});
+   head = &m_entries.back();
+
+   *shared = false;
+   return decoded;
+}
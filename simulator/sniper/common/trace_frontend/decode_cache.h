@@ -0,0 +1,52 @@
+#ifndef __DECODE_CACHE_H
+#define __DECODE_CACHE_H
+
+#include "fixed_types.h"
+#include "lock.h"
+#include "sift_address_table.h"
+
+#include <decoder.h>
+#include <deque>
+#include <vector>
+
+// Decoded static instructions, shared by all trace threads
+//
+// Threads replaying the same binary (threads of one application, copies of an application,
+// restarted applications) decode the same instructions: the first thread to reach an
+// instruction decodes it, the others reuse that decode. Instructions are told apart by PC,
+// ISA and bytes, so threads replaying different binaries never share a decode.
+//
+// A DecodedInst points to the bytes it was decoded from, so these are copied into an arena
+// owned by the cache. Threads keep their own PC-indexed table of what they got from here
+// (see TraceThread::getStaticInfo), so the lock is only taken on the first execution of an
+// instruction by a thread.
+class DecodeCache
+{
+   public:
+      DecodeCache();
+      ~DecodeCache();
+
+      // Decode of the size bytes of code at pc. *shared is set if the decode already existed.
+      const dl::DecodedInst *get(IntPtr pc, const uint8_t *code, UInt8 size, int isa, bool *shared);
+
+   private:
+      static const size_t ARENA_CHUNK_SIZE = 64 << 10;
+
+      struct Entry
+      {
+         const uint8_t *code;     // In the arena
+         UInt8 size;
+         int isa;
+         const dl::DecodedInst *decoded;
+         Entry *next;             // Another instruction at the same PC
+      };
+
+      Lock m_lock;
+      dl::DecoderFactory m_factory;
+      Sift::AddressTable<Entry*> m_table;
+      std::deque<Entry> m_entries;
+      std::vector<uint8_t*> m_arena;
+      size_t m_arena_used;         // In m_arena.back()
+};
+
+#endif // __DECODE_CACHE_H
@@ -6,6 +6,7 @@
 #include "core.h" // for lock_signal_t and mem_op_t
 #include "_thread.h"
 #include "sift_reader.h"
+#include "decode_cache.h"
 #include <vector>
 
 class TraceThread;
@@ -55,6 +56,8 @@ class TraceManager
 
       Sift::Reader *m_kernel_trace_reader;
 
+      DecodeCache m_decode_cache;
+
       String getFifoName(app_id_t app_id, UInt64 thread_num, bool response, bool create);
       thread_id_t newThread(app_id_t app_id, bool first, bool init_fifo, bool spawn, SubsecondTime time, thread_id_t creator_thread_id);
 
@@ -87,6 +90,8 @@ class TraceManager
 
       Sift::Reader *getKernelTraceReader() const { return m_kernel_trace_reader; }
       void setKernelTraceReader(Sift::Reader *reader) { m_kernel_trace_reader = reader; }
+
+      DecodeCache *getDecodeCache() { return &m_decode_cache; }
       
       UInt64 getProgressExpect();
       UInt64 getProgressValue();
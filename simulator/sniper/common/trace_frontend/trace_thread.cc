@@ -20,6 +20,7 @@
 #include "sim_api.h"
 #include "mimicos.h"
 #include "stats.h"
+#include "timer.h"
 #include "parametric_dram_directory_msi/memory_manager.h"
 
 #include <unistd.h>
@@ -77,6 +78,7 @@ TraceThread::TraceThread(Thread *thread, SubsecondTime time_start, String tracef
    , m_trace_has_pa(false)
    , m_champsim_trace(false)
    , m_champsim_access_size(Sift::CHAMPSIM_DEFAULT_MEM_SIZE)
+   , m_start_instruction(Sim()->getCfg()->getInt("traceinput/start_instruction"))
    , m_address_randomization(Sim()->getCfg()->getBool("traceinput/address_randomization"))
    , m_appid_from_coreid(Sim()->getCfg()->getString("scheduler/type") == "sequential" ? true : false)
    , m_stop(false)
@@ -88,12 +90,15 @@ TraceThread::TraceThread(Thread *thread, SubsecondTime time_start, String tracef
    , m_tracefile(tracefile)
    , m_responsefile(responsefile)
    , m_app_id(app_id)
+   , m_vma_inference_app(NULL)
    , m_blocked(false)
    , m_cleanup(cleanup)
    , m_started(false)
    , m_stopped(false)
    , m_champsim_icache_hits(0)
    , m_champsim_icache_misses(0)
+   , m_static_info(16384)
+   , m_decode_cache(Sim()->getTraceManager()->getDecodeCache())
 {
 
    bool userspace_mimicos_enabled = Sim()->getCfg()->getBool("general/enable_userspace_mimicos");
@@ -116,6 +121,9 @@ TraceThread::TraceThread(Thread *thread, SubsecondTime time_start, String tracef
          m_champsim_access_size = Sift::CHAMPSIM_DEFAULT_MEM_SIZE;
    }
 
+   m_trace.setDecompression(Sim()->getCfg()->getInt("traceinput/decompression_threads"),
+                            Sim()->getCfg()->getInt("traceinput/prefetch_blocks"));
+
    m_trace.setHandleInstructionCountFunc(TraceThread::__handleInstructionCountFunc, this);
    m_trace.setHandleCacheOnlyFunc(TraceThread::__handleCacheOnlyFunc, this);
    if (Sim()->getCfg()->getBool("traceinput/mirror_output"))
@@ -146,14 +154,44 @@ TraceThread::TraceThread(Thread *thread, SubsecondTime time_start, String tracef
 
    thread->setVa2paFunc(_va2pa, (UInt64)this);
    stats.kernel_time = SubsecondTime::Zero();
+   stats.instructions = stats.decode_hits = stats.decode_misses = stats.decode_shared = 0;
+   stats.host_time_start = stats.host_time_end = 0;
+
+   // The app has been created by now; without a VMA file, its VMAs are inferred from what we access
+   MimicOS *vma_os = Sim()->isVirtualizedSystem() ? Sim()->getMimicOS_VM() : Sim()->getMimicOS();
+   ApplicationContext *app = vma_os ? vma_os->getApplication(m_app_id) : NULL;
+   if (app && app->isInferringVMAs())
+      m_vma_inference_app = app;
 
    // Guard against duplicate registration when a trace is restarted
    // (--sim-end=last-restart creates a new TraceThread with the same app_id).
    StatsMetricBase *existing = Sim()->getStatsManager()->getMetricObject("trace_thread", m_app_id, "kernel_time");
    if (existing == NULL)
+   {
       registerStatsMetric("trace_thread", m_app_id, "kernel_time", &stats.kernel_time);
+      registerStatsMetric("trace_thread", m_app_id, "instructions", &stats.instructions);
+      registerStatsMetric("trace_thread", m_app_id, "decode_hits", &stats.decode_hits);
+      registerStatsMetric("trace_thread", m_app_id, "decode_misses", &stats.decode_misses);
+      registerStatsMetric("trace_thread", m_app_id, "decode_shared", &stats.decode_shared);
+      // Host ns per instruction: host_time / instructions
+      Sim()->getStatsManager()->registerMetric(new StatsMetricCallback("trace_thread", m_app_id, "host_time", __hostTimeCallback, (UInt64)this));
+   }
    else
+   {
       static_cast<StatsMetric<SubsecondTime>*>(existing)->metric = &stats.kernel_time;
+      static_cast<StatsMetric<UInt64>*>(Sim()->getStatsManager()->getMetricObject("trace_thread", m_app_id, "instructions"))->metric = &stats.instructions;
+      static_cast<StatsMetric<UInt64>*>(Sim()->getStatsManager()->getMetricObject("trace_thread", m_app_id, "decode_hits"))->metric = &stats.decode_hits;
+      static_cast<StatsMetric<UInt64>*>(Sim()->getStatsManager()->getMetricObject("trace_thread", m_app_id, "decode_misses"))->metric = &stats.decode_misses;
+      static_cast<StatsMetric<UInt64>*>(Sim()->getStatsManager()->getMetricObject("trace_thread", m_app_id, "decode_shared"))->metric = &stats.decode_shared;
+      static_cast<StatsMetricCallback*>(Sim()->getStatsManager()->getMetricObject("trace_thread", m_app_id, "host_time"))->arg = (UInt64)this;
+   }
+}
+
+UInt64 TraceThread::getHostTime() const
+{
+   if (stats.host_time_start == 0)
+      return 0;
+   return (stats.host_time_end ? stats.host_time_end : Timer::now()) - stats.host_time_start;
 }
 
 TraceThread::~TraceThread()
@@ -166,11 +204,6 @@ TraceThread::~TraceThread()
       unlink(m_tracefile.c_str());
       unlink(m_responsefile.c_str());
    }
-   for(std::unordered_map<IntPtr, const dl::DecodedInst *>::iterator i = m_decoder_cache.begin() ; i != m_decoder_cache.end() ; ++i)
-   {
-      delete (*i).second;
-   }
-   
    // Clean up ChampSim instruction cache (since TraceManager doesn't delete TraceThreads)
    cleanupChampSimCache();
 }
@@ -502,15 +535,10 @@ SubsecondTime TraceThread::getCurrentTime() const
    return m_thread->getCore()->getPerformanceModel()->getElapsedTime();
 }
 
-Instruction* TraceThread::decode(Sift::Instruction &inst)
+Instruction* TraceThread::decode(Sift::Instruction &inst, const dl::DecodedInst &dec_inst)
 {
 
    //printf("PC: %lx Size: %d num_addresses=%d is_branch=%d\n", inst.sinst->addr, inst.sinst->size, inst.num_addresses, inst.is_branch);
-   if (m_decoder_cache.count(inst.sinst->addr) == 0)
-      m_decoder_cache[inst.sinst->addr] = staticDecode(inst);
-   
-   const dl::DecodedInst& dec_inst = *(m_decoder_cache[inst.sinst->addr]);
-
    OperandList list;
 
    // Ignore memory-referencing operands in NOP instructions
@@ -559,6 +587,7 @@ Instruction* TraceThread::decodeChampsim(Sift::Instruction &inst)
    if (it != m_champsim_icache.end()) {
       // Cache hit - return cached instruction
       m_champsim_icache_hits++;
+      stats.decode_hits++;
       #if DEBUG_CHAMPSIM_CACHE >= DEBUG_BASIC
       printf("[CHAMPSIM_CACHE] HIT  pc=0x%lx branch=%d src_regs=%d dest_regs=%d loads=%d stores=%d -> Instruction*=%p (cache_size=%zu)\n",
              cache_key.pc, cache_key.is_branch, cache_key.num_src_regs, cache_key.num_dest_regs,
@@ -568,6 +597,7 @@ Instruction* TraceThread::decodeChampsim(Sift::Instruction &inst)
    }
    
    m_champsim_icache_misses++;
+   stats.decode_misses++;
    
    #if DEBUG_CHAMPSIM_CACHE >= DEBUG_BASIC
    printf("[CHAMPSIM_CACHE] MISS pc=0x%lx branch=%d src_regs=%d dest_regs=%d loads=%d stores=%d (cache_size=%zu) -> ALLOCATING\n",
@@ -752,20 +782,28 @@ void TraceThread::handleCacheOnlyFunc(uint8_t icount, Sift::CacheOnlyType type,
    }
 }
 
-const dl::DecodedInst* TraceThread::staticDecode(Sift::Instruction &inst)
+TraceThread::StaticInfo &TraceThread::getStaticInfo(Sift::Instruction &inst)
 {
-   dl::DecodedInst *dec_inst = m_factory->CreateInstruction(Sim()->getDecoder(), inst.sinst->data, 
-                                                            inst.sinst->size, inst.sinst->addr);
-   Sim()->getDecoder()->decode(dec_inst, (dl::dl_isa)inst.isa);
-   return dec_inst;
+   if (StaticInfo *info = m_static_info.find(inst.sinst->addr))
+   {
+      stats.decode_hits++;
+      return *info;
+   }
+
+   stats.decode_misses++;
+   bool shared;
+   const dl::DecodedInst *decoded = m_decode_cache->get(inst.sinst->addr, inst.sinst->data, inst.sinst->size, inst.isa, &shared);
+   if (shared)
+      stats.decode_shared++;
+
+   StaticInfo &info = m_static_info.insert(inst.sinst->addr);
+   info.decoded = decoded;
+   return info;
 }
 
 void TraceThread::handleInstructionWarmup(Sift::Instruction &inst, Sift::Instruction &next_inst, Core *core, bool do_icache_warmup, UInt64 icache_warmup_addr, UInt64 icache_warmup_size)
 {
-   if (m_decoder_cache.count(inst.sinst->addr) == 0)
-      m_decoder_cache[inst.sinst->addr] = staticDecode(inst);
-   
-   const dl::DecodedInst &dec_inst = *(m_decoder_cache[inst.sinst->addr]);
+   const dl::DecodedInst &dec_inst = *getStaticInfo(inst).decoded;
 
    // Warmup instruction caches
 
@@ -816,6 +854,7 @@ void TraceThread::handleInstructionWarmup(Sift::Instruction &inst, Sift::Instruc
                UInt64 pa = va2pa(mem_address, is_prefetch ? &no_mapping : NULL);
                if (no_mapping)
                   continue;
+               observeMemoryAccess(pa, false);
 
                core->accessMemory(
                      /*(is_atomic_update) ? Core::LOCK :*/ Core::NONE,
@@ -851,6 +890,7 @@ void TraceThread::handleInstructionWarmup(Sift::Instruction &inst, Sift::Instruc
                UInt64 pa = va2pa(mem_address, is_prefetch ? &no_mapping : NULL);
                if (no_mapping)
                   continue;
+               observeMemoryAccess(pa, true);
 
                if (is_atomic_update)
                   core->logMemoryHit(false, Core::WRITE, pa, Core::MEM_MODELED_COUNT, va2pa(inst.sinst->addr));
@@ -897,6 +937,7 @@ void TraceThread::handleChampSimWarmup(Sift::Instruction &inst, Sift::Instructio
       UInt64 pa = va2pa(inst.src_addresses[idx], &no_mapping);
       if (no_mapping)
          continue;
+      observeMemoryAccess(pa, false);
 
       core->accessMemory(
             Core::NONE,
@@ -914,6 +955,7 @@ void TraceThread::handleChampSimWarmup(Sift::Instruction &inst, Sift::Instructio
       UInt64 pa = va2pa(inst.dest_addresses[idx], &no_mapping);
       if (no_mapping)
          continue;
+      observeMemoryAccess(pa, true);
 
       core->accessMemory(
             Core::NONE,
@@ -931,12 +973,12 @@ void TraceThread::handleInstructionDetailed(Sift::Instruction &inst, Sift::Instr
 
    // Set up instruction
 
-   if (m_icache.count(inst.sinst->addr) == 0)
-      m_icache[inst.sinst->addr] = decode(inst);
-   // Here get the decoder instruction without checking, because we must have it for sure
-   const dl::DecodedInst &dec_inst = *(m_decoder_cache[inst.sinst->addr]);
+   StaticInfo &info = getStaticInfo(inst);
+   if (info.instruction == NULL)
+      info.instruction = decode(inst, *info.decoded);
+   const dl::DecodedInst &dec_inst = *info.decoded;
 
-   Instruction *ins = m_icache[inst.sinst->addr];
+   Instruction *ins = info.instruction;
    DynamicInstruction *dynins = prfmdl->createDynamicInstruction(ins, va2pa(inst.sinst->addr));
 
    // Add dynamic instruction info
@@ -1116,6 +1158,7 @@ void TraceThread::addDetailedMemoryInfo(DynamicInstruction *dynins, Sift::Instru
    }
    else
    {
+      observeMemoryAccess(pa, op_type == Operand::WRITE);
       dynins->addMemory(
          inst.executed,
          SubsecondTime::Zero(),
@@ -1146,6 +1189,7 @@ void TraceThread::addChampSimMemoryInfo(DynamicInstruction *dynins, UInt64 mem_a
    }
    else
    {
+      observeMemoryAccess(pa, op_type == Operand::WRITE);
       dynins->addMemory(
          executed,
          SubsecondTime::Zero(),
@@ -1157,6 +1201,13 @@ void TraceThread::addChampSimMemoryInfo(DynamicInstruction *dynins, UInt64 mem_a
    }
 }
 
+// Called before the access is translated, so that its page fault finds the VMA it created
+void TraceThread::observeMemoryAccess(UInt64 address, bool is_write)
+{
+   if (m_vma_inference_app)
+      m_vma_inference_app->observeAccess(address, is_write);
+}
+
 void TraceThread::unblock()
 {
    LOG_ASSERT_ERROR(m_blocked == true, "Must call only when m_blocked == true");
@@ -1219,6 +1270,8 @@ void TraceThread::m_run_func_with_userpace_mimicos()
       m_thread->reschedule(time, NULL);
    }
 
+   seekToStartInstruction();
+
    Core *core = m_thread->getCore();
    PerformanceModel *prfmdl = core->getPerformanceModel();
 
@@ -1364,6 +1417,7 @@ void TraceThread::m_run_func_with_userpace_mimicos()
             // Only enable once we have received two instructions, otherwise, we could deadlock
             Sim()->getTraceManager()->signalStarted();
             m_started = true;
+            stats.host_time_start = Timer::now();
          }
 
          // We may have been blocked in a system call; starting to execute again means we continue
@@ -1482,9 +1536,13 @@ void TraceThread::m_run_func_with_userpace_mimicos()
                       << num_requested_frames << " frames for page fault handling" << std::endl;
 #endif
 
-            mimic_os->buildMessageWithArgs("page_fault",
-                                           mimic_os->getVaTriggeredPageFault(pf_core_id),
-                                           num_requested_frames);
+            // One-entry batch: the faulting access is replayed right after the reply
+            MimicOSMessage &request = mimic_os->nextMessage(pf_core_id);
+            request.begin(MimicOSProtocol::Opcode::PAGE_FAULT);
+            request.append(MimicOSProtocol::PageFaultRequest{
+               static_cast<uint64_t>(mimic_os->getVaTriggeredPageFault(pf_core_id)),
+               static_cast<uint64_t>(num_requested_frames),
+               static_cast<uint64_t>(pf_core_id) });
 
             // Handle PF on user-space MimicOS (kernel) side
 #if DEBUG_TRACE_THREAD >= DEBUG_DETAILED
@@ -1529,9 +1587,11 @@ void TraceThread::m_run_func_with_userpace_mimicos()
 #endif
 
          executed_instructions++;
+         stats.instructions++;
       }
    }
 
+   stats.host_time_end = Timer::now();
    printf("[TRACE:%u] -- %s --\n", m_thread->getId(), m_stop ? "STOP" : "DONE");
    
    // Clean up ChampSim instruction cache to avoid leaks (destructor is never called)
@@ -1547,6 +1607,17 @@ void TraceThread::m_run_func_with_userpace_mimicos()
 
 
 
+void TraceThread::seekToStartInstruction()
+{
+   if (m_start_instruction == 0)
+      return;
+
+   // Block-indexed traces decode from the block holding m_start_instruction: the instructions
+   // before it in that block are read (their records handled) but not simulated
+   LOG_ASSERT_ERROR(m_trace.Seek(m_start_instruction), "Cannot start trace %s at instruction %ld",
+                    m_trace.getFilename(), m_start_instruction);
+}
+
 void TraceThread::m_run_func_default()
 {
    // Set thread name for Sniper-in-Sniper simulations
@@ -1575,6 +1646,8 @@ void TraceThread::m_run_func_default()
       m_thread->reschedule(time, NULL);
    }
 
+   seekToStartInstruction();
+
    Core *core = m_thread->getCore();
    PerformanceModel *prfmdl = core->getPerformanceModel();
 
@@ -1591,6 +1664,7 @@ void TraceThread::m_run_func_default()
          // Only enable once we have received two instructions, otherwise, we could deadlock
          Sim()->getTraceManager()->signalStarted();
          m_started = true;
+         stats.host_time_start = Timer::now();
       }
       if (m_blocked)
       {
@@ -1677,12 +1751,15 @@ void TraceThread::m_run_func_default()
       }
 
 
+      stats.instructions++;
+
       if (m_stop)
          break;
 
       inst = next_inst;
    }
 
+   stats.host_time_end = Timer::now();
    printf("[TRACE:%u] -- %s --\n", m_thread->getId(), m_stop ? "STOP" : "DONE");
    
    // Clean up ChampSim instruction cache to avoid leaks (destructor is never called)
@@ -6,6 +6,7 @@
 #include "thread.h"
 #include "core.h"
 #include "sift_reader.h"
+#include "decode_cache.h"
 #include "operand.h"
 #include "semaphore.h"
 
@@ -28,6 +29,7 @@
 
 class Instruction;
 class DynamicInstruction;
+class ApplicationContext;
 
 class TraceThread : public Runnable
 {
@@ -64,15 +66,22 @@ class TraceThread : public Runnable
       bool m_trace_has_pa;
       bool m_champsim_trace;
       UInt32 m_champsim_access_size;
+      UInt64 m_start_instruction;            // Instruction of the trace to start at (block-indexed traces)
       bool m_address_randomization;
       bool m_appid_from_coreid;
       uint8_t m_address_randomization_table[256];
       bool m_stop;
-      std::unordered_map<IntPtr, Instruction *> m_icache;
-      //std::unordered_map<IntPtr, const xed_decoded_inst_t *> m_decoder_cache;  // TODO convert to DecoderLib
       //static bool xed_initialized;  // TODO convert to DecoderLib
       //xed_state_t m_xed_state_init;  // TODO convert to DecoderLib
-      std::unordered_map<IntPtr, const dl::DecodedInst *> m_decoder_cache;  // TODO convert to DecoderLib
+
+      // Per PC: its decode (from the DecodeCache shared by all threads), and our Instruction for it once created
+      struct StaticInfo
+      {
+         const dl::DecodedInst *decoded;
+         Instruction *instruction;
+      };
+      Sift::AddressTable<StaticInfo> m_static_info;
+      DecodeCache *m_decode_cache;
       
       // ChampSim instruction cache: key is (PC, is_branch, num_src_regs, num_dest_regs, num_loads, num_stores)
       // This allows reusing instructions when the same PC has the same operand signature
@@ -122,6 +131,7 @@ class TraceThread : public Runnable
       String m_responsefile_kernel;
       
       app_id_t m_app_id;
+      ApplicationContext *m_vma_inference_app; // Our app, if its VMAs are inferred from our memory accesses
       bool m_blocked;
       bool m_cleanup;
       bool m_started;
@@ -136,6 +146,12 @@ class TraceThread : public Runnable
       struct statistics
       {
          SubsecondTime kernel_time;
+         UInt64 instructions;       // Replayed, in any instrumentation mode
+         UInt64 decode_hits;        // Instructions found in m_static_info
+         UInt64 decode_misses;
+         UInt64 decode_shared;      // Misses decoded earlier by another thread
+         UInt64 host_time_start;    // Host ns at the first instruction
+         UInt64 host_time_end;      // Host ns at the last one
       } stats;
       // Make run() a function pointer which is initialized in the constructor
       typedef void (TraceThread::*RunFunc)();
@@ -147,6 +163,7 @@ class TraceThread : public Runnable
 
       void m_run_func_default();
       void m_run_func_with_userpace_mimicos();
+      void seekToStartInstruction();
 
       Sift::Mode handleInstructionCountFunc(uint32_t icount);
       void handleCacheOnlyFunc(uint8_t icount, Sift::CacheOnlyType type, uint64_t eip, uint64_t address);
@@ -162,7 +179,8 @@ class TraceThread : public Runnable
 
 
 
-      Instruction* decode(Sift::Instruction &inst);
+      StaticInfo &getStaticInfo(Sift::Instruction &inst);
+      Instruction* decode(Sift::Instruction &inst, const dl::DecodedInst &dec_inst);
       Instruction* decodeChampsim(Sift::Instruction &inst);
       void handleInstructionWarmup(Sift::Instruction &inst, Sift::Instruction &next_inst, Core *core, bool do_icache_warmup, UInt64 icache_warmup_addr, UInt64 icache_warmup_size);
       void handleChampSimWarmup(Sift::Instruction &inst, Sift::Instruction &next_inst, Core *core);
@@ -171,14 +189,16 @@ class TraceThread : public Runnable
       //void addDetailedMemoryInfo(DynamicInstruction *dynins, Sift::Instruction &inst, const xed_decoded_inst_t &xed_inst, uint32_t mem_idx, Operand::Direction op_type, bool is_pretetch, PerformanceModel *prfmdl);
       void addDetailedMemoryInfo(DynamicInstruction *dynins, Sift::Instruction &inst, const dl::DecodedInst &decoded_inst, uint32_t mem_idx, Operand::Direction op_type, bool is_pretetch, PerformanceModel *prfmdl);
       void addChampSimMemoryInfo(DynamicInstruction *dynins, UInt64 mem_address, Operand::Direction op_type, bool executed, bool is_prefetch, PerformanceModel *prfmdl);
+      void observeMemoryAccess(UInt64 address, bool is_write);
       void unblock();
 
       SubsecondTime getCurrentTime() const;
       
       //static dl::Decoder *m_decoder;
-      dl::DecoderFactory *m_factory;  // we need a factory here to be able to create instructions of any kind
-      //const xed_decoded_inst_t* staticDecode(Sift::Instruction &inst);
-      const dl::DecodedInst* staticDecode(Sift::Instruction &inst);
+
+      static UInt64 __hostTimeCallback(String objectName, UInt32 index, String metricName, UInt64 arg)
+      { return ((TraceThread*)arg)->getHostTime(); }
+      UInt64 getHostTime() const;
 
       long long *m_papi_counters;
       bool m_virtuos_app;
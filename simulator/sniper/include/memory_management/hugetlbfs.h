@@ -9,6 +9,7 @@
  *----------------------------------------------------------------------------*/
 #include "debug_config.h"
 #include "fixed_types.h"
+#include "memory_management/misc/snapshot.h"
 
 #include <string>
 #include <unordered_map>
@@ -339,6 +340,53 @@ public:
 
     bool isEnabled() const { return m_enabled; }
 
+    // ========================================================================
+    // Snapshots
+    // ========================================================================
+
+    /**
+     * @brief Save the pools (which pages are handed out, to whom) and per-app usage.
+     */
+    void saveState(Snapshot::Writer& writer) const
+    {
+        writer.put(m_enabled);
+        writer.putVector(m_pool_2mb);
+        writer.putVector(m_pool_1gb);
+        writer.put(m_free_hugepages_2mb);
+        writer.put(m_free_hugepages_1gb);
+        writer.putVector(usageRecords(m_app_usage_2mb));
+        writer.putVector(usageRecords(m_app_usage_1gb));
+    }
+
+    /**
+     * @brief Restore the pools; fails if the pool sizes differ from this configuration.
+     */
+    bool loadState(Snapshot::Section& section)
+    {
+        bool enabled = false;
+        std::vector<HugePageInfo> pool_2mb, pool_1gb;
+        UInt64 free_2mb = 0, free_1gb = 0;
+        std::vector<AppUsage> usage_2mb, usage_1gb;
+        if (!section.get(enabled) || !section.getVector(pool_2mb) || !section.getVector(pool_1gb)
+            || !section.get(free_2mb) || !section.get(free_1gb)
+            || !section.getVector(usage_2mb) || !section.getVector(usage_1gb))
+            return false;
+        if (enabled != m_enabled || pool_2mb.size() != m_pool_2mb.size() || pool_1gb.size() != m_pool_1gb.size())
+            return false;
+
+        m_pool_2mb.swap(pool_2mb);
+        m_pool_1gb.swap(pool_1gb);
+        m_free_hugepages_2mb = free_2mb;
+        m_free_hugepages_1gb = free_1gb;
+        m_app_usage_2mb.clear();
+        for (const AppUsage& u : usage_2mb)
+            m_app_usage_2mb[static_cast<int>(u.app_id)] = u.pages;
+        m_app_usage_1gb.clear();
+        for (const AppUsage& u : usage_1gb)
+            m_app_usage_1gb[static_cast<int>(u.app_id)] = u.pages;
+        return true;
+    }
+
     // ========================================================================
     // Debug / Logging
     // ========================================================================
@@ -378,6 +426,20 @@ private:
     // Private Members
     // ========================================================================
 
+    // Snapshot record of one m_app_usage_* entry
+    struct AppUsage {
+        SInt64 app_id;
+        UInt64 pages;
+    };
+
+    static std::vector<AppUsage> usageRecords(const std::unordered_map<int, UInt64>& usage)
+    {
+        std::vector<AppUsage> records;
+        for (const auto& kv : usage)
+            records.push_back(AppUsage{kv.first, kv.second});
+        return records;
+    }
+
     bool m_enabled;
 
     // Pool of 2MB huge pages
@@ -0,0 +1,362 @@
+#pragma once
+/*------------------------------------------------------------------------------
+ *  MimicOS snapshots (simulator-agnostic)
+ *
+ *  A snapshot is one binary file made of named sections, each a sequence of
+ *  trivially-copyable records:
+ *
+ *    FileHeader | SectionEntry[num_sections] | section payloads
+ *
+ *  Writer stages the sections in memory and publishes the file with a rename,
+ *  so an interrupted run never leaves a truncated image behind.
+ *
+ *  Reader maps the file read-only and hands out pointers into the mapping:
+ *  the runs of a sweep that start from the same warmed image share its page
+ *  cache pages. Only what a component copies into its own structures costs
+ *  memory.
+ *
+ *  Records are aligned to their type inside a section and sections are
+ *  aligned to SECTION_ALIGNMENT, so those pointers are always well aligned.
+ *
+ *  The format is versioned. Files written by another VERSION, or by a host
+ *  with another byte order, are refused.
+ *
+ *  NO simulator.h, config.hpp or stats.h included here.
+ *----------------------------------------------------------------------------*/
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Snapshot
+{
+    static const char MAGIC[8] = {'M', 'I', 'M', 'I', 'C', 'S', 'N', 'P'};
+    static const uint32_t VERSION = 3;
+    static const uint32_t BYTE_ORDER_MARK = 0x01020304;
+    static const size_t NAME_LENGTH = 48;
+    static const size_t SECTION_ALIGNMENT = 16;
+
+    struct FileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t byte_order;
+        uint64_t num_sections;
+        uint64_t file_size;
+    };
+
+    struct SectionEntry
+    {
+        char name[NAME_LENGTH]; // NUL-terminated
+        uint64_t offset;        // From the start of the file
+        uint64_t size;
+    };
+
+    static inline size_t alignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    /**
+     * @brief Builds a snapshot: beginSection() opens a section, put*() append records to it.
+     */
+    class Writer
+    {
+    public:
+        void beginSection(const std::string &name)
+        {
+            m_sections.push_back(PendingSection());
+            m_sections.back().name = name;
+        }
+
+        template <class T>
+        void put(const T &value) { putArray(&value, 1); }
+
+        template <class T>
+        void putArray(const T *values, size_t count)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Snapshot records must be trivially copyable");
+            std::vector<char> &data = current();
+            size_t offset = alignUp(data.size(), alignof(T));
+            data.resize(offset + count * sizeof(T), 0);
+            if (count)
+                memcpy(&data[offset], values, count * sizeof(T));
+        }
+
+        template <class T>
+        void putVector(const std::vector<T> &values)
+        {
+            put<uint64_t>(values.size());
+            putArray(values.data(), values.size());
+        }
+
+        void putString(const std::string &value)
+        {
+            put<uint64_t>(value.size());
+            putArray(value.data(), value.size());
+        }
+
+        /* Writes the file (through a temporary next to it). On failure, error says why. */
+        bool write(const std::string &path, std::string &error) const
+        {
+            FileHeader header;
+            memset(&header, 0, sizeof(header));
+            memcpy(header.magic, MAGIC, sizeof(MAGIC));
+            header.version = VERSION;
+            header.byte_order = BYTE_ORDER_MARK;
+            header.num_sections = m_sections.size();
+
+            std::vector<SectionEntry> table(m_sections.size());
+            size_t offset = alignUp(sizeof(FileHeader) + table.size() * sizeof(SectionEntry), SECTION_ALIGNMENT);
+            for (size_t i = 0; i < m_sections.size(); i++)
+            {
+                if (m_sections[i].name.size() >= NAME_LENGTH)
+                {
+                    error = "section name too long: " + m_sections[i].name;
+                    return false;
+                }
+                memset(&table[i], 0, sizeof(SectionEntry));
+                strcpy(table[i].name, m_sections[i].name.c_str());
+                table[i].offset = offset;
+                table[i].size = m_sections[i].data.size();
+                offset = alignUp(offset + table[i].size, SECTION_ALIGNMENT);
+            }
+            header.file_size = offset;
+
+            std::string tmp_path = path + ".tmp";
+            FILE *file = fopen(tmp_path.c_str(), "wb");
+            if (!file)
+            {
+                error = "cannot create " + tmp_path;
+                return false;
+            }
+
+            bool ok = fwrite(&header, sizeof(header), 1, file) == 1
+                   && (table.empty() || fwrite(table.data(), sizeof(SectionEntry), table.size(), file) == table.size());
+            for (size_t i = 0; ok && i < m_sections.size(); i++)
+                ok = pad(file, table[i].offset)
+                  && (m_sections[i].data.empty() || fwrite(m_sections[i].data.data(), m_sections[i].data.size(), 1, file) == 1);
+            ok = ok && pad(file, header.file_size);
+            ok = (fclose(file) == 0) && ok;
+
+            if (!ok || rename(tmp_path.c_str(), path.c_str()) != 0)
+            {
+                unlink(tmp_path.c_str());
+                error = "cannot write " + path;
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        struct PendingSection
+        {
+            std::string name;
+            std::vector<char> data;
+        };
+        std::vector<PendingSection> m_sections;
+
+        std::vector<char> &current()
+        {
+            if (m_sections.empty())
+                beginSection("");
+            return m_sections.back().data;
+        }
+
+        static bool pad(FILE *file, size_t offset)
+        {
+            static const char zeros[SECTION_ALIGNMENT] = {0};
+            long position = ftell(file);
+            return position >= 0 && (size_t)position <= offset
+                && fwrite(zeros, 1, offset - position, file) == offset - (size_t)position;
+        }
+    };
+
+    /**
+     * @brief Read cursor over one section of a mapped snapshot
+     *
+     * Every get*() returns false (or NULL) once the section is missing or a read would run
+     * past its end, and ok() stays false from then on, so a loader can read a whole
+     * structure and check once.
+     */
+    class Section
+    {
+    public:
+        Section() : m_data(NULL), m_size(0), m_pos(0), m_ok(false) {}
+        Section(const char *data, size_t size) : m_data(data), m_size(size), m_pos(0), m_ok(true) {}
+
+        bool ok() const { return m_ok; }
+        bool atEnd() const { return m_pos == m_size; }
+        size_t size() const { return m_size; }
+
+        /* Points into the mapping: valid for the lifetime of the Reader */
+        template <class T>
+        const T *getArray(size_t count)
+        {
+            static_assert(std::is_trivially_copyable<T>::value, "Snapshot records must be trivially copyable");
+            size_t offset = alignUp(m_pos, alignof(T));
+            if (!m_ok || offset > m_size || count > (m_size - offset) / sizeof(T))
+            {
+                m_ok = false;
+                return NULL;
+            }
+            m_pos = offset + count * sizeof(T);
+            return reinterpret_cast<const T *>(m_data + offset);
+        }
+
+        template <class T>
+        bool get(T &value)
+        {
+            const T *record = getArray<T>(1);
+            if (record)
+                value = *record;
+            return record != NULL;
+        }
+
+        template <class T>
+        bool getVector(std::vector<T> &values)
+        {
+            uint64_t count = 0;
+            if (!get(count))
+                return false;
+            const T *records = getArray<T>(count);
+            if (records)
+                values.assign(records, records + count);
+            return records != NULL;
+        }
+
+        bool getString(std::string &value)
+        {
+            uint64_t length = 0;
+            if (!get(length))
+                return false;
+            const char *chars = getArray<char>(length);
+            if (chars)
+                value.assign(chars, length);
+            return chars != NULL;
+        }
+
+        /* Marks the section as malformed (e.g. a record failed validation) */
+        void fail() { m_ok = false; }
+
+    private:
+        const char *m_data;
+        size_t m_size;
+        size_t m_pos;
+        bool m_ok;
+    };
+
+    /**
+     * @brief Read-only mapping of a snapshot file
+     */
+    class Reader
+    {
+    public:
+        Reader() : m_base(NULL), m_size(0) {}
+        ~Reader() { close(); }
+
+        Reader(const Reader &) = delete;
+        Reader &operator=(const Reader &) = delete;
+
+        /* Maps and validates path. On failure, error says why. */
+        bool open(const std::string &path, std::string &error)
+        {
+            close();
+
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0)
+            {
+                error = "cannot open " + path;
+                return false;
+            }
+            struct stat st;
+            if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(FileHeader))
+            {
+                ::close(fd);
+                error = path + " is not a snapshot";
+                return false;
+            }
+            void *base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (base == MAP_FAILED)
+            {
+                error = "cannot map " + path;
+                return false;
+            }
+            m_base = static_cast<const char *>(base);
+            m_size = st.st_size;
+
+            const FileHeader *header = reinterpret_cast<const FileHeader *>(m_base);
+            if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0)
+                error = path + " is not a snapshot";
+            else if (header->byte_order != BYTE_ORDER_MARK)
+                error = path + " was written on a host with another byte order";
+            else if (header->version != VERSION)
+                error = path + " has snapshot version " + std::to_string(header->version) + ", expected " + std::to_string(VERSION);
+            else if (header->file_size != m_size || header->num_sections > (m_size - sizeof(FileHeader)) / sizeof(SectionEntry))
+                error = path + " is truncated";
+            else
+            {
+                m_sections = reinterpret_cast<const SectionEntry *>(m_base + sizeof(FileHeader));
+                m_num_sections = header->num_sections;
+                for (size_t i = 0; i < m_num_sections; i++)
+                {
+                    const SectionEntry &entry = m_sections[i];
+                    if (entry.offset % SECTION_ALIGNMENT || entry.offset > m_size || entry.size > m_size - entry.offset
+                        || memchr(entry.name, 0, NAME_LENGTH) == NULL)
+                    {
+                        error = path + " has a corrupt section table";
+                        close();
+                        return false;
+                    }
+                }
+                return true;
+            }
+            close();
+            return false;
+        }
+
+        void close()
+        {
+            if (m_base)
+                munmap(const_cast<char *>(m_base), m_size);
+            m_base = NULL;
+            m_size = 0;
+            m_sections = NULL;
+            m_num_sections = 0;
+        }
+
+        bool isOpen() const { return m_base != NULL; }
+
+        bool hasSection(const std::string &name) const { return find(name) != NULL; }
+
+        /* Cursor over the named section; !ok() if there is no such section */
+        Section section(const std::string &name) const
+        {
+            const SectionEntry *entry = find(name);
+            return entry ? Section(m_base + entry->offset, entry->size) : Section();
+        }
+
+    private:
+        const char *m_base;
+        size_t m_size;
+        const SectionEntry *m_sections = NULL;
+        size_t m_num_sections = 0;
+
+        const SectionEntry *find(const std::string &name) const
+        {
+            for (size_t i = 0; i < m_num_sections; i++)
+                if (name == m_sections[i].name)
+                    return &m_sections[i];
+            return NULL;
+        }
+    };
+}
@@ -0,0 +1,220 @@
+#pragma once
+#ifndef __VMA_INDEX_H__
+#define __VMA_INDEX_H__
+
+#include <algorithm>
+#include <vector>
+#include "vma.h"
+
+/*------------------------------------------------------------------------------
+ *  VMAIndex – the VMAs of one address space, sorted by base address
+ *
+ *  VMAs never overlap, so the VMA containing an address is the last one whose
+ *  base is <= address: a lookup is a binary search instead of a scan over all
+ *  VMAs (JVM and database traces carry thousands of them).
+ *
+ *  On top of that, every core remembers the VMA it hit last. Consecutive
+ *  faults of a core mostly land in the same VMA, so most lookups are one
+ *  bounds check. The hints need no invalidation: VMAs never overlap, so a
+ *  VMA that contains the address is the right one whatever its index is now.
+ *
+ *  Lookups may run concurrently (each core writes only its own hint slot).
+ *  Changes (insert/split/merge/erase/assign) need exclusive access, and they
+ *  shift the indices of the VMAs after the change.
+ *
+ *  NO simulator.h, config.hpp or stats.h included here.
+ *----------------------------------------------------------------------------*/
+class VMAIndex
+{
+    public:
+        explicit VMAIndex(int num_cores = 1)
+            : m_last_hit(num_cores > 0 ? num_cores : 1, -1)
+        {}
+
+        /**
+         * @brief Index of the VMA containing address, or -1
+         *
+         * @param core_id Core doing the lookup (selects the last-hit slot)
+         */
+        int find(IntPtr address, int core_id = 0) const
+        {
+            int &hint = m_last_hit[slot(core_id)];
+            if (hint >= 0 && hint < (int)m_vmas.size() && m_vmas[hint].contains(address))
+                return hint;
+
+            // First VMA starting after address; its predecessor is the only candidate
+            auto it = std::upper_bound(m_vmas.begin(), m_vmas.end(), address,
+                                       [](IntPtr a, const VMA &vma) { return a < vma.getBase(); });
+            if (it == m_vmas.begin() || !(it - 1)->contains(address))
+                return -1;
+
+            hint = (it - 1) - m_vmas.begin();
+            return hint;
+        }
+
+        VMA *lookup(IntPtr address, int core_id = 0)
+        {
+            int index = find(address, core_id);
+            return index < 0 ? nullptr : &m_vmas[index];
+        }
+
+        const VMA *lookup(IntPtr address, int core_id = 0) const
+        {
+            int index = find(address, core_id);
+            return index < 0 ? nullptr : &m_vmas[index];
+        }
+
+        /**
+         * @brief Replace all VMAs (e.g. with the ones parsed from a VMA file)
+         *
+         * The VMAs may come in any order. Overlapping ones are merged, so that lookups
+         * stay unambiguous.
+         *
+         * @return Number of VMAs that were merged into an overlapping one
+         */
+        size_t assign(std::vector<VMA> vmas)
+        {
+            std::stable_sort(vmas.begin(), vmas.end(),
+                             [](const VMA &a, const VMA &b) { return a.getBase() < b.getBase(); });
+
+            m_vmas.clear();
+            size_t merged = 0;
+            for (auto &vma : vmas)
+            {
+                if (!m_vmas.empty() && vma.getBase() < m_vmas.back().getEnd())
+                {
+                    if (vma.getEnd() > m_vmas.back().getEnd())
+                        m_vmas.back() = join(m_vmas.back(), vma);
+                    merged++;
+                    continue;
+                }
+                m_vmas.push_back(std::move(vma));
+            }
+            return merged;
+        }
+
+        /**
+         * @brief Insert a VMA at its sorted position
+         *
+         * @return Its index, or -1 (nothing inserted) if it is empty or overlaps an existing VMA
+         */
+        int insert(const VMA &vma)
+        {
+            if (vma.getEnd() <= vma.getBase())
+                return -1;
+
+            auto it = std::lower_bound(m_vmas.begin(), m_vmas.end(), vma.getBase(),
+                                       [](const VMA &v, IntPtr base) { return v.getBase() < base; });
+            if ((it != m_vmas.end() && it->getBase() < vma.getEnd())
+                || (it != m_vmas.begin() && (it - 1)->getEnd() > vma.getBase()))
+                return -1;
+
+            return m_vmas.insert(it, vma) - m_vmas.begin();
+        }
+
+        /**
+         * @brief Split the VMA containing address into [base, address) and [address, end)
+         *
+         * Both halves keep the VMA's state; physical ranges are cut at address.
+         *
+         * @return Index of the upper half, or -1 if no VMA strictly contains address
+         */
+        int split(IntPtr address)
+        {
+            int index = find(address);
+            if (index < 0 || m_vmas[index].getBase() == address)
+                return -1;
+
+            const VMA &vma = m_vmas[index];
+            VMA lower = withBounds(vma, vma.getBase(), address);
+            VMA upper = withBounds(vma, address, vma.getEnd());
+
+            const IntPtr split_vpn = address >> PAGE_SHIFT;
+            for (const Range &range : vma.getPhysicalRanges())
+            {
+                if (range.vpn + range.bounds <= split_vpn)
+                {
+                    lower.addPhysicalRange(range);
+                }
+                else if (range.vpn >= split_vpn)
+                {
+                    upper.addPhysicalRange(range);
+                }
+                else
+                {
+                    const IntPtr below = split_vpn - range.vpn;
+                    lower.addPhysicalRange(Range{range.vpn, below, range.offset});
+                    upper.addPhysicalRange(Range{split_vpn, range.bounds - below, range.offset + below});
+                }
+            }
+
+            m_vmas[index] = std::move(lower);
+            m_vmas.insert(m_vmas.begin() + index + 1, std::move(upper));
+            return index + 1;
+        }
+
+        /**
+         * @brief Merge the VMA at index with the next one, if they are adjacent
+         *
+         * The merged VMA keeps the lower VMA's allocation state and physical offset.
+         *
+         * @return true if merged
+         */
+        bool merge(int index)
+        {
+            if (index < 0 || index + 1 >= (int)m_vmas.size() || m_vmas[index].getEnd() != m_vmas[index + 1].getBase())
+                return false;
+
+            m_vmas[index] = join(m_vmas[index], m_vmas[index + 1]);
+            m_vmas.erase(m_vmas.begin() + index + 1);
+            return true;
+        }
+
+        void erase(int index) { m_vmas.erase(m_vmas.begin() + index); }
+        void clear() { m_vmas.clear(); }
+
+        size_t size() const { return m_vmas.size(); }
+        bool empty() const { return m_vmas.empty(); }
+
+        VMA &operator[](size_t index) { return m_vmas[index]; }
+        const VMA &operator[](size_t index) const { return m_vmas[index]; }
+
+        /** Sorted by base address */
+        const std::vector<VMA> &vmas() const { return m_vmas; }
+
+    private:
+        static const int PAGE_SHIFT = 12; // Range::vpn and Range::bounds are in 4KB pages
+
+        std::vector<VMA> m_vmas;
+        mutable std::vector<int> m_last_hit; // Per core: index of the VMA hit last
+
+        size_t slot(int core_id) const
+        {
+            return core_id >= 0 ? (size_t)core_id % m_last_hit.size() : 0;
+        }
+
+        // Copy of vma's state with other bounds and no physical ranges
+        static VMA withBounds(const VMA &vma, IntPtr base, IntPtr end)
+        {
+            VMA result(base, end);
+            result.setAllocated(vma.isAllocated());
+            result.setPhysicalOffset(vma.getPhysicalOffset());
+            result.setSuccessfulOffsetBasedAllocations(vma.getSuccessfulOffsetBasedAllocations());
+            return result;
+        }
+
+        // Union of a and the VMA b starting inside or right after it
+        static VMA join(const VMA &a, const VMA &b)
+        {
+            VMA result = withBounds(a, a.getBase(), std::max(a.getEnd(), b.getEnd()));
+            result.setSuccessfulOffsetBasedAllocations(a.getSuccessfulOffsetBasedAllocations()
+                                                       + b.getSuccessfulOffsetBasedAllocations());
+            for (const Range &range : a.getPhysicalRanges())
+                result.addPhysicalRange(range);
+            for (const Range &range : b.getPhysicalRanges())
+                result.addPhysicalRange(range);
+            return result;
+        }
+};
+
+#endif // __VMA_INDEX_H__
@@ -0,0 +1,344 @@
+#pragma once
+#ifndef __VMA_INFERENCE_H__
+#define __VMA_INFERENCE_H__
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include "vma_index.h"
+
+/*------------------------------------------------------------------------------
+ *  VMAInference – online VMA discovery from a stream of memory accesses
+ *
+ *  Streaming counterpart of vma_infer (python -m vma_infer), for traces that
+ *  come without a VMA file. Instead of per-VPN aggregates and a second pass,
+ *  it keeps a sorted list of regions (runs of touched pages) and grows them as
+ *  pages are first touched:
+ *
+ *    - a page at most gap_pages away from a region extends it;
+ *    - growth after the region stayed still for more than time_split accesses
+ *      starts a new region (first-touch discontinuity);
+ *    - the pages a region grew by last (wf_window of them) are split off when
+ *      their write fraction differs from the rest by more than wf_split_delta;
+ *    - two regions that grow into each other are merged when neither criterion
+ *      separates them.
+ *
+ *  Memory is bounded by max_regions: when it is reached, the two closest
+ *  neighbouring regions are merged.
+ *
+ *  Every region is published as one VMA as soon as it changes, so the page
+ *  of each observed access is covered before it faults (eager paging needs a
+ *  VMA for every fault). Accesses inside a region only update its counters.
+ *
+ *  Not thread-safe: the owner serializes observe() and publish().
+ *
+ *  NO simulator.h, config.hpp or stats.h included here.
+ *----------------------------------------------------------------------------*/
+class VMAInference
+{
+    public:
+        struct Params
+        {
+            UInt64 gap_pages = 4;         // Untouched pages allowed between two pages of a region
+            UInt64 time_split = 1000000;  // Accesses a region may stay still before growth starts a new one
+            UInt64 wf_window = 64;        // Pages of growth compared against the rest of the region
+            double wf_split_delta = 0.2;  // Write-fraction difference that splits the window off
+            size_t max_regions = 4096;
+        };
+
+        struct Stats
+        {
+            UInt64 accesses = 0;
+            UInt64 new_regions = 0;
+            UInt64 time_splits = 0;
+            UInt64 wf_splits = 0;
+            UInt64 gap_merges = 0;
+            UInt64 capacity_merges = 0;
+            UInt64 publications = 0;
+        };
+
+        explicit VMAInference(const Params &params)
+            : m_params(params)
+            , m_last_hit(-1)
+        {
+            m_params.max_regions = std::max<size_t>(m_params.max_regions, 2);
+            m_regions.reserve(m_params.max_regions + 1);
+        }
+
+        /**
+         * @brief Account one access of the traced application
+         *
+         * @return true if the regions changed and publish() is due
+         */
+        bool observe(IntPtr address, bool is_write)
+        {
+            m_stats.accesses++;
+            const IntPtr vpn = address >> PAGE_SHIFT;
+
+            if (m_last_hit >= 0 && m_regions[m_last_hit].contains(vpn))
+            {
+                m_regions[m_last_hit].count(vpn, is_write);
+                return false;
+            }
+
+            // Last region starting at or before vpn, and the one after it
+            int next = std::upper_bound(m_regions.begin(), m_regions.end(), vpn,
+                                        [](IntPtr v, const Region &r) { return v < r.start; }) - m_regions.begin();
+            int prev = next - 1;
+
+            if (prev >= 0 && m_regions[prev].contains(vpn))
+            {
+                m_last_hit = prev;
+                m_regions[prev].count(vpn, is_write);
+                return false;
+            }
+
+            if (prev >= 0 && vpn <= m_regions[prev].end + m_params.gap_pages
+                && m_stats.accesses - m_regions[prev].last_growth <= m_params.time_split)
+            {
+                growUp(prev, vpn, is_write);
+            }
+            else if (next < (int)m_regions.size() && vpn + m_params.gap_pages >= m_regions[next].start
+                     && m_stats.accesses - m_regions[next].last_growth <= m_params.time_split)
+            {
+                growDown(next, vpn, is_write);
+            }
+            else
+            {
+                if ((prev >= 0 && vpn <= m_regions[prev].end + m_params.gap_pages)
+                    || (next < (int)m_regions.size() && vpn + m_params.gap_pages >= m_regions[next].start))
+                    m_stats.time_splits++;
+                create(next, vpn, is_write);
+            }
+            return true;
+        }
+
+        /**
+         * @brief Make the VMAs of index match the regions that changed since the last call
+         *
+         * Each changed region becomes exactly one VMA: VMAs crossing its bounds are split,
+         * holes are filled with new VMAs and the VMAs inside it are merged. index must
+         * only hold VMAs published by this object.
+         */
+        void publish(VMAIndex &index)
+        {
+            for (const auto &range : m_changed)
+                cover(index, range.first << PAGE_SHIFT, range.second << PAGE_SHIFT);
+            m_changed.clear();
+            m_stats.publications++;
+        }
+
+        size_t numRegions() const { return m_regions.size(); }
+        Stats &getStats() { return m_stats; }
+        const Stats &getStats() const { return m_stats; }
+
+    private:
+        static const int PAGE_SHIFT = 12;
+
+        struct Region
+        {
+            IntPtr start, end;     // VPNs, end exclusive
+            UInt64 reads, writes;
+            UInt64 last_growth;    // Access count when the region last grew
+            IntPtr window_start;   // Growth window: [window_start, end)
+            UInt64 window_pages, window_reads, window_writes;
+
+            bool contains(IntPtr vpn) const { return vpn >= start && vpn < end; }
+
+            void count(IntPtr vpn, bool is_write)
+            {
+                (is_write ? writes : reads)++;
+                if (vpn >= window_start)
+                    (is_write ? window_writes : window_reads)++;
+            }
+        };
+
+        Params m_params;
+        std::vector<Region> m_regions;                    // Sorted by start, disjoint
+        std::vector<std::pair<IntPtr, IntPtr>> m_changed; // VPN ranges to publish, in order
+        int m_last_hit;
+        Stats m_stats;
+
+        static double writeFraction(UInt64 reads, UInt64 writes)
+        {
+            return (reads + writes) ? (double)writes / (reads + writes) : 0.0;
+        }
+
+        void changed(const Region &region) { m_changed.emplace_back(region.start, region.end); }
+
+        void create(int index, IntPtr vpn, bool is_write)
+        {
+            Region region;
+            region.start = region.window_start = vpn;
+            region.end = vpn + 1;
+            region.reads = region.writes = region.window_reads = region.window_writes = 0;
+            region.window_pages = 1;
+            region.last_growth = m_stats.accesses;
+            region.count(vpn, is_write);
+
+            m_regions.insert(m_regions.begin() + index, region);
+            m_stats.new_regions++;
+            m_last_hit = index;
+            changed(m_regions[index]);
+
+            if (m_regions.size() > m_params.max_regions)
+                mergeClosest();
+        }
+
+        void growUp(int index, IntPtr vpn, bool is_write)
+        {
+            Region &region = m_regions[index];
+            region.end = vpn + 1;
+            region.last_growth = m_stats.accesses;
+            region.window_pages++;
+            region.count(vpn, is_write);
+            m_last_hit = index;
+
+            if (region.window_pages < m_params.wf_window)
+                changed(region);
+            else if (closeWindow(index))
+                index++; // The window was split off and is the growing region now
+            coalesce(index);
+
+            if (m_regions.size() > m_params.max_regions)
+                mergeClosest();
+        }
+
+        void growDown(int index, IntPtr vpn, bool is_write)
+        {
+            Region &region = m_regions[index];
+            region.start = vpn;
+            region.last_growth = m_stats.accesses;
+            region.count(vpn, is_write);
+            m_last_hit = index;
+            changed(region);
+            if (index > 0)
+                coalesce(index - 1);
+        }
+
+        // The growth window is full: split it off if its write fraction stands out, else start a new one
+        bool closeWindow(int index)
+        {
+            Region &region = m_regions[index];
+            const UInt64 body_reads = region.reads - region.window_reads;
+            const UInt64 body_writes = region.writes - region.window_writes;
+            const bool body_large = (UInt64)(region.window_start - region.start) >= m_params.wf_window;
+
+            if (body_large && std::abs(writeFraction(body_reads, body_writes)
+                                       - writeFraction(region.window_reads, region.window_writes)) > m_params.wf_split_delta)
+            {
+                Region upper = region;
+                upper.start = region.window_start;
+                upper.reads = region.window_reads;
+                upper.writes = region.window_writes;
+                region.end = region.window_start;
+                region.reads = body_reads;
+                region.writes = body_writes;
+                resetWindow(region, region.end);
+                resetWindow(upper, upper.end);
+
+                m_regions.insert(m_regions.begin() + index + 1, upper);
+                m_stats.wf_splits++;
+                m_last_hit = index + 1;
+                changed(m_regions[index]);
+                changed(m_regions[index + 1]);
+
+                return true;
+            }
+
+            resetWindow(region, region.end);
+            changed(region);
+            return false;
+        }
+
+        static void resetWindow(Region &region, IntPtr window_start)
+        {
+            region.window_start = window_start;
+            region.window_pages = region.window_reads = region.window_writes = 0;
+        }
+
+        // Merge region index with the next one if it grew to within gap_pages of it and they were growing together
+        void coalesce(int index)
+        {
+            if (index < 0 || index + 1 >= (int)m_regions.size())
+                return;
+            const Region &lower = m_regions[index];
+            const Region &upper = m_regions[index + 1];
+            if (upper.start - lower.end > m_params.gap_pages
+                || std::max(lower.last_growth, upper.last_growth) - std::min(lower.last_growth, upper.last_growth) > m_params.time_split)
+                return;
+
+            join(index);
+            m_stats.gap_merges++;
+        }
+
+        // Over capacity: merge the two regions with the smallest gap between them. Adjacent
+        // regions were split on purpose, so they are merged only if nothing else is left.
+        void mergeClosest()
+        {
+            int best = -1;
+            IntPtr best_gap = 0;
+            for (int i = 0; i + 1 < (int)m_regions.size(); i++)
+            {
+                IntPtr gap = m_regions[i + 1].start - m_regions[i].end;
+                if (gap > 0 && (best < 0 || gap < best_gap))
+                {
+                    best = i;
+                    best_gap = gap;
+                }
+            }
+            if (best < 0)
+                best = 0;
+            join(best);
+            m_stats.capacity_merges++;
+        }
+
+        void join(int index)
+        {
+            Region &lower = m_regions[index];
+            const Region &upper = m_regions[index + 1];
+            lower.end = upper.end;
+            lower.reads += upper.reads;
+            lower.writes += upper.writes;
+            lower.last_growth = std::max(lower.last_growth, upper.last_growth);
+            lower.window_start = upper.window_start;
+            lower.window_pages = upper.window_pages;
+            lower.window_reads = upper.window_reads;
+            lower.window_writes = upper.window_writes;
+            m_regions.erase(m_regions.begin() + index + 1);
+
+            m_last_hit = index;
+            changed(lower);
+        }
+
+        // Make [base, end) exactly one VMA of index
+        static void cover(VMAIndex &index, IntPtr base, IntPtr end)
+        {
+            index.split(base);
+            index.split(end);
+
+            IntPtr pos = base;
+            while (pos < end)
+            {
+                int i = index.find(pos);
+                if (i >= 0)
+                {
+                    pos = index[i].getEnd();
+                    continue;
+                }
+                const std::vector<VMA> &vmas = index.vmas();
+                auto next = std::upper_bound(vmas.begin(), vmas.end(), pos,
+                                             [](IntPtr a, const VMA &vma) { return a < vma.getBase(); });
+                IntPtr hole_end = (next == vmas.end()) ? end : std::min(end, next->getBase());
+                index.insert(VMA(pos, hole_end));
+                pos = hole_end;
+            }
+
+            int first = index.find(base);
+            while (first >= 0 && index[first].getEnd() < end && index.merge(first))
+                ;
+        }
+};
+
+#endif // __VMA_INFERENCE_H__
@@ -117,6 +117,18 @@ public:
         buddy_allocator->fragmentMemory(target_fragmentation);
     }
 
+    bool saveState(Snapshot::Writer& writer) const override
+    {
+        saveBaseState(writer);
+        buddy_allocator->saveState(writer);
+        return true;
+    }
+
+    bool loadState(Snapshot::Section& section) override
+    {
+        return loadBaseState(section) && buddy_allocator->loadState(section);
+    }
+
 private:
     BuddyType* buddy_allocator {nullptr};
 
@@ -11,6 +11,8 @@
 #include <unordered_set>
 
 #include "debug_config.h"
+#include "memory_management/physical_memory_allocators/buddy_free_list.h"
+#include "memory_management/misc/snapshot.h"
 
 // Enable duplicate allocation detection for debugging (set to 0 for production)
 #define BUDDY_DUPLICATE_DETECTION 0
@@ -21,11 +23,18 @@ template <typename Policy>
 class Buddy : private Policy
 {
 public:
+    // The free-list engine is picked by the policy (e.g., from the simulator config)
     Buddy(int memory_size, int max_order, int kernel_size, const String& frag_type)
+        : Buddy(memory_size, max_order, kernel_size, frag_type, Policy::free_list_type())
+    {}
+
+    Buddy(int memory_size, int max_order, int kernel_size, const String& frag_type, BuddyFreeListType free_list_type)
         : m_memory_size(memory_size),
           m_max_order(max_order),
           m_kernel_size(kernel_size),
-          m_frag_type(frag_type)
+          m_frag_type(frag_type),
+          m_free_list_type(free_list_type),
+          free_list(createFreeList())
     {
 
         Policy::on_init(m_memory_size, m_max_order, m_kernel_size);
@@ -37,16 +46,13 @@ public:
                   ", kernel_size = " + std::to_string(kernel_size) +
                   ", frag_type = "   + frag_type.c_str());
 #endif  
-        free_list.resize(m_max_order + 1);
-        for (int i = 0; i < m_max_order + 1; i++)
-            free_list.emplace_back();
-
         if (frag_type == "contiguity")
             frag_fun = &Buddy::getAverageSizeRatio;
         else
             frag_fun = &Buddy::getLargePageRatio;
 
         std::cout << "[Buddy] Memory Size: " << m_memory_size << std::endl;
+        std::cout << "[Buddy] Free list engine: " << buddyFreeListTypeToString(m_free_list_type) << std::endl;
         UInt64 pages_in_block = 1ULL << m_max_order;
         UInt64 current_order = m_max_order;
 
@@ -68,13 +74,13 @@ public:
                 this->log("[Buddy] Adding block of size " + std::to_string(pages_in_block) +
                 " at address " + std::to_string(current_free)); 
 #endif
-                free_list[current_order].push_back(std::make_tuple(current_free, current_free + pages_in_block - 1, false, -1));
+                free_list->push_back(current_order, std::make_tuple(current_free, current_free + pages_in_block - 1, false, -1));
                 current_free += pages_in_block;
                 available_mem_in_pages -= pages_in_block;
             }
 #if DEBUG_BUDDY >= DEBUG_BASIC
 		this->log("[Buddy] Order " + std::to_string(current_order) +
-        " has " + std::to_string(free_list[current_order].size()) + " blocks");
+        " has " + std::to_string(free_list->size(current_order)) + " blocks");
 #endif
             current_order--;
             pages_in_block = 1ULL << current_order;
@@ -82,7 +88,17 @@ public:
 
     }
 
+    ~Buddy() { delete free_list; }
+
+    Buddy(const Buddy&) = delete;
+    Buddy& operator=(const Buddy&) = delete;
+
     int getMaxOrder() const { return m_max_order; }
+    BuddyFreeListType getFreeListType() const { return m_free_list_type; }
+    UInt64 getFreeListHostBytes() const { return free_list->getHostBytes(); }
+
+    /* Is [start, start + 2^order) currently a free block of exactly that order? */
+    bool isFreeBlock(UInt64 start, int order) const { return free_list->isFreeBlock(start, order); }
 
     bool checkIfFree(UInt64 physical_page, bool allocate)
     {
@@ -90,33 +106,19 @@ public:
         this->log("[Buddy::checkIfFree] Checking page " + std::to_string(physical_page) + ", allocate: " + (allocate ? "true" : "false"));
 #endif
         int found_order = -1;
-        int found_block_index = -1;
-        bool found = false;
+        std::tuple<UInt64, UInt64, bool, UInt64> found_block;
 
-        int iterations = 0;
-        // Search for the physical page in the free lists, starting from order 0.
-        for (int i = 0; i <= m_max_order; i++)
-        {
-            for (size_t j = 0; j < free_list[i].size(); ++j)
-            {
-                if (get<0>(free_list[i][j]) <= physical_page && get<1>(free_list[i][j]) >= physical_page)
-                {
-#if DEBUG_BUDDY >= DEBUG_BASIC
-                    this->log("[Buddy::checkIfFree] Found page " + std::to_string(physical_page) + " in block at order " + std::to_string(i) + ", index " + std::to_string(j));
-                    this->log("[Buddy::checkIfFree] Block details: start=" + std::to_string(get<0>(free_list[i][j])) + ", end=" + std::to_string(get<1>(free_list[i][j])));
-#endif
-                    found = true;
-                    found_order = i;
-                    found_block_index = j;
+        // The block is unlinked from its free list right away if we are going to split it
+        bool found = free_list->findContaining(physical_page, allocate, found_order, found_block);
 
-                    goto found_block; // Exit nested loops once the block is found
-                }
-                iterations++;
-            }
+#if DEBUG_BUDDY >= DEBUG_BASIC
+        if (found)
+        {
+            this->log("[Buddy::checkIfFree] Found page " + std::to_string(physical_page) + " in block at order " + std::to_string(found_order));
+            this->log("[Buddy::checkIfFree] Block details: start=" + std::to_string(get<0>(found_block)) + ", end=" + std::to_string(get<1>(found_block)));
         }
+#endif
 
-    found_block:
-    std::cout << "[Buddy::checkIfFree] Iterations: " << iterations << std::endl;
         if (!found)
         {
 #if DEBUG_BUDDY >= DEBUG_BASIC
@@ -134,8 +136,7 @@ public:
             // This involves removing the block and splitting it until we isolate the single page.
             
             // 1. Get the block that contains the page and remove it from its free list.
-            std::tuple<UInt64, UInt64, bool, UInt64> block_to_split = free_list[found_order][found_block_index];
-            free_list[found_order].erase(free_list[found_order].begin() + found_block_index);
+            std::tuple<UInt64, UInt64, bool, UInt64> block_to_split = found_block;
 
 #if DEBUG_BUDDY >= DEBUG_BASIC
             this->log("[Buddy::checkIfFree] Removed block from order " + std::to_string(found_order) + " to start splitting.");
@@ -164,7 +165,7 @@ public:
                     this->log("[Buddy::checkIfFree] Page in first buddy. Returning second buddy (start=" + std::to_string(get<0>(buddy2)) + ", end=" + std::to_string(get<1>(buddy2)) + ") to order " + std::to_string(current_order - 1));
 #endif
                     // The page is in the first buddy. Add the second buddy to the free list.
-                    free_list[current_order - 1].push_back(buddy2);
+                    free_list->push_back(current_order - 1, buddy2);
                     block_to_split = buddy1; // Continue splitting the first buddy.
                 }
                 else
@@ -173,7 +174,7 @@ public:
                     this->log("[Buddy::checkIfFree] Page in second buddy. Returning first buddy (start=" + std::to_string(get<0>(buddy1)) + ", end=" + std::to_string(get<1>(buddy1)) + ") to order " + std::to_string(current_order - 1));
 #endif
                     // The page is in the second buddy. Add the first buddy to the free list.
-                    free_list[current_order - 1].push_back(buddy1);
+                    free_list->push_back(current_order - 1, buddy1);
                     block_to_split = buddy2; // Continue splitting the second buddy.
                 }
             }
@@ -194,7 +195,7 @@ public:
         int ind = ceil(log2(bytes / 4096));
         int i;
         for (i = ind; i <= m_max_order; i++)
-            if (!free_list[i].empty()) break;
+            if (!free_list->empty(i)) break;
 
         if (i == m_max_order + 1)
         {
@@ -202,11 +203,10 @@ public:
             return static_cast<UInt64>(-1);
         }
 
-        auto block = free_list[i].back();
+        auto block = free_list->pop_back(i);
 #if DEBUG_BUDDY >= DEBUG_BASIC
 		this->log("[Buddy] Found free page in order " + std::to_string(i));
 #endif
-        free_list[i].pop_back();
         i--;
 
         while (i >= ind)
@@ -214,10 +214,9 @@ public:
             auto pair1 = std::make_tuple(get<0>(block), get<0>(block) + (get<1>(block) - get<0>(block)) / 2, false, -1);
             auto pair2 = std::make_tuple(get<0>(block) + (get<1>(block) - get<0>(block)) / 2 + 1, get<1>(block), false, -1);
 			assert((get<1>(pair2) - get<0>(pair2) + 1) == (1ULL << i));
-            free_list[i].push_back(pair1);
-            free_list[i].push_back(pair2);
-            block = free_list[i].back();
-            free_list[i].pop_back();
+            // Free the first half and go on splitting the second (the lists end up as if both were pushed and the second popped back)
+            free_list->push_back(i, pair1);
+            block = pair2;
             i--;
         }
 
@@ -254,13 +253,12 @@ public:
 #if DEBUG_BUDDY >= DEBUG_BASIC
         this->log("DEBUG_BUDDY: Checking for 2MB region in free_list[9]");
 #endif
-        if (!free_list[9].empty())
+        if (!free_list->empty(9))
         {
 #if DEBUG_BUDDY >= DEBUG_BASIC
             this->log("DEBUG_BUDDY: 2MB region available in free_list[9]");
 #endif
-            auto block = free_list[9].back();
-            free_list[9].pop_back();
+            auto block = free_list->pop_back(9);
             
 #if BUDDY_DUPLICATE_DETECTION
             UInt64 region_start = get<0>(block);
@@ -294,13 +292,12 @@ public:
 #endif
         for (int i = 10; i <= m_max_order; i++)
         {
-            if (!free_list[i].empty())
+            if (!free_list->empty(i))
             {
 #if DEBUG_BUDDY >= DEBUG_BASIC
 			this->log("DEBUG_BUDDY: Region available in free_list[" + std::to_string(i) + "]");
 #endif
-                auto temp = free_list[i].front();
-                free_list[i].erase(free_list[i].begin());
+                auto temp = free_list->pop_front(i);
 
                 UInt64 start = get<0>(temp);
                 UInt64 end = get<1>(temp);
@@ -314,15 +311,13 @@ public:
 
                 for (UInt64 j = 0; j < chunk; j++)
                 {
-                    free_list[9].push_back(std::make_tuple(start + j * pages_in_block, start + (j + 1) * pages_in_block - 1, false, -1));
-					assert(get<0>(free_list[9].back()) == (start + j * pages_in_block));
+                    free_list->push_back(9, std::make_tuple(start + j * pages_in_block, start + (j + 1) * pages_in_block - 1, false, -1));
 #if DEBUG_BUDDY >= DEBUG_BASIC
 					this->log("DEBUG_BUDDY: Added 2MB chunk to free_list[9], start = " + std::to_string(start + j * pages_in_block));
 #endif
                 }
 
-                auto block = free_list[9].back();
-                free_list[9].pop_back();
+                auto block = free_list->pop_back(9);
                 
 #if BUDDY_DUPLICATE_DETECTION
                 UInt64 region_start = get<0>(block);
@@ -376,7 +371,7 @@ public:
                     std::to_string(end));
 #endif
 
-        free_list[i].push_back(temp);
+        free_list->push_back(i, temp);
 
 #if BUDDY_DUPLICATE_DETECTION
         // Remove freed pages from tracking set
@@ -408,10 +403,9 @@ public:
         {
             for (int i = m_max_order; i >= 9; i--)
             {
-                if (!free_list[i].empty())
+                if (!free_list->empty(i))
                 {
-                    auto temp = free_list[i][0];
-                    free_list[i].erase(free_list[i].begin());
+                    auto temp = free_list->pop_front(i);
 
                     UInt64 start = get<0>(temp);
                     UInt64 end = get<1>(temp);
@@ -428,8 +422,7 @@ public:
                     // This way we are increasing the fragmentation without actually allocating memory which is very useful for testing and evaluation
                     for (UInt64 j = 0; j < chunk; j++)
                     {
-                        free_list[random_order].push_back(std::make_tuple(start + j * pages_in_block, start + (j + 1) * pages_in_block - 1, false, -1));
-                        assert(get<0>(free_list[random_order].back()) == (start + j * pages_in_block));
+                        free_list->push_back(random_order, std::make_tuple(start + j * pages_in_block, start + (j + 1) * pages_in_block - 1, false, -1));
                     }
 
                     break;
@@ -450,24 +443,9 @@ public:
 
     double getAverageSizeRatio()
     {
-        std::vector<UInt64> blockSizes;
-
-        // Collect sizes of all free blocks
-        for (const auto &list : free_list)
-            for (const auto &block : list)
-                blockSizes.push_back(get<1>(block) - get<0>(block) + 1); // check if the block is contiguous
-
-        // Sort block sizes in descending order
-        std::sort(blockSizes.rbegin(), blockSizes.rend());
-
         // Calculate average of top 50 blocks
-        UInt64 totalSize = 0;
         int count = 0;
-        for (auto size : blockSizes)
-        {
-            totalSize += size;
-            if (++count == 50) break;
-        }
+        UInt64 totalSize = free_list->sumLargestBlocks(50, count);
 
         double averageSize = (count > 0) ? (double)totalSize / count : 0.0;
         return averageSize / (1ULL << (m_max_order - 3));
@@ -475,12 +453,8 @@ public:
 
     double getLargePageRatio()
     {
-        int numberOfLargePages = 0;
         // Collect number of 2MB pages based on the free list
-        for (const auto &list : free_list)
-            for (const auto &block : list)
-                if ((get<1>(block) - get<0>(block) + 1) >= 512)
-                    numberOfLargePages += (get<1>(block) - get<0>(block) + 1) / 512;
+        UInt64 numberOfLargePages = free_list->countLargePages();
 
         // calculate the ratio of available large pages to the total number of 2MB pages
         m_frag_factor = (double)numberOfLargePages / (m_total_pages / 512);
@@ -495,12 +469,7 @@ public:
      */
     UInt64 getFreeLargePageCount()
     {
-        UInt64 count = 0;
-        for (const auto &list : free_list)
-            for (const auto &block : list)
-                if ((get<1>(block) - get<0>(block) + 1) >= 512)
-                    count += (get<1>(block) - get<0>(block) + 1) / 512;
-        return count;
+        return free_list->countLargePages();
     }
 
     /**
@@ -524,10 +493,9 @@ public:
             bool split_occurred = false;
             for (int i = m_max_order; i >= 9; i--)
             {
-                if (!free_list[i].empty())
+                if (!free_list->empty(i))
                 {
-                    auto temp = free_list[i][0];
-                    free_list[i].erase(free_list[i].begin());
+                    auto temp = free_list->pop_front(i);
 
                     UInt64 start = get<0>(temp);
                     UInt64 end = get<1>(temp);
@@ -542,7 +510,7 @@ public:
 
                     for (UInt64 j = 0; j < chunk; j++)
                     {
-                        free_list[random_order].push_back(std::make_tuple(start + j * pages_in_block, start + (j + 1) * pages_in_block - 1, false, -1));
+                        free_list->push_back(random_order, std::make_tuple(start + j * pages_in_block, start + (j + 1) * pages_in_block - 1, false, -1));
                     }
                     
                     split_occurred = true;
@@ -570,6 +538,56 @@ public:
     UInt64 getFreePages() const { return m_free_pages; }
     UInt64 getTotalPages() const { return m_total_pages; }
 
+    /* Free lists, in order, so that a restored allocator hands out the same pages */
+    void saveState(Snapshot::Writer& writer) const
+    {
+        writer.put(m_memory_size);
+        writer.put(m_max_order);
+        writer.put(m_kernel_size);
+        writer.put(m_free_pages);
+
+        std::vector<BuddyBlock> blocks;
+        std::vector<SnapshotBlock> records;
+        for (int order = 0; order <= m_max_order; order++)
+        {
+            free_list->getBlocks(order, blocks);
+            records.clear();
+            for (const BuddyBlock& block : blocks)
+                records.push_back(SnapshotBlock{std::get<0>(block), std::get<1>(block)});
+            writer.putVector(records);
+        }
+    }
+
+    /* Replaces the free lists; the free-list engine is kept, whichever one wrote the snapshot */
+    bool loadState(Snapshot::Section& section)
+    {
+        int memory_size = 0, max_order = 0, kernel_size = 0;
+        UInt64 free_pages = 0;
+        if (!section.get(memory_size) || !section.get(max_order) || !section.get(kernel_size) || !section.get(free_pages)
+            || memory_size != m_memory_size || max_order != m_max_order || kernel_size != m_kernel_size)
+            return false;
+
+        BuddyFreeList* restored = createFreeList();
+
+        for (int order = 0; order <= m_max_order; order++)
+        {
+            UInt64 count = 0;
+            const SnapshotBlock* records = section.get(count) ? section.getArray<SnapshotBlock>(count) : NULL;
+            if (!records)
+            {
+                delete restored;
+                return false;
+            }
+            for (UInt64 i = 0; i < count; i++)
+                restored->push_back(order, std::make_tuple(records[i].start, records[i].end, false, -1));
+        }
+
+        delete free_list;
+        free_list = restored;
+        m_free_pages = free_pages;
+        return true;
+    }
+
 #if BUDDY_DUPLICATE_DETECTION
     // Check if a 4KB page has been allocated before (for debugging)
     bool isPageAllocated(UInt64 page_num) const {
@@ -587,6 +605,19 @@ public:
 #endif
 
 private:
+    struct SnapshotBlock
+    {
+        UInt64 start;
+        UInt64 end;
+    };
+
+    BuddyFreeList* createFreeList() const
+    {
+        if (m_free_list_type == BuddyFreeListType::INDEXED)
+            return new IndexedBuddyFreeList(m_max_order, static_cast<UInt64>(m_memory_size) * 1024 / 4);
+        return new VectorBuddyFreeList(m_max_order);
+    }
+
     int m_memory_size;
     int m_max_order;
     int m_kernel_size;
@@ -596,7 +627,8 @@ private:
     UInt64 m_total_pages;
     UInt64 m_free_pages;
 
-    std::vector<std::vector<std::tuple<UInt64, UInt64, bool, UInt64>>> free_list;
+    BuddyFreeListType m_free_list_type;
+    BuddyFreeList* free_list;
     double (Buddy::*frag_fun)();
 
 #if BUDDY_DUPLICATE_DETECTION
@@ -0,0 +1,486 @@
+#pragma once
+/*------------------------------------------------------------------------------
+ *  Buddy free-list engines
+ *  – BuddyFreeList is the storage backend behind Buddy<Policy>: one FIFO/LIFO
+ *    sequence of free blocks per order plus the queries Buddy needs
+ *    (containment lookup, buddy lookup, large-page accounting, largest-block
+ *    sizes).
+ *  – VectorBuddyFreeList keeps the original std::vector-per-order layout and
+ *    answers the queries with linear scans.
+ *  – IndexedBuddyFreeList keeps the same per-order sequences (so both engines
+ *    hand out the exact same physical pages) and an address index next to them:
+ *      * the order of the free block starting at each 4KB page, 4 bits per page
+ *        (0xF where no free block starts), for O(1) buddy lookups and to answer
+ *        "which free block contains page X" by scanning back at most
+ *        2^max_order pages, 16 pages per 64-bit word,
+ *      * one bit per such word that is set when a free block starts in it,
+ *        so that the scan back reads a few summary words instead of up to
+ *        2^max_order / 16 index words,
+ *      * running counters for the fragmentation metrics, so that
+ *        fragmentMemory() does not rescan every block on every iteration.
+ *    Its sequences are compact (start, end) arrays with a moving head, so a
+ *    push or pop only adds one index word to what the vector engine touches,
+ *    and taking the front of a sequence is O(1).
+ *----------------------------------------------------------------------------*/
+#include "fixed_types.h"
+#include <vector>
+#include <tuple>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <cassert>
+
+// (start page, end page, unused, unused) – the layout handed out by Buddy
+typedef std::tuple<UInt64, UInt64, bool, UInt64> BuddyBlock;
+
+enum class BuddyFreeListType {
+    VECTOR,     // std::vector per order, linear scans (original engine)
+    INDEXED     // compact per-order arrays + per-page order index
+};
+
+static inline BuddyFreeListType parseBuddyFreeListType(const std::string& name)
+{
+    if (name == "indexed")
+        return BuddyFreeListType::INDEXED;
+    return BuddyFreeListType::VECTOR;
+}
+
+static inline const char* buddyFreeListTypeToString(BuddyFreeListType type)
+{
+    return (type == BuddyFreeListType::INDEXED) ? "indexed" : "vector";
+}
+
+class BuddyFreeList
+{
+public:
+    virtual ~BuddyFreeList() {}
+
+    virtual void push_back(int order, const BuddyBlock& block) = 0;
+    virtual BuddyBlock pop_back(int order) = 0;
+    virtual BuddyBlock pop_front(int order) = 0;
+    virtual bool empty(int order) const = 0;
+    virtual UInt64 size(int order) const = 0;
+
+    /* Find the free block that contains physical_page. If remove is set, the block
+       is unlinked from its order (keeping the order of the remaining blocks). */
+    virtual bool findContaining(UInt64 physical_page, bool remove, int& order, BuddyBlock& block) = 0;
+
+    /* Is [start, start + 2^order) a free block of that order? (buddy lookup) */
+    virtual bool isFreeBlock(UInt64 start, int order) const = 0;
+
+    /* Number of 2MB pages covered by free blocks of at least 512 pages */
+    virtual UInt64 countLargePages() const = 0;
+
+    /* Sum of the sizes of the (up to) n largest free blocks; count receives how many were summed */
+    virtual UInt64 sumLargestBlocks(int n, int& count) const = 0;
+
+    /* Host memory footprint of the engine, for the microbenchmark */
+    virtual UInt64 getHostBytes() const = 0;
+
+    /* The free blocks of one order, front to back (for snapshots) */
+    virtual void getBlocks(int order, std::vector<BuddyBlock>& blocks) const = 0;
+};
+
+static inline UInt64 buddyBlockPages(const BuddyBlock& block)
+{
+    return std::get<1>(block) - std::get<0>(block) + 1;
+}
+
+class VectorBuddyFreeList : public BuddyFreeList
+{
+public:
+    VectorBuddyFreeList(int max_order)
+        : free_list(max_order + 1)
+    {}
+
+    void push_back(int order, const BuddyBlock& block) override { free_list[order].push_back(block); }
+
+    BuddyBlock pop_back(int order) override
+    {
+        BuddyBlock block = free_list[order].back();
+        free_list[order].pop_back();
+        return block;
+    }
+
+    BuddyBlock pop_front(int order) override
+    {
+        BuddyBlock block = free_list[order].front();
+        free_list[order].erase(free_list[order].begin());
+        return block;
+    }
+
+    bool empty(int order) const override { return free_list[order].empty(); }
+    UInt64 size(int order) const override { return free_list[order].size(); }
+
+    bool findContaining(UInt64 physical_page, bool remove, int& order, BuddyBlock& block) override
+    {
+        // Search for the physical page in the free lists, starting from order 0.
+        for (size_t i = 0; i < free_list.size(); i++)
+        {
+            for (size_t j = 0; j < free_list[i].size(); ++j)
+            {
+                if (std::get<0>(free_list[i][j]) <= physical_page && std::get<1>(free_list[i][j]) >= physical_page)
+                {
+                    order = i;
+                    block = free_list[i][j];
+                    if (remove)
+                        free_list[i].erase(free_list[i].begin() + j);
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    bool isFreeBlock(UInt64 start, int order) const override
+    {
+        for (const auto &block : free_list[order])
+            if (std::get<0>(block) == start && buddyBlockPages(block) == (1ULL << order))
+                return true;
+        return false;
+    }
+
+    UInt64 countLargePages() const override
+    {
+        UInt64 count = 0;
+        for (const auto &list : free_list)
+            for (const auto &block : list)
+                if (buddyBlockPages(block) >= 512)
+                    count += buddyBlockPages(block) / 512;
+        return count;
+    }
+
+    UInt64 sumLargestBlocks(int n, int& count) const override
+    {
+        std::vector<UInt64> blockSizes;
+        for (const auto &list : free_list)
+            for (const auto &block : list)
+                blockSizes.push_back(buddyBlockPages(block));
+
+        std::sort(blockSizes.rbegin(), blockSizes.rend());
+
+        UInt64 totalSize = 0;
+        count = 0;
+        for (auto size : blockSizes)
+        {
+            totalSize += size;
+            if (++count == n) break;
+        }
+        return totalSize;
+    }
+
+    UInt64 getHostBytes() const override
+    {
+        UInt64 bytes = free_list.capacity() * sizeof(free_list[0]);
+        for (const auto &list : free_list)
+            bytes += list.capacity() * sizeof(BuddyBlock);
+        return bytes;
+    }
+
+    void getBlocks(int order, std::vector<BuddyBlock>& blocks) const override { blocks = free_list[order]; }
+
+private:
+    std::vector<std::vector<BuddyBlock>> free_list;
+};
+
+class IndexedBuddyFreeList : public BuddyFreeList
+{
+    static const UInt64 NO_BLOCK = 0xF;     // order nibble of a page where no free block starts
+    static const UInt64 PAGES_PER_WORD = 16;
+    static const UInt64 PREFETCH_DISTANCE = 8;  // pops ahead whose index word is prefetched
+
+    struct Entry
+    {
+        UInt64 start;
+        UInt64 end;
+    };
+
+    /* One order's sequence: the live blocks are entries[head, end) */
+    struct OrderList
+    {
+        std::vector<Entry> entries;
+        size_t head = 0;
+        UInt64 inexact = 0;     // blocks whose size is not exactly 2^order (only from free())
+
+        UInt64 count() const { return entries.size() - head; }
+    };
+
+public:
+    IndexedBuddyFreeList(int max_order, UInt64 total_pages)
+        : m_max_order(max_order),
+          m_orders(max_order + 1),
+          m_start_orders((total_pages + PAGES_PER_WORD - 1) / PAGES_PER_WORD, ~0ULL),
+          m_used_words((m_start_orders.size() + 63) / 64, 0),
+          m_large_pages(0)
+    {
+        assert(max_order < (int)NO_BLOCK && "Order index holds orders up to 14");
+    }
+
+    void push_back(int order, const BuddyBlock& block) override
+    {
+        Entry entry = { std::get<0>(block), std::get<1>(block) };
+        m_orders[order].entries.push_back(entry);
+        index(order, entry);
+    }
+
+    BuddyBlock pop_back(int order) override
+    {
+        OrderList &list = m_orders[order];
+        assert(list.count() > 0);
+        Entry entry = list.entries.back();
+        list.entries.pop_back();
+        if (list.count() == 0)
+            reset(list);
+        else if (list.count() > PREFETCH_DISTANCE)
+            prefetchIndex(list.entries[list.entries.size() - 1 - PREFETCH_DISTANCE].start);
+        unindex(order, entry);
+        return toBlock(entry);
+    }
+
+    BuddyBlock pop_front(int order) override
+    {
+        OrderList &list = m_orders[order];
+        assert(list.count() > 0);
+        Entry entry = list.entries[list.head++];
+        if (list.count() == 0)
+            reset(list);
+        else
+        {
+            if (list.head >= 64 && list.head * 2 >= list.entries.size())
+            {
+                // Drop the consumed front once it is the larger part, so that pop_front stays amortized O(1)
+                list.entries.erase(list.entries.begin(), list.entries.begin() + list.head);
+                list.head = 0;
+            }
+            if (list.count() > PREFETCH_DISTANCE)
+                prefetchIndex(list.entries[list.head + PREFETCH_DISTANCE].start);
+        }
+        unindex(order, entry);
+        return toBlock(entry);
+    }
+
+    bool empty(int order) const override { return m_orders[order].count() == 0; }
+    UInt64 size(int order) const override { return m_orders[order].count(); }
+
+    bool findContaining(UInt64 physical_page, bool remove, int& order, BuddyBlock& block) override
+    {
+        UInt64 start;
+        if (!findStartAtOrBelow(physical_page, start))
+            return false;
+
+        // Free blocks do not overlap: the closest start at or below the page is the only candidate
+        int start_order = getStartOrder(start);
+        UInt64 end = blockEnd(start_order, start);
+        if (end < physical_page)
+            return false;
+
+        order = start_order;
+        block = std::make_tuple(start, end, false, (UInt64)-1);
+        if (remove)
+        {
+            // Unlink from the middle of the sequence; the most recently freed blocks are at the back
+            OrderList &list = m_orders[start_order];
+            for (size_t j = list.entries.size(); j-- > list.head; )
+            {
+                if (list.entries[j].start == start)
+                {
+                    list.entries.erase(list.entries.begin() + j);
+                    break;
+                }
+            }
+            if (list.count() == 0)
+                reset(list);
+            unindex(start_order, Entry{ start, end });
+        }
+        return true;
+    }
+
+    bool isFreeBlock(UInt64 start, int order) const override
+    {
+        if (start / PAGES_PER_WORD >= m_start_orders.size() || getStartOrder(start) != order)
+            return false;
+        return blockEnd(order, start) - start + 1 == (1ULL << order);
+    }
+
+    UInt64 countLargePages() const override { return m_large_pages; }
+
+    UInt64 sumLargestBlocks(int n, int& count) const override
+    {
+        // Block sizes in order i lie in (2^(i-1), 2^i], so walking orders from the top
+        // visits blocks in descending size; only orders holding inexact blocks need sorting.
+        UInt64 totalSize = 0;
+        count = 0;
+        for (int i = m_max_order; i >= 0 && count < n; i--)
+        {
+            const OrderList &list = m_orders[i];
+            if (list.count() == 0)
+                continue;
+
+            if (list.inexact == 0)
+            {
+                UInt64 take = std::min<UInt64>(list.count(), n - count);
+                totalSize += take << i;
+                count += take;
+                continue;
+            }
+
+            std::vector<UInt64> blockSizes;
+            for (size_t j = list.head; j < list.entries.size(); j++)
+                blockSizes.push_back(list.entries[j].end - list.entries[j].start + 1);
+            std::sort(blockSizes.rbegin(), blockSizes.rend());
+            for (auto size : blockSizes)
+            {
+                if (count == n) break;
+                totalSize += size;
+                count++;
+            }
+        }
+        return totalSize;
+    }
+
+    UInt64 getHostBytes() const override
+    {
+        UInt64 bytes = m_orders.capacity() * sizeof(OrderList)
+                     + m_start_orders.capacity() * sizeof(UInt64)
+                     + m_used_words.capacity() * sizeof(UInt64)
+                     + m_inexact_ends.size() * 2 * sizeof(UInt64);
+        for (const auto &list : m_orders)
+            bytes += list.entries.capacity() * sizeof(Entry);
+        return bytes;
+    }
+
+    void getBlocks(int order, std::vector<BuddyBlock>& blocks) const override
+    {
+        const OrderList &list = m_orders[order];
+        blocks.clear();
+        for (size_t j = list.head; j < list.entries.size(); j++)
+            blocks.push_back(toBlock(list.entries[j]));
+    }
+
+private:
+    int m_max_order;
+    std::vector<OrderList> m_orders;
+
+    std::vector<UInt64> m_start_orders;                 // nibble per 4KB page: order of the free block starting here
+    std::vector<UInt64> m_used_words;                   // bit per m_start_orders word: a free block starts in it
+    std::unordered_map<UInt64, UInt64> m_inexact_ends;  // start -> end of the blocks not 2^order pages long
+
+    UInt64 m_large_pages;
+
+    static BuddyBlock toBlock(const Entry& entry)
+    {
+        return std::make_tuple(entry.start, entry.end, false, (UInt64)-1);
+    }
+
+    static void reset(OrderList& list)
+    {
+        list.entries.clear();
+        list.head = 0;
+    }
+
+    int getStartOrder(UInt64 page) const
+    {
+        return (m_start_orders[page / PAGES_PER_WORD] >> ((page % PAGES_PER_WORD) * 4)) & 0xF;
+    }
+
+    void setStartOrder(UInt64 page, UInt64 order)
+    {
+        UInt64 index = page / PAGES_PER_WORD;
+        UInt64 &word = m_start_orders[index];
+        int shift = (page % PAGES_PER_WORD) * 4;
+        word = (word & ~(0xFULL << shift)) | (order << shift);
+        if (word == ~0ULL)
+            m_used_words[index / 64] &= ~(1ULL << (index % 64));
+        else
+            m_used_words[index / 64] |= 1ULL << (index % 64);
+    }
+
+    /* A later pop unindexes this block: start loading its index word now */
+    void prefetchIndex(UInt64 page) const
+    {
+        __builtin_prefetch(&m_start_orders[page / PAGES_PER_WORD], 1);
+    }
+
+    UInt64 blockEnd(int order, UInt64 start) const
+    {
+        if (m_orders[order].inexact)
+        {
+            auto it = m_inexact_ends.find(start);
+            if (it != m_inexact_ends.end())
+                return it->second;
+        }
+        return start + (1ULL << order) - 1;
+    }
+
+    /* Closest free block start at or below page, looking back at most 2^max_order pages */
+    bool findStartAtOrBelow(UInt64 page, UInt64& start) const
+    {
+        UInt64 word = page / PAGES_PER_WORD;
+        if (word >= m_start_orders.size())
+            return false;
+
+        // A free block is never larger than 2^max_order pages, so its start lies within that window
+        UInt64 window_pages = 1ULL << m_max_order;
+        UInt64 lowest_word = ((page >= window_pages) ? page - window_pages + 1 : 0) / PAGES_PER_WORD;
+
+        // One bit per page (the low bit of its nibble) where the nibble is not NO_BLOCK
+        UInt64 starts = startBits(m_start_orders[word]) & (~0ULL >> (63 - (page % PAGES_PER_WORD) * 4));
+        if (!starts)
+        {
+            // Closest word below with a block start, from the summary bits
+            if (word == lowest_word)
+                return false;
+            word--;
+            UInt64 used = m_used_words[word / 64] & (~0ULL >> (63 - word % 64));
+            while (!used)
+            {
+                if (word / 64 == lowest_word / 64)
+                    return false;
+                word = (word / 64) * 64 - 1;
+                used = m_used_words[word / 64];
+            }
+            word = (word / 64) * 64 + 63 - __builtin_clzll(used);
+            if (word < lowest_word)
+                return false;
+            starts = startBits(m_start_orders[word]);
+        }
+        start = word * PAGES_PER_WORD + (63 - __builtin_clzll(starts)) / 4;
+        return true;
+    }
+
+    static UInt64 startBits(UInt64 word)
+    {
+        UInt64 x = ~word;
+        return (x | (x >> 1) | (x >> 2) | (x >> 3)) & 0x1111111111111111ULL;
+    }
+
+    void index(int order, const Entry& entry)
+    {
+        UInt64 pages = entry.end - entry.start + 1;
+        assert(entry.start / PAGES_PER_WORD < m_start_orders.size());
+        assert(getStartOrder(entry.start) == NO_BLOCK && "Buddy block freed twice");
+
+        setStartOrder(entry.start, order);
+        if (pages != (1ULL << order))
+        {
+            m_orders[order].inexact++;
+            m_inexact_ends[entry.start] = entry.end;
+        }
+        if (pages >= 512)
+            m_large_pages += pages / 512;
+    }
+
+    void unindex(int order, const Entry& entry)
+    {
+        UInt64 pages = entry.end - entry.start + 1;
+
+        setStartOrder(entry.start, NO_BLOCK);
+        if (pages != (1ULL << order))
+        {
+            m_orders[order].inexact--;
+            m_inexact_ends.erase(entry.start);
+        }
+        if (pages >= 512)
+            m_large_pages -= pages / 512;
+    }
+};
@@ -4,6 +4,7 @@
 #include <vector>
 #include "semaphore.h"
 #include "../misc/vma.h"
+#include "../misc/snapshot.h"
 
 class PhysicalMemoryAllocator
 {
@@ -105,8 +106,43 @@ public:
      * Default implementation does nothing - subclasses override as needed.
      */
     virtual void dumpFinalStats() {}
+
+    /**
+     * @brief Checkpoint/restore of the allocator state (free lists, reservations, ...)
+     *
+     * Allocators that support snapshots override both and return true; the default
+     * reports the allocator as unsupported. Overrides start with saveBaseState/loadBaseState.
+     * loadState is called on a freshly constructed, unfragmented allocator.
+     */
+    virtual bool saveState(Snapshot::Writer& /*writer*/) const { return false; }
+    virtual bool loadState(Snapshot::Section& /*section*/) { return false; }
+
+    /**
+     * Current end of the kernel area, for rewindKernelArea: page tables restored from a
+     * snapshot carve their initial tables out of the kernel area again when constructed,
+     * although the restored area already accounts for them.
+     */
+    UInt64 getKernelAreaMark() const { return kernel_start_address; }
+    void rewindKernelArea(UInt64 mark) { kernel_start_address = mark; }
     
 protected:
+    void saveBaseState(Snapshot::Writer& writer) const
+    {
+        writer.put(m_memory_size);
+        writer.put(m_kernel_size);
+        writer.put(kernel_start_address);
+        writer.put(instruction_current_address);
+    }
+
+    bool loadBaseState(Snapshot::Section& section)
+    {
+        UInt64 memory_size = 0, kernel_size = 0;
+        if (!section.get(memory_size) || !section.get(kernel_size)
+            || memory_size != m_memory_size || kernel_size != m_kernel_size)
+            return false;
+        return section.get(kernel_start_address) && section.get(instruction_current_address);
+    }
+
     String m_name;
     UInt64 m_memory_size; // in mbytes
     UInt64 kernel_start_address;
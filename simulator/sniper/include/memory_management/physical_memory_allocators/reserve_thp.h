@@ -324,6 +324,60 @@ public:
         // TODO: Implement
     }
 
+    /*
+    * saveState/loadState: buddy free lists plus the 2MB reservations (base PFN, populated
+    * 4KB pages, promotion state), so faults after a restore keep filling the same regions.
+    */
+    bool saveState(Snapshot::Writer& writer) const override
+    {
+        saveBaseState(writer);
+        buddy_allocator->saveState(writer);
+
+        std::vector<Reservation> reservations;
+        reservations.reserve(two_mb_map.size());
+        for (const auto& kv : two_mb_map)
+        {
+            Reservation r;
+            r.region_2MB = kv.first;
+            r.region_begin = get<0>(kv.second);
+            for (int word = 0; word < 8; word++)
+            {
+                r.populated[word] = 0;
+                for (int bit = 0; bit < 64; bit++)
+                    if (get<1>(kv.second)[word * 64 + bit])
+                        r.populated[word] |= 1ULL << bit;
+            }
+            r.promoted = get<2>(kv.second);
+            reservations.push_back(r);
+        }
+        writer.putVector(reservations);
+        return true;
+    }
+
+    bool loadState(Snapshot::Section& section) override
+    {
+        if (!loadBaseState(section) || !buddy_allocator->loadState(section))
+            return false;
+
+        UInt64 count = 0;
+        const Reservation* reservations = section.get(count) ? section.getArray<Reservation>(count) : NULL;
+        if (!reservations)
+            return false;
+
+        two_mb_map.clear();
+        for (UInt64 i = 0; i < count; i++)
+        {
+            const Reservation& r = reservations[i];
+            std::bitset<512> populated;
+            for (int word = 0; word < 8; word++)
+                for (int bit = 0; bit < 64; bit++)
+                    if (r.populated[word] & (1ULL << bit))
+                        populated[word * 64 + bit] = true;
+            two_mb_map[r.region_2MB] = make_tuple(r.region_begin, populated, (bool)r.promoted);
+        }
+        return true;
+    }
+
     IntPtr isLargePageReserved(IntPtr address) { // /* SpecTLB spec engine */ 
         if (two_mb_map.find(address >> 21) != two_mb_map.end())
             return get<0>(two_mb_map[address >> 21]);
@@ -331,6 +385,15 @@ public:
     }
 
 protected:
+    // Snapshot record of one two_mb_map entry
+    struct Reservation
+    {
+        UInt64 region_2MB;
+        UInt64 region_begin;
+        UInt64 populated[8];
+        UInt64 promoted;
+    };
+
     BuddyType* buddy_allocator;
     std::map<UInt64, std::tuple<UInt64, std::bitset<512>, bool>> two_mb_map;
     double threshold_for_promotion;
@@ -9,6 +9,7 @@
  *----------------------------------------------------------------------------*/
 #include "debug_config.h"
 #include "fixed_types.h"
+#include "memory_management/misc/snapshot.h"
 
 #include <string>
 #include <unordered_map>
@@ -210,11 +211,62 @@ public:
         return static_cast<IntPtr>(-1);
     }
 
+    // ========================================================================
+    // Snapshots
+    // ========================================================================
+
+    /**
+     * @brief Save the swapped-out pages and the occupancy of the backing store.
+     */
+    void saveState(Snapshot::Writer& writer) const
+    {
+        writer.put(m_swap_size);
+
+        std::vector<SwappedPage> pages;
+        pages.reserve(m_swap_cache_map.size());
+        for (const auto& kv : m_swap_cache_map)
+            pages.push_back(SwappedPage{kv.first.first, kv.first.second, kv.second});
+        writer.putVector(pages);
+
+        std::vector<UInt64> used((m_free_pages.size() + 63) / 64, 0);
+        for (size_t i = 0; i < m_free_pages.size(); ++i)
+            if (m_free_pages[i])
+                used[i / 64] |= 1ULL << (i % 64);
+        writer.putVector(used);
+    }
+
+    /**
+     * @brief Restore the swap cache; fails if the swap size differs from this configuration.
+     */
+    bool loadState(Snapshot::Section& section)
+    {
+        int swap_size = 0;
+        std::vector<SwappedPage> pages;
+        std::vector<UInt64> used;
+        if (!section.get(swap_size) || !section.getVector(pages) || !section.getVector(used)
+            || swap_size != m_swap_size || used.size() != (m_free_pages.size() + 63) / 64)
+            return false;
+
+        m_swap_cache_map.clear();
+        for (const SwappedPage& page : pages)
+            m_swap_cache_map[std::make_pair(page.virtual_page, static_cast<int>(page.app_id))] = page.swap_location;
+        for (size_t i = 0; i < m_free_pages.size(); ++i)
+            m_free_pages[i] = (used[i / 64] >> (i % 64)) & 1;
+        return true;
+    }
+
 private:
     // ========================================================================
     // Private Members
     // ========================================================================
 
+    // Snapshot record of one m_swap_cache_map entry
+    struct SwappedPage {
+        IntPtr virtual_page;
+        SInt64 app_id;
+        IntPtr swap_location;
+    };
+
     int m_swap_size;   // Number of 4KB pages in the swap space
 
     Stats m_stats;
@@ -3,8 +3,10 @@
 
 #include "log.h"
 #include "lock.h"
+#include "timer.h"
 #include <cstdint>
 #include <iostream>
+#include <vector>
 #include "mimicos.h"
 #include "memory_management/physical_memory_allocators/physical_memory_allocator.h"
 
@@ -17,6 +19,60 @@ public:
     // Static lock for thread-safe page fault handling across all cores
     // SpinLock: non-fair, avoids FIFO ordering overhead of ticket lock
     static SpinLock s_page_fault_lock;
+
+    /**
+     * @brief Lock granularity of the page-fault path (general/page_fault_locking)
+     *
+     * GLOBAL: s_page_fault_lock is held for the whole handler (all cores serialize).
+     * FINE:   s_allocator_lock only guards calls into the shared physical allocator,
+     *         each application's page table is updated under its own lock, and
+     *         page-table frames are served from a per-core frame cache.
+     */
+    enum class FaultLocking { GLOBAL, FINE };
+    static FaultLocking s_fault_locking;
+    static SpinLock s_allocator_lock;
+
+    /**
+     * @brief Lock held by every fault handler while it updates the page table of app_id:
+     * s_page_fault_lock with GLOBAL locking, the application's page-table lock with FINE
+     */
+    static BaseLock& pageTableUpdateLock(MimicOS* os, int app_id);
+
+    /**
+     * @brief Per-core lock statistics of the fault path (host time, not simulated time)
+     */
+    struct FaultLockStats {
+        UInt64 acquisitions = 0;
+        UInt64 wait_ns = 0;
+        UInt64 max_wait_ns = 0;
+        UInt64 pt_frame_cache_hits = 0;
+        UInt64 pt_frame_cache_refills = 0;
+    };
+
+    /**
+     * @brief Acquires a fault-path lock and accounts the time spent waiting for it.
+     * A NULL lock is a no-op, so callers can ask for a lock that only exists in one mode.
+     */
+    class FaultLockGuard {
+    public:
+        FaultLockGuard(BaseLock* lock, FaultLockStats& stats) : m_lock(lock) {
+            if (!m_lock)
+                return;
+            UInt64 start = Timer::now();
+            m_lock->acquire();
+            UInt64 waited = Timer::now() - start;
+            stats.acquisitions++;
+            stats.wait_ns += waited;
+            if (waited > stats.max_wait_ns)
+                stats.max_wait_ns = waited;
+        }
+        ~FaultLockGuard() { if (m_lock) m_lock->release(); }
+
+        FaultLockGuard(const FaultLockGuard&) = delete;
+        FaultLockGuard& operator=(const FaultLockGuard&) = delete;
+    private:
+        BaseLock* m_lock;
+    };
 public:
 
     /**
@@ -54,15 +110,29 @@ public:
     virtual PhysicalMemoryAllocator* getAllocator() = 0;
 
 
-    ExceptionHandlerBase(Core* core) : m_core(core) {
-        m_allocator = NULL; // Instantiate on demand, when getAllocator is called
-    };
+    ExceptionHandlerBase(Core* core);
     virtual ~ExceptionHandlerBase() {};
 
+    const FaultLockStats& getFaultLockStats() const { return m_fault_lock_stats; }
+    const std::vector<UInt64>& getPageTableFrameCache() const { return m_pt_frame_cache; }
+
 protected:
     Core* m_core;
     PhysicalMemoryAllocator *m_allocator;
 
+    FaultLockStats m_fault_lock_stats;
+    UInt32 m_pt_frame_cache_size;            // general/page_table_frame_cache (FINE mode only)
+    std::vector<UInt64> m_pt_frame_cache;    // LIFO, so returned frames are reused first
+
+    // Lock to take for each stage of the fault; NULL when the stage needs no lock in the current mode
+    BaseLock* faultLock() { return s_fault_locking == FaultLocking::GLOBAL ? &s_page_fault_lock : NULL; }
+    BaseLock* allocatorLock() { return s_fault_locking == FaultLocking::FINE ? &s_allocator_lock : NULL; }
+    BaseLock* pageTableLock(MimicOS* os, int app_id);
+
+    /* Page-table frame allocation through the per-core cache (falls back to the allocator) */
+    UInt64 allocatePageTableFrame(UInt64 core_id);
+    void releasePageTableFrames(const std::vector<UInt64>& frames, int frames_used);
+
     // void mapFrames(ParametricDramDirectoryMSI::PageTable* page_table, UInt64 address, UInt64 core_id, UInt64 ppn, int page_size,
     //                              const std::vector<UInt64>& frames_already_allocated_by_virtuos);
 
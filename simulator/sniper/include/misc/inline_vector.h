@@ -0,0 +1,147 @@
+#ifndef INLINE_VECTOR_H
+#define INLINE_VECTOR_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief Vector with the first N elements stored inline.
+ *
+ * Meant for short, hot lists such as the PTE accesses of one page walk: as long as the
+ * list stays within N elements, creating, copying and clearing it never touches the heap.
+ * Longer lists (e.g. cuckoo insertions that keep relocating) spill to a heap buffer, so
+ * N is a performance knob, not a correctness limit. Iterators are plain pointers, which
+ * keeps std::sort / std::unique / erase working as with std::vector.
+ */
+template <class T, size_t N>
+class InlineVector
+{
+   static_assert(std::is_trivially_copyable<T>::value, "InlineVector only holds trivially copyable types");
+
+   public:
+      typedef T value_type;
+      typedef T* iterator;
+      typedef const T* const_iterator;
+      typedef size_t size_type;
+
+      InlineVector() : m_data(inlineData()), m_size(0), m_capacity(N) {}
+      InlineVector(const InlineVector& other) : InlineVector() { assign(other.begin(), other.end()); }
+      InlineVector(InlineVector&& other) : InlineVector() { *this = std::move(other); }
+      ~InlineVector() { release(); }
+
+      InlineVector& operator=(const InlineVector& other)
+      {
+         if (this != &other)
+            assign(other.begin(), other.end());
+         return *this;
+      }
+
+      InlineVector& operator=(InlineVector&& other)
+      {
+         if (this == &other)
+            return *this;
+         if (other.isInline())
+         {
+            assign(other.begin(), other.end());
+         }
+         else
+         {
+            // Steal the spilled buffer
+            release();
+            m_data = other.m_data;
+            m_size = other.m_size;
+            m_capacity = other.m_capacity;
+            other.m_data = other.inlineData();
+            other.m_capacity = N;
+         }
+         other.m_size = 0;
+         return *this;
+      }
+
+      template <class InputIt>
+      void assign(InputIt first, InputIt last)
+      {
+         m_size = 0;
+         reserve(std::distance(first, last));
+         std::copy(first, last, m_data);
+         m_size = std::distance(first, last);
+      }
+
+      void push_back(const T& value)
+      {
+         if (m_size == m_capacity)
+         {
+            T copy = value; // value may live in our own buffer
+            reserve(m_capacity * 2);
+            m_data[m_size++] = copy;
+            return;
+         }
+         m_data[m_size++] = value;
+      }
+
+      template <class... Args>
+      void emplace_back(Args&&... args) { push_back(T(std::forward<Args>(args)...)); }
+
+      void pop_back() { assert(m_size > 0); m_size--; }
+
+      iterator erase(iterator first, iterator last)
+      {
+         iterator new_end = std::copy(last, end(), first);
+         m_size = new_end - m_data;
+         return first;
+      }
+      iterator erase(iterator pos) { return erase(pos, pos + 1); }
+
+      void reserve(size_type capacity)
+      {
+         if (capacity <= m_capacity)
+            return;
+         T* data = new T[capacity];
+         std::copy(m_data, m_data + m_size, data);
+         release();
+         m_data = data;
+         m_capacity = capacity;
+      }
+
+      void clear() { m_size = 0; }
+      size_type size() const { return m_size; }
+      size_type capacity() const { return m_capacity; }
+      bool empty() const { return m_size == 0; }
+
+      T& operator[](size_type idx) { return m_data[idx]; }
+      const T& operator[](size_type idx) const { return m_data[idx]; }
+      T& at(size_type idx) { assert(idx < m_size); return m_data[idx]; }
+      const T& at(size_type idx) const { assert(idx < m_size); return m_data[idx]; }
+      T& front() { return m_data[0]; }
+      const T& front() const { return m_data[0]; }
+      T& back() { return m_data[m_size - 1]; }
+      const T& back() const { return m_data[m_size - 1]; }
+
+      iterator begin() { return m_data; }
+      iterator end() { return m_data + m_size; }
+      const_iterator begin() const { return m_data; }
+      const_iterator end() const { return m_data + m_size; }
+
+   private:
+      // Raw storage, so that constructing an empty list does not run N element constructors
+      T* inlineData() { return reinterpret_cast<T*>(m_inline); }
+      bool isInline() const { return m_data == reinterpret_cast<const T*>(m_inline); }
+      void release()
+      {
+         if (!isInline())
+            delete [] m_data;
+         m_data = inlineData();
+         m_capacity = N;
+      }
+
+      alignas(T) unsigned char m_inline[N * sizeof(T)];
+      T* m_data;
+      size_type m_size;
+      size_type m_capacity;
+};
+
+#endif // INLINE_VECTOR_H
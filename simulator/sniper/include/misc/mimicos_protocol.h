@@ -0,0 +1,143 @@
+#ifndef MIMICOS_PROTOCOL_H
+#define MIMICOS_PROTOCOL_H
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief Wire format of the messages between sniper-space MimicOS and the userspace MimicOS.
+ *
+ * A message is a flat array of 64-bit words, which is what SimReceiveMessage and
+ * SimMimicosResult move through simulated memory: a header (opcode, entry count) followed
+ * by `count` fixed-layout entries of the kind selected by the opcode. Both sides include
+ * this file, so the layouts cannot drift apart, and decoding is a switch on the opcode plus
+ * a copy of each entry at a fixed offset (no name lookups, no per-message allocation).
+ *
+ * Page faults are batched: one request carries a run of faulting addresses and the reply
+ * carries one mapping per request entry, in the same order. Each request entry names the core
+ * that faulted, so a batch may mix the faults of several cores.
+ */
+namespace MimicOSProtocol
+{
+    enum class Opcode : uint64_t
+    {
+        INVALID = 0,
+        PAGE_FAULT = 1,
+        SYSCALL = 2,
+    };
+
+    static const uint32_t MAX_BATCH = 16;            // Page faults served by one round trip
+    static const uint32_t MAX_FRAMES_PER_FAULT = 8;  // Data frame + page-table frames of a 5-level radix, with slack
+
+    struct Header
+    {
+        uint64_t opcode;
+        uint64_t count; // Number of entries following the header
+    };
+
+    // Sniper -> MimicOS: one faulting address
+    struct PageFaultRequest
+    {
+        uint64_t va;
+        uint64_t num_frames; // Data frame + page-table frames the walk found missing
+        uint64_t core_id;    // Core that faulted, whose allocation state serves the fault
+    };
+
+    // MimicOS -> Sniper: mapping for one request entry
+    struct PageFaultResponse
+    {
+        uint64_t vpn;
+        uint64_t ppn;
+        uint64_t page_size;
+        uint64_t num_frames;
+        uint64_t frames[MAX_FRAMES_PER_FAULT]; // frames[0] is the data frame
+    };
+
+    template <class T>
+    constexpr size_t words() { return sizeof(T) / sizeof(uint64_t); }
+
+    static const size_t HEADER_WORDS = words<Header>();
+    static const size_t MAX_MESSAGE_WORDS = HEADER_WORDS + MAX_BATCH * words<PageFaultResponse>();
+
+    inline const char *name(Opcode opcode)
+    {
+        switch (opcode)
+        {
+        case Opcode::PAGE_FAULT: return "page_fault";
+        case Opcode::SYSCALL:    return "syscall";
+        default:                 return "invalid";
+        }
+    }
+
+    /**
+     * @brief Read-only view over a received message (e.g. the argv handed to an exception handler)
+     */
+    class MessageView
+    {
+    public:
+        MessageView(int argc, const uint64_t *argv) : m_argc(argc), m_argv(argv) {}
+
+        Opcode opcode() const { return m_argc > 0 ? static_cast<Opcode>(m_argv[0]) : Opcode::INVALID; }
+        uint32_t count() const { return m_argc >= (int)HEADER_WORDS ? m_argv[1] : 0; }
+
+        // The message holds exactly count() entries of type Entry
+        template <class Entry>
+        bool wellFormed() const
+        {
+            return m_argc >= (int)HEADER_WORDS && count() <= MAX_BATCH
+                && (size_t)m_argc == HEADER_WORDS + count() * words<Entry>();
+        }
+
+        template <class Entry>
+        Entry entry(uint32_t index) const
+        {
+            assert(index < count());
+            Entry e;
+            memcpy(&e, m_argv + HEADER_WORDS + index * words<Entry>(), sizeof(Entry));
+            return e;
+        }
+
+    private:
+        int m_argc;
+        const uint64_t *m_argv;
+    };
+
+    /**
+     * @brief Message buffer with inline storage for the largest message
+     *
+     * Meant to be reused: begin() resets it for a new opcode and append() adds entries in place.
+     */
+    struct Message
+    {
+        int argc;                          // Words in use
+        uint64_t argv[MAX_MESSAGE_WORDS];
+
+        Message() : argc(0) {}
+
+        void begin(Opcode opcode)
+        {
+            argv[0] = static_cast<uint64_t>(opcode);
+            argv[1] = 0;
+            argc = HEADER_WORDS;
+        }
+
+        template <class Entry>
+        bool full() const { return argc + words<Entry>() > MAX_MESSAGE_WORDS || argv[1] == MAX_BATCH; }
+
+        template <class Entry>
+        void append(const Entry &entry)
+        {
+            assert(argc >= (int)HEADER_WORDS && !full<Entry>());
+            memcpy(argv + argc, &entry, sizeof(Entry));
+            argc += words<Entry>();
+            argv[1]++;
+        }
+
+        MessageView view() const { return MessageView(argc, argv); }
+        bool isValid() const { return argc >= (int)HEADER_WORDS; }
+    };
+}
+
+#endif // MIMICOS_PROTOCOL_H
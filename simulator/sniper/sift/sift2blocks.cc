@@ -0,0 +1,300 @@
+// Convert a SIFT trace into a block-indexed trace (see Sift::BlockFileHeader in sift_format.h)
+//
+// The record stream is cut into blocks of about block_kb KB (uncompressed), at instruction
+// boundaries. Each block is made self-contained, so that it can be decoded without the ones
+// before it: it starts with the current ISA and a full-encoding instruction, and it carries
+// the icache pages of all its instructions.
+
+#define __STDC_FORMAT_MACROS
+
+#include "sift_format.h"
+#include "zfstream.h"
+
+#include <inttypes.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <unistd.h>
+#include <zlib.h>
+
+namespace
+{
+   struct BlockWriter
+   {
+      FILE *out;
+      int level;
+      std::vector<Sift::BlockIndexEntry> index;
+      std::vector<char> block;
+      std::vector<Bytef> compressed;
+      uint64_t offset;
+      uint64_t num_instructions;
+      uint64_t block_first_instruction;
+      uint64_t max_block_size;
+
+      BlockWriter(FILE *out, int level)
+         : out(out), level(level), offset(sizeof(Sift::BlockFileHeader)), num_instructions(0), block_first_instruction(0), max_block_size(0)
+      {}
+
+      bool blockHasInstructions() const { return num_instructions != block_first_instruction; }
+
+      void append(const void *data, size_t size)
+      {
+         block.insert(block.end(), static_cast<const char*>(data), static_cast<const char*>(data) + size);
+      }
+
+      bool flush()
+      {
+         if (block.empty())
+            return true;
+
+         uLongf size = compressBound(block.size());
+         compressed.resize(size);
+         if (compress2(compressed.data(), &size, reinterpret_cast<const Bytef*>(block.data()), block.size(), level) != Z_OK
+             || fwrite(compressed.data(), 1, size, out) != size)
+            return false;
+
+         Sift::BlockIndexEntry entry;
+         entry.offset = offset;
+         entry.compressed_size = size;
+         entry.size = block.size();
+         entry.first_instruction = block_first_instruction;
+         index.push_back(entry);
+         block_first_instruction = num_instructions;
+
+         offset += size;
+         max_block_size = std::max<uint64_t>(max_block_size, block.size());
+         block.clear();
+         return true;
+      }
+   };
+
+   void usage(const char *argv0)
+   {
+      fprintf(stderr, "Usage: %s [-b block_kb] [-l level] <input.sift> <output.sift>\n", argv0);
+      exit(1);
+   }
+}
+
+int main(int argc, char* argv[])
+{
+   size_t block_size = 1024 << 10;
+   int level = Z_DEFAULT_COMPRESSION;
+
+   int opt;
+   while ((opt = getopt(argc, argv, "b:l:")) != -1)
+   {
+      switch (opt)
+      {
+         case 'b': block_size = strtoull(optarg, NULL, 10) << 10; break;
+         case 'l': level = atoi(optarg); break;
+         default: usage(argv[0]);
+      }
+   }
+   if (optind + 2 != argc || block_size == 0)
+      usage(argv[0]);
+   const char *input_filename = argv[optind], *output_filename = argv[optind + 1];
+
+   vistream *input = new vifstream(input_filename, std::ios::in | std::ios::binary);
+   Sift::Header hdr;
+   input->read(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+   if (input->fail() || hdr.magic != Sift::MagicNumber)
+   {
+      fprintf(stderr, "%s is not a SIFT trace\n", input_filename);
+      return 1;
+   }
+   std::vector<char> extra(hdr.size);
+   input->read(extra.data(), hdr.size);
+   if (hdr.options & Sift::CompressionZlib)
+      input = new izstream(input);
+
+   FILE *out = fopen(output_filename, "wb");
+   if (!out)
+   {
+      fprintf(stderr, "Cannot open %s\n", output_filename);
+      return 1;
+   }
+
+   // Blocks are compressed on their own, and all icache pages are written in full
+   Sift::BlockFileHeader file_hdr;
+   memset(&file_hdr, 0, sizeof(file_hdr));
+   fwrite(&file_hdr, sizeof(file_hdr), 1, out);
+   file_hdr.magic = Sift::BlockMagicNumber;
+   file_hdr.version = Sift::BlockVersion;
+   file_hdr.options = hdr.options & ~(Sift::CompressionZlib | Sift::IcacheVariable);
+   // Logical-to-physical mappings are sent once, when first used: a block cannot be decoded on its own
+   file_hdr.flags = (hdr.options & Sift::PhysicalAddress) ? 0 : Sift::BlockSeekable;
+
+   BlockWriter writer(out, level);
+   std::unordered_map<uint64_t, std::vector<uint8_t>> icache;
+   std::unordered_set<uint64_t> block_pages; // Icache pages written to the current block
+   uint32_t isa = 0;
+   uint64_t last_address = 0;
+   bool seen_end = false;
+
+   while (!seen_end)
+   {
+      Sift::Record rec;
+      uint8_t byte = input->peek();
+      if (input->fail())
+         break; // Truncated trace, finish it with an End record
+
+      if (byte == 0)
+      {
+         input->read(reinterpret_cast<char*>(&rec), sizeof(rec.Other));
+         std::vector<uint8_t> data(rec.Other.size);
+         input->read(reinterpret_cast<char*>(data.data()), rec.Other.size);
+         if (input->fail())
+            break;
+
+         switch (rec.Other.type)
+         {
+            case Sift::RecOtherEnd:
+               seen_end = true;
+               continue;
+
+            case Sift::RecOtherIcache:
+            case Sift::RecOtherIcacheVariable:
+            {
+               // Kept aside, and written out before the instructions that need them
+               uint64_t address;
+               memcpy(&address, data.data(), sizeof(address));
+               for (size_t pos = sizeof(address); pos < data.size(); )
+               {
+                  uint64_t page = address & Sift::ICACHE_PAGE_MASK, offset = address & Sift::ICACHE_OFFSET_MASK;
+                  size_t amount = std::min<size_t>(data.size() - pos, Sift::ICACHE_SIZE - offset);
+                  std::vector<uint8_t> &bytes = icache[page];
+                  bytes.resize(Sift::ICACHE_SIZE);
+                  memcpy(&bytes[offset], &data[pos], amount);
+                  block_pages.erase(page);
+                  address += amount;
+                  pos += amount;
+               }
+               continue;
+            }
+
+            case Sift::RecOtherISAChange:
+               memcpy(&isa, data.data(), sizeof(isa));
+               break;
+
+            default:
+               break;
+         }
+
+         writer.append(&rec, sizeof(rec.Other));
+         writer.append(data.data(), data.size());
+         continue;
+      }
+
+      uint8_t size;
+      uint64_t addr;
+      uint64_t addresses[4];
+      if ((byte & 0xf) != 0)
+      {
+         input->read(reinterpret_cast<char*>(&rec), sizeof(rec.Instruction));
+         size = rec.Instruction.size;
+         addr = last_address;
+      }
+      else
+      {
+         input->read(reinterpret_cast<char*>(&rec), sizeof(rec.InstructionExt));
+         size = rec.InstructionExt.size;
+         addr = rec.InstructionExt.addr;
+      }
+      int num_addresses = (byte & 0xf) ? rec.Instruction.num_addresses : rec.InstructionExt.num_addresses;
+      input->read(reinterpret_cast<char*>(addresses), num_addresses * sizeof(uint64_t));
+      if (input->fail())
+         break;
+      last_address = addr + size;
+
+      bool block_start = !writer.blockHasInstructions();
+      if (!block_start && writer.block.size() >= block_size)
+      {
+         if (!writer.flush())
+         {
+            fprintf(stderr, "Cannot write %s\n", output_filename);
+            return 1;
+         }
+         block_pages.clear();
+         block_start = true;
+      }
+
+      if (block_start)
+      {
+         Sift::Record isa_rec;
+         isa_rec.Other.zero = 0;
+         isa_rec.Other.type = Sift::RecOtherISAChange;
+         isa_rec.Other.size = sizeof(isa);
+         writer.append(&isa_rec, sizeof(isa_rec.Other));
+         writer.append(&isa, sizeof(isa));
+      }
+
+      for (uint64_t page = addr & Sift::ICACHE_PAGE_MASK; page < addr + size; page += Sift::ICACHE_SIZE)
+      {
+         auto it = icache.find(page);
+         if (it == icache.end() || !block_pages.insert(page).second)
+            continue;
+         Sift::Record icache_rec;
+         icache_rec.Other.zero = 0;
+         icache_rec.Other.type = Sift::RecOtherIcache;
+         icache_rec.Other.size = sizeof(uint64_t) + Sift::ICACHE_SIZE;
+         writer.append(&icache_rec, sizeof(icache_rec.Other));
+         writer.append(&page, sizeof(page));
+         writer.append(it->second.data(), Sift::ICACHE_SIZE);
+      }
+
+      if (block_start && (byte & 0xf) != 0)
+      {
+         // The small encoding takes its address from the previous instruction
+         Sift::Record ext;
+         memset(&ext, 0, sizeof(ext.InstructionExt));
+         ext.InstructionExt.size = size;
+         ext.InstructionExt.num_addresses = rec.Instruction.num_addresses;
+         ext.InstructionExt.is_branch = rec.Instruction.is_branch;
+         ext.InstructionExt.taken = rec.Instruction.taken;
+         ext.InstructionExt.executed = 1;
+         ext.InstructionExt.addr = addr;
+         writer.append(&ext, sizeof(ext.InstructionExt));
+      }
+      else
+      {
+         writer.append(&rec, (byte & 0xf) ? sizeof(rec.Instruction) : sizeof(rec.InstructionExt));
+      }
+      writer.append(addresses, num_addresses * sizeof(uint64_t));
+      writer.num_instructions++;
+   }
+
+   if (!seen_end)
+      fprintf(stderr, "Warning: %s has no End record, it is probably truncated\n", input_filename);
+
+   Sift::Record end;
+   end.Other.zero = 0;
+   end.Other.type = Sift::RecOtherEnd;
+   end.Other.size = 0;
+   writer.append(&end, sizeof(end.Other));
+   if (!writer.flush())
+   {
+      fprintf(stderr, "Cannot write %s\n", output_filename);
+      return 1;
+   }
+   delete input;
+
+   file_hdr.num_blocks = writer.index.size();
+   file_hdr.num_instructions = writer.num_instructions;
+   file_hdr.max_block_size = writer.max_block_size;
+   file_hdr.index_offset = writer.offset;
+   if (fwrite(writer.index.data(), sizeof(Sift::BlockIndexEntry), writer.index.size(), out) != writer.index.size()
+       || fseek(out, 0, SEEK_SET) != 0 || fwrite(&file_hdr, sizeof(file_hdr), 1, out) != 1 || fclose(out) != 0)
+   {
+      fprintf(stderr, "Cannot write %s\n", output_filename);
+      return 1;
+   }
+
+   printf("%s: %" PRIu64 " instructions in %" PRIu64 " blocks of up to %" PRIu64 " bytes, %" PRIu64 " bytes compressed\n",
+          output_filename, file_hdr.num_instructions, file_hdr.num_blocks, file_hdr.max_block_size, writer.offset);
+   return 0;
+}
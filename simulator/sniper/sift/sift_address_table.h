@@ -0,0 +1,122 @@
+#ifndef __SIFT_ADDRESS_TABLE_H
+#define __SIFT_ADDRESS_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Sift
+{
+   // Map from addresses (PCs, page numbers) to small values, for lookups done on every
+   // dynamic instruction: open addressing with linear probing in one flat array, so a
+   // lookup is a multiply and usually a single cache line, where an unordered_map walks
+   // a bucket list of separately allocated nodes.
+   //
+   // Entries cannot be erased. References returned by find() and insert() are valid
+   // until the next insert() of a new address (the table may grow).
+   template <typename V>
+   class AddressTable
+   {
+      public:
+         AddressTable(size_t capacity = 1024)
+            : m_size(0)
+         {
+            size_t slots = 16;
+            while (slots < 2 * capacity)
+               slots *= 2;
+            resize(slots);
+         }
+
+         V* find(uint64_t address)
+         {
+            for (size_t index = hash(address); ; index = (index + 1) & m_mask)
+            {
+               Slot &slot = m_slots[index];
+               if (slot.address == address)
+                  return &slot.value;
+               if (slot.address == EMPTY)
+                  return NULL;
+            }
+         }
+
+         const V* find(uint64_t address) const
+         {
+            return const_cast<AddressTable*>(this)->find(address);
+         }
+
+         // Value for address, value-initialized if address is new
+         V& insert(uint64_t address)
+         {
+            if (2 * (m_size + 1) > m_slots.size())
+               resize(2 * m_slots.size());
+
+            size_t index = hash(address);
+            while (m_slots[index].address != address && m_slots[index].address != EMPTY)
+               index = (index + 1) & m_mask;
+            Slot &slot = m_slots[index];
+            if (slot.address == EMPTY)
+            {
+               slot.address = address;
+               slot.value = V();
+               m_size++;
+            }
+            return slot.value;
+         }
+
+         size_t size() const { return m_size; }
+
+         template <typename F> void forEach(F func)
+         {
+            for (Slot &slot : m_slots)
+               if (slot.address != EMPTY)
+                  func(slot.address, slot.value);
+         }
+
+      private:
+         // Neither a PC nor a page number
+         static const uint64_t EMPTY = ~uint64_t(0);
+
+         struct Slot
+         {
+            uint64_t address;
+            V value;
+         };
+
+         std::vector<Slot> m_slots;
+         size_t m_mask;
+         size_t m_size;
+         int m_shift;
+
+         // Fibonacci hashing: the top bits of the product mix all bits of address, which
+         // matters as PCs and page numbers share their high bits
+         size_t hash(uint64_t address) const
+         {
+            return (address * 0x9e3779b97f4a7c15ULL) >> m_shift;
+         }
+
+         void resize(size_t slots)
+         {
+            std::vector<Slot> old;
+            old.swap(m_slots);
+            m_slots.resize(slots);
+            for (Slot &slot : m_slots)
+               slot.address = EMPTY;
+            m_mask = slots - 1;
+            m_shift = 64;
+            for (size_t s = slots; s > 1; s >>= 1)
+               m_shift--;
+
+            for (Slot &slot : old)
+            {
+               if (slot.address == EMPTY)
+                  continue;
+               size_t index = hash(slot.address);
+               while (m_slots[index].address != EMPTY)
+                  index = (index + 1) & m_mask;
+               m_slots[index] = slot;
+            }
+         }
+   };
+}
+
+#endif // __SIFT_ADDRESS_TABLE_H
@@ -0,0 +1,298 @@
+#include "sift_blocks.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if SIFT_USE_ZLIB
+# include <zlib.h>
+#endif
+
+iblockstream::iblockstream(const char *filename, unsigned int threads, unsigned int prefetch_blocks)
+   : m_base(NULL)
+   , m_size(0)
+   , m_index(NULL)
+   , m_fail(true)
+   , m_block(0)
+   , m_current(NULL)
+   , m_pos(0)
+#if SIFT_USE_THREADS
+   , m_stop(false)
+#endif
+{
+   memset(&m_header, 0, sizeof(m_header));
+#if SIFT_USE_THREADS
+   pthread_mutex_init(&m_lock, NULL);
+   pthread_cond_init(&m_work, NULL);
+   pthread_cond_init(&m_done, NULL);
+#endif
+
+#if !SIFT_USE_ZLIB
+   m_error = "block-indexed traces need zlib, which is disabled at compile time";
+   return;
+#endif
+
+   int fd = open(filename, O_RDONLY);
+   if (fd < 0)
+   {
+      m_error = std::string("cannot open ") + filename;
+      return;
+   }
+   struct stat st;
+   if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(m_header))
+   {
+      close(fd);
+      m_error = std::string(filename) + " is not a block-indexed trace";
+      return;
+   }
+   void *base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   close(fd);
+   if (base == MAP_FAILED)
+   {
+      m_error = std::string("cannot map ") + filename;
+      return;
+   }
+   m_base = static_cast<const char*>(base);
+   m_size = st.st_size;
+
+   memcpy(&m_header, m_base, sizeof(m_header));
+   if (m_header.magic != Sift::BlockMagicNumber || m_header.version != Sift::BlockVersion)
+      m_error = std::string(filename) + " is not a version " + std::to_string(Sift::BlockVersion) + " block-indexed trace";
+   else if (m_header.index_offset > m_size
+            || m_header.num_blocks > (m_size - m_header.index_offset) / sizeof(Sift::BlockIndexEntry))
+      m_error = std::string(filename) + " is truncated";
+
+   m_index = reinterpret_cast<const Sift::BlockIndexEntry*>(m_base + m_header.index_offset);
+   for (uint64_t i = 0; m_error.empty() && i < m_header.num_blocks; i++)
+   {
+      if (m_index[i].offset > m_size || m_index[i].compressed_size > m_size - m_index[i].offset
+          || m_index[i].size > m_header.max_block_size)
+         m_error = std::string(filename) + " has a corrupt block index";
+   }
+   if (!m_error.empty())
+   {
+      munmap(const_cast<char*>(m_base), m_size);
+      m_base = NULL;
+      return;
+   }
+   m_fail = false;
+
+   // Blocks are decompressed ahead only with helper threads; the ring needs room for the
+   // block being read plus one block per thread at least
+#if SIFT_USE_THREADS
+   prefetch_blocks = std::max(prefetch_blocks, threads + 1);
+#else
+   threads = 0;
+#endif
+   m_slots.resize(threads ? prefetch_blocks : 1);
+   for (auto &slot : m_slots)
+   {
+      slot.data.resize(m_header.max_block_size);
+      slot.block = UINT64_MAX;
+      slot.state = SlotFree;
+   }
+
+#if SIFT_USE_THREADS
+   for (unsigned int i = 0; i < threads; i++)
+   {
+      pthread_t thread;
+      if (pthread_create(&thread, NULL, __worker, this) == 0)
+         m_threads.push_back(thread);
+   }
+   if (m_threads.empty())
+      m_slots.resize(1); // No helper threads after all: decompress inline
+#endif
+}
+
+iblockstream::~iblockstream()
+{
+#if SIFT_USE_THREADS
+   pthread_mutex_lock(&m_lock);
+   m_stop = true;
+   pthread_cond_broadcast(&m_work);
+   pthread_mutex_unlock(&m_lock);
+   for (auto &thread : m_threads)
+      pthread_join(thread, NULL);
+   pthread_cond_destroy(&m_done);
+   pthread_cond_destroy(&m_work);
+   pthread_mutex_destroy(&m_lock);
+#endif
+   if (m_base)
+      munmap(const_cast<char*>(m_base), m_size);
+}
+
+uint64_t iblockstream::findBlock(uint64_t instruction) const
+{
+   // Last block whose first instruction is not after instruction
+   const Sift::BlockIndexEntry *end = m_index + m_header.num_blocks;
+   const Sift::BlockIndexEntry *it = std::upper_bound(m_index, end, instruction,
+      [](uint64_t icount, const Sift::BlockIndexEntry &entry) { return icount < entry.first_instruction; });
+   return it == m_index ? 0 : (it - m_index) - 1;
+}
+
+void iblockstream::seekBlock(uint64_t block)
+{
+#if SIFT_USE_THREADS
+   pthread_mutex_lock(&m_lock);
+#endif
+   m_block = block;
+   m_current = NULL;
+   m_pos = 0;
+   m_fail = !is_open();
+#if SIFT_USE_THREADS
+   pthread_cond_broadcast(&m_work);
+   pthread_mutex_unlock(&m_lock);
+#endif
+}
+
+uint64_t iblockstream::getPosition() const
+{
+   if (m_header.num_blocks == 0)
+      return 0;
+   return m_index[std::min(m_block, m_header.num_blocks - 1)].offset;
+}
+
+void iblockstream::read(char* s, std::streamsize n)
+{
+   while (n > 0)
+   {
+      if ((!m_current || m_pos == m_index[m_block].size) && !load(m_current != NULL))
+      {
+         m_fail = true;
+         return;
+      }
+      size_t amount = std::min<size_t>(n, m_index[m_block].size - m_pos);
+      memcpy(s, m_current->data.data() + m_pos, amount);
+      m_pos += amount;
+      s += amount;
+      n -= amount;
+   }
+}
+
+int iblockstream::peek()
+{
+   // Empty blocks are skipped
+   while (!m_current || m_pos == m_index[m_block].size)
+   {
+      if (!load(m_current != NULL))
+      {
+         m_fail = true;
+         return EOF;
+      }
+   }
+   return (unsigned char)m_current->data[m_pos];
+}
+
+bool iblockstream::decompress(uint64_t block, Slot &slot) const
+{
+#if SIFT_USE_ZLIB
+   const Sift::BlockIndexEntry &entry = m_index[block];
+   uLongf size = entry.size;
+   int ret = uncompress(reinterpret_cast<Bytef*>(slot.data.data()), &size,
+                        reinterpret_cast<const Bytef*>(m_base + entry.offset), entry.compressed_size);
+   return ret == Z_OK && size == entry.size;
+#else
+   return false;
+#endif
+}
+
+bool iblockstream::load(bool advance)
+{
+   if (m_fail)
+      return false;
+
+#if SIFT_USE_THREADS
+   if (!m_threads.empty())
+   {
+      pthread_mutex_lock(&m_lock);
+      if (advance)
+         m_block++;
+      m_current = NULL;
+      m_pos = 0;
+      if (m_block >= m_header.num_blocks)
+      {
+         pthread_mutex_unlock(&m_lock);
+         return false;
+      }
+
+      // The window moved: the slot of the block just read is free for a new one
+      pthread_cond_broadcast(&m_work);
+
+      Slot &slot = m_slots[m_block % m_slots.size()];
+      while (slot.block != m_block || (slot.state != SlotReady && slot.state != SlotFailed))
+         pthread_cond_wait(&m_done, &m_lock);
+      bool ok = slot.state == SlotReady;
+      if (ok)
+         m_current = &slot;
+      else
+         m_error = "corrupt block " + std::to_string(m_block);
+      pthread_mutex_unlock(&m_lock);
+      return ok;
+   }
+#endif
+
+   if (advance)
+      m_block++;
+   m_current = NULL;
+   m_pos = 0;
+   if (m_block >= m_header.num_blocks)
+      return false;
+
+   Slot &slot = m_slots[0];
+   if (slot.block != m_block || slot.state != SlotReady)
+   {
+      slot.block = m_block;
+      slot.state = decompress(m_block, slot) ? SlotReady : SlotFailed;
+   }
+   if (slot.state == SlotFailed)
+   {
+      m_error = "corrupt block " + std::to_string(m_block);
+      return false;
+   }
+   m_current = &slot;
+   return true;
+}
+
+#if SIFT_USE_THREADS
+void iblockstream::worker()
+{
+   pthread_mutex_lock(&m_lock);
+   while (true)
+   {
+      // Nearest block of the window [m_block, m_block + slots) that no slot holds or is working on
+      Slot *slot = NULL;
+      uint64_t block = m_block;
+      uint64_t window_end = std::min<uint64_t>(m_block + m_slots.size(), m_header.num_blocks);
+      for (; block < window_end; block++)
+      {
+         Slot &candidate = m_slots[block % m_slots.size()];
+         if (candidate.state != SlotBusy && (candidate.block != block || candidate.state == SlotFree))
+         {
+            slot = &candidate;
+            break;
+         }
+      }
+
+      if (m_stop)
+         break;
+      if (!slot)
+      {
+         pthread_cond_wait(&m_work, &m_lock);
+         continue;
+      }
+
+      // Busy slots are left alone by everyone else, so decompress without the lock
+      slot->block = block;
+      slot->state = SlotBusy;
+      pthread_mutex_unlock(&m_lock);
+      bool ok = decompress(block, *slot);
+      pthread_mutex_lock(&m_lock);
+      slot->state = ok ? SlotReady : SlotFailed;
+      pthread_cond_broadcast(&m_done);
+   }
+   pthread_mutex_unlock(&m_lock);
+}
+#endif
@@ -0,0 +1,77 @@
+#ifndef __SIFT_BLOCKS_H
+#define __SIFT_BLOCKS_H
+
+#include "sift_format.h"
+#include "zfstream.h"
+
+#include <string>
+#include <vector>
+
+#if SIFT_USE_THREADS
+# include <pthread.h>
+#endif
+
+// Reads the record stream of a block-indexed trace (see sift_format.h)
+//
+// The file is mapped read-only. Helper threads decompress the blocks that follow the one
+// being read into a ring of prefetch_blocks buffers, so the reading thread mostly copies
+// out of memory. Without helper threads, a block is decompressed when reading gets to it.
+class iblockstream : public vistream
+{
+   public:
+      iblockstream(const char *filename, unsigned int threads, unsigned int prefetch_blocks);
+      virtual ~iblockstream();
+      virtual void read(char* s, std::streamsize n);
+      virtual int peek();
+      virtual bool fail() const { return m_fail; }
+
+      bool is_open() const { return m_base != NULL; }
+      const std::string &error() const { return m_error; }
+      const Sift::BlockFileHeader &header() const { return m_header; }
+
+      // Block holding instruction (counted from the start of the trace)
+      uint64_t findBlock(uint64_t instruction) const;
+      uint64_t firstInstruction(uint64_t block) const { return m_index[block].first_instruction; }
+      // Continue reading at the start of block
+      void seekBlock(uint64_t block);
+      // File offset of the block being read, for progress reporting
+      uint64_t getPosition() const;
+
+   private:
+      enum SlotState { SlotFree, SlotBusy, SlotReady, SlotFailed };
+      struct Slot
+      {
+         std::vector<char> data;
+         uint64_t block;
+         SlotState state;
+      };
+
+      const char *m_base;
+      size_t m_size;
+      Sift::BlockFileHeader m_header;
+      const Sift::BlockIndexEntry *m_index;
+      std::string m_error;
+      bool m_fail;
+
+      std::vector<Slot> m_slots;    // Block b is decompressed into m_slots[b % m_slots.size()]
+      uint64_t m_block;             // Block being read
+      const Slot *m_current;        // Its slot, once decompressed
+      size_t m_pos;                 // Read position in m_current
+
+#if SIFT_USE_THREADS
+      std::vector<pthread_t> m_threads;
+      pthread_mutex_t m_lock;
+      pthread_cond_t m_work;  // Workers wait for a block of the window to decompress
+      pthread_cond_t m_done;  // The reader waits for its block
+      bool m_stop;
+
+      static void *__worker(void *arg) { static_cast<iblockstream*>(arg)->worker(); return NULL; }
+      void worker();
+#endif
+
+      bool decompress(uint64_t block, Slot &slot) const;
+      // Point m_current at m_block, advancing to the next block first if advance is set
+      bool load(bool advance);
+};
+
+#endif // __SIFT_BLOCKS_H
@@ -18,6 +18,13 @@
 # define SIFT_USE_ZLIB 1
 #endif
 
+// PinCRT has no std::thread: block-indexed traces are then decompressed by the reading thread
+#if defined(PIN_CRT)
+# define SIFT_USE_THREADS 0
+#else
+# define SIFT_USE_THREADS 1
+#endif
+
 namespace Sift
 {
 
@@ -183,6 +190,45 @@ namespace Sift
       CacheOnlyMemIcache,
    } CacheOnlyType;
 
+   // Block-indexed trace files
+   //
+   // The SIFT record stream (without its Header) cut into blocks at instruction boundaries,
+   // each block compressed with zlib on its own, followed by an index of the blocks:
+   //
+   //   BlockFileHeader | block 0 | block 1 | ... | BlockIndexEntry[num_blocks]
+   //
+   // Blocks are self-contained (see sift2blocks): their first instruction uses the extended
+   // encoding and they carry the ISA and the icache pages their instructions need, so that
+   // decoding can start at any block.
+
+   const uint64_t BlockMagicNumber = 0x534b434f4c425453; // "STBLOCKS"
+   const uint32_t BlockVersion = 1;
+
+   typedef enum
+   {
+      BlockSeekable = 1,         //< Decoding may start at any block (not with PhysicalAddress traces)
+   } BlockFlag;
+
+   typedef struct
+   {
+      uint64_t magic;
+      uint32_t version;
+      uint32_t flags;            //< Bit field of BlockFlag flags
+      uint64_t options;          //< Header::options of the record stream (never CompressionZlib)
+      uint64_t num_blocks;
+      uint64_t num_instructions;
+      uint64_t max_block_size;   //< Largest uncompressed block, in bytes
+      uint64_t index_offset;     //< File offset of the BlockIndexEntry array
+   } __attribute__ ((__packed__)) BlockFileHeader;
+
+   typedef struct
+   {
+      uint64_t offset;           //< File offset of the compressed block
+      uint64_t compressed_size;
+      uint64_t size;             //< Uncompressed size
+      uint64_t first_instruction;
+   } __attribute__ ((__packed__)) BlockIndexEntry;
+
    // Determine record type based on first uint8_t
    inline bool IsInstructionSimple(uint8_t byte) { return byte > 0; }
 
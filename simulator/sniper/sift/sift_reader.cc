@@ -2,6 +2,7 @@
 #include "sift_format.h"
 #include "sift_utils.h"
 #include "zfstream.h"
+#include "sift_blocks.h"
 
 #include <array>
 #include <iostream>
@@ -13,6 +14,9 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#if SIFT_USE_THREADS
+# include <pthread.h>
+#endif
 
 #include "../../../../ChampSim/inc/trace_instruction.h"
 #include "../../../../ChampSim/inc/inf_stream.h"
@@ -50,6 +54,123 @@ namespace
          return static_cast<size_t>(stream.gcount());
       }
    };
+
+#if SIFT_USE_THREADS
+   // Inflate a ChampSimStream on a helper thread, a few chunks ahead of the reader
+   struct ReadAheadChampSimStream : public Sift::Reader::ChampSimStream
+   {
+      static const size_t CHUNK_SIZE = 1 << 20;
+
+      struct Chunk
+      {
+         std::vector<char> data;
+         size_t size;   // Less than CHUNK_SIZE: last chunk of the stream
+         bool filled;
+      };
+
+      std::unique_ptr<Sift::Reader::ChampSimStream> source;
+      std::vector<Chunk> chunks;
+      size_t read_chunk, read_pos;
+      bool stop;
+      pthread_mutex_t lock;
+      pthread_cond_t cond;
+      pthread_t thread;
+      bool running;
+
+      ReadAheadChampSimStream(Sift::Reader::ChampSimStream *source, unsigned int num_chunks)
+         : source(source)
+         , chunks(std::max(num_chunks, 2u))
+         , read_chunk(0)
+         , read_pos(0)
+         , stop(false)
+      {
+         for (auto &chunk : chunks)
+         {
+            chunk.data.resize(CHUNK_SIZE);
+            chunk.size = 0;
+            chunk.filled = false;
+         }
+         pthread_mutex_init(&lock, NULL);
+         pthread_cond_init(&cond, NULL);
+         running = pthread_create(&thread, NULL, __fill, this) == 0;
+      }
+
+      ~ReadAheadChampSimStream()
+      {
+         pthread_mutex_lock(&lock);
+         stop = true;
+         pthread_cond_broadcast(&cond);
+         pthread_mutex_unlock(&lock);
+         if (running)
+            pthread_join(thread, NULL);
+         pthread_cond_destroy(&cond);
+         pthread_mutex_destroy(&lock);
+      }
+
+      static void *__fill(void *arg) { static_cast<ReadAheadChampSimStream*>(arg)->fill(); return NULL; }
+
+      void fill()
+      {
+         pthread_mutex_lock(&lock);
+         for (size_t index = 0; ; index = (index + 1) % chunks.size())
+         {
+            Chunk &chunk = chunks[index];
+            while (!stop && chunk.filled)
+               pthread_cond_wait(&cond, &lock);
+            if (stop)
+               break;
+
+            // Only this thread touches an unfilled chunk
+            pthread_mutex_unlock(&lock);
+            size_t size = 0;
+            while (size < CHUNK_SIZE)
+            {
+               size_t amount = source->read_bytes(chunk.data.data() + size, CHUNK_SIZE - size);
+               if (amount == 0)
+                  break;
+               size += amount;
+            }
+            pthread_mutex_lock(&lock);
+            chunk.size = size;
+            chunk.filled = true;
+            pthread_cond_broadcast(&cond);
+            if (size < CHUNK_SIZE)
+               break;
+         }
+         pthread_mutex_unlock(&lock);
+      }
+
+      size_t read_bytes(void *dst, size_t len) override
+      {
+         if (!running)
+            return source->read_bytes(dst, len);
+
+         char *out = reinterpret_cast<char*>(dst);
+         size_t done = 0;
+         pthread_mutex_lock(&lock);
+         while (done < len)
+         {
+            Chunk &chunk = chunks[read_chunk];
+            while (!chunk.filled)
+               pthread_cond_wait(&cond, &lock);
+            size_t amount = std::min(len - done, chunk.size - read_pos);
+            memcpy(out + done, chunk.data.data() + read_pos, amount);
+            done += amount;
+            read_pos += amount;
+            if (read_pos < chunk.size)
+               continue;
+            if (chunk.size < CHUNK_SIZE)
+               break; // End of the stream: the chunk stays filled
+            chunk.filled = false;
+            read_chunk = (read_chunk + 1) % chunks.size();
+            read_pos = 0;
+            pthread_cond_broadcast(&cond);
+         }
+         pthread_mutex_unlock(&lock);
+         return done;
+      }
+   };
+#endif
 }
 
 namespace Sift
@@ -85,6 +206,7 @@ Reader::Reader(const char *filename, const char *response_filename, uint32_t id,
    , icache()
    , scache()
    , vcache()
+   , m_sinst_chunk_used(0)
    , m_id(id)
    , m_trace_has_pa(false)
    , m_seen_end(false)
@@ -92,6 +214,9 @@ Reader::Reader(const char *filename, const char *response_filename, uint32_t id,
    , m_isa(0)
    , m_format(format)
    , m_champsim_stream()
+   , m_blocks(NULL)
+   , m_decompression_threads(0)
+   , m_prefetch_blocks(8)
 {
    m_filename = strdup(filename);
    m_response_filename = strdup(response_filename);
@@ -102,17 +227,17 @@ Reader::~Reader()
    free(m_filename);
    free(m_response_filename);
    if (input)
-      delete input;
+      delete input; // Owns inputstream
+   else if (inputstream)
+      delete inputstream;
    if (response)
       delete response;
-   if (inputstream)
-      delete inputstream;
 
    for (std::unordered_map<uint64_t, const uint8_t*>::iterator i = icache.begin(); i != icache.end(); ++i)
       delete [] (*i).second;
 
-   for (std::unordered_map<uint64_t, const StaticInstruction*>::iterator i = scache.begin(); i != scache.end(); ++i)
-      delete (*i).second;
+   for (StaticInstruction *chunk : m_sinst_chunks)
+      delete [] chunk;
 }
 
 void Reader::resetStream()
@@ -124,6 +249,27 @@ void Reader::resetStream()
    }
 }
 
+void Reader::openChampSimStream(const std::string &fname, bool is_gz, bool is_xz, bool is_bz2)
+{
+   if (is_gz)
+      m_champsim_stream.reset(new InflatingChampSimStream<champsim::decomp_tags::gzip_tag_t<>>(fname));
+   else if (is_xz)
+      m_champsim_stream.reset(new InflatingChampSimStream<champsim::decomp_tags::lzma_tag_t<>>(fname));
+   else if (is_bz2)
+      m_champsim_stream.reset(new InflatingChampSimStream<champsim::decomp_tags::bzip2_tag_t>(fname));
+   else
+   {
+      m_champsim_stream.reset(new IfstreamChampSimStream(inputstream));
+      return;
+   }
+
+#if SIFT_USE_THREADS
+   // Inflating is as expensive as simulating: move it off the simulation thread
+   if (m_decompression_threads > 0)
+      m_champsim_stream.reset(new ReadAheadChampSimStream(m_champsim_stream.release(), m_prefetch_blocks));
+#endif
+}
+
 bool Reader::initStream()
 {
 #if VERBOSE > 0
@@ -158,19 +304,7 @@ bool Reader::initStream()
    {
       std::cout << "[Frontend] Using ChampSim format for trace input\n";
 
-      if (maybe_champsim_compressed)
-      {
-         if (is_gz)
-            m_champsim_stream.reset(new InflatingChampSimStream<champsim::decomp_tags::gzip_tag_t<>>(fname));
-         else if (is_xz)
-            m_champsim_stream.reset(new InflatingChampSimStream<champsim::decomp_tags::lzma_tag_t<>>(fname));
-         else if (is_bz2)
-            m_champsim_stream.reset(new InflatingChampSimStream<champsim::decomp_tags::bzip2_tag_t>(fname));
-      }
-      else
-      {
-         m_champsim_stream.reset(new IfstreamChampSimStream(inputstream));
-      }
+      openChampSimStream(fname, is_gz, is_xz, is_bz2);
 
       return true;
    }
@@ -180,6 +314,27 @@ bool Reader::initStream()
 
    Sift::Header hdr;
    input->read(reinterpret_cast<char*>(&hdr), sizeof(hdr));
+
+   // Block-indexed SIFT: the file is mapped and decompressed by iblockstream, whose record
+   // stream has no Header of its own (its options are in the BlockFileHeader)
+   uint64_t block_magic;
+   memcpy(&block_magic, &hdr, sizeof(block_magic));
+   if (block_magic == BlockMagicNumber)
+   {
+      delete input; // Also closes inputstream
+      inputstream = NULL;
+      m_blocks = new iblockstream(m_filename, m_decompression_threads, m_prefetch_blocks);
+      input = m_blocks;
+      if (!m_blocks->is_open())
+      {
+         std::cerr << "[SIFT:" << m_id << "] " << m_blocks->error() << "\n";
+         return false;
+      }
+      hdr.magic = Sift::MagicNumber;
+      hdr.size = 0;
+      hdr.options = m_blocks->header().options;
+   }
+
    if (hdr.magic != Sift::MagicNumber)
    {
       // Fallback: if we were in Auto mode, try to interpret as ChampSim trace
@@ -190,19 +345,7 @@ bool Reader::initStream()
 
          std::cout << "[Frontend] SIFT magic mismatch, falling back to ChampSim format\n";
 
-         if (maybe_champsim_compressed)
-         {
-            if (is_gz)
-               m_champsim_stream.reset(new InflatingChampSimStream<champsim::decomp_tags::gzip_tag_t<>>(fname));
-            else if (is_xz)
-               m_champsim_stream.reset(new InflatingChampSimStream<champsim::decomp_tags::lzma_tag_t<>>(fname));
-            else if (is_bz2)
-               m_champsim_stream.reset(new InflatingChampSimStream<champsim::decomp_tags::bzip2_tag_t>(fname));
-         }
-         else
-         {
-            m_champsim_stream.reset(new IfstreamChampSimStream(inputstream));
-         }
+         openChampSimStream(fname, is_gz, is_xz, is_bz2);
 
          return true;
       }
@@ -337,10 +480,15 @@ bool Reader::Read(Instruction &inst)
             {
                assert(rec.Other.size == sizeof(uint64_t) + ICACHE_SIZE);
                uint64_t address;
-               uint8_t *bytes = new uint8_t[ICACHE_SIZE];
                input->read(reinterpret_cast<char*>(&address), sizeof(uint64_t));
+               // Block-indexed traces repeat pages in every block that uses them: reuse the buffer
+               uint8_t *bytes = const_cast<uint8_t*>(icache[address]);
+               if (!bytes)
+               {
+                  bytes = new uint8_t[ICACHE_SIZE];
+                  icache[address] = bytes;
+               }
                input->read(reinterpret_cast<char*>(bytes), ICACHE_SIZE);
-               icache[address] = bytes;
                break;
             }
 
@@ -380,7 +528,7 @@ bool Reader::Read(Instruction &inst)
                uint64_t vp, pp;
                input->read(reinterpret_cast<char*>(&vp), sizeof(uint64_t));
                input->read(reinterpret_cast<char*>(&pp), sizeof(uint64_t));
-               vcache[vp] = pp;
+               vcache.insert(vp) = pp;
                break;
             }
 
@@ -894,9 +1042,20 @@ bool Reader::AccessMemory(MemoryLockType lock_signal, MemoryOpType mem_op, uint6
    return true;
 }
 
+StaticInstruction* Reader::newStaticInstruction()
+{
+   const size_t CHUNK_SIZE = 1024;
+   if (m_sinst_chunks.empty() || m_sinst_chunk_used == CHUNK_SIZE)
+   {
+      m_sinst_chunks.push_back(new StaticInstruction[CHUNK_SIZE]);
+      m_sinst_chunk_used = 0;
+   }
+   return &m_sinst_chunks.back()[m_sinst_chunk_used++];
+}
+
 const StaticInstruction* Reader::staticInfoInstruction(uint64_t addr, uint8_t size)
 {
-   StaticInstruction *sinst = new StaticInstruction();
+   StaticInstruction *sinst = newStaticInstruction();
    sinst->addr = addr;
    sinst->size = size;
    sinst->next = NULL;
@@ -930,15 +1089,15 @@ const StaticInstruction* Reader::getStaticInstruction(uint64_t addr, uint8_t siz
    {
       sinst = m_last_sinst->next;
    }
-   else if (scache.count(addr))
+   else if (const StaticInstruction **cached = scache.find(addr))
    {
-      sinst = scache[addr];
+      sinst = *cached;
       assert(sinst->size == size);
    }
    else
    {
       sinst = staticInfoInstruction(addr, size);
-      scache[addr] = sinst;
+      scache.insert(addr) = sinst;
    }
 
    if (m_last_sinst && m_last_sinst->next == NULL)
@@ -958,18 +1117,18 @@ const StaticInstruction* Reader::getChampSimStaticInstruction(uint64_t addr)
    {
       sinst = m_last_sinst->next;
    }
-   else if (scache.count(addr))
+   else if (const StaticInstruction **cached = scache.find(addr))
    {
-      sinst = scache[addr];
+      sinst = *cached;
    }
    else
    {
-      StaticInstruction *new_sinst = new StaticInstruction();
+      StaticInstruction *new_sinst = newStaticInstruction();
       new_sinst->addr = addr;
       new_sinst->size = CHAMPSIM_DEFAULT_INST_SIZE;
       memset(new_sinst->data, 0, sizeof(new_sinst->data));
       new_sinst->next = NULL;
-      scache[addr] = new_sinst;
+      scache.insert(addr) = new_sinst;
       sinst = new_sinst;
    }
 
@@ -1048,8 +1207,43 @@ void Reader::sendSimpleResponse(RecOtherType type, void *data, uint32_t size)
    response->flush();
 }
 
+bool Reader::Seek(uint64_t instruction)
+{
+   if (input == NULL && !m_champsim_stream && !initStream())
+      return false;
+
+   if (!m_blocks || !(m_blocks->header().flags & BlockSeekable))
+   {
+      std::cerr << "[SIFT:" << m_id << "] Cannot seek in " << m_filename << ": not a seekable block-indexed trace (see sift2blocks)\n";
+      return false;
+   }
+   if (instruction >= m_blocks->header().num_instructions)
+   {
+      std::cerr << "[SIFT:" << m_id << "] Cannot seek to instruction " << instruction << ", " << m_filename
+                << " has " << m_blocks->header().num_instructions << "\n";
+      return false;
+   }
+
+   // Blocks are self-contained: decoding starts over at the block holding instruction,
+   // then the instructions before it in the block are read (and their records handled) as usual
+   uint64_t block = m_blocks->findBlock(instruction);
+   m_blocks->seekBlock(block);
+   m_seen_end = false;
+   last_address = 0;
+
+   Instruction inst;
+   for (uint64_t icount = m_blocks->firstInstruction(block); icount < instruction; icount++)
+   {
+      if (!Read(inst))
+         return false;
+   }
+   return true;
+}
+
 uint64_t Reader::getPosition()
 {
+   if (m_blocks)
+      return m_blocks->getPosition();
    if (inputstream)
       return static_cast<uint64_t>(inputstream->tellg());
    else
@@ -1068,14 +1262,14 @@ uint64_t Reader::va2pa(uint64_t va)
       intptr_t vp = va / PAGE_SIZE_SIFT;
       intptr_t vo = va & (PAGE_SIZE_SIFT-1);
 
-      if (vcache.count(vp) == 0)
+      const uint64_t *pp = vcache.find(vp);
+      if (pp == NULL)
       {
          return 0;
       }
       else
       {
-         intptr_t pp = vcache[vp];
-         return (pp * PAGE_SIZE_SIFT) | vo;
+         return (*pp * PAGE_SIZE_SIFT) | vo;
       }
    }
    else
@@ -4,14 +4,17 @@
 #include "sift.h"
 #include "sift_format.h"
 #include "sift_utils.h"
+#include "sift_address_table.h"
 
 #include <unordered_map>
 #include <fstream>
 #include <cassert>
 #include <memory>
+#include <vector>
 
 class vistream;
 class vostream;
+class iblockstream;
 
 namespace Sift
 {
@@ -117,8 +120,12 @@ namespace Sift
 
          uint64_t last_address;
          std::unordered_map<uint64_t, const uint8_t*> icache;
-         std::unordered_map<uint64_t, const StaticInstruction*> scache;
-         std::unordered_map<uint64_t, uint64_t> vcache;
+         AddressTable<const StaticInstruction*> scache;
+         AddressTable<uint64_t> vcache;
+         // StaticInstructions are carved out of chunks, so that the ones decoded together
+         // (a loop, a function) also sit together in memory
+         std::vector<StaticInstruction*> m_sinst_chunks;
+         size_t m_sinst_chunk_used;
 
          uint32_t m_id;
 
@@ -129,9 +136,13 @@ namespace Sift
          int m_isa;
          TraceFormat m_format;
          std::unique_ptr<ChampSimStream> m_champsim_stream;
+         iblockstream *m_blocks;  // input, for block-indexed traces
+         unsigned int m_decompression_threads;
+         unsigned int m_prefetch_blocks;
 
          bool initResponse();
          const Sift::StaticInstruction* staticInfoInstruction(uint64_t addr, uint8_t size);
+         Sift::StaticInstruction* newStaticInstruction();
          const Sift::StaticInstruction* getStaticInstruction(uint64_t addr, uint8_t size);
          const Sift::StaticInstruction* getChampSimStaticInstruction(uint64_t addr);
          void sendSyscallResponse(uint64_t return_code);
@@ -139,12 +150,15 @@ namespace Sift
          void sendSimpleResponse(RecOtherType type, void *data = NULL, uint32_t size = 0);
          bool readChampSim(Instruction &inst);
          void resetStream();
+         void openChampSimStream(const std::string &fname, bool is_gz, bool is_xz, bool is_bz2);
 
       public:
          Reader(const char *filename, const char *response_filename = "", uint32_t id = 0, TraceFormat format = TraceFormat::Auto);
          ~Reader();
          bool initStream();
          bool Read(Instruction&);
+         // Continue reading at the given instruction (block-indexed traces only)
+         bool Seek(uint64_t instruction);
          bool AccessMemory(MemoryLockType lock_signal, MemoryOpType mem_op, uint64_t d_addr, uint8_t *data_buffer, uint32_t data_size);
 
          void setHandleInstructionCountFunc(HandleInstructionCountFunc func, void* arg = NULL) { handleInstructionCountFunc = func; handleInstructionCountArg = arg; }
@@ -157,11 +171,15 @@ namespace Sift
          void setHandleEmuFunc(HandleEmuFunc func, void* arg = NULL) { assert(func); handleEmuFunc = func; handleEmuArg = arg; }
          void setHandleRoutineFunc(HandleRoutineChange funcChange, HandleRoutineAnnounce funcAnnounce, void* arg = NULL) { assert(funcChange); assert(funcAnnounce); handleRoutineChangeFunc = funcChange; handleRoutineAnnounceFunc = funcAnnounce; handleRoutineArg = arg; }
          void setHandleForkFunc(HandleForkFunc func, void* arg = NULL) { assert(func); handleForkFunc = func; handleForkArg = arg;}
+         // Helper threads that decompress ahead of Read (block-indexed SIFT and compressed ChampSim traces),
+         // and how many blocks of a block-indexed trace they keep ready. Call before initStream.
+         void setDecompression(unsigned int threads, unsigned int prefetch_blocks) { m_decompression_threads = threads; m_prefetch_blocks = prefetch_blocks; }
 
          uint64_t getPosition();
          uint64_t getLength();
          bool getTraceHasPhysicalAddresses() const { return m_trace_has_pa; }
          bool isChampSimTrace() const { return m_format == TraceFormat::ChampSim; }
+         bool isBlockIndexed() const { return m_blocks != NULL; }
          TraceFormat getFormat() const { return m_format; }
          uint64_t va2pa(uint64_t va);
          void sendResponseAfterContextSwitch()
@@ -55,6 +55,10 @@ def SniperStats(resultsdir = '.', jobid = None):
     import sniper_stats_jobid
     stats = sniper_stats_jobid.SniperStatsJobid(jobid)
   elif os.path.exists(os.path.join(resultsdir, 'sim.stats.sqlite3')):
+    if os.path.exists(os.path.join(resultsdir, 'sim.stats.bin')):
+      # Values of a general/stats_backend = binary run that were not converted yet
+      import stats_bin2sqlite
+      stats_bin2sqlite.convert(resultsdir)
     import sniper_stats_sqlite
     stats = sniper_stats_sqlite.SniperStatsSqlite(os.path.join(resultsdir, 'sim.stats.sqlite3'))
   elif os.path.exists(os.path.join(resultsdir, 'sim.stats.db')):
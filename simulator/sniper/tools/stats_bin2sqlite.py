@@ -0,0 +1,85 @@
+#!/usr/bin/env python3
+
+# Fill the `values` table of sim.stats.sqlite3 from sim.stats.bin, written when running with
+# general/stats_backend = binary (see common/misc/stats.cc for the file format).
+# sim.stats.bin is removed once its values are in the database.
+
+import sys, os, getopt, struct, array, sqlite3
+
+MAGIC = b'SNSTATS\0'
+VERSION = 1
+RECORD_METRIC, RECORD_SNAPSHOT = 1, 2
+FLAG_DEFAULT_ZERO = 1
+
+def read_values(filename):
+  data = open(filename, 'rb').read()
+  magic, version, _ = struct.unpack_from('=8sII', data, 0)
+  if magic != MAGIC or version != VERSION:
+    raise ValueError('%s is not a version %d binary statistics file' % (filename, VERSION))
+
+  slots = [] # (nameid, core, default_zero) by slot
+  values = []
+  pos = struct.calcsize('=8sII')
+  while pos + 4 <= len(data):
+    rtype, = struct.unpack_from('=I', data, pos)
+    if rtype == RECORD_METRIC:
+      if pos + struct.calcsize('=IIQiI') > len(data):
+        break
+      _, slot, nameid, core, flags = struct.unpack_from('=IIQiI', data, pos)
+      if slot != len(slots):
+        raise ValueError('%s: metric record for slot %d, expected %d' % (filename, slot, len(slots)))
+      slots.append((nameid, core, flags & FLAG_DEFAULT_ZERO))
+      values.append(0)
+      pos += struct.calcsize('=IIQiI')
+    elif rtype == RECORD_SNAPSHOT:
+      _, count, prefixid = struct.unpack_from('=IIQ', data, pos)
+      pos += struct.calcsize('=IIQ')
+      if pos + 12 * count > len(data):
+        break # The simulation did not exit cleanly
+      changed = array.array('I', data[pos:pos + 4 * count])
+      deltas = array.array('Q', data[pos + 4 * count:pos + 12 * count])
+      pos += 12 * count
+      for slot, delta in zip(changed, deltas):
+        values[slot] = (values[slot] + delta) & 0xffffffffffffffff
+      rows = []
+      for (nameid, core, default_zero), value in zip(slots, values):
+        if value == 0 and default_zero:
+          continue
+        # sqlite integers are signed
+        rows.append((prefixid, nameid, core, value - (1 << 64) if value >= (1 << 63) else value))
+      yield prefixid, rows
+    else:
+      raise ValueError('%s: invalid record type %d at offset %d' % (filename, rtype, pos))
+
+
+def convert(resultsdir = '.'):
+  binname = os.path.join(resultsdir, 'sim.stats.bin')
+  db = sqlite3.connect(os.path.join(resultsdir, 'sim.stats.sqlite3'))
+  c = db.cursor()
+  for prefixid, rows in read_values(binname):
+    c.execute('DELETE FROM `values` WHERE prefixid = ?', (prefixid,))
+    c.executemany('INSERT INTO `values` (prefixid, nameid, core, value) VALUES (?, ?, ?, ?)', rows)
+  db.commit()
+  db.close()
+  os.unlink(binname)
+
+
+if __name__ == '__main__':
+  def usage():
+    print('Usage:', sys.argv[0], '[-h (help)] [-d <resultsdir (default: .)>]')
+
+  resultsdir = '.'
+  try:
+    opts, args = getopt.getopt(sys.argv[1:], "hd:")
+  except getopt.GetoptError as e:
+    print(e)
+    usage()
+    sys.exit(1)
+  for o, a in opts:
+    if o == '-h':
+      usage()
+      sys.exit()
+    if o == '-d':
+      resultsdir = a
+
+  convert(resultsdir)